@@ -3,20 +3,52 @@
 * https://thingspeak.mathworks.com/channels/2881290/private_show
 * use http GET request with url containing data to send
 * one cycle (connect to network, to server, send request, close connection) 
-* lasts about 1 second, at the end of the loop() is some delay() because 
+* lasts about 1 second, the next one starts UPLINK_PAUSE_MS later because 
 * free Thingspeak can handle only data update in 15 seconds... 
+* AT commands run as scripts of lib/AtEngine, polled from loop()
 */
 #include <Arduino.h>
-#include <String.h>
 #include <SoftwareSerial.h>
+#include "at_engine.h"
+
+#define UPLINK_PAUSE_MS 10000 // between the end of one cycle and the next
+#define AT_TIMEOUT_MS 5000
 
 // function declarations:
-bool WaitForResponse();
-bool SendCommand(String command);
-bool SendCommandCustomResp(String command, String resp);
-bool WaitForCustomResponse(String resp);
+void onUplinkDone(bool ok, uint8_t step);
+void onCloseDone(bool ok, uint8_t step);
 
 SoftwareSerial gprsSerial(2, 3); // RX, TX
+AtEngine at(gprsSerial);
+
+// one cycle, the request is the data of the script
+const AtStep uplinkScript[] = {
+  {"AT", MODEM_OK, AT_TIMEOUT_MS, 0},
+  // {"AT+CPIN?", MODEM_OK, AT_TIMEOUT_MS, 0}, // SIM pin
+  // {"AT+CREG?", MODEM_OK, AT_TIMEOUT_MS, 0},
+  // {"AT+CSQ", MODEM_OK, AT_TIMEOUT_MS, 0}, // signal quality
+  {"AT+CGATT?", MODEM_OK, AT_TIMEOUT_MS, 0},
+  // start gprs connection
+  {"AT+QICSGP=1,\"internet.t-mobile.cz\",\"gprs\",\"gprs\"", MODEM_OK, AT_TIMEOUT_MS, 0},
+  // set next QIOPEN command to access through domain name (not IP)
+  {"AT+QIDNSIP=1", MODEM_OK, AT_TIMEOUT_MS, 0},
+  // connect to server, wait for response with connection info
+  {"AT+QIOPEN=\"TCP\",\"api.thingspeak.com\",\"80\"", MODEM_OK, AT_TIMEOUT_MS, 0},
+  {nullptr, MODEM_CONNECT_OK, AT_TIMEOUT_MS, 0},
+  // begin http GET request to remote server
+  {"AT+QISEND", MODEM_PROMPT, AT_TIMEOUT_MS, 0},
+  {nullptr, MODEM_SEND_OK, AT_TIMEOUT_MS, AT_SEND_DATA},
+  {nullptr, MODEM_CLOSED, AT_TIMEOUT_MS, 0}, // wait until http connection close
+};
+
+// deactivate gprs context, also after a failed cycle
+const AtStep closeScript[] = {
+  {"AT+QIDEACT", MODEM_DEACT_OK, AT_TIMEOUT_MS, 0},
+};
+
+char request[128];
+unsigned long cycleEnd = 0;
+bool cycleRunning = false;
 
 void setup()
 {
@@ -25,12 +57,20 @@ void setup()
   while (!Serial || !gprsSerial)
     ; // wait until Serial streams are ready
   delay(200);
+  at.setEcho(&Serial);
+  cycleEnd = millis() - UPLINK_PAUSE_MS;
 }
 
+// Modem replies are handled by at.poll(), loop() never waits for them
 void loop()
 {
-  float h = random(0,100); //dht.readHumidity();
-  float t = random(-20,50); //dht.readTemperature();
+  at.poll();
+  if (cycleRunning || millis() - cycleEnd < UPLINK_PAUSE_MS) {
+    return;
+  }
+
+  long h = random(0,100); //dht.readHumidity();
+  long t = random(-20,50); //dht.readTemperature();
 
   Serial.print("Temperature = ");
   Serial.print(t);
@@ -39,115 +79,27 @@ void loop()
   Serial.print(h);
   Serial.println(" %");
 
-  if (gprsSerial.available())
-    Serial.write(gprsSerial.read());
-
-  SendCommand("AT");
-
-  // SendCommand("AT+CPIN?"); // SIM pin
-  // SendCommand("AT+CREG?"); 
-  // SendCommand("AT+CSQ"); // signal quality
-  
-  SendCommand("AT+CGATT?");
-  
-  // start gprs connection
-  SendCommand("AT+QICSGP=1,\"internet.t-mobile.cz\",\"gprs\",\"gprs\""); 
-  
-  // set next QIOPEN command to access through domain name (not IP)
-  SendCommand("AT+QIDNSIP=1");                                           
-  
-  // connect to server
-  SendCommand("AT+QIOPEN=\"TCP\",\"api.thingspeak.com\",\"80\"");        
-  
-  // wait for response with connection info
-  WaitForCustomResponse("CONNECT");                                      
-  
-  // begin http GET request to remote server
-  SendCommandCustomResp("AT+QISEND", ">");    
-
-  String str = "GET https://api.thingspeak.com/update?api_key=S8QL4UGSKU4E3NUH&field1=" + String(t) + "&field2=" + String(h);
-  gprsSerial.println(str);
-  gprsSerial.println((char)26); // end of message
-  WaitForCustomResponse("SEND");
-  WaitForCustomResponse("CLOSED"); // wait until http connection close
-  SendCommandCustomResp("AT+QIDEACT", "DEACT"); // deactivate gprs context
-  delay(10000);
+  int len = snprintf(request, sizeof(request),
+                     "GET https://api.thingspeak.com/update?api_key=S8QL4UGSKU4E3NUH&field1=%ld&field2=%ld\r\n", t, h);
+  cycleRunning = true;
+  at.run(uplinkScript, sizeof(uplinkScript) / sizeof(uplinkScript[0]), onUplinkDone, request, len);
+  at.run(closeScript, 1, onCloseDone);
 }
 
 // fuction definitions ---------------------------
-//...
 
-// inspired by https://forum.arduino.cc/t/purpose-of-delay-in-sim800l-at-commands/1024205/8
-
-bool WaitForResponse()
+void onUplinkDone(bool ok, uint8_t step)
 {
-  unsigned long startTime = millis();
-  while (millis() - startTime < 5000)
-  {
-    String reply = gprsSerial.readStringUntil('\n');
-    if (reply.length() > 0)
-    {
-      Serial.print("Received: \"");
-      Serial.print(reply);
-      Serial.println("\"");
-
-      if (reply.startsWith("OK"))
-        return true;
-
-      if (reply.startsWith("ERROR"))
-        return false;
-    }
+  if (!ok) {
+    Serial.print("Uplink failed at step ");
+    Serial.println(step);
   }
-  Serial.println("Did not receive OK.");
-  return false;
-}
-
-bool SendCommand(String command)
-{
-  Serial.print("Sending command: \"");
-  Serial.print(command);
-  Serial.println("\"");
-
-  gprsSerial.print(command);
-  gprsSerial.print("\r\n");
-
-  return WaitForResponse();
 }
 
-bool SendCommandCustomResp(String command, String resp)
+void onCloseDone(bool ok, uint8_t step)
 {
-  Serial.print("Sending command: \"");
-  Serial.print(command);
-  Serial.println("\"");
-
-  gprsSerial.print(command);
-  gprsSerial.print("\r\n");
-
-  return WaitForCustomResponse(resp);
-}
-
-bool WaitForCustomResponse(String resp)
-{
-  unsigned long startTime = millis();
-  while (millis() - startTime < 5000) // TIMEOUT 5 SECONDS!
-  {
-    String reply = gprsSerial.readStringUntil('\n');
-    if (reply.length() > 0)
-    {
-      Serial.print("Received: \"");
-      Serial.print(reply);
-      Serial.println("\"");
-
-      if (reply.startsWith(resp))
-        return true;
-
-      if (reply.startsWith("ERROR"))
-        return false;
-    }
-  }
-  Serial.print("Did not receive ");
-  Serial.println(resp);
-  return false;
+  cycleRunning = false;
+  cycleEnd = millis();
 }
 
 /*
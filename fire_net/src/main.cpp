@@ -1,25 +1,44 @@
 #include <Arduino.h>
 #include "model_real_data.h"
 #include <EloquentTinyML.h>
+#include "memory_profile.h"
+#include "tflite_arena.h"
+#include "fire_net_fixed.h"
+#include "model_real3_net.h"
+#include "fire_net_grid.h"
 
 // Define the number of inputs and outputs for the model
 #define NUMBER_OF_INPUTS  3
 #define NUMBER_OF_OUTPUTS 1
 
-// Define the size of the tensor arena (used for memory allocation during inference)
-// For small models, 2–4 KB is usually enough
-#define TENSOR_ARENA_SIZE (2 * 1024)
+// Size of the tensor arena (used for memory allocation during inference)
+// comes with the model, MODEL_ARENA_SIZE of its header
+#define TENSOR_ARENA_SIZE MODEL_ARENA_SIZE
+
+// Memory usage (lib/MemoryProfile) is printed every MEMORY_REPORT_LOOPS
+// predictions, static RAM and flash are checked at build time
+// (host_tools/memory_budget.py)
+#define MEMORY_REPORT_LOOPS 60
 
 // Create an instance of the TfLite interpreter for the given model
-Eloquent::TinyML::TfLite<NUMBER_OF_INPUTS, NUMBER_OF_OUTPUTS, TENSOR_ARENA_SIZE> ml;
+ProfiledTfLite<NUMBER_OF_INPUTS, NUMBER_OF_OUTPUTS, TENSOR_ARENA_SIZE> ml;
+
+unsigned int loops = 0;
 
 void setup() {
+    paintStack();
     Serial.begin(9600);
     delay(1000);
 
     // Initialize the model from the included model data array
     ml.begin(model_tflite);
     Serial.println("Model is ready!");
+    Serial.print("Tensor arena used: ");
+    Serial.print((unsigned long)ml.arenaUsed());
+    Serial.print(" of ");
+    Serial.print(TENSOR_ARENA_SIZE);
+    Serial.print(" B, MODEL_ARENA_SIZE needed ");
+    Serial.println((unsigned long)ml.arenaNeeded());
 }
 
 void loop() {
@@ -31,15 +50,43 @@ void loop() {
     // Store input values in an array as expected by EloquentTinyML
     float input[NUMBER_OF_INPUTS] = { x1, x2, x3 };
 
-    // Predict output
+    // Predict output, measure time of TFLite, fixed-point, compile-time
+    // generated and grid inference
+    unsigned long t0 = micros();
     float predicted = ml.predict(input);
+    unsigned long t1 = micros();
+    int predicted_fixed = predictFireProbabilityFixed((int)x1, (int)x2, (int)x3);
+    unsigned long t2 = micros();
+    float predicted_constexpr = model_real3::Net::predict(input);
+    unsigned long t3 = micros();
+    int predicted_grid = predictFireProbabilityGrid((int)x1, (int)x2, (int)x3);
+    unsigned long t4 = micros();
 
     Serial.print("Input: ");
     Serial.print(x1); Serial.print(", ");
     Serial.print(x2); Serial.print(", ");
     Serial.print(x3);
     Serial.print("  =>  predicted: ");
-    Serial.println(predicted);
+    Serial.print(predicted);
+    Serial.print(" (");
+    Serial.print(t1 - t0);
+    Serial.print(" us), fixed point: ");
+    Serial.print(predicted_fixed / 10000.0);
+    Serial.print(" (");
+    Serial.print(t2 - t1);
+    Serial.print(" us), constexpr: ");
+    Serial.print(predicted_constexpr);
+    Serial.print(" (");
+    Serial.print(t3 - t2);
+    Serial.print(" us), grid: ");
+    Serial.print(predicted_grid / 10000.0);
+    Serial.print(" (");
+    Serial.print(t4 - t3);
+    Serial.println(" us)");
+
+    if (++loops % MEMORY_REPORT_LOOPS == 0) {
+        printMemoryUsage(Serial, memoryUsage());
+    }
 
     delay(1000);
 }
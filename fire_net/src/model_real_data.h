@@ -1,6 +1,12 @@
 #ifndef MODEL_DATA_H_
 #define MODEL_DATA_H_
 
+// Tensor arena of the model (TENSOR_ARENA_SIZE): tensors take 92 B of it
+// (host_tools bench_tflite), the rest is data of the TFLite Micro
+// interpreter known only on the target. Lower it to what the memory
+// profile prints after ml.begin().
+#define MODEL_ARENA_SIZE (2 * 1024)
+
 extern const unsigned char model_tflite[];
 extern const unsigned int model_tflite_len;
 
@@ -0,0 +1,211 @@
+# Static RAM and flash per module from the linker map of a firmware, checked
+# against the budget of the part. As an extra script of a PlatformIO
+# environment it has the linker write the map and fails the build when the
+# firmware does not fit, options of the environment:
+#
+#   extra_scripts = post:../host_tools/memory_budget.py
+#   custom_stack_reserve = 2048  ; B, stack peak of the memory profile and margin
+#   custom_heap_reserve = 512    ; B, heap peak of the memory profile and margin
+#   custom_ram_budget = 20480    ; B, RAM region of the map by default
+#   custom_flash_budget = 196608 ; B, FLASH region of the map by default
+#
+# Static RAM (.data and .bss, the tensor arena included) with the stack and
+# heap reserves must fit the RAM, the image (code, constants, the model and
+# the initial .data) the flash. What is left of the RAM is free for buffers.
+#
+# On a map of a build:
+#
+#   python3 memory_budget.py .pio/build/nucleo_l073rz/firmware.map --stack 2048 --heap 512
+#
+# Modules are the libraries (archives of PlatformIO and the toolchain) and
+# the object files of the project (src/main.cpp).
+import argparse
+import os
+import re
+import sys
+
+SECTION = re.compile(r"^ (\.\S+|COMMON)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*))?$")
+CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+OUTPUT_SECTION = re.compile(r"^(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address\s+0x([0-9a-fA-F]+))?)?")
+REGION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+ARCHIVE = re.compile(r"(?:^|/)lib([^/]+)\.a\([^)]*\)$")
+
+# sections of the reserve of the linker script (STM32duino), not code's
+RESERVED = ("._user_heap_stack",)
+# output sections by name when the map has no memory regions (host)
+RAM_SECTIONS = (".data", ".bss", ".tbss", ".tdata")
+FLASH_SECTIONS = (".text", ".rodata", ".data", ".init", ".fini", ".init_array", ".fini_array", ".preinit_array",
+                  ".ARM.extab", ".ARM.exidx", ".isr_vector", ".eh_frame", ".gcc_except_table", ".tdata")
+
+
+def module_name(path):
+    match = ARCHIVE.search(path)
+    if match:
+        return match.group(1)
+    path = path.replace("\\", "/")
+    build = re.search(r"\.pio/build/[^/]+/(.*)$", path)
+    if build:
+        path = build.group(1)
+        if path.startswith("src/"):
+            return path[:-2] if path.endswith(".o") else path
+        return path.split("/")[0]
+    return os.path.basename(path)
+
+
+class MapFile:
+    def __init__(self, path):
+        self.regions = {}  # name: (origin, length)
+        self.ram = {}      # module: B
+        self.flash = {}
+        with open(path, errors="replace") as f:
+            lines = f.read().splitlines()
+        self._parse(lines)
+
+    def region_of(self, address):
+        for name, (origin, length) in self.regions.items():
+            if origin <= address < origin + length:
+                return name
+        return None
+
+    def _parse(self, lines):
+        i = 0
+        while i < len(lines) and not lines[i].startswith("Memory Configuration"):
+            i += 1
+        while i < len(lines) and not lines[i].startswith("Linker script and memory map"):
+            match = REGION.match(lines[i])
+            if match and match.group(1) not in ("Name", "*default*"):
+                self.regions[match.group(1)] = (int(match.group(2), 16), int(match.group(3), 16))
+            i += 1
+
+        in_ram = in_flash = False
+        skip = False
+        while i < len(lines):
+            line = lines[i]
+            i += 1
+            output = OUTPUT_SECTION.match(line)
+            if output:
+                name = output.group(1)
+                skip = name.startswith(RESERVED)
+                if output.group(2) is None and i < len(lines):
+                    # long name, address and size on the next line
+                    output = re.match(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address\s+0x([0-9a-fA-F]+))?",
+                                      lines[i])
+                    groups = (output.group(1), output.group(2), output.group(3)) if output else (None, None, None)
+                else:
+                    groups = (output.group(2), output.group(3), output.group(4))
+                in_ram, in_flash = self._placement(name, groups)
+                continue
+            section = SECTION.match(line)
+            if not section or skip or not (in_ram or in_flash):
+                continue
+            if section.group(2) is None:
+                follow = CONTINUATION.match(lines[i]) if i < len(lines) else None
+                if not follow:
+                    continue
+                i += 1
+                size, source = int(follow.group(2), 16), follow.group(3)
+            else:
+                size, source = int(section.group(3), 16), section.group(4)
+            if size == 0 or source.startswith("load address"):
+                continue
+            module = module_name(source.strip())
+            if in_ram:
+                self.ram[module] = self.ram.get(module, 0) + size
+            if in_flash:
+                self.flash[module] = self.flash.get(module, 0) + size
+
+    def _placement(self, name, groups):
+        address, size, load = groups
+        if address is None:
+            return False, False
+        if not self.regions:
+            return name in RAM_SECTIONS, name in FLASH_SECTIONS
+        vma = self.region_of(int(address, 16))
+        lma = self.region_of(int(load, 16)) if load else vma
+        in_ram = vma is not None and vma.upper().startswith("RAM")
+        in_flash = (vma is not None and vma.upper().startswith("FLASH")) or (
+            lma is not None and lma.upper().startswith("FLASH"))
+        return in_ram, in_flash
+
+    def region_size(self, prefix):
+        sizes = [length for name, (_, length) in self.regions.items() if name.upper().startswith(prefix)]
+        return sum(sizes) if sizes else None
+
+
+def report(map_file, ram_budget, flash_budget, stack, heap, top, out=sys.stdout):
+    """Prints the modules and the budget, returns False when over it"""
+    modules = sorted(set(map_file.ram) | set(map_file.flash),
+                     key=lambda m: -(map_file.ram.get(m, 0) + map_file.flash.get(m, 0)))
+    static_ram = sum(map_file.ram.values())
+    flash = sum(map_file.flash.values())
+    out.write("%-32s %8s %8s\n" % ("module", "RAM", "flash"))
+    for module in modules[:top]:
+        out.write("%-32s %8d %8d\n" % (module, map_file.ram.get(module, 0), map_file.flash.get(module, 0)))
+    if len(modules) > top:
+        rest = modules[top:]
+        out.write("%-32s %8d %8d\n" % ("(%d more)" % len(rest), sum(map_file.ram.get(m, 0) for m in rest),
+                                       sum(map_file.flash.get(m, 0) for m in rest)))
+    out.write("%-32s %8d %8d\n" % ("total", static_ram, flash))
+
+    ok = True
+    if ram_budget:
+        needed = static_ram + stack + heap
+        out.write("RAM:   %d B static + %d B stack + %d B heap = %d of %d B"
+                  % (static_ram, stack, heap, needed, ram_budget))
+        out.write(", %d B free for buffers\n" % (ram_budget - needed) if needed <= ram_budget else "\n")
+        if needed > ram_budget:
+            out.write("RAM budget exceeded by %d B\n" % (needed - ram_budget))
+            ok = False
+    if flash_budget:
+        out.write("flash: %d of %d B" % (flash, flash_budget))
+        out.write(", %d B free\n" % (flash_budget - flash) if flash <= flash_budget else "\n")
+        if flash > flash_budget:
+            out.write("flash budget exceeded by %d B\n" % (flash - flash_budget))
+            ok = False
+    return ok
+
+
+def main(args):
+    map_file = MapFile(args.map)
+    if not map_file.ram and not map_file.flash:
+        print("no sections in %s, not a GNU ld map?" % args.map)
+        return 1
+    ram = args.ram if args.ram is not None else map_file.region_size("RAM")
+    flash = args.flash if args.flash is not None else map_file.region_size("FLASH")
+    return 0 if report(map_file, ram, flash, args.stack, args.heap, args.top) else 1
+
+
+def pio_option(env, name, default):
+    value = env.GetProjectOption("custom_" + name, "")
+    return int(value, 0) if str(value).strip() else default
+
+
+def pio_check(target, source, env):
+    map_path = env.subst("$BUILD_DIR/${PROGNAME}.map")
+    map_file = MapFile(map_path)
+    board = env.BoardConfig()
+    ram = pio_option(env, "ram_budget", map_file.region_size("RAM") or int(board.get("upload.maximum_ram_size", 0)))
+    flash = pio_option(env, "flash_budget", map_file.region_size("FLASH") or int(board.get("upload.maximum_size", 0)))
+    print("Memory budget of %s (%s):" % (env.subst("$PIOENV"), map_path))
+    ok = report(map_file, ram, flash, pio_option(env, "stack_reserve", 0), pio_option(env, "heap_reserve", 0), 12)
+    return 0 if ok else 1
+
+
+try:
+    Import("env")  # noqa: F821, PlatformIO (SCons) extra script
+except NameError:
+    env = None
+
+if env is not None:
+    env.Append(LINKFLAGS=["-Wl,-Map,$BUILD_DIR/${PROGNAME}.map"])
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", pio_check)
+elif __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Static RAM and flash per module of a GNU ld map, checked "
+                                                 "against the budget of the part.")
+    parser.add_argument("map", help="linker map (-Wl,-Map)")
+    parser.add_argument("--ram", type=int, help="RAM budget in B, RAM region of the map by default")
+    parser.add_argument("--flash", type=int, help="flash budget in B, FLASH region of the map by default")
+    parser.add_argument("--stack", type=int, default=0, help="stack reserve in B")
+    parser.add_argument("--heap", type=int, default=0, help="heap reserve in B")
+    parser.add_argument("--top", type=int, default=20, help="modules listed")
+    sys.exit(main(parser.parse_args()))
@@ -0,0 +1,5 @@
+# Links the sanitizer runtimes for environments built with
+# -fsanitize=address,undefined, build_flags reach only the compiler.
+Import("env")
+
+env.Append(LINKFLAGS=["-fsanitize=address,undefined"])
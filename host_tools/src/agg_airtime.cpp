@@ -0,0 +1,148 @@
+// Airtime and transmit energy per reading of aggregated radio frames
+// (lib/FireFrame) for K = 1 .. FIRE_FRAME_AGG_MAX readings per frame.
+//
+// Usage: program [-t ms] [-f prob] <session.TXT>...
+//   -t <ms>    reporting period TIME_SPAN (default 6000)
+//   -f <prob>  AGGREGATE_FLUSH_PROB, probability * 10000 (default 5000)
+//
+// Every session is replayed through the fixed-point fire net and the
+// aggregation of lora_transmitter (AGGREGATE_MODE): a frame is sent after K
+// readings, or at once with a reading over the flush probability and with
+// the first one below it again (single reading in a v2 frame). Frame
+// lengths are the real encoded ones, battery voltage drifts slowly with ADC
+// noise. Time on air is from lib/LoRaAirtime for the node settings (SF9,
+// BW125, CR 4/7), energy is the transmitter current at +17 dBm times the
+// time on air.
+//
+// Prints per K: frames, mean frame length, time on air per frame and per
+// reading, transmit energy per reading, duty cycle of one node and mean age
+// of a reading when its frame is sent. Row v1 is the old 11 byte frame.
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include "samples.h"
+#include "fire_frame.h"
+#include "fire_net_fixed.h"
+#include "lora_airtime.h"
+
+#define TX_CURRENT_MA 90.0  // SX1272 PA_BOOST +17 dBm, datasheet table 6
+#define SUPPLY_V 3.3
+#define VBAT_START 12400    // battery voltage * VOLTAGE_SCALE
+#define MEASURE_MS 100      // measureAverageValues(), 10 x delay(10)
+
+struct Result {
+  long readings = 0;
+  long frames = 0;
+  long bytes = 0;
+  double airtime_ms = 0;
+  double age_s = 0;  // sum of reading ages at the send time
+};
+
+static std::vector<FireReading> loadSession(const char *path) {
+  std::vector<Sample> samples;
+  std::vector<FireReading> readings;
+  if (!readSamples(path, &samples)) {
+    return readings;
+  }
+  unsigned seed = 1;
+  for (size_t i = 0; i < samples.size(); i++) {
+    const Sample &s = samples[i];
+    int vbat = VBAT_START - (int)(i / 50) + (int)(rand_r(&seed) % 17) - 8;
+    FireReading r = {0x11, s.smoke, s.flame, s.gas, predictFireProbabilityFixed(s.smoke, s.flame, s.gas), vbat,
+                     (uint8_t)i, 0, 0};
+    readings.push_back(r);
+  }
+  return readings;
+}
+
+static void sendFrame(size_t len, int readings, double period_s, Result *result) {
+  result->frames++;
+  result->bytes += len;
+  result->airtime_ms += loraTimeOnAirUs(LoRaSettings(), len) / 1e3;
+  // readings are period_s apart, the last one is sent at once
+  result->age_s += period_s * readings * (readings - 1) / 2.0;
+}
+
+static void simulate(const std::vector<FireReading> &session, int k, int flush_prob, double period_s,
+                     Result *result) {
+  FireReading pending[FIRE_FRAME_AGG_MAX];
+  uint8_t frame[FIRE_FRAME_AGG_MAX_LEN];
+  int len = 0;
+  bool last_alarm = false;
+  for (const FireReading &reading : session) {
+    result->readings++;
+    if (k == 0) {  // v1
+      encodeFrameV1(reading, frame);
+      sendFrame(FIRE_FRAME_V1_LEN, 1, period_s, result);
+      continue;
+    }
+    pending[len++] = reading;
+    bool alarm = reading.prob >= flush_prob;
+    bool flush = alarm || last_alarm || len >= k;
+    last_alarm = alarm;
+    if (!flush) {
+      continue;
+    }
+    if (len == 1) {
+      encodeFrameV2(reading, frame);
+      sendFrame(FIRE_FRAME_V2_LEN, 1, period_s, result);
+    } else {
+      size_t frame_len = encodeFrameAgg(pending, len, (uint8_t)(period_s + 0.5), frame, sizeof(frame));
+      FireReading decoded[FIRE_FRAME_AGG_MAX];
+      if (frame_len == 0 || decodeFrames(frame, frame_len, decoded, FIRE_FRAME_AGG_MAX) != len) {
+        fprintf(stderr, "aggregated frame of %d readings does not decode\n", len);
+        exit(1);
+      }
+      sendFrame(frame_len, len, period_s, result);
+    }
+    len = 0;
+  }
+  // readings still pending at the end are not counted
+  result->readings -= len;
+}
+
+int main(int argc, char **argv) {
+  int period_ms = 6000;
+  int flush_prob = 5000;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:f:")) != -1) {
+    if (opt == 't') {
+      period_ms = atoi(optarg);
+    } else if (opt == 'f') {
+      flush_prob = atoi(optarg);
+    } else {
+      optind = argc + 1;
+      break;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-t ms] [-f prob] <session.TXT>...\n", argv[0]);
+    return 1;
+  }
+  std::vector<std::vector<FireReading>> sessions;
+  for (int a = optind; a < argc; a++) {
+    sessions.push_back(loadSession(argv[a]));
+    if (sessions.back().empty()) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+  }
+
+  double period_s = (period_ms + MEASURE_MS) / 1000.0;
+  printf("%3s %8s %8s %10s %10s %12s %8s %8s\n", "K", "frames", "B/frame", "ms/frame", "ms/reading",
+         "mJ/reading", "duty %", "age s");
+  for (int k = 0; k <= FIRE_FRAME_AGG_MAX; k++) {
+    Result r;
+    for (const std::vector<FireReading> &session : sessions) {
+      simulate(session, k, flush_prob, period_s, &r);
+    }
+    double airtime_per_reading = r.airtime_ms / r.readings;
+    char name[8];
+    snprintf(name, sizeof(name), k ? "%d" : "v1", k);
+    printf("%3s %8ld %8.1f %10.1f %10.2f %12.3f %8.3f %8.1f\n", name, r.frames, (double)r.bytes / r.frames,
+           r.airtime_ms / r.frames, airtime_per_reading, airtime_per_reading * TX_CURRENT_MA * SUPPLY_V / 1000.0,
+           100.0 * airtime_per_reading / (period_s * 1000.0), r.age_s / r.readings);
+  }
+  return 0;
+}
@@ -0,0 +1,445 @@
+// Batch scoring of recorded sessions (SD card logs) by the fire net without
+// TensorFlow. Logs are memory-mapped, split into chunks on line boundaries,
+// parsed and scored by all cores. The dense layers are evaluated for 8 rows
+// at once with AVX2 (scalar fallback without it), weights are the same
+// constexpr arrays as in lib/FireNet (model_real3_net.h).
+//
+// Usage: program [options] <session.TXT>...
+//   -t <threshold>  decision threshold for confusion matrices (default 0.5)
+//   -o <dir>        write per-session probability traces <dir>/<session>.csv,
+//                   sessions of the same file name in different directories
+//                   get the directories in the name (lhota_velke_ohne_TABOR4.TXT)
+//   -j <threads>    number of worker threads (default all cores)
+//
+// Prints confusion matrix per session and in total, ROC / threshold sweep
+// and AUC over all labelled rows, and throughput in rows per second.
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "model_real3_net.h"
+
+#define CHUNK_SIZE (1 << 20)  // bytes of CSV per task
+#define ROC_BINS 1000         // probability histogram resolution for ROC
+#define SWEEP_STEP 0.05
+
+#define HIDDEN 18
+
+struct Session {
+  std::string path;
+  const char *data;
+  size_t size;
+};
+
+struct Chunk {
+  int session;
+  const char *begin;
+  const char *end;
+  std::vector<float> prob;
+  std::vector<signed char> label;  // -1 for unlabelled rows
+};
+
+struct Confusion {
+  long tp = 0, fp = 0, tn = 0, fn = 0;
+
+  void add(float p, int label, float threshold) {
+    if (label < 0) {
+      return;
+    }
+    bool alarm = p >= threshold;
+    tp += alarm && label;
+    fp += alarm && !label;
+    tn += !alarm && !label;
+    fn += !alarm && label;
+  }
+};
+
+// ---- parsing ---------------------------------------------------------------
+
+// Parses unsigned integer, returns pointer behind it
+static inline const char *parseInt(const char *p, const char *end, int *value) {
+  int v = 0;
+  while (p < end && (unsigned)(*p - '0') < 10) {
+    v = v * 10 + (*p - '0');
+    p++;
+  }
+  *value = v;
+  return p;
+}
+
+static inline const char *skipLine(const char *p, const char *end) {
+  const char *nl = (const char *)memchr(p, '\n', end - p);
+  return nl ? nl + 1 : end;
+}
+
+// Parses rows smoke,flame,gas[,label[,prob]] of the chunk, lines not
+// starting with a digit (header, garbage after power loss) are skipped
+static void parseChunk(const char *p, const char *end, std::vector<float> *x, std::vector<signed char> *label) {
+  while (p < end) {
+    if ((unsigned)(*p - '0') >= 10) {
+      p = skipLine(p, end);
+      continue;
+    }
+    int v[4];
+    int n = 0;
+    while (n < 4) {
+      p = parseInt(p, end, &v[n++]);
+      if (p >= end || *p != ',') {
+        break;
+      }
+      p++;
+    }
+    p = skipLine(p, end);
+    if (n < 3) {
+      continue;
+    }
+    x->push_back((float)v[0]);
+    x->push_back((float)v[1]);
+    x->push_back((float)v[2]);
+    label->push_back(n >= 4 ? (signed char)(v[3] != 0) : -1);
+  }
+}
+
+// ---- inference -------------------------------------------------------------
+
+static void predictScalar(const float *x, float *prob, size_t rows) {
+  for (size_t r = 0; r < rows; r++) {
+    prob[r] = model_real3::Net::predict(x + 3 * r);
+  }
+}
+
+#ifdef __AVX2__
+
+// exp(x) for 8 floats, Cephes polynomial, relative error ~1e-7
+static inline __m256 exp256(__m256 x) {
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.3f));
+  __m256 fx = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(0.693359375f), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(-2.12194440e-4f), x);
+  __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+  __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127)), 23);
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+}
+
+// 8 rows per iteration, rows are de-interleaved by gather
+static void predict(const float *x, float *prob, size_t rows) {
+  const __m256i idx = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  size_t r = 0;
+  for (; r + 8 <= rows; r += 8) {
+    const float *row = x + 3 * r;
+    __m256 smoke = _mm256_i32gather_ps(row, idx, 4);
+    __m256 flame = _mm256_i32gather_ps(row + 1, idx, 4);
+    __m256 gas = _mm256_i32gather_ps(row + 2, idx, 4);
+
+    __m256 logit = _mm256_set1_ps(model_real3::dense_1_bias[0]);
+    for (int j = 0; j < HIDDEN; j++) {
+      __m256 h = _mm256_set1_ps(model_real3::dense_bias[j]);
+      h = _mm256_fmadd_ps(smoke, _mm256_set1_ps(model_real3::dense_kernel[0][j]), h);
+      h = _mm256_fmadd_ps(flame, _mm256_set1_ps(model_real3::dense_kernel[1][j]), h);
+      h = _mm256_fmadd_ps(gas, _mm256_set1_ps(model_real3::dense_kernel[2][j]), h);
+      h = _mm256_max_ps(h, _mm256_setzero_ps());
+      logit = _mm256_fmadd_ps(h, _mm256_set1_ps(model_real3::dense_1_kernel[j][0]), logit);
+    }
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 p = _mm256_div_ps(one, _mm256_add_ps(one, exp256(_mm256_sub_ps(_mm256_setzero_ps(), logit))));
+    _mm256_storeu_ps(prob + r, p);
+  }
+  predictScalar(x + 3 * r, prob + r, rows - r);
+}
+
+#else
+
+static void predict(const float *x, float *prob, size_t rows) {
+  predictScalar(x, prob, rows);
+}
+
+#endif
+
+static void scoreChunk(Chunk *chunk) {
+  std::vector<float> x;
+  x.reserve((chunk->end - chunk->begin) / 4);
+  parseChunk(chunk->begin, chunk->end, &x, &chunk->label);
+  chunk->prob.resize(chunk->label.size());
+  predict(x.data(), chunk->prob.data(), chunk->prob.size());
+}
+
+// ---- input -----------------------------------------------------------------
+
+static bool mapSession(const char *path, Session *session) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  session->path = path;
+  session->size = st.st_size;
+  session->data = "";
+  if (st.st_size > 0) {
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    session->data = (const char *)data;
+  }
+  close(fd);
+  return true;
+}
+
+// Splits session into chunks of about CHUNK_SIZE ending on a line boundary
+static void splitSession(const Session &session, int index, std::vector<Chunk> *chunks) {
+  const char *p = session.data;
+  const char *end = session.data + session.size;
+  while (p < end) {
+    const char *chunk_end = p + CHUNK_SIZE < end ? skipLine(p + CHUNK_SIZE, end) : end;
+    Chunk chunk;
+    chunk.session = index;
+    chunk.begin = p;
+    chunk.end = chunk_end;
+    chunks->push_back(std::move(chunk));
+    p = chunk_end;
+  }
+}
+
+// ---- output ----------------------------------------------------------------
+
+static void printConfusion(const char *name, long rows, const Confusion &c) {
+  long labelled = c.tp + c.fp + c.tn + c.fn;
+  printf("%-40s rows %9ld  TP %8ld FP %8ld TN %8ld FN %8ld", name, rows, c.tp, c.fp, c.tn, c.fn);
+  if (labelled > 0) {
+    printf("  acc %6.2f %%", 100.0 * (c.tp + c.tn) / labelled);
+  }
+  printf("\n");
+}
+
+// Last `depth` components of path joined by '_', "." and ".." skipped
+static std::string traceName(const std::string &path, int depth) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find('/', start);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    std::string part = path.substr(start, end - start);
+    if (!part.empty() && part != "." && part != "..") {
+      parts.push_back(part);
+    }
+    start = end + 1;
+  }
+  std::string name;
+  for (size_t i = parts.size() > (size_t)depth ? parts.size() - depth : 0; i < parts.size(); i++) {
+    name += name.empty() ? parts[i] : "_" + parts[i];
+  }
+  return name;
+}
+
+// Trace names of the sessions, the file name or as many directories above
+// it as it takes to tell it from the others, false when two sessions are
+// the same file
+static bool traceNames(const std::vector<Session> &sessions, std::vector<std::string> *names) {
+  std::vector<int> depth(sessions.size(), 1);
+  for (bool clash = true; clash;) {
+    clash = false;
+    names->clear();
+    for (size_t s = 0; s < sessions.size(); s++) {
+      names->push_back(traceName(sessions[s].path, depth[s]));
+    }
+    for (size_t a = 0; a < sessions.size(); a++) {
+      for (size_t b = a + 1; b < sessions.size(); b++) {
+        if ((*names)[a] != (*names)[b]) {
+          continue;
+        }
+        if ((*names)[a] == traceName(sessions[a].path, depth[a] + 1) &&
+            (*names)[b] == traceName(sessions[b].path, depth[b] + 1)) {
+          fprintf(stderr, "%s and %s give the same trace %s.csv\n", sessions[a].path.c_str(),
+                  sessions[b].path.c_str(), (*names)[a].c_str());
+          return false;
+        }
+        depth[a]++;
+        depth[b]++;
+        clash = true;
+      }
+    }
+  }
+  return true;
+}
+
+static bool writeTrace(const char *dir, const std::string &name, const Chunk *chunks, size_t count) {
+  std::string path = std::string(dir) + "/" + name + ".csv";
+  FILE *f = fopen(path.c_str(), "w");
+  if (!f) {
+    return false;
+  }
+  fprintf(f, "row,prob,label\n");
+  long row = 0;
+  for (size_t c = 0; c < count; c++) {
+    for (size_t i = 0; i < chunks[c].prob.size(); i++) {
+      fprintf(f, "%ld,%.4f,%d\n", row++, chunks[c].prob[i], chunks[c].label[i]);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static void printRoc(const std::vector<long> &pos, const std::vector<long> &neg) {
+  long total_pos = 0, total_neg = 0;
+  for (int b = 0; b <= ROC_BINS; b++) {
+    total_pos += pos[b];
+    total_neg += neg[b];
+  }
+  if (total_pos == 0 || total_neg == 0) {
+    printf("ROC: needs both labels\n");
+    return;
+  }
+
+  // sweep thresholds from 1 down to 0, trapezoidal AUC
+  printf("\n%9s %8s %8s %9s\n", "threshold", "TPR", "FPR", "precision");
+  long tp = 0, fp = 0;
+  double auc = 0, last_tpr = 0, last_fpr = 0;
+  double next_print = 1.0;
+  for (int b = ROC_BINS; b >= 0; b--) {
+    tp += pos[b];
+    fp += neg[b];
+    double tpr = (double)tp / total_pos;
+    double fpr = (double)fp / total_neg;
+    auc += (fpr - last_fpr) * (tpr + last_tpr) / 2;
+    last_tpr = tpr;
+    last_fpr = fpr;
+    double threshold = (double)b / ROC_BINS;
+    if (threshold <= next_print + 1e-9) {
+      printf("%9.2f %8.4f %8.4f %9.4f\n", threshold, tpr, fpr, tp + fp > 0 ? (double)tp / (tp + fp) : 1.0);
+      next_print -= SWEEP_STEP;
+    }
+  }
+  printf("AUC: %.4f\n", auc);
+}
+
+int main(int argc, char **argv) {
+  float threshold = 0.5f;
+  const char *trace_dir = NULL;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  int opt;
+  while ((opt = getopt(argc, argv, "t:o:j:")) != -1) {
+    switch (opt) {
+      case 't': threshold = atof(optarg); break;
+      case 'o': trace_dir = optarg; break;
+      case 'j': threads = std::max(1, atoi(optarg)); break;
+      default:
+        fprintf(stderr, "usage: %s [-t threshold] [-o trace_dir] [-j threads] <session.TXT>...\n", argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-t threshold] [-o trace_dir] [-j threads] <session.TXT>...\n", argv[0]);
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Session> sessions;
+  std::vector<Chunk> chunks;
+  size_t bytes = 0;
+  for (int a = optind; a < argc; a++) {
+    Session session;
+    if (!mapSession(argv[a], &session)) {
+      fprintf(stderr, "cannot map %s\n", argv[a]);
+      return 1;
+    }
+    splitSession(session, (int)sessions.size(), &chunks);
+    bytes += session.size;
+    sessions.push_back(session);
+  }
+  std::vector<std::string> trace_names;
+  if (trace_dir && !traceNames(sessions, &trace_names)) {
+    return 1;
+  }
+
+  // workers take chunks in order, chunks keep the row order of sessions
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&]() {
+      for (size_t i = next++; i < chunks.size(); i = next++) {
+        scoreChunk(&chunks[i]);
+      }
+    });
+  }
+  for (std::thread &w : workers) {
+    w.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  // per-session and total statistics
+  Confusion total;
+  long total_rows = 0;
+  std::vector<long> pos(ROC_BINS + 1), neg(ROC_BINS + 1);
+  size_t c = 0;
+  for (size_t s = 0; s < sessions.size(); s++) {
+    Confusion confusion;
+    long rows = 0;
+    size_t first = c;
+    for (; c < chunks.size() && chunks[c].session == (int)s; c++) {
+      const Chunk &chunk = chunks[c];
+      for (size_t i = 0; i < chunk.prob.size(); i++) {
+        confusion.add(chunk.prob[i], chunk.label[i], threshold);
+        total.add(chunk.prob[i], chunk.label[i], threshold);
+        int bin = (int)(chunk.prob[i] * ROC_BINS);
+        if (chunk.label[i] == 1) {
+          pos[bin]++;
+        } else if (chunk.label[i] == 0) {
+          neg[bin]++;
+        }
+      }
+      rows += chunk.prob.size();
+    }
+    total_rows += rows;
+    printConfusion(sessions[s].path.c_str(), rows, confusion);
+    if (trace_dir) {
+      if (!writeTrace(trace_dir, trace_names[s], chunks.data() + first, c - first)) {
+        fprintf(stderr, "cannot write trace of %s to %s\n", sessions[s].path.c_str(), trace_dir);
+      }
+    }
+  }
+  printConfusion("total", total_rows, total);
+  printRoc(pos, neg);
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  printf("\nscored %ld rows (%.1f MB) in %.3f s by %d threads: %.2f M rows/s, %.0f MB/s%s\n",
+         total_rows, bytes / 1e6, seconds, threads, total_rows / seconds / 1e6, bytes / seconds / 1e6,
+#ifdef __AVX2__
+         ", AVX2"
+#else
+         ", scalar"
+#endif
+  );
+
+  for (const Session &session : sessions) {
+    if (session.size > 0) {
+      munmap((void *)session.data, session.size);
+    }
+  }
+  return 0;
+}
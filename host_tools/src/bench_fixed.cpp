@@ -0,0 +1,63 @@
+// Host benchmark of the fixed-point fire net (lib/FireNetFixed).
+//
+// Usage: program <data.csv> [predictions.txt]
+//   data.csv        ... smoke,flame,gas[,...] with header (real_model/all_data.csv, data/*.TXT)
+//   predictions.txt ... one prediction per line, compare it with the numpy
+//                       emulation by real_model/check_fixed.py --kernel_output
+//
+// Reported time is host time only, cycles on the STM32L073 are measured by
+// the fire_net firmware which runs both TFLite and fixed-point inference.
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+#include "samples.h"
+#include "fire_net_fixed.h"
+#include "fire_net_fixed_weights.h"
+
+#define TFLITE_MODEL_LEN 2048   // model_tflite_len of model_real3
+#define TFLITE_ARENA_SIZE 2048  // TENSOR_ARENA_SIZE in lora_transmitter
+#define REPEAT 200
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <data.csv> [predictions.txt]\n", argv[0]);
+    return 1;
+  }
+  std::vector<Sample> samples;
+  if (!readSamples(argv[1], &samples) || samples.empty()) {
+    fprintf(stderr, "cannot read samples from %s\n", argv[1]);
+    return 1;
+  }
+
+  std::vector<uint16_t> predictions(samples.size());
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < REPEAT; r++) {
+    for (size_t i = 0; i < samples.size(); i++) {
+      predictions[i] = predictFireProbabilityFixed(samples[i].smoke, samples[i].flame, samples[i].gas);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() / ((double)REPEAT * samples.size());
+
+  size_t weights_size = sizeof(fire_net_fixed_w1) + sizeof(fire_net_fixed_b1) + sizeof(fire_net_fixed_w2)
+                      + sizeof(fire_net_fixed_b2) + sizeof(fire_net_fixed_sigmoid);
+  printf("samples:              %zu\n", samples.size());
+  printf("host time:            %.1f ns / inference\n", ns);
+  printf("constant data:        %zu B (TFLite flatbuffer %d B)\n", weights_size, TFLITE_MODEL_LEN);
+  printf("working RAM:          0 B arena (TFLite arena %d B)\n", TFLITE_ARENA_SIZE);
+
+  if (argc > 2) {
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", argv[2]);
+      return 1;
+    }
+    for (size_t i = 0; i < predictions.size(); i++) {
+      fprintf(out, "%u\n", predictions[i]);
+    }
+    fclose(out);
+    printf("predictions written:  %s\n", argv[2]);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Host benchmark of the radio frame codec (lib/FireFrame).
+//
+// Usage: program [-n frames]
+//   -n <frames>  random readings encoded and decoded per run (default 1000000)
+//
+// Prints encode and decode time per frame of v1 and v2 and the time on air
+// of both frames for every spreading factor with the other node settings
+// (BW 125 kHz, CR 4/7, explicit header, CRC) from lib/LoRaAirtime. Time on
+// air grows in steps of whole interleaver blocks (SF - 2 * DE bytes of
+// payload with CR 4/7), so a shorter frame saves airtime only when it drops
+// below a block boundary.
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+#include "fire_frame.h"
+#include "lora_airtime.h"
+
+#define REPEAT 10
+
+static std::vector<FireReading> randomReadings(size_t count) {
+  std::vector<FireReading> readings(count);
+  unsigned seed = 1;
+  for (FireReading &r : readings) {
+    r.transm_id = rand_r(&seed) % 256;
+    r.smoke = rand_r(&seed) % 1024;
+    r.flame = rand_r(&seed) % 1024;
+    r.gas = rand_r(&seed) % 1024;
+    r.prob = rand_r(&seed) % 10001;
+    r.vbat = 9000 + rand_r(&seed) % 3600;
+    r.seq = rand_r(&seed) % 256;
+    r.flags = 0;
+  }
+  return readings;
+}
+
+template <size_t LEN, typename Encode, typename Decode>
+static void bench(const char *name, const std::vector<FireReading> &readings, Encode encode, Decode decode) {
+  std::vector<uint8_t> frames(readings.size() * LEN);
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < REPEAT; r++) {
+    for (size_t i = 0; i < readings.size(); i++) {
+      encode(readings[i], &frames[i * LEN]);
+    }
+  }
+  auto middle = std::chrono::steady_clock::now();
+  long sum = 0;
+  long rejected = 0;
+  FireReading out;
+  for (int r = 0; r < REPEAT; r++) {
+    for (size_t i = 0; i < readings.size(); i++) {
+      if (!decode(&frames[i * LEN], LEN, &out)) {
+        rejected++;
+      }
+      sum += out.smoke + out.prob;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double n = (double)readings.size() * REPEAT;
+  printf("%-4s %6zu %12.2f %12.2f %10ld   (checksum %ld)\n", name, LEN,
+         std::chrono::duration<double, std::nano>(middle - start).count() / n,
+         std::chrono::duration<double, std::nano>(end - middle).count() / n, rejected, sum);
+}
+
+int main(int argc, char **argv) {
+  size_t count = 1000000;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    if (opt == 'n') {
+      count = atol(optarg);
+    } else {
+      fprintf(stderr, "usage: %s [-n frames]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<FireReading> readings = randomReadings(count);
+  printf("%-4s %6s %12s %12s %10s\n", "ver", "bytes", "encode ns", "decode ns", "rejected");
+  bench<FIRE_FRAME_V1_LEN>("v1", readings, encodeFrameV1, decodeFrameV1);
+  bench<FIRE_FRAME_V2_LEN>("v2", readings, encodeFrameV2, decodeFrameV2);
+
+  printf("\n%4s %12s %12s %8s\n", "SF", "v1 ms", "v2 ms", "saved");
+  for (uint8_t sf = 7; sf <= 12; sf++) {
+    LoRaSettings settings;
+    settings.sf = sf;
+    double v1 = loraTimeOnAirUs(settings, FIRE_FRAME_V1_LEN) / 1e3;
+    double v2 = loraTimeOnAirUs(settings, FIRE_FRAME_V2_LEN) / 1e3;
+    printf("%4u %12.1f %12.1f %7.1f%%%s\n", sf, v1, v2, 100.0 * (v1 - v2) / v1, sf == 9 ? "  <- nodes" : "");
+  }
+  return 0;
+}
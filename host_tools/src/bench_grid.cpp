@@ -0,0 +1,77 @@
+// Host benchmark of the grid surrogate (lib/FireNetGrid) against the float
+// network (lib/FireNet, same graph as the TFLite model) and the fixed-point
+// kernel (lib/FireNetFixed).
+//
+// Usage: program <data.csv>
+//
+// Host time shows only the relative cost, on the STM32L073 all paths are
+// timed by the fire_net firmware.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "samples.h"
+#include "model_real3_net.h"
+#include "fire_net_fixed.h"
+#include "fire_net_grid.h"
+#include "fire_net_grid_table.h"
+
+#define REPEAT 200
+
+static volatile uint32_t sink;
+
+template <class Predict>
+static double measure(const std::vector<Sample> &samples, Predict predict) {
+  uint32_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < REPEAT; r++) {
+    for (size_t i = 0; i < samples.size(); i++) {
+      sum += predict(samples[i]);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = sum;
+  return std::chrono::duration<double, std::nano>(end - start).count() / ((double)REPEAT * samples.size());
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <data.csv>\n", argv[0]);
+    return 1;
+  }
+  std::vector<Sample> samples;
+  if (!readSamples(argv[1], &samples) || samples.empty()) {
+    fprintf(stderr, "cannot read samples from %s\n", argv[1]);
+    return 1;
+  }
+
+  double ns_float = measure(samples, [](const Sample &s) {
+    float input[3] = {(float)s.smoke, (float)s.flame, (float)s.gas};
+    return (uint32_t)(model_real3::Net::predict(input) * 10000);
+  });
+  double ns_fixed = measure(samples, [](const Sample &s) {
+    return (uint32_t)predictFireProbabilityFixed(s.smoke, s.flame, s.gas);
+  });
+  double ns_grid = measure(samples, [](const Sample &s) {
+    return (uint32_t)predictFireProbabilityGrid(s.smoke, s.flame, s.gas);
+  });
+
+  // disagreement with the float network
+  int max_error = 0;
+  long sum_error = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    float input[3] = {(float)samples[i].smoke, (float)samples[i].flame, (float)samples[i].gas};
+    int reference = (int)(model_real3::Net::predict(input) * 10000 + 0.5f);
+    int error = abs((int)predictFireProbabilityGrid(samples[i].smoke, samples[i].flame, samples[i].gas) - reference);
+    max_error = error > max_error ? error : max_error;
+    sum_error += error;
+  }
+
+  printf("samples:          %zu\n", samples.size());
+  printf("float net:        %.1f ns / inference\n", ns_float);
+  printf("fixed point:      %.1f ns / inference\n", ns_fixed);
+  printf("grid:             %.1f ns / inference, table %zu B\n", ns_grid, sizeof(fire_net_grid));
+  printf("grid abs error:   max %d, mean %.1f [1/10000]\n", max_error, (double)sum_error / samples.size());
+  return 0;
+}
@@ -0,0 +1,292 @@
+// Host benchmark of the temporal fire net (lib/FireNetTemporal) against the
+// fixed-point fire net (lib/FireNetFixed, the model of the end node).
+//
+// Usage: program [-p predictions.txt] [-t held_out.csv]... <session.csv>...
+//   -p <file>  one prediction of the temporal net per line over all sessions
+//              in order, compare it with the numpy emulation by
+//              real_model/export_temporal.py --kernel_output (give it the
+//              sessions of its --sessions in the same order)
+//   -t <file>  a held-out session (--test_sessions of train_temporal.py),
+//              not one the net was trained on, marked * in the table; its
+//              totals are the result, the training sessions are summed apart
+//
+// Every file is a session (data/*.TXT) replayed one reading per measurement
+// cycle, the temporal net from a fresh state as after a reset of the node.
+// Per session it prints the accuracy of both nets, false alarms (readings
+// without fire over the alarm threshold) and, for every fire onset (label
+// going 0 -> 1), the detection delay of both nets: readings from the onset
+// to the first alarm that starts at or after it. An alarm already on at the
+// onset (a false alarm running into the fire) is no detection, it is
+// counted apart ("on before" when no alarm starts in the fire). Checks that
+// a replay after reset() gives the same predictions (the state is the whole
+// memory of the net) and that the state stays in <-1, 1>.
+//
+// Reported time is host time (and host cycles on x86), cycles on the
+// STM32L073 are in the STAGE_NET energy profile of lora_transmitter with
+// TEMPORAL_NET_MODE. Operation counts of a step are printed for comparison.
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HOST_CYCLES
+#endif
+#include "samples.h"
+#include "fire_net_fixed.h"
+#include "fire_net_fixed_weights.h"
+#include "fire_net_temporal.h"
+#include "fire_net_temporal_weights.h"
+
+#define PERIOD_S 6           // TIME_SPAN
+#define ALARM_PROB 5000      // REPORT_ALARM_PROB
+#define STATE_ONE (1 << FIRE_NET_TEMPORAL_FRAC)
+#define REPEAT 200
+
+struct Session {
+  std::string name;
+  bool held_out = false;
+  std::vector<Sample> samples;
+  std::vector<uint16_t> fixed;
+  std::vector<uint16_t> temporal;
+};
+
+struct Totals {
+  long readings = 0;
+  long correct_fixed = 0;
+  long correct_temporal = 0;
+  long false_fixed = 0;
+  long false_temporal = 0;
+  long onsets = 0;
+  long missed_fixed = 0;
+  long missed_temporal = 0;
+  long on_fixed = 0;  // alarm already on at the onset
+  long on_temporal = 0;
+  long delay_fixed = 0;  // readings, onsets both nets detected
+  long delay_temporal = 0;
+  long detected_both = 0;
+};
+
+static bool replay(Session *session) {
+  FireNetTemporal net;
+  for (const Sample &s : session->samples) {
+    session->fixed.push_back(predictFireProbabilityFixed(s.smoke, s.flame, s.gas));
+    session->temporal.push_back(net.step(s.smoke, s.flame, s.gas));
+    for (int j = 0; j < FIRE_NET_TEMPORAL_HIDDEN; j++) {
+      if (net.state()[j] < -STATE_ONE || net.state()[j] > STATE_ONE) {
+        fprintf(stderr, "%s: state %d out of <-1, 1>\n", session->name.c_str(), net.state()[j]);
+        return false;
+      }
+    }
+  }
+  net.reset();
+  for (size_t i = 0; i < session->samples.size(); i++) {
+    const Sample &s = session->samples[i];
+    if (net.step(s.smoke, s.flame, s.gas) != session->temporal[i]) {
+      fprintf(stderr, "%s row %zu: replay after reset() differs\n", session->name.c_str(), i + 1);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Readings from onset to the first alarm that starts in the fire (the
+// reading before it below the threshold), -1 when the fire ends (or the
+// session) without one
+static long detectionDelay(const Session &session, const std::vector<uint16_t> &probs, size_t onset) {
+  for (size_t i = onset; i < probs.size() && session.samples[i].label > 0; i++) {
+    if (probs[i] >= ALARM_PROB && probs[i - 1] < ALARM_PROB) {
+      return (long)(i - onset);
+    }
+  }
+  return -1;
+}
+
+static void printDelay(long delay, bool on) {
+  if (delay >= 0) {
+    printf(" %8lds%s", delay * PERIOD_S, on ? " (alarm on at onset)" : "");
+  } else {
+    printf(" %9s", on ? "on before" : "missed");
+  }
+}
+
+static void evaluate(const Session &session, Totals *totals) {
+  long correct[2] = {};
+  long false_alarms[2] = {};
+  long labeled = 0;
+  for (size_t i = 0; i < session.samples.size(); i++) {
+    int label = session.samples[i].label;
+    if (label < 0) {
+      continue;
+    }
+    bool fixed = session.fixed[i] >= ALARM_PROB;
+    bool temporal = session.temporal[i] >= ALARM_PROB;
+    correct[0] += fixed == (label > 0);
+    correct[1] += temporal == (label > 0);
+    false_alarms[0] += fixed && label == 0;
+    false_alarms[1] += temporal && label == 0;
+    labeled++;
+  }
+  std::string name = session.held_out ? session.name + " *" : session.name;
+  printf("%-36s %6ld %7.1f%% %7.1f%% %6ld %6ld\n", name.c_str(), labeled,
+         labeled ? 100.0 * correct[0] / labeled : 0.0, labeled ? 100.0 * correct[1] / labeled : 0.0, false_alarms[0],
+         false_alarms[1]);
+  totals->readings += labeled;
+  totals->correct_fixed += correct[0];
+  totals->correct_temporal += correct[1];
+  totals->false_fixed += false_alarms[0];
+  totals->false_temporal += false_alarms[1];
+
+  for (size_t i = 1; i < session.samples.size(); i++) {
+    if (session.samples[i].label <= 0 || session.samples[i - 1].label != 0) {
+      continue;
+    }
+    long fixed = detectionDelay(session, session.fixed, i);
+    long temporal = detectionDelay(session, session.temporal, i);
+    bool fixed_on = session.fixed[i - 1] >= ALARM_PROB;
+    bool temporal_on = session.temporal[i - 1] >= ALARM_PROB;
+    printf("    onset at row %-6zu delay fixed", i + 1);
+    printDelay(fixed, fixed_on);
+    printf(", temporal");
+    printDelay(temporal, temporal_on);
+    printf("\n");
+    if (fixed >= 0 && temporal >= 0) {
+      totals->delay_fixed += fixed;
+      totals->delay_temporal += temporal;
+      totals->detected_both++;
+    }
+    totals->onsets++;
+    totals->missed_fixed += fixed < 0 && !fixed_on;
+    totals->missed_temporal += temporal < 0 && !temporal_on;
+    totals->on_fixed += fixed_on;
+    totals->on_temporal += temporal_on;
+  }
+}
+
+static void printTotals(const char *title, long sessions, const Totals &totals) {
+  if (totals.readings == 0) {
+    return;
+  }
+  printf("\n%s, %ld sessions, %ld labeled readings:\n", title, sessions, totals.readings);
+  printf("  accuracy: fixed %.1f %%, temporal %.1f %%\n", 100.0 * totals.correct_fixed / totals.readings,
+         100.0 * totals.correct_temporal / totals.readings);
+  printf("  false alarms: fixed %ld, temporal %ld readings\n", totals.false_fixed, totals.false_temporal);
+  printf("  %ld fire onsets: missed by fixed %ld, by temporal %ld; alarm already on at the onset: fixed %ld, "
+         "temporal %ld\n", totals.onsets, totals.missed_fixed, totals.missed_temporal, totals.on_fixed,
+         totals.on_temporal);
+  if (totals.detected_both) {
+    printf("  detection delay over %ld onsets both detect: fixed %ld s, temporal %ld s in total (mean %.1f s, "
+           "%.1f s)\n", totals.detected_both, totals.delay_fixed * PERIOD_S, totals.delay_temporal * PERIOD_S,
+           (double)totals.delay_fixed * PERIOD_S / totals.detected_both,
+           (double)totals.delay_temporal * PERIOD_S / totals.detected_both);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *predictions_path = nullptr;
+  std::vector<std::string> held_out;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:t:")) != -1) {
+    switch (opt) {
+      case 'p': predictions_path = optarg; break;
+      case 't': held_out.push_back(optarg); break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-p predictions.txt] [-t held_out.csv]... <session.csv>...\n", argv[0]);
+    return 1;
+  }
+  // held-out sessions are also replayed when not among the others
+  std::vector<std::string> paths(held_out);
+  for (int a = optind; a < argc; a++) {
+    bool listed = false;
+    for (const std::string &path : held_out) {
+      listed |= path == argv[a];
+    }
+    if (!listed) {
+      paths.push_back(argv[a]);
+    }
+  }
+  std::vector<Session> sessions;
+  for (size_t a = 0; a < paths.size(); a++) {
+    Session session;
+    session.name = paths[a];
+    session.held_out = a < held_out.size();
+    const char *path = paths[a].c_str();
+    if (!readSamples(path, &session.samples) || session.samples.empty()) {
+      fprintf(stderr, "cannot read %s\n", path);
+      return 1;
+    }
+    if (!replay(&session)) {
+      return 1;
+    }
+    sessions.push_back(session);
+  }
+
+  printf("%-36s %6s %8s %8s %6s %6s\n", "session", "rows", "fixed", "temporal", "false", "false");
+  printf("%-36s %6s %8s %8s %6s %6s\n", "", "", "accuracy", "accuracy", "fixed", "temp.");
+  Totals totals[2];  // trained on, held out
+  long counts[2] = {};
+  for (const Session &session : sessions) {
+    evaluate(session, &totals[session.held_out]);
+    counts[session.held_out]++;
+  }
+  printTotals(held_out.empty() ? "all sessions" : "training sessions", counts[0], totals[0]);
+  printTotals("held-out sessions", counts[1], totals[1]);
+
+  long steps = 0;
+  uint32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+#ifdef HOST_CYCLES
+  uint64_t cycles_start = __rdtsc();
+#endif
+  for (int r = 0; r < REPEAT; r++) {
+    for (const Session &session : sessions) {
+      FireNetTemporal net;
+      for (const Sample &s : session.samples) {
+        sink += net.step(s.smoke, s.flame, s.gas);
+      }
+      steps += session.samples.size();
+    }
+  }
+#ifdef HOST_CYCLES
+  double cycles = (double)(__rdtsc() - cycles_start) / steps;
+#endif
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / steps;
+
+  const int hidden = FIRE_NET_TEMPORAL_HIDDEN;
+  size_t weights_size = sizeof(fire_net_temporal_w) + sizeof(fire_net_temporal_u) + sizeof(fire_net_temporal_b)
+                      + sizeof(fire_net_temporal_bn_rec) + sizeof(fire_net_temporal_wo)
+                      + sizeof(fire_net_temporal_bo) + sizeof(fire_net_temporal_sigmoid);
+  size_t fixed_size = sizeof(fire_net_fixed_w1) + sizeof(fire_net_fixed_b1) + sizeof(fire_net_fixed_w2)
+                    + sizeof(fire_net_fixed_b2) + sizeof(fire_net_fixed_sigmoid);
+  printf("\nhost time:            %.1f ns / step (checksum %u)\n", ns, sink);
+#ifdef HOST_CYCLES
+  printf("host cycles:          %.0f / step (TSC)\n", cycles);
+#endif
+  printf("multiply-adds:        %d / step (fixed net %d)\n", 3 * hidden * (3 + hidden) + hidden,
+         FIRE_NET_FIXED_HIDDEN * 3 + FIRE_NET_FIXED_HIDDEN);
+  printf("sigmoid lookups:      %d / step (fixed net 1)\n", 3 * hidden + 1);
+  printf("state RAM:            %zu B, %zu B on the stack during a step\n", sizeof(FireNetTemporal),
+         sizeof(int16_t) * hidden);
+  printf("constant data:        %zu B (fixed net %zu B)\n", weights_size, fixed_size);
+
+  if (predictions_path) {
+    FILE *out = fopen(predictions_path, "w");
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", predictions_path);
+      return 1;
+    }
+    for (const Session &session : sessions) {
+      for (uint16_t p : session.temporal) {
+        fprintf(out, "%u\n", p);
+      }
+    }
+    fclose(out);
+    printf("predictions written:  %s\n", predictions_path);
+  }
+  return 0;
+}
@@ -0,0 +1,648 @@
+// Host benchmark of the TFLite models of the fire net: the current float
+// model (real_model/model_real3.tflite) against the full-integer model the
+// TFLite converter makes in real_model/quantize_int8.py
+// (model_real3_int8.tflite).
+//
+// Usage: program [-p predictions.txt] [-r outputs.txt] <data.csv>[,<data.csv>...] <model.tflite>...
+//   -p <file>  one prediction of the last model per line, compare it with
+//              the TFLite interpreter by real_model/quantize_int8.py
+//              --kernel_output
+//   -r <file>  one output of the last model per line, the probability
+//              (%.9g, int8 dequantized), the TFLite reference of
+//              real_model/check_fixed.py and check_constexpr.py
+//              (--tflite_output) where TensorFlow is not installed
+//
+// Rows of several data files (sessions) are taken in the order given.
+//
+// Every model is read from its flatbuffer and run by reference kernels of
+// the operators the fire net needs (FULLY_CONNECTED, LOGISTIC, float32 or
+// int8), with the same arithmetic as the TFLite int8 kernels (the logistic
+// by the 256 entry table built at prepare). Tensors that are not constant
+// get places in an arena as the memory planner of TFLite Micro does (first
+// fit by lifetime, 16 B alignment). Prints accuracy against the labels,
+// agreement with the first model, host time per inference, constant data
+// and arena of the tensors. The interpreter of TFLite Micro adds its own
+// structures (tensors, node data) to the arena, so the arena of a model
+// (MODEL_ARENA_SIZE of its header) is measured on the target: the memory
+// profile of the firmware prints the arena used after ml.begin().
+//
+// An int8 input takes the raw ADC counts as real_model/quantize_int8.py
+// quantizes them, by a multiplier of 2^-16 (2^16 / input scale) and the
+// zero point.
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "samples.h"
+
+#define PROB_SCALE 10000
+#define ALARM_PROB 5000
+#define ARENA_ALIGN 16  // kDefaultTensorAlignment of TFLite Micro
+#define REPEAT 200
+
+static volatile long sink;  // keeps the timed loop
+
+// TFLite schema
+enum TensorType { TYPE_FLOAT32 = 0, TYPE_INT32 = 2, TYPE_INT8 = 9 };
+enum BuiltinOperator { OP_FULLY_CONNECTED = 9, OP_LOGISTIC = 14 };
+enum Activation { ACTIVATION_NONE = 0, ACTIVATION_RELU = 1 };
+
+// Reader of the flatbuffer, offsets out of the file make it fail
+class FlatReader {
+ public:
+  explicit FlatReader(const std::vector<uint8_t> &data) : d_(data) {}
+
+  bool ok() const { return ok_; }
+  uint32_t root() { return u32(0); }
+
+  // Position of field of table, 0 when it is not present
+  uint32_t field(uint32_t table, int index) {
+    uint32_t vtable = table - (uint32_t)(int32_t)u32(table);
+    uint16_t vtable_size = u16(vtable);
+    if (4 + 2 * index >= vtable_size) {
+      return 0;
+    }
+    uint16_t offset = u16(vtable + 4 + 2 * index);
+    return offset ? table + offset : 0;
+  }
+  uint32_t scalar32(uint32_t table, int index, uint32_t value) {
+    uint32_t p = field(table, index);
+    return p ? u32(p) : value;
+  }
+  uint8_t scalar8(uint32_t table, int index, uint8_t value) {
+    uint32_t p = field(table, index);
+    return p ? u8(p) : value;
+  }
+  // Referenced table, vector or string of field, 0 when not present
+  uint32_t ref(uint32_t table, int index) {
+    uint32_t p = field(table, index);
+    return p ? p + u32(p) : 0;
+  }
+  uint32_t length(uint32_t vector) { return vector ? u32(vector) : 0; }
+  uint32_t element(uint32_t vector, uint32_t i, uint32_t size) { return vector + 4 + i * size; }
+  uint32_t tableAt(uint32_t vector, uint32_t i) {
+    uint32_t p = element(vector, i, 4);
+    return p + u32(p);
+  }
+  std::string string(uint32_t s) {
+    uint32_t n = length(s);
+    return check(s + 4, n) ? std::string((const char *)&d_[s + 4], n) : std::string();
+  }
+  std::vector<int> ints(uint32_t vector) {
+    std::vector<int> out;
+    for (uint32_t i = 0; i < length(vector); i++) {
+      out.push_back((int32_t)u32(element(vector, i, 4)));
+    }
+    return out;
+  }
+
+  uint8_t u8(uint32_t p) { return check(p, 1) ? d_[p] : 0; }
+  uint16_t u16(uint32_t p) { return check(p, 2) ? (uint16_t)(d_[p] | d_[p + 1] << 8) : 0; }
+  uint32_t u32(uint32_t p) {
+    return check(p, 4) ? (uint32_t)d_[p] | d_[p + 1] << 8 | d_[p + 2] << 16 | (uint32_t)d_[p + 3] << 24 : 0;
+  }
+  bool check(uint32_t p, uint32_t n) {
+    if ((uint64_t)p + n > d_.size()) {
+      ok_ = false;
+    }
+    return ok_;
+  }
+
+ private:
+  const std::vector<uint8_t> &d_;
+  bool ok_ = true;
+};
+
+struct Tensor {
+  std::string name;
+  std::vector<int> shape;
+  int type;
+  std::vector<uint8_t> data;  // constant tensors
+  std::vector<float> scale;
+  std::vector<int64_t> zero_point;
+  size_t bytes = 0;
+  int first_use = -1;  // op, -1 model input
+  int last_use = -1;
+  size_t offset = 0;  // in the arena
+};
+
+struct Op {
+  int code;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+  int activation = ACTIVATION_NONE;
+  // int8 fully connected: requantization per output, activation range
+  std::vector<int32_t> multiplier;
+  std::vector<int> shift;
+  int32_t out_min = -128;
+  int32_t out_max = 127;
+  // int8 logistic
+  int8_t table[256];
+};
+
+struct Model {
+  std::string path;
+  size_t file_size = 0;
+  std::vector<Tensor> tensors;
+  std::vector<Op> ops;
+  int input = -1;
+  int output = -1;
+  size_t constant_bytes = 0;
+  size_t arena_bytes = 0;
+  int32_t input_multiplier = 0;  // int8 input, 2^16 / scale
+};
+
+static size_t typeSize(int type) {
+  return type == TYPE_FLOAT32 || type == TYPE_INT32 ? 4 : 1;
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> *data) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    data->insert(data->end(), buffer, buffer + n);
+  }
+  fclose(f);
+  return true;
+}
+
+static bool parseModel(const std::vector<uint8_t> &file, Model *model, std::string *error) {
+  FlatReader r(file);
+  if (file.size() < 8 || memcmp(&file[4], "TFL3", 4) != 0) {
+    *error = "no TFLite flatbuffer";
+    return false;
+  }
+  uint32_t root = r.root();
+  uint32_t opcodes = r.ref(root, 1);
+  uint32_t subgraphs = r.ref(root, 2);
+  uint32_t buffers = r.ref(root, 4);
+  if (r.length(subgraphs) != 1) {
+    *error = "one subgraph expected";
+    return false;
+  }
+  std::vector<int> codes;
+  for (uint32_t i = 0; i < r.length(opcodes); i++) {
+    uint32_t oc = r.tableAt(opcodes, i);
+    int code = (int8_t)r.scalar8(oc, 0, 0);
+    int builtin = (int32_t)r.scalar32(oc, 3, 0);
+    codes.push_back(builtin > code ? builtin : code);
+  }
+  uint32_t subgraph = r.tableAt(subgraphs, 0);
+  uint32_t tensors = r.ref(subgraph, 0);
+  for (uint32_t i = 0; i < r.length(tensors); i++) {
+    uint32_t t = r.tableAt(tensors, i);
+    Tensor tensor;
+    tensor.name = r.string(r.ref(t, 3));
+    tensor.shape = r.ints(r.ref(t, 0));
+    tensor.type = r.scalar8(t, 1, TYPE_FLOAT32);
+    if (tensor.type != TYPE_FLOAT32 && tensor.type != TYPE_INT32 && tensor.type != TYPE_INT8) {
+      *error = "tensor " + tensor.name + " of unsupported type";
+      return false;
+    }
+    size_t elements = 1;
+    for (int dim : tensor.shape) {
+      elements *= dim > 0 ? dim : 1;
+    }
+    tensor.bytes = elements * typeSize(tensor.type);
+    uint32_t buffer_index = r.scalar32(t, 2, 0);
+    if (buffer_index < r.length(buffers)) {
+      uint32_t data = r.ref(r.tableAt(buffers, buffer_index), 0);
+      uint32_t n = r.length(data);
+      if (n && r.check(data + 4, n)) {
+        tensor.data.assign(file.begin() + data + 4, file.begin() + data + 4 + n);
+        if (n != tensor.bytes) {
+          *error = "tensor " + tensor.name + " with wrong data size";
+          return false;
+        }
+      }
+    }
+    uint32_t quantization = r.ref(t, 4);
+    if (quantization) {
+      uint32_t scales = r.ref(quantization, 2);
+      uint32_t zero_points = r.ref(quantization, 3);
+      for (uint32_t k = 0; k < r.length(scales); k++) {
+        uint32_t bits = r.u32(r.element(scales, k, 4));
+        float scale;
+        memcpy(&scale, &bits, 4);
+        tensor.scale.push_back(scale);
+      }
+      for (uint32_t k = 0; k < r.length(zero_points); k++) {
+        uint32_t p = r.element(zero_points, k, 8);
+        tensor.zero_point.push_back((int64_t)((uint64_t)r.u32(p) | (uint64_t)r.u32(p + 4) << 32));
+      }
+    }
+    if (tensor.type != TYPE_FLOAT32 && (tensor.scale.empty() || tensor.scale.size() != tensor.zero_point.size())) {
+      *error = "integer tensor " + tensor.name + " without quantization";
+      return false;
+    }
+    model->tensors.push_back(tensor);
+  }
+  std::vector<int> inputs = r.ints(r.ref(subgraph, 1));
+  std::vector<int> outputs = r.ints(r.ref(subgraph, 2));
+  uint32_t operators = r.ref(subgraph, 3);
+  for (uint32_t i = 0; i < r.length(operators); i++) {
+    uint32_t o = r.tableAt(operators, i);
+    Op op;
+    uint32_t opcode = r.scalar32(o, 0, 0);
+    op.code = opcode < codes.size() ? codes[opcode] : -1;
+    op.inputs = r.ints(r.ref(o, 1));
+    op.outputs = r.ints(r.ref(o, 2));
+    uint32_t options = r.ref(o, 4);
+    if (options && op.code == OP_FULLY_CONNECTED) {
+      op.activation = r.scalar8(options, 0, ACTIVATION_NONE);
+    }
+    model->ops.push_back(op);
+  }
+  if (!r.ok()) {
+    *error = "flatbuffer offset out of the file";
+    return false;
+  }
+  if (inputs.size() != 1 || outputs.size() != 1) {
+    *error = "one input and one output expected";
+    return false;
+  }
+  model->input = inputs[0];
+  model->output = outputs[0];
+  return true;
+}
+
+// Checks the operators and tensors, prepares the int8 kernels
+static bool prepareModel(Model *model, std::string *error) {
+  int n = model->tensors.size();
+  for (size_t i = 0; i < model->ops.size(); i++) {
+    Op &op = model->ops[i];
+    for (int t : op.inputs) {
+      if (t < 0 || t >= n) {
+        *error = "operator input out of tensors";
+        return false;
+      }
+    }
+    if (op.outputs.size() != 1 || op.outputs[0] < 0 || op.outputs[0] >= n) {
+      *error = "operator with one output expected";
+      return false;
+    }
+    const Tensor &in = model->tensors[op.inputs[0]];
+    const Tensor &out = model->tensors[op.outputs[0]];
+    if (op.code == OP_FULLY_CONNECTED) {
+      if (op.inputs.size() != 3 || model->tensors[op.inputs[1]].data.empty() ||
+          model->tensors[op.inputs[2]].data.empty() || model->tensors[op.inputs[1]].shape.size() != 2) {
+        *error = "fully connected with constant weights and bias expected";
+        return false;
+      }
+      if (op.activation != ACTIVATION_NONE && op.activation != ACTIVATION_RELU) {
+        *error = "fused activation other than relu";
+        return false;
+      }
+      const Tensor &w = model->tensors[op.inputs[1]];
+      if (in.type == TYPE_INT8) {
+        int units = w.shape[0];
+        for (int u = 0; u < units; u++) {
+          // as QuantizeMultiplier(): real = multiplier * 2^(shift - 31)
+          double real = (double)in.scale[0] * w.scale[w.scale.size() > 1 ? u : 0] / out.scale[0];
+          int shift = 0;
+          double mantissa = frexp(real, &shift);
+          int64_t multiplier = (int64_t)llround(mantissa * (1ll << 31));
+          if (multiplier == (1ll << 31)) {
+            multiplier /= 2;
+            shift++;
+          }
+          op.multiplier.push_back((int32_t)multiplier);
+          op.shift.push_back(shift);
+        }
+        int32_t zero_point = (int32_t)out.zero_point[0];
+        op.out_min = op.activation == ACTIVATION_RELU && zero_point > -128 ? zero_point : -128;
+      }
+    } else if (op.code == OP_LOGISTIC) {
+      if (in.type == TYPE_INT8) {
+        for (int q = -128; q < 128; q++) {
+          double x = (q - in.zero_point[0]) * (double)in.scale[0];
+          double y = round(1 / (1 + exp(-x)) / out.scale[0]) + out.zero_point[0];
+          op.table[q + 128] = (int8_t)(y < -128 ? -128 : (y > 127 ? 127 : y));
+        }
+      }
+    } else {
+      *error = "operator " + std::to_string(op.code) + " not supported";
+      return false;
+    }
+    if (in.type != out.type) {
+      *error = "mixed types of an operator";
+      return false;
+    }
+  }
+
+  // lifetimes and first fit placement of the tensors that are not constant
+  for (size_t i = 0; i < model->ops.size(); i++) {
+    for (int t : model->ops[i].inputs) {
+      model->tensors[t].last_use = i;
+    }
+    Tensor &out = model->tensors[model->ops[i].outputs[0]];
+    if (out.first_use < 0) {
+      out.first_use = i;
+    }
+    out.last_use = i;
+  }
+  model->tensors[model->input].first_use = -1;
+  model->tensors[model->output].last_use = model->ops.size();
+  std::vector<int> placed;
+  for (int i = 0; i < n; i++) {
+    Tensor &t = model->tensors[i];
+    if (!t.data.empty()) {
+      model->constant_bytes += t.data.size();
+      continue;
+    }
+    // largest first as the greedy planner, offsets by first fit
+    placed.push_back(i);
+  }
+  std::vector<int> order = placed;
+  for (size_t a = 0; a < order.size(); a++) {
+    for (size_t b = a + 1; b < order.size(); b++) {
+      if (model->tensors[order[b]].bytes > model->tensors[order[a]].bytes) {
+        std::swap(order[a], order[b]);
+      }
+    }
+  }
+  std::vector<int> done;
+  for (int i : order) {
+    Tensor &t = model->tensors[i];
+    size_t offset = 0;
+    bool moved = true;
+    while (moved) {
+      moved = false;
+      for (int j : done) {
+        const Tensor &o = model->tensors[j];
+        bool live_together = t.first_use <= o.last_use && o.first_use <= t.last_use;
+        if (live_together && offset < o.offset + o.bytes && o.offset < offset + t.bytes) {
+          offset = (o.offset + o.bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+          moved = true;
+        }
+      }
+    }
+    t.offset = offset;
+    done.push_back(i);
+    if (offset + t.bytes > model->arena_bytes) {
+      model->arena_bytes = offset + t.bytes;
+    }
+  }
+
+  const Tensor &input = model->tensors[model->input];
+  if (input.type == TYPE_INT8) {
+    model->input_multiplier = (int32_t)lround(65536.0 / input.scale[0]);
+  }
+  if (input.bytes != 3 * typeSize(input.type) || model->tensors[model->output].bytes != typeSize(input.type)) {
+    *error = "input of smoke, flame, gas and one output expected";
+    return false;
+  }
+  return true;
+}
+
+// TFLite fixed-point helpers of the int8 kernels
+static int32_t saturatingRoundingDoublingHighMul(int32_t a, int32_t b) {
+  if (a == b && a == INT32_MIN) {
+    return INT32_MAX;
+  }
+  int64_t ab = (int64_t)a * b;
+  int32_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+  return (int32_t)((ab + nudge) / (1ll << 31));
+}
+
+static int32_t roundingDivideByPot(int32_t x, int exponent) {
+  int32_t mask = (int32_t)((1ll << exponent) - 1);
+  int32_t remainder = x & mask;
+  int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+static int32_t multiplyByQuantizedMultiplier(int32_t x, int32_t multiplier, int shift) {
+  int left = shift > 0 ? shift : 0;
+  int right = shift > 0 ? 0 : -shift;
+  return roundingDivideByPot(saturatingRoundingDoublingHighMul(x * (1 << left), multiplier), right);
+}
+
+static void runOp(const Model &model, const Op &op, std::vector<uint8_t> *arena) {
+  const Tensor &in = model.tensors[op.inputs[0]];
+  const Tensor &out = model.tensors[op.outputs[0]];
+  if (op.code == OP_FULLY_CONNECTED) {
+    const Tensor &w = model.tensors[op.inputs[1]];
+    const Tensor &b = model.tensors[op.inputs[2]];
+    int units = w.shape[0];
+    int depth = w.shape[1];
+    if (in.type == TYPE_FLOAT32) {
+      const float *x = (const float *)&(*arena)[in.offset];
+      const float *wd = (const float *)w.data.data();
+      const float *bd = (const float *)b.data.data();
+      float *y = (float *)&(*arena)[out.offset];
+      for (int u = 0; u < units; u++) {
+        float acc = bd[u];
+        for (int k = 0; k < depth; k++) {
+          acc += x[k] * wd[u * depth + k];
+        }
+        y[u] = op.activation == ACTIVATION_RELU && acc < 0 ? 0 : acc;
+      }
+    } else {
+      const int8_t *x = (const int8_t *)&(*arena)[in.offset];
+      const int8_t *wd = (const int8_t *)w.data.data();
+      const int32_t *bd = (const int32_t *)b.data.data();
+      int8_t *y = (int8_t *)&(*arena)[out.offset];
+      int32_t in_zero_point = (int32_t)in.zero_point[0];
+      int32_t out_zero_point = (int32_t)out.zero_point[0];
+      for (int u = 0; u < units; u++) {
+        int32_t acc = bd[u];
+        for (int k = 0; k < depth; k++) {
+          acc += (x[k] - in_zero_point) * wd[u * depth + k];
+        }
+        acc = multiplyByQuantizedMultiplier(acc, op.multiplier[u], op.shift[u]) + out_zero_point;
+        y[u] = (int8_t)(acc < op.out_min ? op.out_min : (acc > op.out_max ? op.out_max : acc));
+      }
+    }
+  } else if (in.type == TYPE_FLOAT32) {
+    size_t n = in.bytes / 4;
+    const float *x = (const float *)&(*arena)[in.offset];
+    float *y = (float *)&(*arena)[out.offset];
+    for (size_t i = 0; i < n; i++) {
+      y[i] = 1 / (1 + expf(-x[i]));
+    }
+  } else {
+    const int8_t *x = (const int8_t *)&(*arena)[in.offset];
+    int8_t *y = (int8_t *)&(*arena)[out.offset];
+    for (size_t i = 0; i < in.bytes; i++) {
+      y[i] = op.table[x[i] + 128];
+    }
+  }
+}
+
+// Fire probability scaled by PROB_SCALE of one reading, as the firmware
+static int predict(const Model &model, const Sample &s, std::vector<uint8_t> *arena) {
+  const Tensor &input = model.tensors[model.input];
+  const int counts[3] = {s.smoke, s.flame, s.gas};
+  if (input.type == TYPE_FLOAT32) {
+    float *x = (float *)&(*arena)[input.offset];
+    for (int i = 0; i < 3; i++) {
+      x[i] = counts[i];
+    }
+  } else {
+    int8_t *x = (int8_t *)&(*arena)[input.offset];
+    for (int i = 0; i < 3; i++) {
+      int c = counts[i] < 0 ? 0 : counts[i];
+      int32_t q = ((c * model.input_multiplier + (1 << 15)) >> 16) + (int32_t)input.zero_point[0];
+      x[i] = (int8_t)(q < -128 ? -128 : (q > 127 ? 127 : q));
+    }
+  }
+  for (const Op &op : model.ops) {
+    runOp(model, op, arena);
+  }
+  const Tensor &output = model.tensors[model.output];
+  if (output.type == TYPE_FLOAT32) {
+    return (int)(*(const float *)&(*arena)[output.offset] * PROB_SCALE);
+  }
+  int8_t q = *(const int8_t *)&(*arena)[output.offset];
+  return ((q + 128) * PROB_SCALE + 128) >> 8;
+}
+
+// Output of the last predict() as a probability, int8 dequantized
+static double output(const Model &model, const std::vector<uint8_t> &arena) {
+  const Tensor &output = model.tensors[model.output];
+  if (output.type == TYPE_FLOAT32) {
+    return *(const float *)&arena[output.offset];
+  }
+  return (*(const int8_t *)&arena[output.offset] - output.zero_point[0]) * (double)output.scale[0];
+}
+
+int main(int argc, char **argv) {
+  const char *predictions_path = nullptr;
+  const char *outputs_path = nullptr;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:r:")) != -1) {
+    switch (opt) {
+      case 'p': predictions_path = optarg; break;
+      case 'r': outputs_path = optarg; break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind + 2 > argc) {
+    fprintf(stderr, "usage: %s [-p predictions.txt] [-r outputs.txt] <data.csv>[,<data.csv>...] <model.tflite>...\n",
+            argv[0]);
+    return 1;
+  }
+  std::vector<Sample> samples;
+  std::string data_paths = argv[optind];
+  for (size_t start = 0; start <= data_paths.size();) {
+    size_t end = data_paths.find(',', start);
+    end = end == std::string::npos ? data_paths.size() : end;
+    std::string path = data_paths.substr(start, end - start);
+    if (!readSamples(path.c_str(), &samples)) {
+      fprintf(stderr, "cannot read samples from %s\n", path.c_str());
+      return 1;
+    }
+    start = end + 1;
+  }
+  if (samples.empty()) {
+    fprintf(stderr, "no samples in %s\n", argv[optind]);
+    return 1;
+  }
+
+  std::vector<Model> models;
+  std::vector<std::vector<int>> predictions;
+  std::vector<double> outputs;  // of the last model
+  for (int a = optind + 1; a < argc; a++) {
+    std::vector<uint8_t> file;
+    Model model;
+    std::string error;
+    model.path = argv[a];
+    if (!readFile(argv[a], &file)) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+    model.file_size = file.size();
+    if (!parseModel(file, &model, &error) || !prepareModel(&model, &error)) {
+      fprintf(stderr, "%s: %s\n", argv[a], error.c_str());
+      return 1;
+    }
+    std::vector<uint8_t> arena(model.arena_bytes);
+    std::vector<int> probs;
+    outputs.clear();
+    for (const Sample &s : samples) {
+      probs.push_back(predict(model, s, &arena));
+      outputs.push_back(output(model, arena));
+    }
+    models.push_back(model);
+    predictions.push_back(probs);
+  }
+
+  printf("samples: %zu\n\n", samples.size());
+  printf("%-36s %8s %8s %8s %8s %8s %9s %7s\n", "model", "flatbuf", "const", "arena", "accuracy", "agree",
+         "max diff", "ns");
+  for (size_t m = 0; m < models.size(); m++) {
+    const Model &model = models[m];
+    long correct = 0;
+    long labeled = 0;
+    long agree = 0;
+    int max_diff = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+      bool alarm = predictions[m][i] >= ALARM_PROB;
+      if (samples[i].label >= 0) {
+        correct += alarm == (samples[i].label > 0);
+        labeled++;
+      }
+      agree += alarm == (predictions[0][i] >= ALARM_PROB);
+      int diff = abs(predictions[m][i] - predictions[0][i]);
+      max_diff = diff > max_diff ? diff : max_diff;
+    }
+
+    std::vector<uint8_t> arena(model.arena_bytes);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEAT; r++) {
+      for (const Sample &s : samples) {
+        sink += predict(model, s, &arena);
+      }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                ((double)REPEAT * samples.size());
+    printf("%-36s %6zu B %6zu B %6zu B %7.2f%% %7.2f%% %9d %7.1f\n", model.path.c_str(), model.file_size,
+           model.constant_bytes, model.arena_bytes, labeled ? 100.0 * correct / labeled : 0.0,
+           100.0 * agree / samples.size(), max_diff, ns);
+  }
+  printf("\narena: tensors that are not constant (peak of live ones), without the interpreter structures\n");
+  printf("agree, max diff: decision (p >= 0.5) and probability [1/%d] against the first model\n", PROB_SCALE);
+  for (const Model &model : models) {
+    const Tensor &input = model.tensors[model.input];
+    if (input.type == TYPE_INT8) {
+      printf("%s: int8 input, counts * %d / 2^16 %+lld\n", model.path.c_str(), (int)model.input_multiplier,
+             (long long)input.zero_point[0]);
+    }
+  }
+
+  if (predictions_path) {
+    FILE *out = fopen(predictions_path, "w");
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", predictions_path);
+      return 1;
+    }
+    for (int p : predictions.back()) {
+      fprintf(out, "%d\n", p);
+    }
+    fclose(out);
+    printf("predictions written:  %s\n", predictions_path);
+  }
+  if (outputs_path) {
+    FILE *out = fopen(outputs_path, "w");
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", outputs_path);
+      return 1;
+    }
+    for (double p : outputs) {
+      fprintf(out, "%.9g\n", p);
+    }
+    fclose(out);
+    printf("outputs written:      %s\n", outputs_path);
+  }
+  return 0;
+}
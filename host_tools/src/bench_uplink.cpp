@@ -0,0 +1,182 @@
+// Host benchmark of lib/UplinkWriter, the request serializer of lora_receiver.
+//
+// Usage: program [-n readings]
+//   -n <readings>  pseudo-random readings per run (default 200000)
+//
+// Compares three ways of writing the single ThingSpeak GET request:
+//   string    ... the original String concatenation with float prob and
+//                 v_bat, emulated with std::string (small strings stay
+//                 inline there, so its allocation count is a lower bound of
+//                 Arduino String, which allocates for every temporary)
+//   snprintf  ... integer fixed point snprintf into a buffer
+//   writer    ... UplinkWriter into a buffer
+// and checks the writer output byte by byte against snprintf for the query,
+// bulk csv and compact formats, including edge values.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include "uplink_writer.h"
+
+#define PROB_SCALE UPLINK_PROB_SCALE
+#define VOLTAGE_SCALE UPLINK_VOLTAGE_SCALE
+#define API_KEY "S8QL4UGSKU4E3NUH"
+#define REQUEST_LEN 192  // uplinkBuffer of lora_receiver
+#define REPEAT 10
+
+static unsigned long long allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static std::string floatString(float value) {  // String(float), two decimals
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%.2f", value);
+  return std::string(buf);
+}
+
+static size_t requestString(const FireReading &m, char *out) {
+  float prob = float(m.prob) / PROB_SCALE;
+  float v_bat = float(m.vbat) / VOLTAGE_SCALE;
+  std::string str = "GET https://api.thingspeak.com/update?api_key=" API_KEY "&field1=" + std::to_string(m.flame) +
+                    "&field2=" + std::to_string(m.smoke) + "&field3=" + std::to_string(m.gas) + "&field4=" +
+                    floatString(prob) + "&field5=" + floatString(v_bat);
+  out[0] = str[0];  // keep the string alive for the optimizer
+  return str.length();
+}
+
+static size_t requestSnprintf(const FireReading &m, char *out) {
+  return snprintf(out, REQUEST_LEN,
+                  "GET https://api.thingspeak.com/update?api_key=%s&field1=%d&field2=%d&field3=%d"
+                  "&field4=%d.%04d&field5=%d.%03d\r\n", API_KEY, m.flame, m.smoke, m.gas, m.prob / PROB_SCALE,
+                  m.prob % PROB_SCALE, m.vbat / VOLTAGE_SCALE, m.vbat % VOLTAGE_SCALE);
+}
+
+static size_t requestWriter(const FireReading &m, char *out) {
+  UplinkWriter request(out, REQUEST_LEN);
+  request.text("GET https://api.thingspeak.com/update?api_key=" API_KEY "&");
+  writeQueryFields(request, m);
+  request.text("\r\n");
+  return request.length();
+}
+
+static FireReading randomReading(unsigned *seed) {
+  FireReading m;
+  m.transm_id = rand_r(seed) % 256;
+  m.smoke = rand_r(seed) % 1024;
+  m.flame = rand_r(seed) % 1024;
+  m.gas = rand_r(seed) % 1024;
+  m.prob = rand_r(seed) % (PROB_SCALE + 1);
+  m.vbat = 3000 + rand_r(seed) % 10000;
+  return m;
+}
+
+// ---- output check against snprintf ----------------------------------------------
+
+static bool same(const char *name, const FireReading &m, const char *expected, const UplinkWriter &out) {
+  if (out.length() == strlen(expected) && strcmp(out.c_str(), expected) == 0) {
+    return true;
+  }
+  printf("%s differs for %d,%d,%d,%d,%d:\n  snprintf %s\n  writer   %s\n", name, m.smoke, m.flame, m.gas, m.prob,
+         m.vbat, expected, out.c_str());
+  return false;
+}
+
+static bool checkReading(const FireReading &m) {
+  char expected[REQUEST_LEN];
+  char buf[REQUEST_LEN];
+  bool ok = true;
+
+  requestSnprintf(m, expected);
+  requestWriter(m, buf);
+  ok &= strcmp(expected, buf) == 0 || (printf("request differs: %s / %s\n", expected, buf), false);
+
+  UplinkWriter out(buf, sizeof(buf));
+  snprintf(expected, sizeof(expected), "%d,%d,%d,%d.%04d,%d.%03d", m.flame, m.smoke, m.gas, m.prob / PROB_SCALE,
+           m.prob % PROB_SCALE, m.vbat / VOLTAGE_SCALE, m.vbat % VOLTAGE_SCALE);
+  writeCsvFields(out, m);
+  ok &= same("csv", m, expected, out);
+
+  out.clear();
+  snprintf(expected, sizeof(expected), "%d,%d,%d,%d,%d", m.smoke, m.flame, m.gas, m.prob, m.vbat);
+  writeCompactFields(out, m);
+  ok &= same("compact", m, expected, out);
+  return ok;
+}
+
+static bool checkOverflow() {
+  char buf[8];
+  UplinkWriter out(buf, sizeof(buf));
+  out.text("0123").fixed(123456, 1000);
+  return out.overflow() && out.length() == sizeof(buf) - 1 && strcmp(buf, "0123123") == 0;
+}
+
+// ---- timing -------------------------------------------------------------------------
+
+typedef size_t (*RequestFn)(const FireReading &, char *);
+
+static void bench(const char *name, RequestFn fn, const std::vector<FireReading> &readings) {
+  char out[REQUEST_LEN];
+  size_t bytes = 0;
+  unsigned long long allocations_start = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < REPEAT; r++) {
+    for (const FireReading &m : readings) {
+      bytes += fn(m, out);
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  double requests = (double)readings.size() * REPEAT;
+  printf("%-9s %9.1f %12.2f %10.1f\n", name, ns / requests, (allocations - allocations_start) / requests,
+         bytes / requests);
+}
+
+int main(int argc, char **argv) {
+  size_t count = 200000;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    if (opt == 'n') {
+      count = atoi(optarg);
+    } else {
+      fprintf(stderr, "usage: %s [-n readings]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<FireReading> readings;
+  readings.reserve(count);
+  unsigned seed = 1;
+  for (size_t i = 0; i < count; i++) {
+    readings.push_back(randomReading(&seed));
+  }
+
+  bool ok = checkOverflow();
+  const int edges[] = {0, 1, 9, 10, 99, 999, 1000, 1001, 9999, 10000, 65534};
+  for (int e : edges) {
+    FireReading m = {255, e, e, e, e, e};
+    ok &= checkReading(m);
+  }
+  for (const FireReading &m : readings) {
+    ok &= checkReading(m);
+  }
+  printf("output check: %s\n\n", ok ? "writer matches snprintf" : "FAILED");
+
+  printf("%-9s %9s %12s %10s\n", "method", "ns/req", "allocs/req", "bytes/req");
+  bench("string", requestString, readings);
+  bench("snprintf", requestSnprintf, readings);
+  bench("writer", requestWriter, readings);
+  return ok ? 0 : 1;
+}
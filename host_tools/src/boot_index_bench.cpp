@@ -0,0 +1,391 @@
+// Host benchmark of choosing the SD log of a new session at boot of the end
+// node (lora_transmitter, lets_rock_it) on an emulated FAT volume.
+//
+// Usage: program [files]...
+//   files  directory entries of the card (default 10 100 1000)
+//
+// The volume follows the SD library (SdFat of Arduino SD 1.x): FAT32 root
+// directory of 32 byte entries, 16 per sector, 1024 per 32 KB cluster, one
+// 512 byte block cache for data, FAT and directory. Opening a file by name
+// reads the directory from its start up to the entry (up to the end of the
+// directory when there is none), File::openNextFile() reads the next entry
+// and opens it by name, so counting the files rescans the directory per
+// file. Creating a file writes its directory entry at once, close() of a
+// written file writes the data block and the entry with the size.
+//
+// Every card holds logs tabor0.txt .. (files - 1 entries) and the manifest
+// of lib/SessionIndex, boots are
+//   directory count   ... getNumFiles() of the old setup(), tabor<count>
+//   index             ... manifest created with the first log
+//   index, upgraded   ... manifest behind the logs of an older firmware
+//   index, recovery   ... no manifest (first boot after the upgrade)
+// each up to the empty log opened with FILE_WRITE. Prints sector reads and
+// writes, SD time and the boot time with SD.begin(). Then checks the name
+// allocation over a run of boots with torn manifest records, resets between
+// the log and its record, foreign files and rotation.
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "session_index.h"
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x13
+
+#define ENTRIES_PER_SECTOR 16
+#define ENTRIES_PER_CLUSTER 1024  // 64 sectors
+#define CLUSTER_BYTES 32768
+#define FAT_ENTRIES 128           // FAT32 entries per sector
+#define READ_MS 1.2               // CMD17 and 512 B at 4 MHz SPI
+#define WRITE_MS 3.0              // CMD24, 512 B and the card busy
+#define BEGIN_MS 20.0             // SD.begin() card initialization
+#define MANIFEST "SESSIONS.IDX"
+
+// Block numbers of the regions
+static const int64_t DATA = 0;
+static const int64_t FAT = 1LL << 40;
+static const int64_t DIR = 2LL << 40;
+
+struct Entry {
+  std::string name;  // 8.3 upper case as the SD library lists it
+  std::string content;
+};
+
+class Volume;
+
+class File {
+ public:
+  File() {}
+  File(Volume *volume, int entry, bool directory) : volume_(volume), entry_(entry), directory_(directory) {}
+
+  explicit operator bool() const { return volume_ != nullptr; }
+  const char *name() const;
+  uint32_t size() const;
+  bool seek(uint32_t pos);
+  int read();
+  size_t write(const uint8_t *data, size_t len);
+  void close();
+  File openNextFile(uint8_t mode = FILE_READ);
+
+ private:
+  Volume *volume_ = nullptr;
+  int entry_ = -1;
+  bool directory_ = false;
+  uint32_t pos_ = 0;  // byte of a file, entry of the directory
+  bool dirty_ = false;
+};
+
+class Volume {
+ public:
+  long reads = 0;
+  long writes = 0;
+  std::vector<Entry> entries;
+
+  void begin() {
+    cached_ = -1;
+    dirty_ = false;
+    reads += 2;  // MBR, volume boot sector
+  }
+
+  File open(const char *path, uint8_t mode = FILE_READ) {
+    if (strcmp(path, "/") == 0) {
+      return File(this, -1, true);
+    }
+    std::string name = upper(path[0] == '/' ? path + 1 : path);
+    int found = lookup(name);
+    if (found < 0) {
+      if (mode != FILE_WRITE || !valid83(name)) {
+        return File();
+      }
+      // free entry at the end of the directory, written at once
+      found = entries.size();
+      modify(DIR + found / ENTRIES_PER_SECTOR, true);
+      evict();
+      entries.push_back({name, ""});
+    } else if (mode == FILE_WRITE) {
+      walkChain(entries[found].content.size());  // seek to the end
+    }
+    return File(this, found, false);
+  }
+
+  void load(int64_t block, bool read) {
+    if (cached_ == block) {
+      return;
+    }
+    evict();
+    if (read) {
+      reads++;
+    }
+    cached_ = block;
+  }
+
+  void modify(int64_t block, bool read) {
+    load(block, read);
+    dirty_ = true;
+  }
+
+  void evict() {
+    if (dirty_) {
+      writes += cached_ >= FAT && cached_ < DIR ? 2 : 1;  // both FAT copies
+      dirty_ = false;
+    }
+  }
+
+  // Reads entry of the directory
+  void readEntry(int entry) {
+    if (entry > 0 && entry % ENTRIES_PER_CLUSTER == 0) {
+      load(FAT + entry / ENTRIES_PER_CLUSTER / FAT_ENTRIES, true);  // next cluster of the directory
+    }
+    load(DIR + entry / ENTRIES_PER_SECTOR, true);
+  }
+
+  void walkChain(uint32_t bytes) {
+    for (uint32_t c = 1; c < (bytes + CLUSTER_BYTES - 1) / CLUSTER_BYTES; c++) {
+      load(FAT + c / FAT_ENTRIES, true);
+    }
+  }
+
+  static int64_t dataBlock(int entry, uint32_t pos) { return DATA + ((int64_t)entry << 24) + pos / 512; }
+
+ private:
+  // Entry of name, reading the directory from its start, -1 for none
+  int lookup(const std::string &name) {
+    for (size_t i = 0; i <= entries.size(); i++) {
+      readEntry(i);  // at the end the free entry
+      if (i < entries.size() && entries[i].name == name) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static std::string upper(const char *name) {
+    std::string s = name;
+    for (char &c : s) {
+      c = toupper((unsigned char)c);
+    }
+    return s;
+  }
+
+  static bool valid83(const std::string &name) {
+    size_t dot = name.find('.');
+    return (dot == std::string::npos ? name.size() : dot) <= 8 &&
+           (dot == std::string::npos || name.size() - dot - 1 <= 3);
+  }
+
+  int64_t cached_ = -1;
+  bool dirty_ = false;
+};
+
+const char *File::name() const {
+  return directory_ ? "/" : volume_->entries[entry_].name.c_str();
+}
+
+uint32_t File::size() const {
+  return directory_ ? 0 : volume_->entries[entry_].content.size();
+}
+
+bool File::seek(uint32_t pos) {
+  if (directory_ || pos > size()) {
+    return false;
+  }
+  volume_->walkChain(pos);
+  pos_ = pos;
+  return true;
+}
+
+int File::read() {
+  if (directory_ || pos_ >= size()) {
+    return -1;
+  }
+  volume_->load(Volume::dataBlock(entry_, pos_), true);
+  return (uint8_t)volume_->entries[entry_].content[pos_++];
+}
+
+size_t File::write(const uint8_t *data, size_t len) {
+  std::string &content = volume_->entries[entry_].content;
+  for (size_t i = 0; i < len; i++) {
+    uint32_t pos = content.size();  // FILE_WRITE appends
+    if (pos % CLUSTER_BYTES == 0) {
+      volume_->modify(FAT + pos / CLUSTER_BYTES / FAT_ENTRIES, true);
+    }
+    volume_->modify(Volume::dataBlock(entry_, pos), pos % 512 != 0);
+    content += (char)data[i];
+  }
+  dirty_ = dirty_ || len > 0;
+  return len;
+}
+
+void File::close() {
+  if (volume_ && dirty_) {
+    volume_->evict();
+    volume_->modify(DIR + entry_ / ENTRIES_PER_SECTOR, true);
+    volume_->evict();
+  }
+  volume_ = nullptr;
+}
+
+File File::openNextFile(uint8_t mode) {
+  if (pos_ >= volume_->entries.size()) {
+    volume_->readEntry(pos_);  // free entry ends the directory
+    return File();
+  }
+  volume_->readEntry(pos_);
+  // the SD library opens the entry by its name from the directory start
+  std::string name = volume_->entries[pos_++].name;
+  return volume_->open(name.c_str(), mode);
+}
+
+// getNumFiles() and the name of the old setup()
+static File countBoot(Volume &volume, std::string *name) {
+  File root = volume.open("/");
+  int cntr = 0;
+  while (true) {
+    File entry = root.openNextFile();
+    if (!entry) {
+      break;
+    }
+    cntr++;
+    entry.close();
+  }
+  *name = "tabor" + std::to_string(cntr) + ".txt";
+  return volume.open(name->c_str(), FILE_WRITE);
+}
+
+enum Boot { COUNT, INDEX, UPGRADED, RECOVERY, BOOTS };
+static const char *boot_names[BOOTS] = {"directory count", "index", "index, upgraded", "index, recovery"};
+
+static void fillCard(Volume *volume, int files, Boot boot) {
+  uint8_t record[SESSION_INDEX_RECORD];
+  SessionIndex::encodeRecord(files - 2, record);
+  std::string manifest;
+  for (int s = 0; s < files - 1; s++) {
+    manifest.append((const char *)record, SESSION_INDEX_RECORD);  // one per session, the last counts
+  }
+  if (boot == INDEX) {
+    volume->entries.push_back({MANIFEST, manifest});
+  }
+  for (int s = 0; s < files - 1; s++) {
+    volume->entries.push_back({"TABOR" + std::to_string(s) + ".TXT", std::string(4096, 'x')});
+  }
+  if (boot == UPGRADED || boot == COUNT) {
+    volume->entries.push_back({MANIFEST, manifest});
+  }
+}
+
+// Removes the last record of the manifest
+static void dropRecord(Volume *volume) {
+  for (Entry &e : volume->entries) {
+    if (e.name == MANIFEST && e.content.size() >= SESSION_INDEX_RECORD) {
+      e.content.resize(e.content.size() - SESSION_INDEX_RECORD);
+    }
+  }
+}
+
+static bool checkRun() {
+  Volume volume;
+  SessionIndex index(MANIFEST, "tabor", ".bin", FILE_WRITE);
+  std::vector<std::string> names;
+  volume.entries.push_back({"TABOR0.TXT", "old"});  // older firmware
+  volume.entries.push_back({"NOTES.TXT", "foreign"});
+  srand(7);
+  int expected = 1;
+  int skipped = 0;  // empty logs
+  for (int boot = 0; boot < 200; boot++) {
+    volume.begin();
+    File log = index.create(volume);
+    // a session after an empty log the manifest lost is fine, an earlier
+    // one or a log with rows is not
+    if (!log || index.session() < expected || log.size() != 0) {
+      fprintf(stderr, "boot %d: session %d, expected %d\n", boot, index.session(), expected);
+      return false;
+    }
+    skipped += index.session() - expected;
+    expected = index.session();
+    int event = rand() % 8;
+    if (event == 0) {  // reset before the first row, the empty log stays
+      expected++;
+      continue;
+    }
+    if (event == 1) {  // reset between the log and its record
+      dropRecord(&volume);
+      continue;
+    }
+    const uint8_t row[] = "1,2,3\n";
+    log.write(row, sizeof(row) - 1);
+    log.close();
+    names.push_back(index.name());
+    expected++;
+    if (event == 2) {  // torn record
+      File manifest = volume.open(MANIFEST, FILE_WRITE);
+      manifest.write(row, 2);
+      manifest.close();
+    } else if (event == 3) {  // record lost, log written
+      dropRecord(&volume);
+    } else if (event == 4 && expected < 900) {  // rotation
+      File next = index.rotate(volume, log);
+      if (!next || index.session() != expected) {
+        fprintf(stderr, "boot %d: rotation to session %d\n", boot, index.session());
+        return false;
+      }
+      next.write(row, sizeof(row) - 1);
+      next.close();
+      names.push_back(index.name());
+      expected++;
+    }
+  }
+  std::set<std::string> unique(names.begin(), names.end());
+  if (unique.size() != names.size()) {
+    fprintf(stderr, "a log name used twice\n");
+    return false;
+  }
+  printf("\n200 boots with resets, torn and lost records and rotation: %zu logs with rows, %d empty logs "
+         "skipped, ok\n", names.size(), skipped);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  std::vector<int> sizes;
+  for (int a = 1; a < argc; a++) {
+    sizes.push_back(atoi(argv[a]));
+    if (sizes.back() < 2 || sizes.back() > 1000) {
+      fprintf(stderr, "usage: %s [files 2 .. 1000]...\n", argv[0]);
+      return 1;
+    }
+  }
+  if (sizes.empty()) {
+    sizes = {10, 100, 1000};
+  }
+
+  printf("%6s  %-17s %8s %8s %10s %10s  %s\n", "files", "boot", "reads", "writes", "SD ms", "boot ms", "log");
+  for (int files : sizes) {
+    for (int b = 0; b < BOOTS; b++) {
+      Volume volume;
+      fillCard(&volume, files, (Boot)b);
+      volume.begin();
+      volume.reads = 0;
+      volume.writes = 0;
+      std::string name;
+      File log;
+      if (b == COUNT) {
+        log = countBoot(volume, &name);
+      } else {
+        SessionIndex index(MANIFEST, "tabor", ".txt", FILE_WRITE);
+        log = index.create(volume);
+        name = index.name();
+        if (index.session() != files - 1 || index.recovered() != (b == RECOVERY)) {
+          fprintf(stderr, "%s: session %d of %d files\n", boot_names[b], index.session(), files);
+          return 1;
+        }
+      }
+      double ms = volume.reads * READ_MS + volume.writes * WRITE_MS;
+      printf("%6d  %-17s %8ld %8ld %10.1f %10.1f  %s\n", files, boot_names[b], volume.reads, volume.writes, ms,
+             ms + BEGIN_MS + 2 * READ_MS, log ? name.c_str() : "(no 8.3 name)");
+    }
+  }
+  return checkRun() ? 0 : 1;
+}
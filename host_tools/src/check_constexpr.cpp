@@ -0,0 +1,57 @@
+// Runs the compile-time generated fire net (lib/FireNet, model_real3_net.h)
+// over recorded sessions and writes its predictions.
+//
+// Usage: program <predictions.txt> <session.TXT>...
+//   predictions.txt ... one prediction per line for all rows of all sessions
+//                       in the given order, compare it with the TFLite model
+//                       by real_model/check_constexpr.py --net_output
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "samples.h"
+#include "model_real3_net.h"
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <predictions.txt> <session.TXT>...\n", argv[0]);
+    return 1;
+  }
+  FILE *out = fopen(argv[1], "w");
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", argv[1]);
+    return 1;
+  }
+
+  double total_ns = 0;
+  size_t total_rows = 0;
+  for (int a = 2; a < argc; a++) {
+    std::vector<Sample> samples;
+    if (!readSamples(argv[a], &samples)) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      fclose(out);
+      return 1;
+    }
+
+    std::vector<float> predictions(samples.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples.size(); i++) {
+      float input[model_real3::Net::inputs] = {(float)samples[i].smoke, (float)samples[i].flame, (float)samples[i].gas};
+      predictions[i] = model_real3::Net::predict(input);
+    }
+    auto end = std::chrono::steady_clock::now();
+    total_ns += std::chrono::duration<double, std::nano>(end - start).count();
+    total_rows += samples.size();
+
+    int alarms = 0;
+    for (size_t i = 0; i < predictions.size(); i++) {
+      fprintf(out, "%.7f\n", predictions[i]);
+      alarms += predictions[i] >= 0.5f;
+    }
+    printf("%-40s rows %5zu, p >= 0.5 in %5d\n", argv[a], samples.size(), alarms);
+  }
+  fclose(out);
+  if (total_rows > 0) {
+    printf("host time: %.1f ns / inference\n", total_ns / total_rows);
+  }
+  return 0;
+}
@@ -0,0 +1,231 @@
+// Host harness of the rolling-window features of the end node
+// (lib/FireFeatures, ROLLING_FEATURES_MODE of lora_transmitter).
+//
+// Usage: program [options] <session.csv>...
+//   -w <readings>  window, 5, 10, 20 or 40 (default 10, FEATURE_WINDOW)
+//   -e <shift>     EMA weight 1 / 2^shift of a new reading (default 2)
+//   -o <file>      write the features of every reading as CSV
+//
+// Every file is a session (data/*.TXT, real_model/all_data.csv) replayed
+// through a fresh extractor, one reading per row. The features are checked
+// against a double precision reference over the same window (value, min
+// and max exactly, the fixed-point ones to their rounding). Prints the
+// separation of each feature between readings without and with fire
+// (Cohen's d), the RAM of every feature and the host time per reading.
+//
+// The CSV has the columns session,label and the features in counts
+// (divided by fireFeatureScale()), the input of an extended model as the
+// node computes it.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include "samples.h"
+#include "fire_features.h"
+
+#define SPEED_ROUNDS 200
+
+static volatile int32_t sink;  // keeps the timed loop
+
+struct Session {
+  std::string name;
+  std::vector<Sample> samples;
+};
+
+// Features of a reading by the definition, over the last window readings
+static void referenceFeatures(const std::deque<int> &window, double *ema, int ema_shift, int y, bool first,
+                              double *out) {
+  double alpha = 1.0 / (1 << ema_shift);
+  *ema = first ? y : *ema + alpha * (y - *ema);
+  double n = window.size();
+  double mean = 0;
+  double min = window.front();
+  double max = window.front();
+  for (int v : window) {
+    mean += v / n;
+    min = v < min ? v : min;
+    max = v > max ? v : max;
+  }
+  double var = 0;
+  double k_mean = (n - 1) / 2;
+  double cov = 0;
+  double k_var = 0;
+  for (size_t k = 0; k < window.size(); k++) {
+    var += (window[k] - mean) * (window[k] - mean) / n;
+    cov += (k - k_mean) * (window[k] - mean);
+    k_var += (k - k_mean) * (k - k_mean);
+  }
+  out[FEATURE_VALUE] = y;
+  out[FEATURE_EMA] = *ema;
+  out[FEATURE_VARIANCE] = var;
+  out[FEATURE_SLOPE] = k_var > 0 ? cov / k_var : 0;
+  out[FEATURE_MIN] = min;
+  out[FEATURE_MAX] = max;
+}
+
+// Largest error of each feature kind allowed against the reference, counts
+static const double tolerance[FEATURES_PER_SENSOR] = {0, 0.1, 1.0 / FIRE_FEATURE_SCALE_Q4,
+                                                      1.0 / FIRE_FEATURE_SCALE_Q4, 0, 0};
+
+template <uint8_t Window>
+static int run(const std::vector<Session> &sessions, int ema_shift, FILE *out) {
+  double max_error[FIRE_FEATURES_COUNT] = {};
+  double sum[2][FIRE_FEATURES_COUNT] = {};
+  double sum_sq[2][FIRE_FEATURES_COUNT] = {};
+  long labeled[2] = {};
+  long readings = 0;
+
+  if (out) {
+    fprintf(out, "session,label");
+    for (int i = 0; i < FIRE_FEATURES_COUNT; i++) {
+      fprintf(out, ",%s", fireFeatureName(i));
+    }
+    fprintf(out, "\n");
+  }
+  for (const Session &session : sessions) {
+    FireFeatures<Window> features(ema_shift);
+    std::deque<int> windows[FIRE_FEATURE_SENSORS];
+    double emas[FIRE_FEATURE_SENSORS] = {};
+    for (size_t r = 0; r < session.samples.size(); r++) {
+      const Sample &s = session.samples[r];
+      features.update(s.smoke, s.flame, s.gas);
+      int32_t vector[FIRE_FEATURES_COUNT];
+      features.vector(vector);
+
+      int ys[FIRE_FEATURE_SENSORS] = {s.smoke, s.flame, s.gas};
+      double reference[FIRE_FEATURES_COUNT];
+      for (int sensor = 0; sensor < FIRE_FEATURE_SENSORS; sensor++) {
+        windows[sensor].push_back(ys[sensor]);
+        if (windows[sensor].size() > Window) {
+          windows[sensor].pop_front();
+        }
+        referenceFeatures(windows[sensor], &emas[sensor], ema_shift, ys[sensor], r == 0,
+                          reference + sensor * FEATURES_PER_SENSOR);
+      }
+      if (out) {
+        fprintf(out, "%s,%d", session.name.c_str(), s.label);
+      }
+      for (int i = 0; i < FIRE_FEATURES_COUNT; i++) {
+        double value = (double)vector[i] / fireFeatureScale(i);
+        double error = fabs(value - reference[i]);
+        if (error > max_error[i]) {
+          max_error[i] = error;
+        }
+        if (error > tolerance[i % FEATURES_PER_SENSOR] + 1e-9) {
+          fprintf(stderr, "%s row %zu: %s %.4f, reference %.4f\n", session.name.c_str(), r + 1, fireFeatureName(i),
+                  value, reference[i]);
+          return 1;
+        }
+        if (s.label >= 0) {
+          int label = s.label > 0;
+          sum[label][i] += value;
+          sum_sq[label][i] += value * value;
+        }
+        if (out) {
+          fprintf(out, fireFeatureScale(i) == 1 ? ",%.0f" : ",%.4f", value);
+        }
+      }
+      if (out) {
+        fprintf(out, "\n");
+      }
+      if (s.label >= 0) {
+        labeled[s.label > 0]++;
+      }
+      readings++;
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < SPEED_ROUNDS; round++) {
+    for (const Session &session : sessions) {
+      FireFeatures<Window> features(ema_shift);
+      for (const Sample &s : session.samples) {
+        features.update(s.smoke, s.flame, s.gas);
+        int32_t vector[FIRE_FEATURES_COUNT];
+        features.vector(vector);
+        sink = vector[FIRE_FEATURES_COUNT - 1];
+      }
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+              ((double)readings * SPEED_ROUNDS);
+
+  printf("%ld readings of %zu sessions, window %d readings, EMA weight 1/%d\n\n", readings, sessions.size(), Window,
+         1 << ema_shift);
+  printf("%-12s %10s %10s %10s %8s\n", "feature", "max error", "mean", "mean", "d");
+  printf("%-12s %10s %10s %10s %8s\n", "", "counts", "no fire", "fire", "");
+  for (int i = 0; i < FIRE_FEATURES_COUNT; i++) {
+    double mean[2];
+    double var[2];
+    for (int l = 0; l < 2; l++) {
+      mean[l] = labeled[l] ? sum[l][i] / labeled[l] : 0;
+      var[l] = labeled[l] ? sum_sq[l][i] / labeled[l] - mean[l] * mean[l] : 0;
+    }
+    double pooled = sqrt((var[0] + var[1]) / 2);
+    printf("%-12s %10.4f %10.2f %10.2f %8.2f\n", fireFeatureName(i), max_error[i], mean[0], mean[1],
+           pooled > 0 ? (mean[1] - mean[0]) / pooled : 0.0);
+  }
+
+  // RAM of RollingStats<Window>: ring and running sums shared by value,
+  // variance and slope
+  size_t queue = 4 * Window + 2;
+  size_t ring = 2 * Window + 4;  // ring, slot, count, sequence
+  printf("\nRAM per sensor (bytes): value, variance, slope %zu (ring %zu, sums 12), EMA 5, min %zu, max %zu\n",
+         ring + 12, ring, queue, queue);
+  printf("RAM of FireFeatures<%d>: %zu B (3 sensors), vector %zu B\n", Window, sizeof(FireFeatures<Window>),
+         sizeof(int32_t) * FIRE_FEATURES_COUNT);
+  printf("host time: %.1f ns per reading (update and vector)\n", ns);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int window = 10;
+  int ema_shift = 2;
+  const char *out_path = nullptr;
+  int opt;
+  while ((opt = getopt(argc, argv, "w:e:o:")) != -1) {
+    switch (opt) {
+      case 'w': window = atoi(optarg); break;
+      case 'e': ema_shift = atoi(optarg); break;
+      case 'o': out_path = optarg; break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind >= argc || ema_shift < 0 || ema_shift > 8) {
+    fprintf(stderr, "usage: %s [-w 5|10|20|40] [-e shift] [-o features.csv] <session.csv>...\n", argv[0]);
+    return 1;
+  }
+  std::vector<Session> sessions;
+  for (int a = optind; a < argc; a++) {
+    Session session;
+    session.name = argv[a];
+    if (!readSamples(argv[a], &session.samples) || session.samples.empty()) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+    sessions.push_back(session);
+  }
+  FILE *out = nullptr;
+  if (out_path && !(out = fopen(out_path, "w"))) {
+    fprintf(stderr, "cannot write %s\n", out_path);
+    return 1;
+  }
+  int result;
+  switch (window) {
+    case 5: result = run<5>(sessions, ema_shift, out); break;
+    case 10: result = run<10>(sessions, ema_shift, out); break;
+    case 20: result = run<20>(sessions, ema_shift, out); break;
+    case 40: result = run<40>(sessions, ema_shift, out); break;
+    default:
+      fprintf(stderr, "window %d not compiled in, use 5, 10, 20 or 40\n", window);
+      result = 1;
+  }
+  if (out) {
+    fclose(out);
+  }
+  return result;
+}
@@ -0,0 +1,245 @@
+// Fuzz test of the radio frame codec (lib/FireFrame).
+//
+// Usage: program [-n iterations] [-s seed]
+//   -n <iterations>  random cases per check (default 1000000)
+//   -s <seed>        random seed (default 1)
+//
+// Checks:
+//   roundtrip  ... v1, v2 and v2 heartbeat encode / decode of random readings
+//                  in range gives the same reading (v2 battery within half a
+//                  step), diagnostics frame of random values the same values
+//   aggregated ... encode / decode of 1 .. FIRE_FRAME_AGG_MAX readings as
+//                  random walks with steps of random size gives the same
+//                  readings, sequence numbers and ages
+//   range      ... values out of range make encode fail and decode reject
+//                  the frame (v1 error value, v2 error flag), v2 battery is
+//                  clamped only
+//   garbage    ... decodeFrames() and decodeFrameDiag() of random bytes of every length
+//                  0 .. MAX_FUZZ_LEN reads only len bytes (the frame is in
+//                  an exact size heap buffer, run with -fsanitize=address),
+//                  accepted readings are in range of the fields and an
+//                  accepted v2 frame encodes back to the same bytes
+// Build environment fuzz_frame enables the address and undefined behavior
+// sanitizers.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <random>
+#include "fire_frame.h"
+
+#define MAX_FUZZ_LEN (FIRE_FRAME_AGG_MAX_LEN + 8)
+
+static std::mt19937 rng;
+
+static int uniform(int lo, int hi) {
+  return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+static FireReading randomReading(int sensor_max, int prob_max, int vbat_max) {
+  FireReading r;
+  r.transm_id = uniform(0, 255);
+  r.smoke = uniform(0, sensor_max);
+  r.flame = uniform(0, sensor_max);
+  r.gas = uniform(0, sensor_max);
+  r.prob = uniform(0, prob_max);
+  r.vbat = uniform(0, vbat_max);
+  r.seq = uniform(0, 255);
+  r.flags = uniform(0, 15) & ~(FIRE_FLAG_ERROR | FIRE_FLAG_HEARTBEAT);
+  r.suppressed = uniform(0, 65535);
+  return r;
+}
+
+static bool sameValues(const FireReading &a, const FireReading &b, int vbat_tolerance) {
+  return a.transm_id == b.transm_id && a.smoke == b.smoke && a.flame == b.flame && a.gas == b.gas &&
+         a.prob == b.prob && abs(a.vbat - b.vbat) <= vbat_tolerance;
+}
+
+static bool sameDiag(const FireDiag &a, const FireDiag &b) {
+  bool same = a.transm_id == b.transm_id && a.seq == b.seq && a.flags == b.flags && a.cycles == b.cycles &&
+              a.cycle_ms == b.cycle_ms;
+  for (int s = 0; s < FIRE_DIAG_STAGES; s++) {
+    same = same && a.stage_us[s] == b.stage_us[s] && a.stage_uj[s] == b.stage_uj[s];
+  }
+  return same;
+}
+
+static void printReading(const char *what, const FireReading &r) {
+  printf("  %s id %u smoke %d flame %d gas %d prob %d vbat %d seq %u flags %x\n", what, r.transm_id, r.smoke,
+         r.flame, r.gas, r.prob, r.vbat, r.seq, r.flags);
+}
+
+static bool checkRoundtrip(long iterations) {
+  long failed = 0;
+  for (long i = 0; i < iterations; i++) {
+    FireReading in = randomReading(FIRE_FRAME_V2_SENSOR_MAX, FIRE_FRAME_V2_PROB_MAX, FIRE_FRAME_V2_VBAT_MAX);
+    FireReading out;
+    uint8_t v1[FIRE_FRAME_V1_LEN];
+    uint8_t v2[FIRE_FRAME_V2_LEN];
+    bool ok = encodeFrameV1(in, v1) && decodeFrame(v1, sizeof(v1), &out) && sameValues(in, out, 0);
+    ok = ok && encodeFrameV2(in, v2) && decodeFrame(v2, sizeof(v2), &out) &&
+         sameValues(in, out, FIRE_FRAME_V2_VBAT_STEP / 2) && out.seq == in.seq && out.flags == in.flags;
+    uint8_t heartbeat[FIRE_FRAME_V2_HEARTBEAT_LEN];
+    ok = ok && encodeFrameV2Heartbeat(in, heartbeat) && decodeFrame(heartbeat, sizeof(heartbeat), &out) &&
+         sameValues(in, out, FIRE_FRAME_V2_VBAT_STEP / 2) && out.flags == (in.flags | FIRE_FLAG_HEARTBEAT) &&
+         out.suppressed == in.suppressed && !decodeFrame(heartbeat, FIRE_FRAME_V2_LEN, &out);
+    FireDiag diag_in = {in.transm_id, in.seq, (uint8_t)(in.flags & 0x0F), (uint16_t)uniform(0, 65535),
+                        (uint16_t)uniform(0, 65535)};
+    for (int s = 0; s < FIRE_DIAG_STAGES; s++) {
+      diag_in.stage_us[s] = rng();
+      diag_in.stage_uj[s] = rng();
+    }
+    uint8_t diag_frame[FIRE_FRAME_DIAG_LEN];
+    FireDiag diag_out;
+    encodeFrameDiag(diag_in, diag_frame);
+    ok = ok && decodeFrameDiag(diag_frame, sizeof(diag_frame), &diag_out) && sameDiag(diag_in, diag_out) &&
+         !decodeFrameDiag(diag_frame, sizeof(diag_frame) - 1, &diag_out) &&
+         decodeFrames(diag_frame, sizeof(diag_frame), &out, 1) == 0;
+    if (!ok && failed++ < 5) {
+      printReading("roundtrip failed for", in);
+    }
+  }
+  printf("roundtrip  %10ld cases  %s\n", iterations, failed ? "FAILED" : "ok");
+  return failed == 0;
+}
+
+static int walk(int value, int step, int max) {
+  value += uniform(-step, step);
+  return value < 0 ? 0 : value > max ? max : value;
+}
+
+static bool checkAggregated(long iterations) {
+  long failed = 0;
+  for (long i = 0; i < iterations; i++) {
+    int count = uniform(1, FIRE_FRAME_AGG_MAX);
+    int step = 1 << uniform(0, 14);
+    uint8_t interval_s = uniform(0, 255);
+    FireReading in[FIRE_FRAME_AGG_MAX];
+    in[0] = randomReading(FIRE_FRAME_V2_SENSOR_MAX, FIRE_FRAME_V2_PROB_MAX, FIRE_FRAME_V2_VBAT_MAX);
+    for (int r = 1; r < count; r++) {
+      in[r] = in[r - 1];
+      in[r].smoke = walk(in[r].smoke, step, FIRE_FRAME_V2_SENSOR_MAX);
+      in[r].flame = walk(in[r].flame, step, FIRE_FRAME_V2_SENSOR_MAX);
+      in[r].gas = walk(in[r].gas, step, FIRE_FRAME_V2_SENSOR_MAX);
+      in[r].prob = walk(in[r].prob, step, FIRE_FRAME_V2_PROB_MAX);
+      in[r].vbat = walk(in[r].vbat, step, FIRE_FRAME_V2_VBAT_MAX);
+    }
+    uint8_t frame[FIRE_FRAME_AGG_MAX_LEN];
+    FireReading out[FIRE_FRAME_AGG_MAX];
+    size_t len = encodeFrameAgg(in, count, interval_s, frame, sizeof(frame));
+    bool ok = len > 0 && decodeFrames(frame, len, out, FIRE_FRAME_AGG_MAX) == count;
+    // one byte less does not decode
+    ok = ok && decodeFrames(frame, len - 1, out, FIRE_FRAME_AGG_MAX) == 0;
+    ok = ok && decodeFrames(frame, len, out, FIRE_FRAME_AGG_MAX) == count;
+    for (int r = 0; ok && r < count; r++) {
+      ok = sameValues(in[r], out[r], FIRE_FRAME_V2_VBAT_STEP / 2) && out[r].seq == (uint8_t)(in[0].seq + r) &&
+           out[r].age_s == (count - 1 - r) * interval_s;
+    }
+    if (!ok && failed++ < 5) {
+      printf("  aggregated frame of %d readings, step %d failed\n", count, step);
+    }
+  }
+  printf("aggregated %10ld cases  %s\n", iterations, failed ? "FAILED" : "ok");
+  return failed == 0;
+}
+
+static bool inRange(const FireReading &r) {
+  return r.smoke >= 0 && r.smoke <= FIRE_FRAME_V2_SENSOR_MAX && r.flame >= 0 && r.flame <= FIRE_FRAME_V2_SENSOR_MAX &&
+         r.gas >= 0 && r.gas <= FIRE_FRAME_V2_SENSOR_MAX && r.prob >= 0 && r.prob <= FIRE_FRAME_V2_PROB_MAX &&
+         r.vbat >= 0 && r.vbat <= FIRE_FRAME_V2_VBAT_MAX;
+}
+
+static bool checkRange(long iterations) {
+  long failed = 0;
+  for (long i = 0; i < iterations; i++) {
+    FireReading in = randomReading(FIRE_FRAME_V2_SENSOR_MAX, FIRE_FRAME_V2_PROB_MAX, 12600);
+    int field = uniform(0, 4);
+    int value = uniform(0, 1) ? uniform(-100000, -1) : uniform(FIRE_FRAME_ERR_VALUE, 1000000);
+    int *fields[] = {&in.smoke, &in.flame, &in.gas, &in.prob, &in.vbat};
+    *fields[field] = value;
+    FireReading out;
+    uint8_t v1[FIRE_FRAME_V1_LEN];
+    uint8_t v2[FIRE_FRAME_V2_LEN];
+    bool is_vbat = field == 4;
+    // battery voltage is not checked by decode in both versions
+    bool ok = !encodeFrameV1(in, v1) && decodeFrame(v1, sizeof(v1), &out) == is_vbat;
+    ok = ok && !encodeFrameV2(in, v2) && decodeFrame(v2, sizeof(v2), &out) == is_vbat;
+    if (is_vbat) {
+      ok = ok && out.vbat == (value < 0 ? 0 : FIRE_FRAME_V2_VBAT_MAX);
+    } else {
+      ok = ok && (out.flags & FIRE_FLAG_ERROR);
+    }
+    if (!ok && failed++ < 5) {
+      printReading("range check failed for", in);
+    }
+  }
+  printf("range      %10ld cases  %s\n", iterations, failed ? "FAILED" : "ok");
+  return failed == 0;
+}
+
+static bool checkGarbage(long iterations) {
+  long failed = 0;
+  long accepted[MAX_FUZZ_LEN + 1] = {};
+  for (long i = 0; i < iterations; i++) {
+    size_t len = i % (MAX_FUZZ_LEN + 1);
+    uint8_t *frame = (uint8_t *)malloc(len ? len : 1);
+    for (size_t b = 0; b < len; b++) {
+      frame[b] = uniform(0, 255);
+    }
+    int version = uniform(0, 3);  // most of them look like v2 or aggregated
+    if (len >= 1 && version) {
+      frame[0] = (frame[0] & 0x0F) | ((version == 1 ? FIRE_FRAME_V2 : FIRE_FRAME_AGG) << 4);
+    }
+    FireReading out[FIRE_FRAME_AGG_MAX];
+    FireDiag diag;
+    decodeFrameDiag(frame, len, &diag);
+    int count = decodeFrames(frame, len, out, FIRE_FRAME_AGG_MAX);
+    if (count > 0) {
+      accepted[len]++;
+      for (int r = 0; r < count && len != FIRE_FRAME_V1_LEN; r++) {
+        if (!inRange(out[r]) && failed++ < 5) {
+          printReading("out of range", out[r]);
+        }
+      }
+      if (len != FIRE_FRAME_V1_LEN && frame[0] >> 4 == FIRE_FRAME_V2) {
+        uint8_t again[FIRE_FRAME_V2_LEN];
+        if (!encodeFrameV2(out[0], again) || memcmp(again, frame, FIRE_FRAME_V2_LEN) != 0) {
+          if (failed++ < 5) {
+            printReading("re-encode differs for", out[0]);
+          }
+        }
+      }
+    }
+    free(frame);
+  }
+  long total = 0;
+  for (int len = 0; len <= MAX_FUZZ_LEN; len++) {
+    total += accepted[len];
+  }
+  printf("garbage    %10ld cases  %s, accepted %ld (v1 %ld, v2 %ld)\n", iterations, failed ? "FAILED" : "ok", total,
+         accepted[FIRE_FRAME_V1_LEN], accepted[FIRE_FRAME_V2_LEN]);
+  return failed == 0;
+}
+
+int main(int argc, char **argv) {
+  long iterations = 1000000;
+  unsigned seed = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    if (opt == 'n') {
+      iterations = atol(optarg);
+    } else if (opt == 's') {
+      seed = atoi(optarg);
+    } else {
+      fprintf(stderr, "usage: %s [-n iterations] [-s seed]\n", argv[0]);
+      return 1;
+    }
+  }
+  rng.seed(seed);
+
+  bool ok = checkRoundtrip(iterations);
+  ok &= checkAggregated(iterations);
+  ok &= checkRange(iterations);
+  ok &= checkGarbage(iterations);
+  return ok ? 0 : 1;
+}
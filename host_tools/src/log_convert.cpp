@@ -0,0 +1,253 @@
+// Converter of the binary SD card logs of the end nodes (lib/FireLog,
+// SD_LOG_BINARY_MODE of lora_transmitter) to the CSV of the recorded
+// sessions (data/*.TXT) that the training scripts read.
+//
+// Usage: program [options] <log.bin>...
+//   -o <dir>  write <dir>/<log name>.TXT per log instead of stdout
+//   -n        no prob column, smoke,flame,gas,label only
+//   -s        strict, drop the records of an unfinished last block (no CRC)
+//   -t        self test, arguments are CSV sessions instead of logs
+//
+// Rows are smoke,flame,gas,label,prob with the probability in 2 decimals
+// as the CSV log of the node. Blocks with a bad CRC, sync byte or sequence
+// are skipped and reported, the exit code is 2 when some were.
+//
+// Self test: every session is encoded into a log in memory (probability
+// from the fixed-point fire net), decoded back and compared field by field,
+// then again with one corrupted byte per block, where only that block may
+// be lost. Prints bytes per reading of the CSV and of the log and the
+// conversion speed.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "samples.h"
+#include "fire_log.h"
+#include "fire_net_fixed.h"
+#include "uplink_writer.h"
+
+#define PERIOD_MS 6000  // TIME_SPAN
+#define SPEED_ROUNDS 200
+
+struct Stats {
+  long blocks = 0;
+  long bad_blocks = 0;
+  long unverified = 0;  // records of an unfinished last block
+  long records = 0;
+};
+
+// Decodes log into records, false when it is no fire log
+static bool decodeLog(const std::vector<uint8_t> &log, bool strict, std::vector<FireLogRecord> *records,
+                      Stats *stats) {
+  FireLogSchema schema;
+  if (!decodeLogSchema(log.data(), log.size(), &schema)) {
+    return false;
+  }
+  FireLogRecord block_records[FIRE_LOG_BLOCK_RECORDS];
+  uint16_t expected_seq = 0;
+  for (size_t offset = FIRE_LOG_BLOCK; offset < log.size(); offset += FIRE_LOG_BLOCK) {
+    size_t len = log.size() - offset < FIRE_LOG_BLOCK ? log.size() - offset : FIRE_LOG_BLOCK;
+    const uint8_t *block = log.data() + offset;
+    bool verified;
+    int n = decodeLogBlock(block, len, block_records, FIRE_LOG_BLOCK_RECORDS, &verified);
+    stats->blocks++;
+    uint16_t seq = len >= FIRE_LOG_HEADER_LEN ? (uint16_t)(block[1] << 8 | block[2]) : 0;
+    if (n < 0 || seq != expected_seq) {
+      stats->bad_blocks++;
+      expected_seq++;
+      continue;
+    }
+    expected_seq++;
+    if (!verified) {
+      stats->unverified += n;
+      if (strict) {
+        continue;
+      }
+    }
+    records->insert(records->end(), block_records, block_records + n);
+    stats->records += n;
+  }
+  return true;
+}
+
+static void writeCsv(const std::vector<FireLogRecord> &records, bool with_prob, std::string *out) {
+  out->append(with_prob ? "smoke,flame,gas,label, prob\n" : "smoke,flame,gas,label\n");
+  char row[64];
+  for (const FireLogRecord &r : records) {
+    UplinkWriter w(row, sizeof(row));
+    w.number((long)r.smoke).character(',').number((long)r.flame).character(',').number((long)r.gas);
+    w.character(',').number((long)r.label);
+    if (with_prob) {
+      w.character(',').fixed((r.prob + 50) / 100, 100);
+    }
+    w.character('\n');
+    out->append(w.c_str(), w.length());
+  }
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> *data) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  uint8_t buffer[1 << 16];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    data->insert(data->end(), buffer, buffer + n);
+  }
+  fclose(f);
+  return true;
+}
+
+static std::vector<uint8_t> encodeLog(const std::vector<FireLogRecord> &records) {
+  FireLogEncoder encoder;
+  std::vector<uint8_t> log(FIRE_LOG_BLOCK);
+  encoder.begin(0x11, PERIOD_MS, log.data());
+  uint8_t chunk[FIRE_LOG_CHUNK_MAX];
+  for (const FireLogRecord &r : records) {
+    size_t n = encoder.encode(r, chunk);
+    log.insert(log.end(), chunk, chunk + n);
+  }
+  return log;
+}
+
+static bool sameRecords(const std::vector<FireLogRecord> &a, const std::vector<FireLogRecord> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].smoke != b[i].smoke || a[i].flame != b[i].flame || a[i].gas != b[i].gas || a[i].prob != b[i].prob ||
+        a[i].label != b[i].label) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int selfTest(int argc, char **argv) {
+  long readings = 0;
+  long csv_bytes = 0;
+  long log_bytes = 0;
+  std::vector<std::vector<uint8_t>> logs;
+  for (int a = 0; a < argc; a++) {
+    std::vector<Sample> samples;
+    if (!readSamples(argv[a], &samples)) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+    std::vector<FireLogRecord> records;
+    for (const Sample &s : samples) {
+      records.push_back({s.smoke, s.flame, s.gas, predictFireProbabilityFixed(s.smoke, s.flame, s.gas),
+                         (uint8_t)(s.label > 0)});
+    }
+    std::vector<uint8_t> log = encodeLog(records);
+
+    std::vector<FireLogRecord> decoded;
+    Stats stats;
+    if (!decodeLog(log, false, &decoded, &stats) || stats.bad_blocks || !sameRecords(records, decoded)) {
+      fprintf(stderr, "%s: decoded log differs from the session\n", argv[a]);
+      return 1;
+    }
+    // one corrupted byte per full block loses that block, the unfinished
+    // last one is left
+    std::vector<uint8_t> corrupted = log;
+    long full_blocks = log.size() / FIRE_LOG_BLOCK - 1;
+    for (size_t offset = FIRE_LOG_BLOCK; offset + FIRE_LOG_BLOCK <= log.size(); offset += FIRE_LOG_BLOCK) {
+      corrupted[offset + (offset * 7919) % FIRE_LOG_BLOCK] ^= 0x10;
+    }
+    decoded.clear();
+    Stats bad;
+    if (!decodeLog(corrupted, false, &decoded, &bad) || bad.bad_blocks != full_blocks ||
+        decoded.size() != (size_t)stats.unverified) {
+      fprintf(stderr, "%s: corrupted blocks not detected (%ld of %ld)\n", argv[a], bad.bad_blocks, full_blocks);
+      return 1;
+    }
+
+    std::string csv;
+    writeCsv(records, true, &csv);
+    readings += records.size();
+    csv_bytes += csv.size();
+    log_bytes += log.size();
+    logs.push_back(log);
+    printf("%-36s %6zu readings, csv %7zu B, log %6zu B (%zu blocks)\n", argv[a], records.size(), csv.size(),
+           log.size(), log.size() / FIRE_LOG_BLOCK);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t out_bytes = 0;
+  for (int round = 0; round < SPEED_ROUNDS; round++) {
+    for (const std::vector<uint8_t> &log : logs) {
+      std::vector<FireLogRecord> records;
+      Stats stats;
+      std::string csv;
+      decodeLog(log, false, &records, &stats);
+      writeCsv(records, true, &csv);
+      out_bytes += csv.size();
+    }
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("\n%ld readings, bytes per reading csv %.1f, log %.2f (%.1fx smaller, schema block included)\n",
+         readings, (double)csv_bytes / readings, (double)log_bytes / readings, (double)csv_bytes / log_bytes);
+  printf("conversion %.1f M readings/s, %.0f MB/s of csv\n", readings * SPEED_ROUNDS / s / 1e6, out_bytes / s / 1e6);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *out_dir = nullptr;
+  bool with_prob = true;
+  bool strict = false;
+  bool test = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:nst")) != -1) {
+    switch (opt) {
+      case 'o': out_dir = optarg; break;
+      case 'n': with_prob = false; break;
+      case 's': strict = true; break;
+      case 't': test = true; break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-o dir] [-n] [-s] [-t] <log.bin>...\n", argv[0]);
+    return 1;
+  }
+  if (test) {
+    return selfTest(argc - optind, argv + optind);
+  }
+
+  bool damaged = false;
+  for (int a = optind; a < argc; a++) {
+    std::vector<uint8_t> log;
+    std::vector<FireLogRecord> records;
+    Stats stats;
+    if (!readFile(argv[a], &log) || !decodeLog(log, strict, &records, &stats)) {
+      fprintf(stderr, "%s: no fire log\n", argv[a]);
+      return 1;
+    }
+    std::string csv;
+    writeCsv(records, with_prob, &csv);
+    FILE *out = stdout;
+    std::string out_path;
+    if (out_dir) {
+      std::string name = argv[a];
+      name = name.substr(name.find_last_of('/') + 1);
+      out_path = std::string(out_dir) + "/" + name.substr(0, name.find_last_of('.')) + ".TXT";
+      out = fopen(out_path.c_str(), "w");
+      if (!out) {
+        fprintf(stderr, "cannot write %s\n", out_path.c_str());
+        return 1;
+      }
+    }
+    fwrite(csv.data(), 1, csv.size(), out);
+    if (out != stdout) {
+      fclose(out);
+    }
+    fprintf(stderr, "%s: %ld readings in %ld blocks, %ld bad blocks, %ld unverified%s\n", argv[a], stats.records,
+            stats.blocks, stats.bad_blocks, stats.unverified, strict && stats.unverified ? " (dropped)" : "");
+    damaged |= stats.bad_blocks > 0;
+  }
+  return damaged ? 2 : 0;
+}
@@ -0,0 +1,381 @@
+// Discrete-event simulation of many end nodes (lora_transmitter) reporting
+// to one central node (lora_receiver) over LoRa.
+//
+// Usage: program [options] <session.TXT>...
+//   -n <list>    node counts, comma separated (default 1,10,100,1000,10000)
+//   -p <list>    reporting periods TIME_SPAN in ms (default 6000,30000,60000)
+//   -d <s>       simulated time per run (default 3600)
+//   -u <ms>      blocking GSM uplink per received packet (default 5070)
+//   -r <m>       radius of the area around the receiver (default 2000)
+//   -s <seed>    random seed (default 1)
+//
+// Every node replays a recorded session (random start row) through the
+// fixed-point fire net and sends the real v2 frame of lib/FireFrame
+// every TIME_SPAN + measurement time, with its own clock error. Airtime is
+// computed by lib/LoRaAirtime for the node settings (SF9, BW125, CR 4/7).
+//
+// Radio model: log-distance path loss with log-normal shadowing, the
+// receiver locks to a packet whose preamble is CAPTURE_DB above all packets
+// on air, a locked packet is corrupted by a later packet that is not
+// CAPTURE_DB below it. Corrupted packets still raise DIO0 (CRC error).
+//
+// Receiver model follows lora_receiver/src/main.cpp: DIO0 sets receivedFlag,
+// loop() polls it every POLL_MS, readData() takes the packet from the FIFO
+// and the following uplink blocks loop() for the uplink time (also after a
+// CRC error, newData is set for any packet). The radio listens meanwhile,
+// a newer packet overwrites an unread one in the FIFO.
+//
+// Prints per node count and period: offered load, delivery and loss causes,
+// delivered readings per second and alarm latency (time from the first
+// frame with probability >= ALARM_PROB of an alarm episode to the end of
+// the uplink of a frame of that episode).
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "samples.h"
+#include "fire_frame.h"
+#include "fire_net_fixed.h"
+#include "lora_airtime.h"
+
+#define TX_POWER_DBM 17.0      // lora.begin() default
+#define SENSITIVITY_DBM -129.0 // SX1272 SF9 BW125
+#define CAPTURE_DB 6.0         // co-channel rejection at the same SF
+#define PATH_LOSS_1M_DB 25.2   // free space at 1 m, 434 MHz
+#define PATH_LOSS_EXP 3.0
+#define SHADOWING_DB 6.0
+#define MIN_DISTANCE_M 20.0
+
+#define MEASURE_MS 100         // measureAverageValues(), 10 x delay(10)
+#define CLOCK_PPM 100          // node clock error, uniform +-
+#define POLL_MS 50             // delay(50) at the end of the receiver loop()
+#define ALARM_PROB 5000        // probability scaled by PROB_SCALE
+#define VBAT_SCALED 11086
+#define FRAME_LEN FIRE_FRAME_V2_LEN  // frame of lora_transmitter
+
+struct Session {
+  std::vector<FireReading> rows;
+};
+
+struct Node {
+  double rssi;
+  uint64_t period_us;
+  const Session *session;
+  size_t row;
+  bool in_alarm;           // last frame had probability >= ALARM_PROB
+  uint64_t alarm_since;    // tx time of the first alarm frame not delivered yet, 0 if none
+  uint8_t seq;             // sequence number of the next frame
+};
+
+struct Packet {
+  uint32_t node;
+  uint64_t end;
+  double rssi;
+  bool corrupted;
+  uint8_t frame[FRAME_LEN];
+};
+
+enum EventType { TX_START, TX_END, POLL };
+
+struct Event {
+  uint64_t at;
+  EventType type;
+  uint32_t index;  // node for TX_START, packet for TX_END
+
+  bool operator>(const Event &other) const { return at > other.at; }
+};
+
+struct Result {
+  uint64_t sent = 0;
+  uint64_t delivered = 0;
+  uint64_t weak = 0;          // below sensitivity
+  uint64_t collided = 0;      // not locked due to interference, or corrupted while locked
+  uint64_t busy = 0;          // receiver locked to another packet
+  uint64_t overwritten = 0;   // received, replaced in the FIFO before readData()
+  uint64_t crc_errors = 0;    // corrupted packets raising DIO0, each costs an uplink
+  uint64_t decode_errors = 0; // frame decoded differently than sent
+  uint64_t uplinks = 0;
+  uint64_t alarms = 0;
+  uint64_t alarms_missed = 0;
+  std::vector<double> alarm_latency_s;
+};
+
+class Simulation {
+ public:
+  Simulation(const std::vector<Session> &sessions, uint32_t nodes, uint32_t period_ms, double radius_m,
+             uint64_t uplink_us, uint32_t seed)
+      : uplink_us_(uplink_us), rng_(seed) {
+    airtime_us_ = loraTimeOnAirUs(LoRaSettings(), FRAME_LEN);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> shadowing(0.0, SHADOWING_DB);
+    nodes_.resize(nodes);
+    for (uint32_t i = 0; i < nodes; i++) {
+      Node &node = nodes_[i];
+      // uniform in the disk around the receiver
+      double d = std::max(MIN_DISTANCE_M, radius_m * sqrt(unit(rng_)));
+      node.rssi = TX_POWER_DBM - PATH_LOSS_1M_DB - 10.0 * PATH_LOSS_EXP * log10(d) + shadowing(rng_);
+      double ppm = (2.0 * unit(rng_) - 1.0) * CLOCK_PPM;
+      node.period_us = (uint64_t)(((uint64_t)period_ms + MEASURE_MS) * 1000.0 * (1.0 + ppm * 1e-6));
+      node.session = &sessions[i % sessions.size()];
+      node.row = (size_t)(unit(rng_) * node.session->rows.size());
+      node.in_alarm = false;
+      node.alarm_since = 0;
+      node.seq = 0;
+      events_.push(Event{(uint64_t)(unit(rng_) * node.period_us), TX_START, i});
+    }
+    events_.push(Event{0, POLL, 0});
+  }
+
+  Result run(uint64_t duration_us) {
+    while (!events_.empty() && events_.top().at < duration_us) {
+      Event event = events_.top();
+      events_.pop();
+      now_ = event.at;
+      switch (event.type) {
+        case TX_START: txStart(event.index); break;
+        case TX_END: txEnd(event.index); break;
+        case POLL: poll(); break;
+      }
+    }
+    // alarm episodes still waiting at the end are not counted as missed
+    return result_;
+  }
+
+  uint32_t airtimeUs() const { return airtime_us_; }
+
+ private:
+  void txStart(uint32_t n) {
+    Node &node = nodes_[n];
+    events_.push(Event{now_ + node.period_us, TX_START, n});
+
+    FireReading reading = node.session->rows[node.row];
+    node.row = (node.row + 1) % node.session->rows.size();
+    reading.transm_id = (uint8_t)n;  // one byte address, nodes above 256 share it
+    reading.seq = node.seq++;
+
+    bool alarm = reading.prob >= ALARM_PROB;
+    if (alarm && !node.in_alarm) {
+      result_.alarms++;
+      node.alarm_since = now_;
+    } else if (!alarm && node.in_alarm && node.alarm_since) {
+      result_.alarms_missed++;  // episode ended, none of its frames got through
+      node.alarm_since = 0;
+    }
+    node.in_alarm = alarm;
+
+    uint32_t p = allocPacket();
+    Packet &packet = packets_[p];
+    packet.node = n;
+    packet.end = now_ + airtime_us_;
+    packet.rssi = node.rssi;
+    packet.corrupted = false;
+    encodeFrameV2(reading, packet.frame);
+    result_.sent++;
+    events_.push(Event{packet.end, TX_END, p});
+
+    if (packet.rssi < SENSITIVITY_DBM) {
+      result_.weak++;
+      packet.corrupted = true;
+    } else if (locked_ >= 0) {
+      Packet &locked = packets_[locked_];
+      if (packet.rssi > locked.rssi - CAPTURE_DB) {
+        locked.corrupted = true;
+      }
+      result_.busy++;
+      packet.corrupted = true;
+    } else if (!on_air_.empty() && packet.rssi < *on_air_.rbegin() + CAPTURE_DB) {
+      result_.collided++;
+      packet.corrupted = true;
+    } else {
+      locked_ = (int32_t)p;
+    }
+    on_air_.insert(packet.rssi);
+  }
+
+  void txEnd(uint32_t p) {
+    Packet &packet = packets_[p];
+    on_air_.erase(on_air_.find(packet.rssi));
+    if ((int32_t)p != locked_) {
+      freePacket(p);
+      return;
+    }
+    locked_ = -1;
+    if (packet.corrupted) {
+      result_.collided++;
+      result_.crc_errors++;
+    }
+    // DIO0 at RxDone, a packet not read yet is overwritten
+    if (fifo_ >= 0) {
+      if (!packets_[fifo_].corrupted) {
+        result_.overwritten++;
+      }
+      freePacket(fifo_);
+    }
+    fifo_ = (int32_t)p;
+  }
+
+  void poll() {
+    uint64_t next = now_ + POLL_MS * 1000;
+    if (fifo_ >= 0) {
+      Packet &packet = packets_[fifo_];
+      uint64_t uplink_end = now_ + uplink_us_;
+      if (!packet.corrupted) {
+        deliver(packet, uplink_end);
+      }
+      freePacket(fifo_);
+      fifo_ = -1;
+      result_.uplinks++;
+      next = uplink_end + POLL_MS * 1000;
+    }
+    events_.push(Event{next, POLL, 0});
+  }
+
+  void deliver(const Packet &packet, uint64_t at) {
+    FireReading reading;
+    if (!decodeFrame(packet.frame, FRAME_LEN, &reading) || reading.transm_id != (uint8_t)packet.node) {
+      result_.decode_errors++;
+      return;
+    }
+    result_.delivered++;
+    Node &node = nodes_[packet.node];
+    if (reading.prob >= ALARM_PROB && node.alarm_since) {
+      result_.alarm_latency_s.push_back((at - node.alarm_since) / 1e6);
+      node.alarm_since = 0;
+    }
+  }
+
+  uint32_t allocPacket() {
+    if (free_.empty()) {
+      packets_.emplace_back();
+      return (uint32_t)packets_.size() - 1;
+    }
+    uint32_t p = free_.back();
+    free_.pop_back();
+    return p;
+  }
+
+  void freePacket(uint32_t p) { free_.push_back(p); }
+
+  uint64_t uplink_us_;
+  uint32_t airtime_us_;
+  std::mt19937 rng_;
+  uint64_t now_ = 0;
+  std::vector<Node> nodes_;
+  std::vector<Packet> packets_;  // pool, only packets on air or in the FIFO are alive
+  std::vector<uint32_t> free_;
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event> > events_;
+  std::multiset<double> on_air_;  // rssi of all packets on air
+  int32_t locked_ = -1;
+  int32_t fifo_ = -1;
+  Result result_;
+};
+
+static bool parseList(const char *arg, std::vector<uint32_t> *list) {
+  list->clear();
+  const char *p = arg;
+  while (*p) {
+    char *end;
+    long value = strtol(p, &end, 10);
+    if (end == p || value <= 0) {
+      return false;
+    }
+    list->push_back((uint32_t)value);
+    p = *end == ',' ? end + 1 : end;
+  }
+  return !list->empty();
+}
+
+static bool loadSession(const char *path, Session *session) {
+  std::vector<Sample> samples;
+  if (!readSamples(path, &samples) || samples.empty()) {
+    return false;
+  }
+  for (const Sample &s : samples) {
+    FireReading reading = {0, s.smoke, s.flame, s.gas, predictFireProbabilityFixed(s.smoke, s.flame, s.gas), VBAT_SCALED};
+    session->rows.push_back(reading);
+  }
+  return true;
+}
+
+static double percentile(std::vector<double> values, double q) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[std::min(values.size() - 1, (size_t)(q * values.size()))];
+}
+
+int main(int argc, char **argv) {
+  std::vector<uint32_t> node_counts = {1, 10, 100, 1000, 10000};
+  std::vector<uint32_t> periods = {6000, 30000, 60000};
+  double duration_s = 3600;
+  uint32_t uplink_ms = 5070;
+  double radius_m = 2000;
+  uint32_t seed = 1;
+  const char *usage = "usage: %s [-n nodes,...] [-p period_ms,...] [-d s] [-u uplink_ms] [-r radius_m] [-s seed] <session.TXT>...\n";
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:p:d:u:r:s:")) != -1) {
+    bool ok = true;
+    switch (opt) {
+      case 'n': ok = parseList(optarg, &node_counts); break;
+      case 'p': ok = parseList(optarg, &periods); break;
+      case 'd': duration_s = atof(optarg); break;
+      case 'u': uplink_ms = atoi(optarg); break;
+      case 'r': radius_m = atof(optarg); break;
+      case 's': seed = atoi(optarg); break;
+      default: ok = false;
+    }
+    if (!ok) {
+      fprintf(stderr, usage, argv[0]);
+      return 1;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, usage, argv[0]);
+    return 1;
+  }
+  std::vector<Session> sessions(argc - optind);
+  for (int a = optind; a < argc; a++) {
+    if (!loadSession(argv[a], &sessions[a - optind])) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+  }
+
+  printf("airtime %.1f ms per %d byte frame, uplink %u ms, %.0f s per run, %zu sessions\n\n",
+         loraTimeOnAirUs(LoRaSettings(), FRAME_LEN) / 1e3, FRAME_LEN, uplink_ms, duration_s, sessions.size());
+  printf("%6s %7s %7s %9s %7s %6s %6s %6s %6s %6s %5s %8s %7s %7s %7s %6s %6s\n", "nodes", "period", "G", "sent",
+         "deliv%", "weak%", "coll%", "busy%", "overw%", "crc", "decE", "read/s", "alarms", "lat_avg", "lat_p95", "missed", "wall");
+  for (uint32_t period : periods) {
+    for (uint32_t nodes : node_counts) {
+      auto start = std::chrono::steady_clock::now();
+      Simulation sim(sessions, nodes, period, radius_m, (uint64_t)uplink_ms * 1000, seed);
+      Result r = sim.run((uint64_t)(duration_s * 1e6));
+      double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      double g = (double)nodes * sim.airtimeUs() / ((period + MEASURE_MS) * 1000.0);
+      double sent = r.sent ? (double)r.sent : 1;
+      double lat_avg = 0;
+      for (double l : r.alarm_latency_s) {
+        lat_avg += l;
+      }
+      lat_avg = r.alarm_latency_s.empty() ? 0 : lat_avg / r.alarm_latency_s.size();
+      printf("%6u %7u %7.3f %9llu %7.2f %6.2f %6.2f %6.2f %6.2f %6llu %5llu %8.3f %7llu %7.1f %7.1f %6llu %5.1fs\n", nodes,
+             period, g, (unsigned long long)r.sent, 100.0 * r.delivered / sent, 100.0 * r.weak / sent,
+             100.0 * r.collided / sent, 100.0 * r.busy / sent, 100.0 * r.overwritten / sent,
+             (unsigned long long)r.crc_errors, (unsigned long long)r.decode_errors, r.delivered / duration_s,
+             (unsigned long long)r.alarms, lat_avg, percentile(r.alarm_latency_s, 0.95),
+             (unsigned long long)r.alarms_missed, wall);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,219 @@
+// Replay of recorded sessions through the change-driven reporting of the
+// end nodes (lib/ReportPolicy, REPORT_ON_CHANGE_MODE of lora_transmitter).
+//
+// Usage: program [options] <session.TXT>...
+//   -s <counts>  sensor dead-band REPORT_SENSOR_DEADBAND (default 8)
+//   -p <prob>    probability dead-band REPORT_PROB_DEADBAND (default 250)
+//   -a <prob>    alarm threshold REPORT_ALARM_PROB (default 5000)
+//   -b <s>       heartbeat period REPORT_HEARTBEAT_MS / 1000 (default 300)
+//   -t <ms>      reporting period TIME_SPAN (default 6000)
+//
+// Every session is replayed through the fixed-point fire net, one reading
+// per TIME_SPAN + measurement time. Prints per session the readings sent
+// with every reading reported and with the policy, by reason, and the time
+// on air of the frames (v2, heartbeat with the suppressed count).
+//
+// Alarm latency: the node sends at once when the probability crosses its
+// own threshold, so a receiver alarming at that threshold gets no delay. A
+// receiver (or ThingSpeak reaction) with another threshold sees the
+// crossing only with the next sent reading. For receiver thresholds
+// 10 .. 90 % the worst added latency over all episodes (first reading over
+// the threshold until the first sent one over it) and the episodes that
+// ended before any reading over it was sent are printed, then the same
+// summary for a grid of dead-bands. Below REPORT_ALARM_PROB a missed
+// episode is lost for the receiver, not late: a probability rising less
+// than REPORT_PROB_DEADBAND over the threshold and falling back is never
+// sent, so the worst latency of such a threshold has to be read together
+// with its missed episodes.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "samples.h"
+#include "fire_frame.h"
+#include "fire_net_fixed.h"
+#include "lora_airtime.h"
+#include "report_policy.h"
+
+#define MEASURE_MS 100  // measureAverageValues(), 10 x delay(10)
+#define THRESHOLDS 9     // receiver thresholds 1000 .. 9000
+
+struct Session {
+  std::string name;
+  std::vector<FireReading> readings;
+};
+
+struct Result {
+  long readings = 0;
+  long sent[REPORT_REASONS] = {};
+  double airtime_ms = 0;
+  double worst_latency_s[THRESHOLDS] = {};
+  long episodes[THRESHOLDS] = {};
+  long missed[THRESHOLDS] = {};
+
+  long total() const { return readings - sent[REPORT_NONE]; }
+
+  void add(const Result &r) {
+    readings += r.readings;
+    for (int i = 0; i < REPORT_REASONS; i++) {
+      sent[i] += r.sent[i];
+    }
+    airtime_ms += r.airtime_ms;
+    for (int t = 0; t < THRESHOLDS; t++) {
+      if (r.worst_latency_s[t] > worst_latency_s[t]) {
+        worst_latency_s[t] = r.worst_latency_s[t];
+      }
+      episodes[t] += r.episodes[t];
+      missed[t] += r.missed[t];
+    }
+  }
+};
+
+static bool loadSession(const char *path, Session *session) {
+  std::vector<Sample> samples;
+  if (!readSamples(path, &samples) || samples.empty()) {
+    return false;
+  }
+  session->name = path;
+  for (const Sample &s : samples) {
+    FireReading r = {0x11, s.smoke, s.flame, s.gas, predictFireProbabilityFixed(s.smoke, s.flame, s.gas), 11086};
+    session->readings.push_back(r);
+  }
+  return true;
+}
+
+static Result replay(const Session &session, const ReportSettings &settings, unsigned long period_ms) {
+  Result result;
+  ReportPolicy policy(settings);
+  // per receiver threshold: time of the first reading over it not sent yet
+  long pending_since[THRESHOLDS];
+  for (int t = 0; t < THRESHOLDS; t++) {
+    pending_since[t] = -1;
+  }
+  for (size_t i = 0; i < session.readings.size(); i++) {
+    const FireReading &reading = session.readings[i];
+    unsigned long now_ms = i * period_ms;
+    ReportReason reason = policy.check(reading, now_ms);
+    result.readings++;
+    result.sent[reason]++;
+    if (reason != REPORT_NONE) {
+      size_t len = reason == REPORT_HEARTBEAT ? FIRE_FRAME_V2_HEARTBEAT_LEN : FIRE_FRAME_V2_LEN;
+      result.airtime_ms += loraTimeOnAirUs(LoRaSettings(), len) / 1e3;
+    }
+
+    for (int t = 0; t < THRESHOLDS; t++) {
+      int threshold = (t + 1) * 1000;
+      bool over = reading.prob >= threshold;
+      bool was_over = i > 0 && session.readings[i - 1].prob >= threshold;
+      if (over && !was_over) {
+        result.episodes[t]++;
+        pending_since[t] = (long)now_ms;
+      }
+      if (!over && pending_since[t] >= 0) {
+        result.missed[t]++;  // episode over, the receiver never saw it
+        pending_since[t] = -1;
+      }
+      if (over && reason != REPORT_NONE && pending_since[t] >= 0) {
+        double latency_s = (now_ms - pending_since[t]) / 1000.0;
+        if (latency_s > result.worst_latency_s[t]) {
+          result.worst_latency_s[t] = latency_s;
+        }
+        pending_since[t] = -1;
+      }
+    }
+  }
+  return result;
+}
+
+static Result replayAll(const std::vector<Session> &sessions, const ReportSettings &settings,
+                        unsigned long period_ms) {
+  Result total;
+  for (const Session &session : sessions) {
+    total.add(replay(session, settings, period_ms));
+  }
+  return total;
+}
+
+int main(int argc, char **argv) {
+  ReportSettings settings = {8, 250, 5000, 300000};
+  int time_span_ms = 6000;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:p:a:b:t:")) != -1) {
+    switch (opt) {
+      case 's': settings.sensor_deadband = atoi(optarg); break;
+      case 'p': settings.prob_deadband = atoi(optarg); break;
+      case 'a': settings.alarm_prob = atoi(optarg); break;
+      case 'b': settings.heartbeat_ms = atol(optarg) * 1000; break;
+      case 't': time_span_ms = atoi(optarg); break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-s counts] [-p prob] [-a prob] [-b s] [-t ms] <session.TXT>...\n", argv[0]);
+    return 1;
+  }
+  std::vector<Session> sessions;
+  for (int a = optind; a < argc; a++) {
+    Session session;
+    if (!loadSession(argv[a], &session)) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+    sessions.push_back(session);
+  }
+  unsigned long period_ms = time_span_ms + MEASURE_MS;
+
+  printf("dead-band sensors %d, probability %d, alarm %d, heartbeat %lu s, period %lu ms\n\n",
+         settings.sensor_deadband, settings.prob_deadband, settings.alarm_prob, settings.heartbeat_ms / 1000,
+         period_ms);
+  printf("%-36s %8s %6s %7s %6s %6s %6s %6s %10s\n", "session", "readings", "sent", "saved%", "first", "change",
+         "alarm", "heart", "airtime s");
+  Result total;
+  double all_airtime_s = 0;
+  for (const Session &session : sessions) {
+    Result r = replay(session, settings, period_ms);
+    total.add(r);
+    double all_s = r.readings * loraTimeOnAirUs(LoRaSettings(), FIRE_FRAME_V2_LEN) / 1e6;
+    all_airtime_s += all_s;
+    printf("%-36s %8ld %6ld %7.1f %6ld %6ld %6ld %6ld %4.1f/%4.1f\n", session.name.c_str(), r.readings, r.total(),
+           100.0 * r.sent[REPORT_NONE] / r.readings, r.sent[REPORT_FIRST], r.sent[REPORT_CHANGE],
+           r.sent[REPORT_ALARM], r.sent[REPORT_HEARTBEAT], r.airtime_ms / 1000, all_s);
+  }
+  printf("%-36s %8ld %6ld %7.1f %6ld %6ld %6ld %6ld %4.1f/%4.1f\n\n", "total", total.readings, total.total(),
+         100.0 * total.sent[REPORT_NONE] / total.readings, total.sent[REPORT_FIRST], total.sent[REPORT_CHANGE],
+         total.sent[REPORT_ALARM], total.sent[REPORT_HEARTBEAT], total.airtime_ms / 1000, all_airtime_s);
+
+  printf("%-22s", "receiver threshold %");
+  for (int t = 0; t < THRESHOLDS; t++) {
+    printf(" %6d", (t + 1) * 10);
+  }
+  printf("\n%-22s", "episodes");
+  for (int t = 0; t < THRESHOLDS; t++) {
+    printf(" %6ld", total.episodes[t]);
+  }
+  printf("\n%-22s", "worst added latency s");
+  for (int t = 0; t < THRESHOLDS; t++) {
+    printf(" %6.1f", total.worst_latency_s[t]);
+  }
+  printf("\n%-22s", "missed episodes");
+  for (int t = 0; t < THRESHOLDS; t++) {
+    printf(" %6ld", total.missed[t]);
+  }
+
+  printf("\n\n%8s %8s %7s %18s %18s\n", "sensor", "prob", "saved%", "30 %: latency/miss", "70 %: latency/miss");
+  const int sensor_bands[] = {4, 8, 16, 32};
+  const int prob_bands[] = {250, 500, 1000, 2000};
+  for (int sensor : sensor_bands) {
+    for (int prob : prob_bands) {
+      ReportSettings grid = settings;
+      grid.sensor_deadband = sensor;
+      grid.prob_deadband = prob;
+      Result r = replayAll(sessions, grid, period_ms);
+      printf("%8d %8d %7.1f %11.1f s / %2ld %11.1f s / %2ld\n", sensor, prob, 100.0 * r.sent[REPORT_NONE] / r.readings,
+             r.worst_latency_s[2], r.missed[2], r.worst_latency_s[6], r.missed[6]);
+    }
+  }
+  return 0;
+}
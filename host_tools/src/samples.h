@@ -0,0 +1,38 @@
+#ifndef SAMPLES_H_
+#define SAMPLES_H_
+
+#include <stdio.h>
+#include <vector>
+
+// One row of a recorded session (data/*.TXT) or of real_model/all_data.csv:
+// smoke,flame,gas,label[,prob]
+struct Sample {
+  int smoke;
+  int flame;
+  int gas;
+  int label;
+};
+
+// Reads all rows of CSV file with header, rows without label get label -1
+inline bool readSamples(const char *path, std::vector<Sample> *samples) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    return false;
+  }
+  char line[128];
+  if (!fgets(line, sizeof(line), f)) { // header
+    fclose(f);
+    return false;
+  }
+  while (fgets(line, sizeof(line), f)) {
+    Sample s;
+    s.label = -1;
+    if (sscanf(line, "%d,%d,%d,%d", &s.smoke, &s.flame, &s.gas, &s.label) >= 3) {
+      samples->push_back(s);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+#endif  // SAMPLES_H_
@@ -0,0 +1,389 @@
+// Host benchmark of SD card logging of the end node (lora_transmitter) on
+// an emulated SD card block device.
+//
+// Usage: program [options] <session.TXT>...
+//   -t <ms>     reporting period TIME_SPAN + measurement (default 6100)
+//   -f <s>      flush period SD_LOG_FLUSH_MS / 1000 (default 60)
+//   -p <prob>   sync at once from probability SD_LOG_SYNC_PROB (default 5000)
+//   -e <n>      every n-th write of the buffered policies fails (card busy),
+//               its bytes stay in the buffer for the next flush (n >= 2)
+//
+// The card model follows the SdFat volume of the Arduino SD library: FAT32
+// with 32 KB clusters and two FAT copies, one 512 byte block cache for
+// data, FAT and directory. A write into a block that is not cached reads it
+// first unless it starts the block past the end of the file, a whole
+// aligned block is written around the cache, a new cluster reads and
+// updates the FAT, sync (flush(), close()) writes the dirty cache block and
+// the directory entry with the file size. SD.begin() reads the MBR and the
+// volume boot sector.
+//
+// Rows (smoke,flame,gas,label,prob) of every session are logged one per
+// period with
+//   open/close        ... SD.open(), the row, close() per reading (old)
+//   open/close power  ... the same with SD_POWER_MODE, SD.begin() per row
+//   keep-open sync    ... file open all the time, flush() per reading
+//   buffered          ... lib/SdLog, file open all the time
+//   buffered power    ... lib/SdLog, SD_POWER_MODE around every flush
+//   binary            ... lib/SdLog with lib/FireLog records
+//                         (SD_LOG_BINARY_MODE), file open all the time
+//   binary power      ... the same with SD_POWER_MODE
+// with the flush before sleep of LOW_POWER_MODE (horizon of one period).
+// Prints per reading the sector reads and writes, bytes of the log and
+// bytes written to the card, SD time and energy from the timing constants
+// below, and the most rows not on the card yet (lost at a power cut).
+// The file content is checked against the rows, the one of the buffered
+// policies also at every flush (synced part is a prefix of the rows), and
+// no row of them may stay off the card for the flush period (until the
+// next row or wake-up).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "samples.h"
+#include "fire_log.h"
+#include "fire_net_fixed.h"
+#include "sd_log.h"
+#include "uplink_writer.h"
+
+#define CLUSTER_SECTORS 64      // FAT32 of 8 .. 32 GB cards
+#define FAT_ENTRIES 128         // FAT32 entries per sector
+#define READ_MS 1.2             // CMD17 and 512 B at 4 MHz SPI
+#define WRITE_MS 3.0            // CMD24, 512 B and the card busy
+#define BEGIN_MS 20.0           // SD.begin() card initialization
+#define POWER_UP_MS 10.0        // SD_POWER_UP_MS
+#define SD_MA 30.0              // card writing (DRAW_SD_WRITE_MA)
+#define MCU_MA 6.0              // MCU waiting on SPI
+#define RAIL_V 3.3
+#define EFFICIENCY 0.85
+#define HEADER "smoke,flame,gas,label, prob\r\n"
+
+// Block numbers of the regions
+static const int64_t DATA = 0;
+static const int64_t FAT = 1LL << 40;
+static const int64_t DIR = 2LL << 40;
+
+class Card {
+ public:
+  long reads = 0;
+  long writes = 0;
+  long begins = 0;
+
+  void begin() {
+    cached_ = -1;
+    dirty_ = false;
+    reads += 2;
+    begins++;
+  }
+
+  void load(int64_t block, bool read) {
+    if (cached_ == block) {
+      return;
+    }
+    evict();
+    if (read) {
+      reads++;
+    }
+    cached_ = block;
+  }
+
+  void modify(int64_t block, bool read) {
+    load(block, read);
+    dirty_ = true;
+  }
+
+  void writeAround(int64_t block) {
+    if (cached_ == block) {
+      cached_ = -1;
+      dirty_ = false;
+    }
+    writes++;
+  }
+
+  void evict() {
+    if (dirty_) {
+      writes += cached_ >= FAT && cached_ < DIR ? 2 : 1;  // both FAT copies
+      dirty_ = false;
+    }
+  }
+
+ private:
+  int64_t cached_ = -1;
+  bool dirty_ = false;
+};
+
+// Log file opened in FILE_WRITE (append), first cluster at the start of the
+// data region of an empty card
+class CardFile {
+ public:
+  CardFile(Card *card, std::string *content, uint32_t *synced) : card_(card), content_(content), synced_(synced) {}
+
+  void open() {
+    card_->load(DIR, true);  // directory entry
+    uint32_t clusters = clusterCount();
+    for (uint32_t c = 0; c < clusters; c++) {  // seek to the end walks the chain
+      card_->load(FAT + c / FAT_ENTRIES, true);
+    }
+  }
+
+  // Every n-th write() fails without writing, 0 never
+  void failEvery(int n) { fail_every_ = n; }
+
+  size_t write(const uint8_t *data, size_t len) {
+    if (fail_every_ > 0 && ++writes_ % fail_every_ == 0) {
+      return 0;
+    }
+    for (size_t done = 0; done < len;) {
+      uint32_t pos = content_->size();
+      if (pos % (CLUSTER_SECTORS * 512) == 0 && pos / (CLUSTER_SECTORS * 512) >= clusterCount()) {
+        uint32_t cluster = clusterCount();
+        card_->modify(FAT + cluster / FAT_ENTRIES, true);  // free entry, link of the previous one
+      }
+      uint32_t offset = pos % 512;
+      size_t chunk = 512 - offset < len - done ? 512 - offset : len - done;
+      if (offset == 0 && chunk == 512) {
+        card_->writeAround(DATA + pos / 512);
+      } else {
+        card_->modify(DATA + pos / 512, offset != 0);
+      }
+      content_->append((const char *)data + done, chunk);
+      done += chunk;
+      dirty_ = true;
+    }
+    return len;
+  }
+
+  void flush() {
+    if (!dirty_) {
+      return;
+    }
+    card_->evict();
+    card_->modify(DIR, true);
+    card_->evict();
+    *synced_ = content_->size();
+    dirty_ = false;
+  }
+
+  void close() { flush(); }
+
+ private:
+  uint32_t clusterCount() const {
+    return (content_->size() + CLUSTER_SECTORS * 512 - 1) / (CLUSTER_SECTORS * 512);
+  }
+
+  Card *card_;
+  std::string *content_;
+  uint32_t *synced_;
+  bool dirty_ = false;
+  int fail_every_ = 0;
+  long writes_ = 0;
+};
+
+enum Policy { OPEN_CLOSE, OPEN_CLOSE_POWER, KEEP_OPEN_SYNC, BUFFERED, BUFFERED_POWER, BINARY, BINARY_POWER,
+              POLICIES };
+static const char *policy_names[POLICIES] = {"open/close", "open/close power", "keep-open sync", "buffered",
+                                             "buffered power", "binary", "binary power"};
+
+struct Row {
+  std::string text;
+  FireLogRecord record;
+};
+
+struct Result {
+  long rows = 0;
+  long log_bytes = 0;
+  long flushes = 0;
+  long max_at_risk = 0;  // rows
+  Card card;
+};
+
+static std::vector<Row> loadSession(const char *path) {
+  std::vector<Sample> samples;
+  std::vector<Row> rows;
+  if (!readSamples(path, &samples)) {
+    return rows;
+  }
+  for (const Sample &s : samples) {
+    int prob = predictFireProbabilityFixed(s.smoke, s.flame, s.gas);
+    char buffer[48];
+    UplinkWriter out(buffer, sizeof(buffer));
+    out.number((long)s.smoke).character(',').number((long)s.flame).character(',').number((long)s.gas);
+    out.character(',').number((long)(s.label > 0)).character(',').fixed((prob + 50) / 100, 100).character('\n');
+    rows.push_back({std::string(out.c_str(), out.length()), {s.smoke, s.flame, s.gas, prob, (uint8_t)(s.label > 0)}});
+  }
+  return rows;
+}
+
+// Rows not in the synced part of the file, ends are the file sizes with
+// every row
+static long rowsAtRisk(const std::vector<uint32_t> &ends, uint32_t synced) {
+  long complete = 0;
+  while (complete < (long)ends.size() && ends[complete] <= synced) {
+    complete++;
+  }
+  return ends.size() - complete;
+}
+
+// Oldest row not on the card is younger than flush_ms until the next row
+// (row i is taken at i * period_ms)
+static bool withinFlushPeriod(const std::vector<uint32_t> &ends, long at_risk, unsigned long now_ms,
+                              unsigned long period_ms, unsigned long flush_ms) {
+  if (at_risk == 0) {
+    return true;
+  }
+  unsigned long oldest_ms = (ends.size() - at_risk) * period_ms;
+  return now_ms + period_ms - oldest_ms < flush_ms;
+}
+
+static bool simulate(const std::vector<Row> &session, Policy policy, unsigned long period_ms,
+                     unsigned long flush_ms, int sync_prob, int fail_every, Result *result) {
+  bool binary = policy == BINARY || policy == BINARY_POWER;
+  bool buffered = policy == BUFFERED || policy == BUFFERED_POWER || binary;
+  FireLogEncoder encoder;
+  std::string content = HEADER;  // written by setup(), synced
+  if (binary) {
+    uint8_t schema[FIRE_LOG_BLOCK];
+    content.assign((const char *)schema, encoder.begin(0x11, period_ms, schema));
+  }
+  std::string expected = content;
+  std::vector<uint32_t> ends;
+  uint32_t synced = content.size();
+  Card &card = result->card;
+  CardFile file(&card, &content, &synced);
+  if (buffered) {
+    file.failEvery(fail_every);
+  }
+  SdLog log(flush_ms);
+  log.begin(content.size());
+  bool power = policy == OPEN_CLOSE_POWER || policy == BUFFERED_POWER || policy == BINARY_POWER;
+  if (!power) {
+    card.begin();
+    file.open();
+  }
+
+  for (size_t i = 0; i < session.size(); i++) {
+    const Row &row = session[i];
+    unsigned long now_ms = i * period_ms;
+    std::string bytes = row.text;
+    if (binary) {
+      uint8_t chunk[FIRE_LOG_CHUNK_MAX];
+      bytes.assign((const char *)chunk, encoder.encode(row.record, chunk));
+    }
+    expected += bytes;
+    ends.push_back(expected.size());
+    result->rows++;
+    result->log_bytes += bytes.size();
+
+    SdLogFlush what = SD_LOG_ALL;
+    if (buffered) {
+      log.append(bytes.data(), bytes.size(), now_ms);
+      // after the row, and before the sleep to the next one
+      what = row.record.prob >= sync_prob ? SD_LOG_ALL : log.due(now_ms, period_ms);
+      if (what == SD_LOG_KEEP) {
+        long at_risk = rowsAtRisk(ends, synced);
+        if (at_risk > result->max_at_risk) {
+          result->max_at_risk = at_risk;
+        }
+        if (!withinFlushPeriod(ends, at_risk, now_ms, period_ms, flush_ms)) {
+          fprintf(stderr, "%s: row %zu is not on the card after the flush period\n", policy_names[policy],
+                  ends.size() - at_risk + 1);
+          return false;
+        }
+        continue;
+      }
+    }
+
+    result->flushes++;
+    if (power) {
+      card.begin();
+    }
+    if (power || policy == OPEN_CLOSE) {
+      file.open();
+    }
+    if (buffered) {
+      log.flush(file, what);
+    } else {
+      file.write((const uint8_t *)row.text.data(), row.text.size());
+    }
+    if (power || policy == OPEN_CLOSE) {
+      file.close();
+    } else {
+      file.flush();
+    }
+    if (expected.compare(0, synced, content, 0, synced) != 0) {
+      fprintf(stderr, "%s: synced part of the file is not the rows\n", policy_names[policy]);
+      return false;
+    }
+    long at_risk = rowsAtRisk(ends, synced);
+    if (at_risk > result->max_at_risk) {
+      result->max_at_risk = at_risk;
+    }
+  }
+
+  // end of the session, e.g. before the card is taken out
+  if (log.pending()) {
+    if (power) {
+      card.begin();
+      file.open();
+    }
+    while (!log.flush(file, SD_LOG_ALL)) {
+    }
+    file.close();
+  }
+  if (content != expected) {
+    fprintf(stderr, "%s: file differs from the rows\n", policy_names[policy]);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  unsigned long period_ms = 6100;
+  unsigned long flush_ms = 60000;
+  int sync_prob = 5000;
+  int fail_every = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:f:p:e:")) != -1) {
+    switch (opt) {
+      case 't': period_ms = atol(optarg); break;
+      case 'f': flush_ms = atol(optarg) * 1000; break;
+      case 'p': sync_prob = atoi(optarg); break;
+      case 'e': fail_every = atoi(optarg); break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind >= argc || fail_every == 1) {
+    fprintf(stderr, "usage: %s [-t ms] [-f s] [-p prob] [-e n] <session.TXT>...\n", argv[0]);
+    return 1;
+  }
+  std::vector<std::vector<Row>> sessions;
+  for (int a = optind; a < argc; a++) {
+    sessions.push_back(loadSession(argv[a]));
+    if (sessions.back().empty()) {
+      fprintf(stderr, "cannot read %s\n", argv[a]);
+      return 1;
+    }
+  }
+
+  printf("period %lu ms, flush %lu s, sync from probability %d\n\n", period_ms, flush_ms / 1000, sync_prob);
+  printf("%-17s %8s %8s %8s %8s %8s %9s %9s %8s %8s\n", "policy", "flushes", "reads", "writes", "B/row",
+         "card B", "SD ms", "SD mJ", "begins", "at risk");
+  printf("%-17s %8s %8s %8s %8s %8s %9s %9s %8s %8s\n", "", "/row", "/row", "/row", "", "/row", "/row", "/row",
+         "/row", "rows");
+  for (int p = 0; p < POLICIES; p++) {
+    Result r;
+    for (const std::vector<Row> &session : sessions) {
+      if (!simulate(session, (Policy)p, period_ms, flush_ms, sync_prob, fail_every, &r)) {
+        return 1;
+      }
+    }
+    double n = r.rows;
+    double ms = r.card.reads * READ_MS + r.card.writes * WRITE_MS + r.card.begins * (BEGIN_MS + POWER_UP_MS);
+    double mj = ms * (SD_MA + MCU_MA) * RAIL_V / EFFICIENCY / 1000.0;
+    printf("%-17s %8.3f %8.3f %8.3f %8.1f %8.1f %9.2f %9.3f %8.3f %8ld\n", policy_names[p], r.flushes / n,
+           r.card.reads / n, r.card.writes / n, r.log_bytes / n, r.card.writes * 512.0 / n, ms / n, mj / n,
+           r.card.begins / n, r.max_at_risk);
+  }
+  return 0;
+}
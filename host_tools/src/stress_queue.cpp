@@ -0,0 +1,216 @@
+// Stress test of lib/SpscQueue, the queue between LoRa reception (DIO0
+// interrupt) and the GSM uplink (loop()) of lora_receiver.
+//
+// Usage: program [-n items]
+//   -n <items>  items produced per run (default 2000000)
+//
+// The producer is a simulated interrupt source: a POSIX timer signal that
+// preempts the consumer on the same thread (as DIO0 preempts loop() on the
+// single core MCU), and in a second run a producer thread on another core.
+// The consumer stalls now and then like a blocking uplink, so both drop
+// policies are exercised. Every item carries a sequence number and a
+// checksum, the test fails on a torn or reordered item or when
+// pushed / popped / dropped counters do not add up.
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "spsc_queue.h"
+
+#define QUEUE_CAPACITY 16
+#define TIMER_PERIOD_NS 20000  // simulated interrupt every 20 us
+#define BURST 3                // items per simulated interrupt
+#define STALL_EVERY 64         // consumer stalls after every 64 items ...
+#define STALL_US 400           // ... for 400 us (uplink)
+
+struct Item {
+  uint32_t seq;
+  uint32_t payload[4];
+  uint32_t check;
+};
+
+typedef SpscQueue<Item, QUEUE_CAPACITY> Queue;
+
+static Item makeItem(uint32_t seq) {
+  Item item;
+  item.seq = seq;
+  uint32_t check = seq * 2654435761u;
+  for (int i = 0; i < 4; i++) {
+    item.payload[i] = check ^ (i * 0x9E3779B9u);
+    check = check * 31 + item.payload[i];
+  }
+  item.check = check;
+  return item;
+}
+
+static bool itemValid(const Item &item) {
+  Item expected = makeItem(item.seq);
+  for (int i = 0; i < 4; i++) {
+    if (item.payload[i] != expected.payload[i]) {
+      return false;
+    }
+  }
+  return item.check == expected.check;
+}
+
+struct Report {
+  uint64_t popped = 0;
+  uint64_t torn = 0;
+  uint64_t reordered = 0;
+  uint64_t gaps = 0;  // missing sequence numbers seen by the consumer
+  uint32_t next_seq = 0;
+  double seconds = 0;
+};
+
+static void busyWaitUs(int us) {
+  auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+// consumer side, shared by both runs
+static void consume(Queue *queue, Report *report) {
+  Item item;
+  while (queue->pop(&item)) {
+    report->popped++;
+    if (!itemValid(item)) {
+      report->torn++;
+    } else if (item.seq < report->next_seq) {
+      report->reordered++;
+    } else {
+      report->gaps += item.seq - report->next_seq;
+      report->next_seq = item.seq + 1;
+    }
+    if (report->popped % STALL_EVERY == 0) {
+      busyWaitUs(STALL_US);
+    }
+  }
+}
+
+// ---- producer in a signal handler on the consumer thread ----------------------
+
+static Queue *signal_queue;
+static std::atomic<uint32_t> signal_seq;
+static uint32_t signal_items;
+
+static void onTimer(int) {
+  for (int i = 0; i < BURST; i++) {
+    uint32_t seq = signal_seq.load(std::memory_order_relaxed);
+    if (seq >= signal_items) {
+      return;
+    }
+    signal_queue->push(makeItem(seq));
+    signal_seq.store(seq + 1, std::memory_order_relaxed);
+  }
+}
+
+static Report runSignal(Queue *queue, uint32_t items) {
+  Report report;
+  signal_queue = queue;
+  signal_seq = 0;
+  signal_items = items;
+
+  struct sigaction action = {};
+  action.sa_handler = onTimer;
+  sigaction(SIGALRM, &action, nullptr);
+  timer_t timer;
+  struct sigevent event = {};
+  event.sigev_notify = SIGEV_SIGNAL;
+  event.sigev_signo = SIGALRM;
+  timer_create(CLOCK_MONOTONIC, &event, &timer);
+  struct itimerspec spec = {};
+  spec.it_value.tv_nsec = TIMER_PERIOD_NS;
+  spec.it_interval.tv_nsec = TIMER_PERIOD_NS;
+
+  auto start = std::chrono::steady_clock::now();
+  timer_settime(timer, 0, &spec, nullptr);
+  while (signal_seq.load() < items) {
+    consume(queue, &report);
+  }
+  timer_delete(timer);
+  consume(queue, &report);
+  report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+// ---- producer thread -------------------------------------------------------------
+
+static Report runThread(Queue *queue, uint32_t items) {
+  Report report;
+  std::atomic<bool> done(false);
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    for (uint32_t seq = 0; seq < items; seq++) {
+      queue->push(makeItem(seq));
+      if (seq % BURST == BURST - 1) {
+        busyWaitUs(1);
+      }
+    }
+    done = true;
+  });
+  while (!done.load()) {
+    consume(queue, &report);
+  }
+  producer.join();
+  consume(queue, &report);
+  report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+static bool check(const char *name, const Queue &queue, const Report &r, uint32_t items) {
+  // with QUEUE_DROP_NEWEST rejected items are not counted as pushed
+  uint64_t produced = queue.policy() == QUEUE_DROP_NEWEST ? (uint64_t)queue.pushed() + queue.dropped() : queue.pushed();
+  bool counters_ok = produced == items && r.popped + queue.dropped() == items && r.gaps + (items - r.next_seq) == queue.dropped();
+  bool ok = counters_ok && r.torn == 0 && r.reordered == 0;
+  printf("%-8s %-12s %9llu %9u %8u %5u %6llu %9llu %9.2f  %s\n", name,
+         queue.policy() == QUEUE_DROP_NEWEST ? "drop_newest" : "drop_oldest", (unsigned long long)r.popped,
+         queue.dropped(), queue.highWater(), QUEUE_CAPACITY, (unsigned long long)r.torn,
+         (unsigned long long)r.reordered, items / r.seconds / 1e6, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+static double pushPopNs(uint32_t items) {
+  Queue queue;
+  Item item = {};
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t seq = 0; seq < items; seq++) {
+    queue.push(makeItem(seq));
+    queue.pop(&item);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return item.seq == items - 1 ? ns / items : -1;
+}
+
+int main(int argc, char **argv) {
+  uint32_t items = 2000000;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    if (opt == 'n') {
+      items = atoi(optarg);
+    } else {
+      fprintf(stderr, "usage: %s [-n items]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const QueueDropPolicy policies[] = {QUEUE_DROP_NEWEST, QUEUE_DROP_OLDEST};
+  bool ok = true;
+  printf("%-8s %-12s %9s %9s %8s %5s %6s %9s %9s\n", "producer", "policy", "popped", "dropped", "high", "cap",
+         "torn", "reorder", "M item/s");
+  for (QueueDropPolicy policy : policies) {
+    Queue queue(policy);
+    Report r = runSignal(&queue, items / 20);  // timer signals are slow, fewer items
+    ok &= check("signal", queue, r, items / 20);
+  }
+  for (QueueDropPolicy policy : policies) {
+    Queue queue(policy);
+    Report r = runThread(&queue, items);
+    ok &= check("thread", queue, r, items);
+  }
+  printf("\npush + pop without contention: %.1f ns\n", pushPopNs(items));
+  return ok ? 0 : 1;
+}
@@ -21,20 +21,23 @@
 #include "Arduino.h"
 #include <SPI.h>
 #include "SD.h"
+#include "session_index.h"
 
 #define CSPIN 9
+// number of the last log in the manifest instead of counting the files,
+// next log from LOG_ROTATE_BYTES on (lib/SessionIndex)
+#define SESSION_MANIFEST "SESSIONS.IDX"
+#define LOG_ROTATE_BYTES 1048576
 
 //functions 
-int getNumFiles(File dir);
 bool writeData(File mf, int smoke, int flame, int gas);
 bool writeHeader(File mf, String header);
 
 File myFile;
 String full_filename;
+SessionIndex sessionIndex(SESSION_MANIFEST, "tabor", ".txt", FILE_WRITE);
 
 void setup() {
-  String filename = "tabor"; // default file name, can be changed
-
   // Open serial communications and wait for port to open:
   Serial.begin(9600);
   while (!Serial) {
@@ -50,18 +53,14 @@ void setup() {
   }
   Serial.println("initialization done.");
   
-  File root = SD.open("/");
-
-  int num_files = getNumFiles(root);
+  myFile = sessionIndex.create(SD);
 
-  Serial.println("Counter: " + String(num_files));
+  Serial.println("Session: " + String(sessionIndex.session()));
 
-  full_filename = filename + String(num_files) + String(".txt") ;
+  full_filename = sessionIndex.name();
   
   Serial.println(full_filename);
 
-  myFile = SD.open(full_filename, FILE_WRITE);
-
   // if the file opened okay, write to it:
   if (myFile) {
     Serial.print("Writing header to " + full_filename);
@@ -106,6 +105,16 @@ void loop() {
     int smoke = random(1,1024), flame = random(1,1024), gas = random(1,1024);
     // write to file
     writeData(myFile, smoke, flame, gas);
+    // continue in the next log when this one is full
+    if (myFile.size() >= LOG_ROTATE_BYTES) {
+      myFile = sessionIndex.rotate(SD, myFile);
+      if (myFile) {
+        full_filename = sessionIndex.name();
+        writeHeader(myFile, "smoke,flame,gas");
+      } else {
+        Serial.println("error opening next log");
+      }
+    }
     // close the file:
     myFile.close();
     Serial.println(" done.");
@@ -0,0 +1,146 @@
+#include "at_engine.h"
+#include <string.h>
+
+AtEngine::AtEngine(Stream &modem)
+    : modem_(modem), head_(0), queued_(0), step_(0), state_(AT_IDLE), tx_pos_(0), step_start_(0), urc_(nullptr), echo_(nullptr), timeouts_(0), errors_(0) {}
+
+bool AtEngine::run(const AtStep *script, uint8_t steps, AtDoneCallback done, const char *data, uint16_t data_len) {
+  if (queued_ == AT_SCRIPT_QUEUE_LEN) {
+    return false;
+  }
+  Script &s = queue_[(head_ + queued_) % AT_SCRIPT_QUEUE_LEN];
+  s.steps = script;
+  s.count = steps;
+  s.done = done;
+  s.data = data;
+  s.data_len = data_len;
+  queued_++;
+  return true;
+}
+
+void AtEngine::poll() {
+  if (state_ == AT_IDLE && queued_) {
+    step_ = 0;
+    startStep();
+  }
+  if (state_ == AT_SEND_COMMAND || state_ == AT_SEND_DATA_STATE) {
+    sendChunk();
+  }
+  // replies are taken also while sending, e.g. the QISEND prompt
+  receive();
+  if (state_ == AT_WAIT && millis() - step_start_ >= queue_[head_].steps[step_].timeout_ms) {
+    timeouts_++;
+    if (echo_) {
+      echo_->print(F("Did not receive "));
+      echo_->println(ModemReader::name(queue_[head_].steps[step_].expect));
+    }
+    stepDone(false);
+  }
+}
+
+void AtEngine::startStep() {
+  const Script &s = queue_[head_];
+  if (step_ >= s.count) {
+    finish(true);
+    return;
+  }
+  const AtStep &step = s.steps[step_];
+  tx_pos_ = 0;
+  if (step.command) {
+    if (echo_) {
+      echo_->print(F("Sending command: \""));
+      echo_->print(step.command);
+      echo_->println(F("\""));
+    }
+    state_ = AT_SEND_COMMAND;
+  } else if (step.flags & AT_SEND_DATA) {
+    state_ = AT_SEND_DATA_STATE;
+  } else {
+    state_ = AT_WAIT;
+    step_start_ = millis();
+  }
+}
+
+void AtEngine::sendChunk() {
+  const Script &s = queue_[head_];
+  const AtStep &step = s.steps[step_];
+  uint8_t budget = AT_TX_CHUNK;
+  if (state_ == AT_SEND_COMMAND) {
+    // command and CR LF
+    uint16_t len = strlen(step.command);
+    while (budget && tx_pos_ < len + 2) {
+      modem_.write(tx_pos_ < len ? step.command[tx_pos_] : "\r\n"[tx_pos_ - len]);
+      tx_pos_++;
+      budget--;
+    }
+    if (tx_pos_ < len + 2) {
+      return;
+    }
+    state_ = AT_WAIT;
+    step_start_ = millis();
+    return;
+  }
+  // data and Ctrl+Z
+  while (budget && tx_pos_ < s.data_len + 1) {
+    modem_.write(tx_pos_ < s.data_len ? (uint8_t)s.data[tx_pos_] : (uint8_t)AT_CTRL_Z);
+    tx_pos_++;
+    budget--;
+  }
+  if (tx_pos_ == s.data_len + 1) {
+    state_ = AT_WAIT;
+    step_start_ = millis();
+  }
+}
+
+void AtEngine::receive() {
+  while (modem_.available()) {
+    ModemToken token = reader_.feed((char)modem_.read());
+    if (token != MODEM_NONE) {
+      lineDone(token);
+    }
+  }
+}
+
+void AtEngine::lineDone(ModemToken token) {
+  if (echo_ && token != MODEM_PROMPT) {
+    echo_->print(F("Received: \""));
+    echo_->print(reader_.line());
+    echo_->println(F("\""));
+  }
+  if (state_ == AT_WAIT) {
+    if (token == queue_[head_].steps[step_].expect) {
+      stepDone(true);
+      return;
+    }
+    if (ModemReader::isFailure(token)) {
+      errors_++;
+      stepDone(false);
+      return;
+    }
+  }
+  if (urc_ && token != MODEM_PROMPT) {
+    urc_(token, reader_.line());
+  }
+}
+
+void AtEngine::stepDone(bool ok) {
+  const AtStep &step = queue_[head_].steps[step_];
+  if (!ok && !(step.flags & AT_OPTIONAL)) {
+    finish(false);
+    return;
+  }
+  step_++;
+  startStep();
+}
+
+void AtEngine::finish(bool ok) {
+  Script s = queue_[head_];
+  uint8_t step = step_;
+  head_ = (head_ + 1) % AT_SCRIPT_QUEUE_LEN;
+  queued_--;
+  state_ = AT_IDLE;
+  // the callback may queue the next script
+  if (s.done) {
+    s.done(ok, step);
+  }
+}
@@ -0,0 +1,91 @@
+#ifndef AT_ENGINE_H_
+#define AT_ENGINE_H_
+
+#include <Arduino.h>
+#include "modem_reader.h"
+
+// Non-blocking AT command engine for the Quectel M95. Command sequences are
+// declared as scripts (arrays of AtStep) and queued with run(); poll(),
+// called from loop(), does a bounded amount of work per call: it writes at
+// most AT_TX_CHUNK bytes, takes the characters received so far and checks
+// the timeout of the current step. Replies are tokenized by ModemReader,
+// lines that do not answer the current step (URCs like "+QIRDI" or "CLOSED"
+// when not expected) go to the URC callback.
+//
+// A step succeeds on its expected token. It fails on timeout or a failure
+// token (ERROR, CONNECT FAIL, SEND FAIL); a failed step stops the script
+// unless it is AT_OPTIONAL.
+#define AT_TX_CHUNK 16        // bytes written per poll(), about 17 ms at 9600 Bd
+#define AT_SCRIPT_QUEUE_LEN 4
+#define AT_CTRL_Z 0x1A
+
+// AtStep flags
+#define AT_OPTIONAL 0x01   // failure does not stop the script
+#define AT_SEND_DATA 0x02  // step without command, sends the data of the script ended by Ctrl+Z
+
+struct AtStep {
+  const char *command;  // sent with CR LF, nullptr only waits (or sends data)
+  ModemToken expect;    // response that completes the step
+  uint16_t timeout_ms;  // from the last byte sent
+  uint8_t flags;
+};
+
+// Called when a script ends, step is the index of the failed step or the step count
+typedef void (*AtDoneCallback)(bool ok, uint8_t step);
+typedef void (*AtUrcCallback)(ModemToken token, const char *line);
+
+class AtEngine {
+ public:
+  explicit AtEngine(Stream &modem);
+
+  // Queues script, data (for AT_SEND_DATA steps) has to stay valid until
+  // the script ends. False when the queue is full.
+  bool run(const AtStep *script, uint8_t steps, AtDoneCallback done = nullptr, const char *data = nullptr,
+           uint16_t data_len = 0);
+
+  void poll();
+
+  // a script is running or queued
+  bool busy() const { return queued_ > 0; }
+
+  void onUrc(AtUrcCallback urc) { urc_ = urc; }
+
+  // Commands and replies are echoed to print, like the old blocking helpers did
+  void setEcho(Print *echo) { echo_ = echo; }
+
+  uint32_t timeouts() const { return timeouts_; }
+  uint32_t errors() const { return errors_; }
+
+ private:
+  struct Script {
+    const AtStep *steps;
+    uint8_t count;
+    AtDoneCallback done;
+    const char *data;
+    uint16_t data_len;
+  };
+  enum State { AT_IDLE, AT_SEND_COMMAND, AT_SEND_DATA_STATE, AT_WAIT };
+
+  void startStep();
+  void sendChunk();
+  void receive();
+  void lineDone(ModemToken token);
+  void stepDone(bool ok);
+  void finish(bool ok);
+
+  Stream &modem_;
+  Script queue_[AT_SCRIPT_QUEUE_LEN];
+  uint8_t head_;
+  uint8_t queued_;
+  uint8_t step_;
+  State state_;
+  uint16_t tx_pos_;             // position in the command or data being sent
+  unsigned long step_start_;
+  ModemReader reader_;
+  AtUrcCallback urc_;
+  Print *echo_;
+  uint32_t timeouts_;
+  uint32_t errors_;
+};
+
+#endif  // AT_ENGINE_H_
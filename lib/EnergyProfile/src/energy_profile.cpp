@@ -0,0 +1,113 @@
+#include "energy_profile.h"
+
+const char *profileStageName(int stage) {
+  static const char *names[PROFILE_STAGES] = {"adc", "net", "sd", "battery", "awake", "sleep", "tx", "sensors"};
+  return stage >= 0 && stage < PROFILE_STAGES ? names[stage] : "?";
+}
+
+void EnergyProfiler::begin(ProfileStage stage, uint32_t now_us) {
+  begin_us_[stage] = now_us;
+  running_[stage] = true;
+}
+
+void EnergyProfiler::end(ProfileStage stage, uint32_t now_us) {
+  if (!running_[stage]) {
+    return;
+  }
+  stage_us_[stage] += now_us - begin_us_[stage];
+  running_[stage] = false;
+}
+
+void EnergyProfiler::endCycle(uint32_t now_us, uint32_t awake_us) {
+  if (!started_) {
+    started_ = true;
+    cycle_start_us_ = now_us;
+    for (int s = 0; s < PROFILE_STAGES; s++) {
+      stage_us_[s] = 0;
+      begin_us_[s] = running_[s] && s >= STAGE_TX ? now_us : begin_us_[s];
+    }
+    return;
+  }
+  uint32_t cycle_us = now_us - cycle_start_us_;
+  cycle_start_us_ = now_us;
+  for (int s = STAGE_TX; s < PROFILE_STAGES; s++) {
+    if (running_[s]) {
+      stage_us_[s] += now_us - begin_us_[s];
+      begin_us_[s] = now_us;
+    }
+  }
+
+  // awake and sleep are what the timed stages leave of the awake time and
+  // the cycle, idle stages are in neither of them
+  uint32_t timed_us = 0;
+  uint32_t idle_us = 0;
+  for (int s = 0; s < STAGE_AWAKE; s++) {
+    if (idle(s)) {
+      idle_us += stage_us_[s];
+    } else {
+      timed_us += stage_us_[s];
+    }
+  }
+  uint32_t active_us = cycle_us > idle_us ? cycle_us - idle_us : 0;
+  if (awake_us > active_us) {
+    awake_us = active_us;
+  }
+  if (awake_us < timed_us) {
+    awake_us = timed_us;  // RTC resolution
+  }
+  stage_us_[STAGE_AWAKE] = awake_us - timed_us;
+  stage_us_[STAGE_SLEEP] = active_us > awake_us ? active_us - awake_us : 0;
+
+  for (int s = 0; s < PROFILE_STAGES; s++) {
+    uint32_t uw = model_.stage_uw[s];
+    if (idle(s)) {
+      uw += model_.idle_uw;
+    } else if (s < STAGE_TX) {
+      uw += s == STAGE_SLEEP ? model_.stop_uw : model_.run_uw;
+    }
+    total_us_[s] += stage_us_[s];
+    total_nj_[s] += (uint64_t)stage_us_[s] * uw / 1000;
+    stage_us_[s] = 0;
+  }
+  total_cycle_us_ += cycle_us;
+  cycles_++;
+}
+
+uint32_t EnergyProfiler::meanCycleUs() const {
+  return cycles_ ? (uint32_t)(total_cycle_us_ / cycles_) : 0;
+}
+
+uint32_t EnergyProfiler::meanUs(int stage) const {
+  return cycles_ ? (uint32_t)(total_us_[stage] / cycles_) : 0;
+}
+
+uint32_t EnergyProfiler::meanUj(int stage) const {
+  return cycles_ ? (uint32_t)(total_nj_[stage] / 1000 / cycles_) : 0;
+}
+
+uint32_t EnergyProfiler::meanCycleUj() const {
+  uint64_t nj = 0;
+  for (int s = 0; s < PROFILE_STAGES; s++) {
+    nj += total_nj_[s];
+  }
+  return cycles_ ? (uint32_t)(nj / 1000 / cycles_) : 0;
+}
+
+void EnergyProfiler::fillDiag(FireDiag *diag) const {
+  diag->cycles = cycles_;
+  uint32_t cycle_ms = meanCycleUs() / 1000;
+  diag->cycle_ms = cycle_ms > 65535 ? 65535 : (uint16_t)cycle_ms;
+  for (int s = 0; s < PROFILE_STAGES; s++) {
+    diag->stage_us[s] = meanUs(s);
+    diag->stage_uj[s] = meanUj(s);
+  }
+}
+
+void EnergyProfiler::reset() {
+  cycles_ = 0;
+  total_cycle_us_ = 0;
+  for (int s = 0; s < PROFILE_STAGES; s++) {
+    total_us_[s] = 0;
+    total_nj_[s] = 0;
+  }
+}
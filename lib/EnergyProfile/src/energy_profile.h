@@ -0,0 +1,81 @@
+#ifndef ENERGY_PROFILE_H_
+#define ENERGY_PROFILE_H_
+
+#include <stdint.h>
+#include "fire_frame.h"
+
+// Time and energy per stage of the end node measurement cycle
+// (lora_transmitter). MCU stages split the cycle: the timed ones, the rest
+// of the awake time and STOP mode. Load stages (radio transmitting,
+// sensors powered) overlap them. Energy of a stage is its time times the
+// draw of the model: the MCU (run, idle for the timed stages the core
+// sleeps through, or STOP) plus the extra of the stage, only the extra for
+// load stages. Means per cycle are kept since reset()
+// for serial and the diagnostics frame (lib/FireFrame).
+enum ProfileStage : uint8_t {
+  STAGE_ADC,      // measureAverageValues()
+  STAGE_NET,      // rolling features, getFireProbability()
+  STAGE_SD,       // SD card write
+  STAGE_BATTERY,  // measureBattery()
+  STAGE_AWAKE,    // rest of the awake time (serial, frame, scheduling)
+  STAGE_SLEEP,    // STOP mode
+  STAGE_TX,       // startTransmit() until setFlag(), load
+  STAGE_SENSORS,  // sensors powered, load
+  PROFILE_STAGES
+};
+
+static_assert(PROFILE_STAGES == FIRE_DIAG_STAGES, "diagnostics frame carries every stage");
+
+// Draw from the pack in uW
+struct EnergyModel {
+  uint32_t run_uw;                    // MCU awake
+  uint32_t idle_uw;                   // MCU in sleep mode (WFI)
+  uint32_t stop_uw;                   // MCU in STOP mode
+  uint32_t stage_uw[PROFILE_STAGES];  // extra of the stage
+  uint8_t idle_stages;                // bit per timed stage spent in sleep mode
+};
+
+const char *profileStageName(int stage);
+
+class EnergyProfiler {
+ public:
+  explicit EnergyProfiler(const EnergyModel &model) : model_(model) {}
+
+  // Time stamps in us of any clock that runs through the stage, load
+  // stages span STOP mode where SysTick (micros()) stops. Time of a stage
+  // adds up within a cycle.
+  void begin(ProfileStage stage, uint32_t now_us);
+  void end(ProfileStage stage, uint32_t now_us);
+  bool running(ProfileStage stage) const { return running_[stage]; }
+
+  // Ends the cycle at now_us (clock of the load stages) with awake_us of
+  // MCU awake time (at most the cycle, without the idle stages), running
+  // load stages go on in the next cycle. The first call only starts the
+  // cycle.
+  void endCycle(uint32_t now_us, uint32_t awake_us);
+
+  // Means per cycle since reset()
+  uint16_t cycles() const { return cycles_; }
+  uint32_t meanCycleUs() const;
+  uint32_t meanUs(int stage) const;
+  uint32_t meanUj(int stage) const;
+  uint32_t meanCycleUj() const;  // all stages
+  void fillDiag(FireDiag *diag) const;
+  void reset();
+
+ private:
+  bool idle(int stage) const { return stage < STAGE_AWAKE && (model_.idle_stages >> stage & 1); }
+
+  EnergyModel model_;
+  bool started_ = false;
+  uint32_t cycle_start_us_ = 0;
+  bool running_[PROFILE_STAGES] = {};
+  uint32_t begin_us_[PROFILE_STAGES] = {};
+  uint32_t stage_us_[PROFILE_STAGES] = {};  // current cycle
+  uint16_t cycles_ = 0;
+  uint64_t total_cycle_us_ = 0;
+  uint64_t total_us_[PROFILE_STAGES] = {};
+  uint64_t total_nj_[PROFILE_STAGES] = {};
+};
+
+#endif  // ENERGY_PROFILE_H_
@@ -0,0 +1,19 @@
+#include "fire_features.h"
+
+static const char *feature_names[FIRE_FEATURES_COUNT] = {
+    "smoke", "smoke_ema", "smoke_var", "smoke_slope", "smoke_min", "smoke_max",
+    "flame", "flame_ema", "flame_var", "flame_slope", "flame_min", "flame_max",
+    "gas",   "gas_ema",   "gas_var",   "gas_slope",   "gas_min",   "gas_max"};
+
+int fireFeatureScale(int i) {
+  switch (i % FEATURES_PER_SENSOR) {
+    case FEATURE_EMA:
+    case FEATURE_VARIANCE:
+    case FEATURE_SLOPE: return FIRE_FEATURE_SCALE_Q4;
+    default: return 1;
+  }
+}
+
+const char *fireFeatureName(int i) {
+  return i >= 0 && i < FIRE_FEATURES_COUNT ? feature_names[i] : "";
+}
@@ -0,0 +1,188 @@
+#ifndef FIRE_FEATURES_H_
+#define FIRE_FEATURES_H_
+
+#include <stdint.h>
+
+// Streaming features of the sensor readings of the end node, updated once
+// per reading (the mean of a measurement, TIME_SPAN apart). Per sensor:
+//   value     ... the reading
+//   EMA       ... exponential moving average, weight 1 / 2^ema_shift of
+//                 the new reading
+//   variance  ... population variance over the last Window readings
+//   slope     ... least squares slope over the last Window readings, per
+//                 reading, the rise of smoke and CO before a fire
+//   min, max  ... over the last Window readings
+// Until Window readings are in, the statistics are over the ones there are
+// (slope 0 below two).
+//
+// All integer. The ring buffer of the window keeps the readings, running
+// sums sum(y), sum(y^2) and sum(k * y) (k age order in the window) are
+// updated in O(1), min and max by monotonic queues (amortized O(1), at most
+// Window steps for one reading). Features are fixed point, value divided by
+// fireFeatureScale() gives counts (per reading for the slope, counts^2 for
+// the variance).
+#define FIRE_FEATURE_SENSORS 3
+// FEATURES_PER_SENSOR as a macro, #if of the firmware compares counts
+#define FIRE_FEATURES_PER_SENSOR 6
+#define FIRE_FEATURE_READING_MAX 4095
+#define FIRE_FEATURE_SCALE_Q4 16
+
+enum FireFeature {
+  FEATURE_VALUE,
+  FEATURE_EMA,       // Q4
+  FEATURE_VARIANCE,  // Q4
+  FEATURE_SLOPE,     // Q4
+  FEATURE_MIN,
+  FEATURE_MAX,
+  FEATURES_PER_SENSOR
+};
+
+static_assert(FIRE_FEATURES_PER_SENSOR == FEATURES_PER_SENSOR, "FIRE_FEATURES_PER_SENSOR out of date");
+
+// Feature vector: smoke features, flame features, gas features
+#define FIRE_FEATURES_COUNT (FIRE_FEATURE_SENSORS * FIRE_FEATURES_PER_SENSOR)
+
+// Divisor of feature i of the vector to counts
+int fireFeatureScale(int i);
+// Name of feature i of the vector, e.g. "smoke_slope"
+const char *fireFeatureName(int i);
+
+// Window statistics of one sensor, readings of at most 12 bits (ADC counts)
+template <uint8_t Window>
+class RollingStats {
+  static_assert(Window >= 2, "Window needs two readings for a slope");
+  static_assert(Window <= 64, "sum(y^2) of the window has to fit 32 bits");
+
+ public:
+  explicit RollingStats(uint8_t ema_shift) : ema_shift_(ema_shift) {}
+
+  void update(uint16_t y);
+  // FEATURES_PER_SENSOR features into out
+  void features(int32_t *out) const;
+
+  uint8_t count() const { return n_; }
+
+ private:
+  // Monotonic queue of the readings (with their sequence numbers) that can
+  // still become the minimum (max_queue false) or maximum of the window
+  struct Queue {
+    uint16_t seq[Window];
+    uint16_t y[Window];
+    uint8_t head = 0;
+    uint8_t len = 0;
+  };
+  void push(Queue *q, uint16_t y, bool max_queue);
+
+  uint16_t ring_[Window];
+  uint8_t pos_ = 0;   // slot of the next reading, the oldest one of a full window
+  uint8_t n_ = 0;     // readings in the window
+  uint16_t seq_ = 0;  // readings so far, wraps
+  uint8_t ema_shift_;
+  int32_t ema_ = 0;  // Q8
+  uint32_t sum_ = 0;
+  uint32_t sum_sq_ = 0;
+  uint32_t sum_age_ = 0;  // sum(k * y), k = 0 for the oldest reading
+  Queue min_;
+  Queue max_;
+};
+
+// Features of smoke, flame and gas
+template <uint8_t Window>
+class FireFeatures {
+ public:
+  explicit FireFeatures(uint8_t ema_shift) : sensors_{RollingStats<Window>(ema_shift), RollingStats<Window>(ema_shift),
+                                                      RollingStats<Window>(ema_shift)} {}
+
+  void update(int smoke, int flame, int gas) {
+    sensors_[0].update(clampReading(smoke));
+    sensors_[1].update(clampReading(flame));
+    sensors_[2].update(clampReading(gas));
+  }
+
+  // FIRE_FEATURES_COUNT features into out
+  void vector(int32_t *out) const {
+    for (int s = 0; s < FIRE_FEATURE_SENSORS; s++) {
+      sensors_[s].features(out + s * FEATURES_PER_SENSOR);
+    }
+  }
+
+  uint8_t count() const { return sensors_[0].count(); }
+
+ private:
+  static uint16_t clampReading(int y) {
+    return y < 0 ? 0 : (y > FIRE_FEATURE_READING_MAX ? FIRE_FEATURE_READING_MAX : (uint16_t)y);
+  }
+
+  RollingStats<Window> sensors_[FIRE_FEATURE_SENSORS];
+};
+
+template <uint8_t Window>
+void RollingStats<Window>::push(Queue *q, uint16_t y, bool max_queue) {
+  // reading older than the window leaves at the front
+  if (q->len > 0 && (uint16_t)(seq_ - q->seq[q->head]) >= Window) {
+    q->head = (q->head + 1) % Window;
+    q->len--;
+  }
+  // readings the new one dominates leave at the back
+  while (q->len > 0) {
+    uint16_t back = q->y[(q->head + q->len - 1) % Window];
+    if (max_queue ? back > y : back < y) {
+      break;
+    }
+    q->len--;
+  }
+  uint8_t tail = (q->head + q->len) % Window;
+  q->seq[tail] = seq_;
+  q->y[tail] = y;
+  q->len++;
+}
+
+template <uint8_t Window>
+void RollingStats<Window>::update(uint16_t y) {
+  if (n_ == 0) {
+    ema_ = (int32_t)y << 8;
+  } else {
+    ema_ += (((int32_t)y << 8) - ema_) >> ema_shift_;
+  }
+  if (n_ == Window) {
+    uint16_t old = ring_[pos_];
+    sum_ -= old;
+    sum_sq_ -= (uint32_t)old * old;
+    // ages of the others drop by one, the new reading gets Window - 1
+    sum_age_ -= sum_;
+    sum_age_ += (uint32_t)(Window - 1) * y;
+  } else {
+    sum_age_ += (uint32_t)n_ * y;
+    n_++;
+  }
+  sum_ += y;
+  sum_sq_ += (uint32_t)y * y;
+  push(&min_, y, false);
+  push(&max_, y, true);
+  ring_[pos_] = y;
+  pos_ = (pos_ + 1) % Window;
+  seq_++;
+}
+
+template <uint8_t Window>
+void RollingStats<Window>::features(int32_t *out) const {
+  int32_t n = n_;
+  out[FEATURE_VALUE] = n > 0 ? ring_[(pos_ + Window - 1) % Window] : 0;
+  out[FEATURE_EMA] = (ema_ + 8) >> 4;
+  if (n == 0) {
+    out[FEATURE_VARIANCE] = out[FEATURE_SLOPE] = out[FEATURE_MIN] = out[FEATURE_MAX] = 0;
+    return;
+  }
+  // n^2 var = n sum(y^2) - sum(y)^2
+  int64_t spread = (int64_t)n * sum_sq_ - (int64_t)sum_ * sum_;
+  out[FEATURE_VARIANCE] = (int32_t)(spread * FIRE_FEATURE_SCALE_Q4 / (n * n));
+  // slope = (n sum(k y) - sum(k) sum(y)) / (n sum(k^2) - sum(k)^2)
+  int64_t sum_k = (int64_t)n * (n - 1) / 2;
+  int64_t denominator = (int64_t)n * n * (n * n - 1) / 12;
+  int64_t numerator = (int64_t)n * sum_age_ - sum_k * sum_;
+  out[FEATURE_SLOPE] = denominator > 0 ? (int32_t)(numerator * FIRE_FEATURE_SCALE_Q4 / denominator) : 0;
+  out[FEATURE_MIN] = min_.y[min_.head];
+  out[FEATURE_MAX] = max_.y[max_.head];
+}
+
+#endif  // FIRE_FEATURES_H_
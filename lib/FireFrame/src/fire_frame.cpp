@@ -0,0 +1,342 @@
+#include "fire_frame.h"
+
+static bool encodeNumber(int num, uint8_t *out) {
+  if (num < 0 || num >= FIRE_FRAME_ERR_VALUE) { // It is not possible to encode int in two bytes
+    out[0] = 0xFF;
+    out[1] = 0xFF;
+    return false;
+  }
+  out[0] = (uint8_t)(num >> 8);
+  out[1] = (uint8_t)(num & 0xFF);
+  return true;
+}
+
+static int decodeNumber(const uint8_t *in) {
+  return ((int)in[0] << 8) | (int)in[1];
+}
+
+bool encodeFrameV1(const FireReading &reading, uint8_t frame[FIRE_FRAME_V1_LEN]) {
+  bool ok = true;
+  frame[0] = reading.transm_id;
+  ok &= encodeNumber(reading.smoke, frame + 1);
+  ok &= encodeNumber(reading.flame, frame + 3);
+  ok &= encodeNumber(reading.gas, frame + 5);
+  ok &= encodeNumber(reading.prob, frame + 7);
+  ok &= encodeNumber(reading.vbat, frame + 9);
+  return ok;
+}
+
+bool decodeFrameV1(const uint8_t *frame, size_t len, FireReading *reading) {
+  if (len < FIRE_FRAME_V1_LEN) {
+    return false;
+  }
+  reading->transm_id = frame[0];
+  reading->smoke = decodeNumber(frame + 1);
+  reading->flame = decodeNumber(frame + 3);
+  reading->gas = decodeNumber(frame + 5);
+  reading->prob = decodeNumber(frame + 7);
+  reading->vbat = decodeNumber(frame + 9);
+  reading->seq = 0;
+  reading->flags = 0;
+  reading->age_s = 0;
+  reading->suppressed = 0;
+  if (reading->flame >= FIRE_FRAME_ERR_VALUE || reading->gas >= FIRE_FRAME_ERR_VALUE ||
+      reading->smoke >= FIRE_FRAME_ERR_VALUE || reading->prob >= FIRE_FRAME_ERR_VALUE) {
+    return false;
+  }
+  return true;
+}
+
+// Bit packing of the v2 frame, fields most significant bit first. Only the
+// low bits + n <= 32 bits of the accumulator are used.
+struct BitWriter {
+  uint8_t *out;
+  uint32_t acc;
+  uint8_t bits;
+
+  void put(uint32_t value, uint8_t n) {
+    acc = (acc << n) | value;
+    bits += n;
+    while (bits >= 8) {
+      bits -= 8;
+      *out++ = (uint8_t)(acc >> bits);
+    }
+  }
+};
+
+struct BitReader {
+  const uint8_t *in;
+  uint32_t acc;
+  uint8_t bits;
+
+  uint32_t get(uint8_t n) {
+    while (bits < n) {
+      acc = (acc << 8) | *in++;
+      bits += 8;
+    }
+    bits -= n;
+    return (acc >> bits) & ((1UL << n) - 1);
+  }
+};
+
+// Value limited to <0, max>, clamped is set when it did not fit
+static uint32_t clampField(int value, int max, bool *clamped) {
+  if (value < 0) {
+    *clamped = true;
+    return 0;
+  }
+  if (value > max) {
+    *clamped = true;
+    return max;
+  }
+  return value;
+}
+
+// Reading fields as packed in v2 and the aggregated frame
+enum { FIELD_SMOKE, FIELD_FLAME, FIELD_GAS, FIELD_PROB, FIELD_VBAT, FIELDS };
+static const uint8_t field_bits[FIELDS] = {10, 10, 10, 14, 12};
+
+// Clamps values of the reading to the fields, error is set for sensor or
+// probability value out of range, vbat_clamped for battery voltage
+static void packFields(const FireReading &reading, uint32_t fields[FIELDS], bool *error, bool *vbat_clamped) {
+  fields[FIELD_SMOKE] = clampField(reading.smoke, FIRE_FRAME_V2_SENSOR_MAX, error);
+  fields[FIELD_FLAME] = clampField(reading.flame, FIRE_FRAME_V2_SENSOR_MAX, error);
+  fields[FIELD_GAS] = clampField(reading.gas, FIRE_FRAME_V2_SENSOR_MAX, error);
+  fields[FIELD_PROB] = clampField(reading.prob, FIRE_FRAME_V2_PROB_MAX, error);
+  uint32_t vbat = clampField(reading.vbat, FIRE_FRAME_V2_VBAT_MAX + FIRE_FRAME_V2_VBAT_STEP / 2 - 1, vbat_clamped);
+  fields[FIELD_VBAT] = (vbat + FIRE_FRAME_V2_VBAT_STEP / 2) / FIRE_FRAME_V2_VBAT_STEP;
+}
+
+static void unpackFields(const uint32_t fields[FIELDS], FireReading *reading) {
+  reading->smoke = fields[FIELD_SMOKE];
+  reading->flame = fields[FIELD_FLAME];
+  reading->gas = fields[FIELD_GAS];
+  reading->prob = fields[FIELD_PROB];
+  reading->vbat = fields[FIELD_VBAT] * FIRE_FRAME_V2_VBAT_STEP;
+}
+
+bool encodeFrameV2(const FireReading &reading, uint8_t frame[FIRE_FRAME_V2_LEN]) {
+  bool error = false;
+  bool vbat_clamped = false;
+  uint32_t fields[FIELDS];
+  packFields(reading, fields, &error, &vbat_clamped);
+
+  BitWriter w = {frame, 0, 0};
+  w.put(FIRE_FRAME_V2, 4);
+  w.put((reading.flags | (error ? FIRE_FLAG_ERROR : 0)) & 0x0F, 4);
+  w.put(reading.transm_id, 8);
+  w.put(reading.seq, 8);
+  for (int f = 0; f < FIELDS; f++) {
+    w.put(fields[f], field_bits[f]);
+  }
+  return !error && !vbat_clamped;
+}
+
+bool encodeFrameV2Heartbeat(const FireReading &reading, uint8_t frame[FIRE_FRAME_V2_HEARTBEAT_LEN]) {
+  FireReading heartbeat = reading;
+  heartbeat.flags |= FIRE_FLAG_HEARTBEAT;
+  bool ok = encodeFrameV2(heartbeat, frame);
+  frame[FIRE_FRAME_V2_LEN] = (uint8_t)(reading.suppressed >> 8);
+  frame[FIRE_FRAME_V2_LEN + 1] = (uint8_t)(reading.suppressed & 0xFF);
+  return ok;
+}
+
+bool decodeFrameV2(const uint8_t *frame, size_t len, FireReading *reading) {
+  if (len < FIRE_FRAME_V2_LEN || frame[0] >> 4 != FIRE_FRAME_V2) {
+    return false;
+  }
+  BitReader r = {frame, 0, 0};
+  r.get(4);
+  reading->flags = r.get(4);
+  reading->transm_id = r.get(8);
+  reading->seq = r.get(8);
+  uint32_t fields[FIELDS];
+  for (int f = 0; f < FIELDS; f++) {
+    fields[f] = r.get(field_bits[f]);
+  }
+  unpackFields(fields, reading);
+  reading->age_s = 0;
+  reading->suppressed = 0;
+  if (reading->flags & FIRE_FLAG_HEARTBEAT) {
+    if (len < FIRE_FRAME_V2_HEARTBEAT_LEN) {
+      return false;
+    }
+    reading->suppressed = decodeNumber(frame + FIRE_FRAME_V2_LEN);
+  }
+  return !(reading->flags & FIRE_FLAG_ERROR);
+}
+
+bool decodeFrame(const uint8_t *frame, size_t len, FireReading *reading) {
+  if (len == FIRE_FRAME_V1_LEN) {
+    return decodeFrameV1(frame, len, reading);
+  }
+  return decodeFrameV2(frame, len, reading);
+}
+
+// Deltas of the aggregated frame, small of both signs to small unsigned
+static uint32_t zigzag(int32_t delta) {
+  return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static uint8_t bitWidth(uint32_t value) {
+  uint8_t bits = 0;
+  while (value) {
+    bits++;
+    value >>= 1;
+  }
+  return bits;
+}
+
+size_t encodeFrameAgg(const FireReading *readings, int count, uint8_t interval_s, uint8_t *frame, size_t size) {
+  if (count < 1 || count > FIRE_FRAME_AGG_MAX) {
+    return 0;
+  }
+  bool error = false;
+  bool vbat_clamped = false;
+  uint32_t fields[FIRE_FRAME_AGG_MAX][FIELDS];
+  uint8_t widths[FIELDS] = {0};
+  for (int i = 0; i < count; i++) {
+    packFields(readings[i], fields[i], &error, &vbat_clamped);
+    for (int f = 0; i > 0 && f < FIELDS; f++) {
+      uint8_t width = bitWidth(zigzag((int32_t)fields[i][f] - (int32_t)fields[i - 1][f]));
+      if (width > widths[f]) {
+        widths[f] = width;
+      }
+    }
+  }
+  size_t bits = 8 * FIRE_FRAME_AGG_HEADER_LEN;
+  for (int f = 0; f < FIELDS; f++) {
+    bits += field_bits[f] + (count - 1) * widths[f];
+  }
+  size_t len = (bits + 7) / 8;
+  if (len > size) {
+    return 0;
+  }
+
+  BitWriter w = {frame, 0, 0};
+  w.put(FIRE_FRAME_AGG, 4);
+  w.put((readings[0].flags | (error ? FIRE_FLAG_ERROR : 0)) & 0x0F, 4);
+  w.put(readings[0].transm_id, 8);
+  w.put(readings[0].seq, 8);
+  w.put(count - 1, 4);
+  for (int f = 0; f < FIELDS; f++) {
+    w.put(widths[f], 4);
+  }
+  w.put(interval_s, 8);
+  for (int f = 0; f < FIELDS; f++) {
+    w.put(fields[0][f], field_bits[f]);
+  }
+  for (int i = 1; i < count; i++) {
+    for (int f = 0; f < FIELDS; f++) {
+      if (widths[f]) {
+        w.put(zigzag((int32_t)fields[i][f] - (int32_t)fields[i - 1][f]), widths[f]);
+      }
+    }
+  }
+  w.put(0, 7); // pads the last byte
+  return len;
+}
+
+int decodeFrameAgg(const uint8_t *frame, size_t len, FireReading *readings, int max) {
+  if (len < FIRE_FRAME_AGG_HEADER_LEN || frame[0] >> 4 != FIRE_FRAME_AGG) {
+    return 0;
+  }
+  BitReader r = {frame, 0, 0};
+  r.get(4);
+  uint8_t flags = r.get(4);
+  uint8_t transm_id = r.get(8);
+  uint8_t seq = r.get(8);
+  int count = r.get(4) + 1;
+  uint8_t widths[FIELDS];
+  size_t bits = 8 * FIRE_FRAME_AGG_HEADER_LEN;
+  for (int f = 0; f < FIELDS; f++) {
+    widths[f] = r.get(4);
+    bits += field_bits[f] + (count - 1) * widths[f];
+  }
+  uint8_t interval_s = r.get(8);
+  if ((flags & FIRE_FLAG_ERROR) || count > max || len < (bits + 7) / 8) {
+    return 0;
+  }
+
+  uint32_t fields[FIELDS];
+  for (int f = 0; f < FIELDS; f++) {
+    fields[f] = r.get(field_bits[f]);
+  }
+  for (int i = 0; i < count; i++) {
+    if (i > 0) {
+      for (int f = 0; f < FIELDS; f++) {
+        if (widths[f]) {
+          // masked to the field, a corrupted delta cannot leave its range
+          fields[f] = (fields[f] + unzigzag(r.get(widths[f]))) & ((1UL << field_bits[f]) - 1);
+        }
+      }
+    }
+    FireReading *reading = &readings[i];
+    reading->transm_id = transm_id;
+    reading->flags = i == 0 ? flags : flags & ~FIRE_FLAG_BOOT;
+    reading->seq = (uint8_t)(seq + i);
+    reading->age_s = (uint16_t)((count - 1 - i) * interval_s);
+    reading->suppressed = 0;
+    unpackFields(fields, reading);
+  }
+  return count;
+}
+
+int decodeFrames(const uint8_t *frame, size_t len, FireReading *readings, int max) {
+  if (max < 1 || len < 1) {
+    return 0;
+  }
+  if (len != FIRE_FRAME_V1_LEN && frame[0] >> 4 == FIRE_FRAME_AGG) {
+    return decodeFrameAgg(frame, len, readings, max);
+  }
+  return decodeFrame(frame, len, readings) ? 1 : 0;
+}
+
+static uint8_t *putBytes(uint32_t value, int n, uint8_t *out) {
+  for (int i = n - 1; i >= 0; i--) {
+    *out++ = (uint8_t)(value >> (8 * i));
+  }
+  return out;
+}
+
+static uint32_t getBytes(const uint8_t **in, int n) {
+  uint32_t value = 0;
+  for (int i = 0; i < n; i++) {
+    value = (value << 8) | *(*in)++;
+  }
+  return value;
+}
+
+void encodeFrameDiag(const FireDiag &diag, uint8_t frame[FIRE_FRAME_DIAG_LEN]) {
+  uint8_t *out = frame;
+  *out++ = (uint8_t)(FIRE_FRAME_DIAG << 4 | (diag.flags & 0x0F));
+  *out++ = diag.transm_id;
+  *out++ = diag.seq;
+  out = putBytes(diag.cycles, 2, out);
+  out = putBytes(diag.cycle_ms, 2, out);
+  for (int i = 0; i < FIRE_DIAG_STAGES; i++) {
+    out = putBytes(diag.stage_us[i], 4, out);
+    out = putBytes(diag.stage_uj[i], 4, out);
+  }
+}
+
+bool decodeFrameDiag(const uint8_t *frame, size_t len, FireDiag *diag) {
+  if (len < FIRE_FRAME_DIAG_LEN || frame[0] >> 4 != FIRE_FRAME_DIAG) {
+    return false;
+  }
+  const uint8_t *in = frame;
+  diag->flags = *in++ & 0x0F;
+  diag->transm_id = *in++;
+  diag->seq = *in++;
+  diag->cycles = (uint16_t)getBytes(&in, 2);
+  diag->cycle_ms = (uint16_t)getBytes(&in, 2);
+  for (int i = 0; i < FIRE_DIAG_STAGES; i++) {
+    diag->stage_us[i] = getBytes(&in, 4);
+    diag->stage_uj[i] = getBytes(&in, 4);
+  }
+  return true;
+}
@@ -0,0 +1,132 @@
+#ifndef FIRE_FRAME_H_
+#define FIRE_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Radio frames sent by the end nodes (lora_transmitter) to the central node
+// (lora_receiver). The receiver tells the versions apart by length.
+//
+// v1, 11 bytes:
+//   {node address, smoke, flame, gas, probability * PROB_SCALE,
+//    battery voltage * VOLTAGE_SCALE}
+// every value in two bytes, upper byte first. Value that does not fit in
+// <0, FIRE_FRAME_ERR_VALUE) is sent as the error value 0xFFFF.
+#define FIRE_FRAME_V1_LEN 11
+#define FIRE_FRAME_ERR_VALUE 65535
+
+// v2, 10 bytes, bit packed, most significant bit first:
+//   version 4 | flags 4 | node address 8 | sequence 8 | smoke 10 |
+//   flame 10 | gas 10 | probability * PROB_SCALE 14 |
+//   battery voltage * VOLTAGE_SCALE / FIRE_FRAME_V2_VBAT_STEP 12
+// Sensor or probability value out of range is sent clamped with
+// FIRE_FLAG_ERROR, battery voltage is only clamped (to 16.38 V).
+// Heartbeat of a node with change-driven reporting (FIRE_FLAG_HEARTBEAT)
+// adds the readings suppressed since reset of the node, 16 bits, wrapping.
+// Other lengths than FIRE_FRAME_V1_LEN are reserved for versions >= 2.
+#define FIRE_FRAME_V2_LEN 10
+#define FIRE_FRAME_V2_HEARTBEAT_LEN 12
+#define FIRE_FRAME_V2 2
+#define FIRE_FRAME_V2_SENSOR_MAX 1023
+#define FIRE_FRAME_V2_PROB_MAX 16383
+#define FIRE_FRAME_V2_VBAT_STEP 4
+#define FIRE_FRAME_V2_VBAT_MAX (4095 * FIRE_FRAME_V2_VBAT_STEP)
+
+// Aggregated frame, 1 .. FIRE_FRAME_AGG_MAX readings of one node taken
+// interval seconds apart, bit packed as v2:
+//   version 4 | flags 4 | node address 8 | sequence of the first reading 8 |
+//   count - 1 4 | width of smoke, flame, gas, probability, battery 5 x 4 |
+//   interval in seconds 8 |
+//   first reading as in v2 56 |
+//   (count - 1) x zigzag deltas to the previous reading in the widths
+// Flags and value clamping as in v2, FIRE_FLAG_ERROR if any reading has
+// a value out of range.
+#define FIRE_FRAME_AGG 3
+#define FIRE_FRAME_AGG_MAX 16
+#define FIRE_FRAME_AGG_HEADER_LEN 7
+// header, first reading and 15 deltas of the widest fields (61 bits)
+#define FIRE_FRAME_AGG_MAX_LEN 129
+
+#define FIRE_FRAME_MAX_LEN FIRE_FRAME_AGG_MAX_LEN
+
+// Diagnostics frame of the end node energy profile (lib/EnergyProfile),
+// sent every few hundred cycles, bytes:
+//   version 4 | flags 4 | node address 8 | sequence 8 |
+//   cycles 16 | mean cycle length in ms 16 |
+//   FIRE_DIAG_STAGES x (mean time per cycle in us 32,
+//                       mean energy per cycle in uJ 32)
+// multi-byte values upper byte first. Sequence is the one of the next
+// reading frame, diagnostics frames do not advance it.
+#define FIRE_FRAME_DIAG 4
+#define FIRE_DIAG_STAGES 8
+#define FIRE_FRAME_DIAG_LEN (7 + FIRE_DIAG_STAGES * 8)
+
+// v2 flags
+#define FIRE_FLAG_ERROR 0x1  // some sensor or probability value out of range
+#define FIRE_FLAG_BOOT 0x2   // first frame after reset of the node, sequence starts again
+#define FIRE_FLAG_HEARTBEAT 0x4  // v2 heartbeat, suppressed count follows
+
+struct FireReading {
+  uint8_t transm_id;
+  int smoke;
+  int flame;
+  int gas;
+  int prob;
+  int vbat;
+  uint8_t seq;    // v2 and aggregated frame, 0 in v1
+  uint8_t flags;  // v2 and aggregated frame, 0 in v1
+  uint16_t age_s; // aggregated frame, seconds before the last reading of the frame
+  uint16_t suppressed; // v2 heartbeat, readings not sent since reset of the node
+};
+
+struct FireDiag {
+  uint8_t transm_id;
+  uint8_t seq;
+  uint8_t flags;
+  uint16_t cycles;     // measurement cycles the means are taken over
+  uint16_t cycle_ms;
+  uint32_t stage_us[FIRE_DIAG_STAGES];
+  uint32_t stage_uj[FIRE_DIAG_STAGES];
+};
+
+// Fills frame, returns false if some value was replaced by the error value
+bool encodeFrameV1(const FireReading &reading, uint8_t frame[FIRE_FRAME_V1_LEN]);
+
+// Returns false for short frame or when smoke, flame, gas or probability
+// carry the error value (battery voltage is not checked, as it never was in
+// the receiver)
+bool decodeFrameV1(const uint8_t *frame, size_t len, FireReading *reading);
+
+// Fills frame, returns false if some value was clamped. FIRE_FLAG_ERROR is
+// added to reading.flags when a sensor or probability value was clamped.
+bool encodeFrameV2(const FireReading &reading, uint8_t frame[FIRE_FRAME_V2_LEN]);
+
+// Heartbeat frame, FIRE_FLAG_HEARTBEAT is added to reading.flags
+bool encodeFrameV2Heartbeat(const FireReading &reading, uint8_t frame[FIRE_FRAME_V2_HEARTBEAT_LEN]);
+
+// Returns false for short frame, other version or FIRE_FLAG_ERROR. Battery
+// voltage is rounded to FIRE_FRAME_V2_VBAT_STEP.
+bool decodeFrameV2(const uint8_t *frame, size_t len, FireReading *reading);
+
+// Decodes v1 or v2 frame, v1 by its length
+bool decodeFrame(const uint8_t *frame, size_t len, FireReading *reading);
+
+// Encodes count readings of one node (address, flags and sequence of the
+// first one are sent), returns frame length or 0 when count is out of
+// range or frame is shorter than needed
+size_t encodeFrameAgg(const FireReading *readings, int count, uint8_t interval_s, uint8_t *frame, size_t size);
+
+// Returns number of readings, 0 for short frame, other version, more
+// readings than max or FIRE_FLAG_ERROR
+int decodeFrameAgg(const uint8_t *frame, size_t len, FireReading *readings, int max);
+
+// Decodes frame of any version (v1 by its length) into readings, returns
+// their number or 0
+int decodeFrames(const uint8_t *frame, size_t len, FireReading *readings, int max);
+
+void encodeFrameDiag(const FireDiag &diag, uint8_t frame[FIRE_FRAME_DIAG_LEN]);
+
+// Returns false for short frame or other version
+bool decodeFrameDiag(const uint8_t *frame, size_t len, FireDiag *diag);
+
+#endif  // FIRE_FRAME_H_
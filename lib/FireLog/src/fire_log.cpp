@@ -0,0 +1,222 @@
+#include "fire_log.h"
+#include <string.h>
+
+#define FIRE_LOG_MAGIC "FLOG"
+
+static const char *field_names[FIRE_LOG_FIELDS] = {"smoke", "flame", "gas", "prob", "label"};
+static const uint8_t field_encodings[FIRE_LOG_FIELDS] = {FIRE_LOG_DELTA, FIRE_LOG_DELTA, FIRE_LOG_DELTA,
+                                                         FIRE_LOG_DELTA, FIRE_LOG_BIT};
+static const uint16_t field_scales[FIRE_LOG_FIELDS] = {1, 1, 1, 10000, 1};
+
+uint16_t fireLogCrc(const uint8_t *data, size_t len, uint16_t crc) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static uint32_t zigzag(int32_t delta) {
+  return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static int32_t delta(int a, int b) {
+  return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static uint8_t *putVarint(uint32_t value, uint8_t *out) {
+  while (value >= 0x80) {
+    *out++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = (uint8_t)value;
+  return out;
+}
+
+// false when the varint runs past end or is longer than 5 bytes
+static bool getVarint(const uint8_t **in, const uint8_t *end, uint32_t *value) {
+  uint32_t v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (*in >= end) {
+      return false;
+    }
+    uint8_t b = *(*in)++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *value = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint8_t *putBytes(uint32_t value, int n, uint8_t *out) {
+  for (int i = n - 1; i >= 0; i--) {
+    *out++ = (uint8_t)(value >> (8 * i));
+  }
+  return out;
+}
+
+static uint32_t getBytes(const uint8_t *in, int n) {
+  uint32_t value = 0;
+  for (int i = 0; i < n; i++) {
+    value = value << 8 | in[i];
+  }
+  return value;
+}
+
+static size_t encodeRecord(const FireLogRecord &r, const FireLogRecord &prev, uint8_t *out) {
+  uint8_t *p = out;
+  p = putVarint(zigzag(delta(r.smoke, prev.smoke)), p);
+  p = putVarint(zigzag(delta(r.flame, prev.flame)), p);
+  p = putVarint(zigzag(delta(r.gas, prev.gas)), p);
+  p = putVarint(zigzag(delta(r.prob, prev.prob)) << 1 | r.label, p);
+  return p - out;
+}
+
+size_t FireLogEncoder::begin(uint8_t transm_id, uint32_t period_ms, uint8_t *out) {
+  memset(out, 0, FIRE_LOG_BLOCK);
+  uint8_t *p = out;
+  memcpy(p, FIRE_LOG_MAGIC, 4);
+  p += 4;
+  *p++ = FIRE_LOG_VERSION;
+  *p++ = transm_id;
+  p = putBytes(period_ms, 4, p);
+  *p++ = FIRE_LOG_FIELDS;
+  for (int f = 0; f < FIRE_LOG_FIELDS; f++) {
+    *p++ = field_encodings[f];
+    p = putBytes(field_scales[f], 2, p);
+    size_t len = strlen(field_names[f]) + 1;
+    memcpy(p, field_names[f], len);
+    p += len;
+  }
+  putBytes(fireLogCrc(out, FIRE_LOG_BLOCK - 2), 2, out + FIRE_LOG_BLOCK - 2);
+  pos_ = FIRE_LOG_BLOCK;
+  seq_ = 0;
+  return FIRE_LOG_BLOCK;
+}
+
+uint8_t *FireLogEncoder::put(const uint8_t *data, size_t len, uint8_t *out) {
+  memcpy(out, data, len);
+  crc_ = fireLogCrc(data, len, crc_);
+  pos_ += len;
+  return out + len;
+}
+
+size_t FireLogEncoder::encode(const FireLogRecord &record, uint8_t *out) {
+  FireLogRecord r = record;
+  r.prob = r.prob < 0 ? 0 : (r.prob > 65535 ? 65535 : r.prob);
+  r.label = r.label ? 1 : 0;
+  uint8_t *start = out;
+  uint8_t encoded[FIRE_LOG_RECORD_MAX];
+  size_t len = encodeRecord(r, prev_, encoded);
+
+  if (pos_ < FIRE_LOG_BLOCK && pos_ + len > FIRE_LOG_BLOCK - FIRE_LOG_TRAILER_LEN) {
+    out += end(out);
+  }
+  if (pos_ >= FIRE_LOG_BLOCK) {
+    uint8_t header[FIRE_LOG_HEADER_LEN] = {FIRE_LOG_SYNC, (uint8_t)(seq_ >> 8), (uint8_t)seq_};
+    seq_++;
+    pos_ = 0;
+    crc_ = 0xFFFF;
+    count_ = 0;
+    prev_ = FireLogRecord();
+    out = put(header, sizeof(header), out);
+    len = encodeRecord(r, prev_, encoded);
+  }
+  out = put(encoded, len, out);
+  count_++;
+  prev_ = r;
+  return out - start;
+}
+
+size_t FireLogEncoder::end(uint8_t *out) {
+  if (pos_ >= FIRE_LOG_BLOCK) {
+    return 0;
+  }
+  static const uint8_t zero = 0;
+  uint8_t *start = out;
+  while (pos_ < FIRE_LOG_BLOCK - FIRE_LOG_TRAILER_LEN) {
+    out = put(&zero, 1, out);
+  }
+  out = put(&count_, 1, out);
+  out = putBytes(crc_, 2, out);
+  pos_ = FIRE_LOG_BLOCK;
+  return out - start;
+}
+
+bool decodeLogSchema(const uint8_t *block, size_t len, FireLogSchema *schema) {
+  if (len < FIRE_LOG_BLOCK || memcmp(block, FIRE_LOG_MAGIC, 4) != 0 ||
+      fireLogCrc(block, FIRE_LOG_BLOCK - 2) != getBytes(block + FIRE_LOG_BLOCK - 2, 2)) {
+    return false;
+  }
+  schema->version = block[4];
+  schema->transm_id = block[5];
+  schema->period_ms = getBytes(block + 6, 4);
+  if (schema->version != FIRE_LOG_VERSION || block[10] != FIRE_LOG_FIELDS) {
+    return false;
+  }
+  const uint8_t *p = block + 11;
+  const uint8_t *end = block + FIRE_LOG_BLOCK - 2;
+  for (int f = 0; f < FIRE_LOG_FIELDS; f++) {
+    size_t name_len = strlen(field_names[f]) + 1;
+    if (p + 3 + name_len > end || p[0] != field_encodings[f] || getBytes(p + 1, 2) != field_scales[f] ||
+        memcmp(p + 3, field_names[f], name_len) != 0) {
+      return false;
+    }
+    p += 3 + name_len;
+  }
+  return true;
+}
+
+int decodeLogBlock(const uint8_t *block, size_t len, FireLogRecord *records, int max, bool *verified) {
+  *verified = false;
+  if (len < FIRE_LOG_HEADER_LEN || block[0] != FIRE_LOG_SYNC) {
+    return -1;
+  }
+  const uint8_t *end = block + (len < FIRE_LOG_BLOCK ? len : FIRE_LOG_BLOCK);
+  int count = -1;  // unknown without trailer
+  if (len >= FIRE_LOG_BLOCK) {
+    if (fireLogCrc(block, FIRE_LOG_BLOCK - 2) != getBytes(block + FIRE_LOG_BLOCK - 2, 2)) {
+      return -1;
+    }
+    end = block + FIRE_LOG_BLOCK - FIRE_LOG_TRAILER_LEN;
+    count = *end;
+    *verified = true;
+  }
+
+  FireLogRecord prev = FireLogRecord();
+  const uint8_t *in = block + FIRE_LOG_HEADER_LEN;
+  int n = 0;
+  while (count < 0 ? in < end : n < count) {
+    uint32_t v[4];
+    for (int i = 0; i < 4; i++) {
+      if (!getVarint(&in, end, &v[i])) {
+        // record cut by the end of an unfinished block ends it
+        return count < 0 ? n : -1;
+      }
+    }
+    if (n >= max) {
+      return -1;
+    }
+    FireLogRecord &r = records[n++];
+    r.smoke = (int)((uint32_t)prev.smoke + (uint32_t)unzigzag(v[0]));
+    r.flame = (int)((uint32_t)prev.flame + (uint32_t)unzigzag(v[1]));
+    r.gas = (int)((uint32_t)prev.gas + (uint32_t)unzigzag(v[2]));
+    r.prob = (int)((uint32_t)prev.prob + (uint32_t)unzigzag(v[3] >> 1));
+    r.label = v[3] & 1;
+    prev = r;
+  }
+  for (; count >= 0 && in < end; in++) {
+    if (*in != 0) {
+      return -1;  // padding
+    }
+  }
+  return n;
+}
@@ -0,0 +1,100 @@
+#ifndef FIRE_LOG_H_
+#define FIRE_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary SD card log of the end nodes (lora_transmitter), converted back to
+// the CSV of the sessions by host_tools log_convert. The file is a sequence
+// of FIRE_LOG_BLOCK byte blocks at sector boundaries (lib/SdLog writes whole
+// sectors), multi-byte values upper byte first.
+//
+// Schema block, the first one:
+//   magic "FLOG" | version 8 | node address 8 | reading period in ms 32 |
+//   field count 8 | per field: encoding 8, scale 16, name NUL-terminated |
+//   zero padding | CRC 16
+// Fields of version 1: smoke, flame, gas (FIRE_LOG_DELTA, scale 1),
+// prob (FIRE_LOG_DELTA, probability * 10000) and label (FIRE_LOG_BIT).
+//
+// Data block:
+//   sync FIRE_LOG_SYNC 8 | block sequence 16 | records | zero padding |
+//   record count 8 | CRC 16
+// A record is four varints (7 bits per byte, least significant group
+// first, high bit set on all but the last byte): zigzag deltas of smoke,
+// flame and gas to the previous record, zigzag delta of prob shifted left
+// by one with the label in bit 0. The first record of a block is a delta
+// to zeros, so every block decodes on its own. A record that would run
+// into the trailer starts the next block.
+//
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial 0xFFFF) covers the block
+// up to the CRC. The last block of a file may end without padding and
+// trailer (not full yet when the node lost power or the card was taken
+// out), its records decode unverified.
+#define FIRE_LOG_BLOCK 512
+#define FIRE_LOG_VERSION 1
+#define FIRE_LOG_SYNC 0xB1
+#define FIRE_LOG_HEADER_LEN 3
+#define FIRE_LOG_TRAILER_LEN 3
+#define FIRE_LOG_FIELDS 5
+#define FIRE_LOG_RECORD_MAX 18  // three 5 byte varints and a 3 byte one
+#define FIRE_LOG_BLOCK_RECORDS ((FIRE_LOG_BLOCK - FIRE_LOG_HEADER_LEN - FIRE_LOG_TRAILER_LEN) / 4)
+// padding, trailer, header and record of one encode() call
+#define FIRE_LOG_CHUNK_MAX (FIRE_LOG_RECORD_MAX + FIRE_LOG_TRAILER_LEN + FIRE_LOG_HEADER_LEN + FIRE_LOG_RECORD_MAX)
+
+enum FireLogEncoding : uint8_t {
+  FIRE_LOG_DELTA = 1,  // zigzag varint delta to the previous record
+  FIRE_LOG_BIT = 2     // bit 0 of the prob varint
+};
+
+struct FireLogRecord {
+  int smoke;
+  int flame;
+  int gas;
+  int prob;       // probability * 10000, clamped to 0 .. 65535
+  uint8_t label;  // golden label switch, non-zero is 1
+};
+
+struct FireLogSchema {
+  uint8_t version;
+  uint8_t transm_id;
+  uint32_t period_ms;
+};
+
+class FireLogEncoder {
+ public:
+  // Schema block of a new log file, FIRE_LOG_BLOCK bytes into out
+  size_t begin(uint8_t transm_id, uint32_t period_ms, uint8_t *out);
+
+  // Encodes record into out (FIRE_LOG_CHUNK_MAX bytes at most), with the
+  // trailer of the full block and the header of the next one before it
+  // when needed, returns the length
+  size_t encode(const FireLogRecord &record, uint8_t *out);
+
+  // Pads the open block and writes its trailer into out (FIRE_LOG_BLOCK
+  // bytes at most), before the file is closed for good, returns the
+  // length, 0 without an open block
+  size_t end(uint8_t *out);
+
+ private:
+  // Appends len bytes of data to the block at out
+  uint8_t *put(const uint8_t *data, size_t len, uint8_t *out);
+
+  uint16_t pos_ = FIRE_LOG_BLOCK;  // in the current block, full after begin()
+  uint16_t seq_ = 0;
+  uint8_t count_ = 0;
+  uint16_t crc_ = 0;
+  FireLogRecord prev_ = {};
+};
+
+uint16_t fireLogCrc(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+
+// Decodes the schema block, false when it is no fire log of a known
+// version and schema
+bool decodeLogSchema(const uint8_t *block, size_t len, FireLogSchema *schema);
+
+// Decodes a data block of len bytes (FIRE_LOG_BLOCK, less for the last
+// block of a file) into at most max records, returns their count, -1 for a
+// corrupted block. verified is set for a full block with a good CRC.
+int decodeLogBlock(const uint8_t *block, size_t len, FireLogRecord *records, int max, bool *verified);
+
+#endif  // FIRE_LOG_H_
@@ -0,0 +1,107 @@
+#ifndef FIRE_NET_H_
+#define FIRE_NET_H_
+
+#include <math.h>
+
+// Compile-time specialized dense network. Layer sizes and weights are
+// template parameters, so the whole forward pass is unrolled by the compiler,
+// there is no model parsing, no tensor arena and no init at startup.
+// Weights are generated from Keras .h5 by real_model/export_constexpr.py:
+//
+//   typedef FireNet<Dense<3, 18, Relu, dense_kernel, dense_bias>,
+//                   Dense<18, 1, Sigmoid, dense_1_kernel, dense_1_bias> > Net;
+//   float prob = Net::predict(input);
+
+struct Linear {
+  static inline float apply(float x) { return x; }
+};
+
+struct Relu {
+  static inline float apply(float x) { return x > 0.0f ? x : 0.0f; }
+};
+
+struct Sigmoid {
+  static inline float apply(float x) { return 1.0f / (1.0f + expf(-x)); }
+};
+
+// Sum of x[i] * kernel[i][J] for i < I, unrolled from the last input
+template <int In, int Out, const float (&Kernel)[In][Out], int I, int J>
+struct DenseDot {
+  static inline float run(const float *x) {
+    return DenseDot<In, Out, Kernel, I - 1, J>::run(x) + x[I - 1] * Kernel[I - 1][J];
+  }
+};
+
+template <int In, int Out, const float (&Kernel)[In][Out], int J>
+struct DenseDot<In, Out, Kernel, 0, J> {
+  static inline float run(const float *) { return 0.0f; }
+};
+
+// Outputs y[j] for j < J, unrolled from the last neuron
+template <int In, int Out, class Activation, const float (&Kernel)[In][Out], const float (&Bias)[Out], int J>
+struct DenseNeurons {
+  static inline void run(const float *x, float *y) {
+    DenseNeurons<In, Out, Activation, Kernel, Bias, J - 1>::run(x, y);
+    y[J - 1] = Activation::apply(Bias[J - 1] + DenseDot<In, Out, Kernel, In, J - 1>::run(x));
+  }
+};
+
+template <int In, int Out, class Activation, const float (&Kernel)[In][Out], const float (&Bias)[Out]>
+struct DenseNeurons<In, Out, Activation, Kernel, Bias, 0> {
+  static inline void run(const float *, float *) {}
+};
+
+// Fully connected layer, kernel is stored as [inputs][outputs] like in Keras
+template <int In, int Out, class Activation, const float (&Kernel)[In][Out], const float (&Bias)[Out]>
+struct Dense {
+  static const int inputs = In;
+  static const int outputs = Out;
+
+  static inline void forward(const float *x, float *y) {
+    DenseNeurons<In, Out, Activation, Kernel, Bias, Out>::run(x, y);
+  }
+};
+
+template <class... Layers>
+class FireNet;
+
+template <class Last>
+class FireNet<Last> {
+ public:
+  static const int inputs = Last::inputs;
+  static const int outputs = Last::outputs;
+
+  static inline void predict(const float *input, float *output) {
+    Last::forward(input, output);
+  }
+
+  // Same as ml.predict(input) of EloquentTinyML, returns the first output
+  static inline float predict(const float *input) {
+    float output[outputs];
+    predict(input, output);
+    return output[0];
+  }
+};
+
+template <class First, class... Rest>
+class FireNet<First, Rest...> {
+  static_assert(First::outputs == FireNet<Rest...>::inputs, "sizes of consecutive layers do not match");
+
+ public:
+  static const int inputs = First::inputs;
+  static const int outputs = FireNet<Rest...>::outputs;
+
+  static inline void predict(const float *input, float *output) {
+    float hidden[First::outputs];
+    First::forward(input, hidden);
+    FireNet<Rest...>::predict(hidden, output);
+  }
+
+  static inline float predict(const float *input) {
+    float output[outputs];
+    predict(input, output);
+    return output[0];
+  }
+};
+
+#endif  // FIRE_NET_H_
@@ -0,0 +1,45 @@
+// Generated by real_model/export_constexpr.py from model_real3.h5, do not edit.
+#ifndef MODEL_REAL3_NET_H_
+#define MODEL_REAL3_NET_H_
+
+#include "fire_net.h"
+
+namespace model_real3 {
+
+constexpr float dense_kernel[3][18] = {
+  {0.0282765403f, 0.261268854f, -0.142117411f, 0.679797471f, 0.393471986f, 0.283492297f, -0.456439883f, -0.0773928165f, -0.253886551f, -0.207834661f, -0.127525762f, -0.484960347f, 0.163825676f, 0.0907922685f, -0.373041719f, -0.20492129f, -0.53030622f, 0.0606800877f},
+  {0.283520669f, 0.186123222f, -0.402447462f, 0.286200732f, -0.145642966f, 0.149807304f, -0.4568955f, -0.134979561f, 0.424454808f, 0.108990915f, -0.192926884f, -0.367628366f, 0.135959268f, 0.317595482f, -0.375909805f, 0.310612381f, -0.000640330778f, 0.200752363f},
+  {0.480696917f, 0.304210246f, 0.163377956f, -0.171032071f, -0.0710254163f, 0.136708736f, -0.0650687218f, 0.238891721f, 0.290682524f, 0.229192868f, 0.0607005879f, -0.360113174f, -0.474097341f, 0.452383041f, -0.342528403f, -0.0852588639f, -0.0454300977f, -0.448184252f},
+};
+
+constexpr float dense_bias[18] = {-0.102072984f, -0.10042116f, -0.105545975f, -0.121663846f, -0.112238884f, 0.09976051f, 0.0f, -0.0957708955f, 0.10737215f, 0.000363834697f, -0.0907711014f, 0.0f, -0.0806499645f, 0.104318149f, 0.0f, -0.0266781077f, 0.0f, 0.0461673401f};
+
+constexpr float dense_1_kernel[18][1] = {
+  {-0.430003792f},
+  {-0.0891751349f},
+  {-0.194478318f},
+  {-0.0417569131f},
+  {-0.336235493f},
+  {0.155222714f},
+  {-0.244250014f},
+  {-0.287267625f},
+  {0.189092115f},
+  {0.0241200551f},
+  {-0.366896242f},
+  {-0.225541502f},
+  {-0.466570795f},
+  {0.389141411f},
+  {-0.207771614f},
+  {-0.407622248f},
+  {0.280378908f},
+  {0.45470956f},
+};
+
+constexpr float dense_1_bias[1] = {0.103708334f};
+
+typedef FireNet<Dense<3, 18, Relu, dense_kernel, dense_bias>,
+                Dense<18, 1, Sigmoid, dense_1_kernel, dense_1_bias> > Net;
+
+}  // namespace model_real3
+
+#endif  // MODEL_REAL3_NET_H_
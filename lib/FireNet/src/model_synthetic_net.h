@@ -0,0 +1,37 @@
+// Generated by real_model/export_constexpr.py from ../synthetic_model_v1/model.h5, do not edit.
+#ifndef MODEL_SYNTHETIC_NET_H_
+#define MODEL_SYNTHETIC_NET_H_
+
+#include "fire_net.h"
+
+namespace model_synthetic {
+
+constexpr float dense_kernel[3][10] = {
+  {-0.553788185f, 0.251000702f, -0.165208757f, -0.649784148f, 0.246552199f, 0.803880513f, -0.545634747f, -0.546700656f, 0.286316961f, 0.281682193f},
+  {-0.491958797f, 0.895803034f, -0.333080441f, -0.0726301372f, -0.350803673f, 0.831798494f, -0.304353774f, 0.0786859021f, 1.14699221f, 0.155475333f},
+  {-0.410719514f, 0.877634108f, -0.625291348f, 0.0800730586f, 0.668516397f, 0.572572887f, -0.333573639f, 0.240629882f, 0.698059142f, 0.317343652f},
+};
+
+constexpr float dense_bias[10] = {0.0f, -0.631195486f, 1.52131915f, -0.0639069676f, 1.32484317f, -0.732743621f, 0.0f, -0.228696734f, -0.658192694f, 0.871859014f};
+
+constexpr float dense_1_kernel[10][1] = {
+  {0.584976614f},
+  {1.57859981f},
+  {-1.28019691f},
+  {0.332993209f},
+  {-0.637389362f},
+  {1.01266515f},
+  {-0.706130683f},
+  {0.520653188f},
+  {1.42145205f},
+  {-0.776299238f},
+};
+
+constexpr float dense_1_bias[1] = {-0.707837284f};
+
+typedef FireNet<Dense<3, 10, Relu, dense_kernel, dense_bias>,
+                Dense<10, 1, Sigmoid, dense_1_kernel, dense_1_bias> > Net;
+
+}  // namespace model_synthetic
+
+#endif  // MODEL_SYNTHETIC_NET_H_
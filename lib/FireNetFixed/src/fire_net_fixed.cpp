@@ -0,0 +1,66 @@
+#include "fire_net_fixed.h"
+#include "fire_net_fixed_weights.h"
+
+// Number formats (see real_model/export_fixed.py):
+//   input  ... integer ADC counts <0, FIRE_NET_FIXED_ADC_MAX>
+//   w1, b1 ... Q(FIRE_NET_FIXED_W1_FRAC), the exporter guarantees the hidden
+//              accumulator fits int32, hidden activations keep the same format
+//   w2     ... Q15, products are summed in int64 (the precision is needed,
+//              hidden activations reach hundreds for raw ADC inputs)
+//   logit  ... rescaled to Q12 for the sigmoid table lookup
+
+#define FIRE_NET_FIXED_OUT_FRAC (FIRE_NET_FIXED_W1_FRAC + FIRE_NET_FIXED_W2_FRAC)
+
+static int32_t clampInput(int x) {
+  if (x < 0) {
+    return 0;
+  }
+  if (x > FIRE_NET_FIXED_ADC_MAX) {
+    return FIRE_NET_FIXED_ADC_MAX;
+  }
+  return x;
+}
+
+uint16_t sigmoidFixed(int32_t logit) {
+  // sigmoid(-z) = 1 - sigmoid(z), so only positive half is tabulated
+  const uint16_t one = fire_net_fixed_sigmoid[FIRE_NET_FIXED_SIGMOID_LEN - 1];
+  const int interp_bits = FIRE_NET_FIXED_LOGIT_FRAC - FIRE_NET_FIXED_SIGMOID_STEP_BITS;
+  bool negative = logit < 0;
+  uint32_t z = negative ? (uint32_t)(-logit) : (uint32_t)logit;
+
+  uint32_t idx = z >> interp_bits;
+  uint16_t p;
+  if (idx >= FIRE_NET_FIXED_SIGMOID_LEN - 1) {
+    p = one;
+  } else {
+    // linear interpolation between two neighbouring table entries
+    uint32_t t = z & ((1u << interp_bits) - 1);
+    uint32_t lo = fire_net_fixed_sigmoid[idx];
+    uint32_t hi = fire_net_fixed_sigmoid[idx + 1];
+    p = (uint16_t)(lo + (((hi - lo) * t + (1u << (interp_bits - 1))) >> interp_bits));
+  }
+  return negative ? (uint16_t)(one - p) : p;
+}
+
+uint16_t predictFireProbabilityFixed(int smoke, int flame, int gas) {
+  const int32_t x0 = clampInput(smoke);
+  const int32_t x1 = clampInput(flame);
+  const int32_t x2 = clampInput(gas);
+
+  int64_t acc_out = fire_net_fixed_b2;
+  for (int i = 0; i < FIRE_NET_FIXED_HIDDEN; i++) {
+    int32_t hidden = fire_net_fixed_b1[i]
+                   + x0 * fire_net_fixed_w1[i][0]
+                   + x1 * fire_net_fixed_w1[i][1]
+                   + x2 * fire_net_fixed_w1[i][2];
+    if (hidden <= 0) { // relu
+      continue;
+    }
+    acc_out += (int64_t)hidden * fire_net_fixed_w2[i];
+  }
+
+  // rescale logit to Q12 with rounding, arithmetic shift rounds toward -inf
+  const int shift = FIRE_NET_FIXED_OUT_FRAC - FIRE_NET_FIXED_LOGIT_FRAC;
+  int32_t logit = (int32_t)((acc_out + ((int64_t)1 << (shift - 1))) >> shift);
+  return sigmoidFixed(logit);
+}
@@ -0,0 +1,17 @@
+#ifndef FIRE_NET_FIXED_H_
+#define FIRE_NET_FIXED_H_
+
+#include <stdint.h>
+
+// Integer inference of the 3-18-1 fire net (Dense(18, relu) -> Dense(1, sigmoid)).
+// Inputs are raw 10 bit ADC averages and no float operation is used, so it is
+// cheap on the FPU-less Cortex-M0+ and needs no tensor arena. Weights are
+// generated by real_model/export_fixed.py into fire_net_fixed_weights.h.
+//
+// Returns fire probability scaled by 10000 (same as PROB_SCALE in the firmware).
+uint16_t predictFireProbabilityFixed(int smoke, int flame, int gas);
+
+// Tabulated sigmoid of logit in Q12, returns probability scaled by 10000.
+uint16_t sigmoidFixed(int32_t logit_q12);
+
+#endif  // FIRE_NET_FIXED_H_
@@ -0,0 +1,71 @@
+// Generated by real_model/export_fixed.py from model_real3.h5, do not edit.
+#ifndef FIRE_NET_FIXED_WEIGHTS_H_
+#define FIRE_NET_FIXED_WEIGHTS_H_
+
+#include <stdint.h>
+
+#define FIRE_NET_FIXED_HIDDEN 18
+#define FIRE_NET_FIXED_ADC_MAX 1023
+#define FIRE_NET_FIXED_W1_FRAC 20
+#define FIRE_NET_FIXED_W2_FRAC 15
+#define FIRE_NET_FIXED_LOGIT_FRAC 12
+#define FIRE_NET_FIXED_SIGMOID_STEP_BITS 4
+#define FIRE_NET_FIXED_SIGMOID_LEN 161
+
+// hidden layer weights in Q20, one row per neuron (smoke, flame, gas)
+static const int32_t fire_net_fixed_w1[FIRE_NET_FIXED_HIDDEN][3] = {
+  29650, 297293, 504047,
+  273960, 195164, 318988,
+  -149021, -421997, 171314,
+  712819, 300103, -179340,
+  412585, -152718, -74476,
+  297263, 157084, 143350,
+  -478612, -479090, -68230,
+  -81152, -141536, 250496,
+  -266219, 445073, 304803,
+  -217930, 114285, 240326,
+  -133720, -202298, 63649,
+  -508518, -385486, -377606,
+  171784, 142564, -497127,
+  95203, 333023, 474358,
+  -391163, -394170, -359167,
+  -214876, 325701, -89400,
+  -556066, -671, -47637,
+  63628, 210504, -469955
+};
+
+// hidden layer bias in Q20
+static const int32_t fire_net_fixed_b1[FIRE_NET_FIXED_HIDDEN] = {
+  -107031, -105299, -110673, -127574, -117691, 104606,
+  0, -100423, 112588, 382, -95180, 0,
+  -84568, 109386, 0, -27974, 0, 48410
+};
+
+// output layer weights in Q15
+static const int16_t fire_net_fixed_w2[FIRE_NET_FIXED_HIDDEN] = {
+  -14090, -2922, -6373, -1368, -11018, 5086, -8004, -9413, 6196, 790, -12022, -7391,
+  -15289, 12751, -6808, -13357, 9187, 14900
+};
+
+// output layer bias in Q35
+static const int64_t fire_net_fixed_b2 = 3563391232LL;
+
+// sigmoid(k / 16) * PROB_SCALE for k = 0 .. FIRE_NET_FIXED_SIGMOID_LEN - 1
+static const uint16_t fire_net_fixed_sigmoid[FIRE_NET_FIXED_SIGMOID_LEN] = {
+  5000, 5156, 5312, 5467, 5622, 5775, 5927, 6077, 6225, 6370, 6514, 6654,
+  6792, 6926, 7058, 7186, 7311, 7432, 7549, 7663, 7773, 7879, 7982, 8081,
+  8176, 8267, 8355, 8439, 8520, 8597, 8670, 8741, 8808, 8872, 8933, 8991,
+  9047, 9099, 9149, 9196, 9241, 9284, 9325, 9363, 9399, 9433, 9466, 9497,
+  9526, 9553, 9579, 9604, 9627, 9649, 9669, 9689, 9707, 9724, 9740, 9756,
+  9770, 9784, 9797, 9809, 9820, 9831, 9841, 9850, 9859, 9868, 9876, 9883,
+  9890, 9897, 9903, 9909, 9914, 9919, 9924, 9929, 9933, 9937, 9941, 9944,
+  9948, 9951, 9954, 9957, 9959, 9962, 9964, 9966, 9968, 9970, 9972, 9974,
+  9975, 9977, 9978, 9979, 9981, 9982, 9983, 9984, 9985, 9986, 9987, 9988,
+  9988, 9989, 9990, 9990, 9991, 9991, 9992, 9992, 9993, 9993, 9994, 9994,
+  9994, 9995, 9995, 9995, 9996, 9996, 9996, 9996, 9997, 9997, 9997, 9997,
+  9997, 9998, 9998, 9998, 9998, 9998, 9998, 9998, 9998, 9999, 9999, 9999,
+  9999, 9999, 9999, 9999, 9999, 9999, 9999, 9999, 9999, 9999, 9999, 9999,
+  9999, 9999, 9999, 10000, 10000
+};
+
+#endif  // FIRE_NET_FIXED_WEIGHTS_H_
@@ -0,0 +1,54 @@
+#include "fire_net_grid.h"
+#include "fire_net_grid_table.h"
+#include "fire_net_fixed.h"
+
+#define FIRE_NET_GRID_ONE (1 << FIRE_NET_GRID_STEP_BITS)
+#define FIRE_NET_GRID_ADC_MAX ((FIRE_NET_GRID_SIZE - 1) * FIRE_NET_GRID_ONE - 1)
+#define FIRE_NET_GRID_LOGIT_FRAC 12
+
+// interpolated logit is in Q(FIRE_NET_GRID_FRAC + 3 * FIRE_NET_GRID_STEP_BITS)
+#define FIRE_NET_GRID_SHIFT (FIRE_NET_GRID_FRAC + 3 * FIRE_NET_GRID_STEP_BITS - FIRE_NET_GRID_LOGIT_FRAC)
+
+static int32_t clampInput(int x) {
+  if (x < 0) {
+    return 0;
+  }
+  if (x > FIRE_NET_GRID_ADC_MAX) {
+    return FIRE_NET_GRID_ADC_MAX;
+  }
+  return x;
+}
+
+uint16_t predictFireProbabilityGrid(int smoke, int flame, int gas) {
+  const int32_t x = clampInput(smoke);
+  const int32_t y = clampInput(flame);
+  const int32_t z = clampInput(gas);
+
+  // cell index and position inside the cell
+  const int i = x >> FIRE_NET_GRID_STEP_BITS;
+  const int j = y >> FIRE_NET_GRID_STEP_BITS;
+  const int k = z >> FIRE_NET_GRID_STEP_BITS;
+  const int32_t tx = x & (FIRE_NET_GRID_ONE - 1);
+  const int32_t ty = y & (FIRE_NET_GRID_ONE - 1);
+  const int32_t tz = z & (FIRE_NET_GRID_ONE - 1);
+  const int32_t ux = FIRE_NET_GRID_ONE - tx;
+  const int32_t uy = FIRE_NET_GRID_ONE - ty;
+  const int32_t uz = FIRE_NET_GRID_ONE - tz;
+
+  // weights of the eight cell corners sum up to 2^(3 * STEP_BITS)
+  int32_t acc = ux * uy * uz * fire_net_grid[i][j][k]
+              + ux * uy * tz * fire_net_grid[i][j][k + 1]
+              + ux * ty * uz * fire_net_grid[i][j + 1][k]
+              + ux * ty * tz * fire_net_grid[i][j + 1][k + 1]
+              + tx * uy * uz * fire_net_grid[i + 1][j][k]
+              + tx * uy * tz * fire_net_grid[i + 1][j][k + 1]
+              + tx * ty * uz * fire_net_grid[i + 1][j + 1][k]
+              + tx * ty * tz * fire_net_grid[i + 1][j + 1][k + 1];
+
+  #if FIRE_NET_GRID_SHIFT > 0
+  int32_t logit = (acc + (1 << (FIRE_NET_GRID_SHIFT - 1))) >> FIRE_NET_GRID_SHIFT;
+  #else
+  int32_t logit = acc << -FIRE_NET_GRID_SHIFT;
+  #endif
+  return sigmoidFixed(logit);
+}
@@ -0,0 +1,14 @@
+#ifndef FIRE_NET_GRID_H_
+#define FIRE_NET_GRID_H_
+
+#include <stdint.h>
+
+// Constant-time surrogate of the fire net: trilinear interpolation in a 3-D
+// grid of logits over (smoke, flame, gas) ADC space followed by tabulated
+// sigmoid. The grid is generated by real_model/export_grid.py, which also
+// reports its error against the TFLite model.
+//
+// Returns fire probability scaled by 10000 (same as PROB_SCALE in the firmware).
+uint16_t predictFireProbabilityGrid(int smoke, int flame, int gas);
+
+#endif  // FIRE_NET_GRID_H_
@@ -0,0 +1,338 @@
+// Generated by real_model/export_grid.py from model_real3.h5, do not edit.
+#ifndef FIRE_NET_GRID_TABLE_H_
+#define FIRE_NET_GRID_TABLE_H_
+
+#include <stdint.h>
+
+#define FIRE_NET_GRID_STEP_BITS 6
+#define FIRE_NET_GRID_SIZE 17
+#define FIRE_NET_GRID_FRAC 4
+
+// logit in Q4 at [smoke][flame][gas] = [i][j][k] * 64
+static const int8_t fire_net_grid[FIRE_NET_GRID_SIZE][FIRE_NET_GRID_SIZE][FIRE_NET_GRID_SIZE] = {
+  {
+    {3,-96,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-15,-7,-13,-40,-114,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-35,-26,-19,-22,-29,-42,-84,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-55,-2,-28,-31,-33,-36,-46,-57,-86,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-75,10,-55,-39,-42,-45,-48,-53,-63,-73,-88,-128,-128,-128,-128,-128,-128},
+    {-95,-10,-53,-48,-51,-54,-57,-60,-62,-70,-80,-90,-101,-128,-128,-128,-128},
+    {-115,-30,-8,-85,-60,-63,-65,-68,-71,-74,-77,-87,-97,-107,-117,-128,-128},
+    {-128,-50,36,-105,-68,-71,-74,-77,-80,-83,-86,-89,-94,-104,-114,-124,-128},
+    {-128,-70,16,-60,-114,-80,-83,-86,-89,-92,-94,-97,-100,-103,-111,-121,-128},
+    {-128,-90,-4,-15,-128,-95,-92,-95,-98,-100,-103,-106,-109,-112,-115,-118,-127},
+    {-128,-109,-24,30,-111,-128,-101,-103,-106,-109,-112,-115,-118,-121,-124,-126,-128},
+    {-128,-128,-44,41,-66,-128,-125,-112,-115,-118,-121,-124,-127,-128,-128,-128,-128},
+    {-128,-128,-64,21,-21,-128,-128,-121,-124,-127,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-84,1,24,-117,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-104,-19,66,-72,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-124,-39,46,-27,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-59,26,18,-123,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-100,2,-3,-17,-66,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-72,18,51,48,45,38,-7,-78,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-58,27,40,39,36,34,31,28,25,-19,-97,-128,-128,-128,-128,-128,-128},
+    {-78,7,-8,31,28,25,22,19,16,13,10,-4,-46,-119,-128,-128,-128},
+    {-98,-13,22,11,19,16,13,10,7,5,2,-1,-4,-12,-48,-91,-128},
+    {-118,-33,53,-38,10,7,4,2,-1,-4,-7,-10,-13,-16,-19,-29,-50},
+    {-128,-52,33,-29,-19,-1,-4,-7,-10,-13,-16,-19,-22,-24,-27,-30,-35},
+    {-128,-72,13,16,-67,-10,-13,-16,-19,-22,-25,-27,-30,-33,-36,-39,-42},
+    {-128,-92,-7,61,-80,-48,-22,-25,-28,-31,-33,-36,-39,-42,-45,-48,-51},
+    {-128,-112,-27,58,-36,-97,-31,-34,-36,-39,-42,-45,-48,-51,-54,-57,-59},
+    {-128,-128,-47,38,9,-128,-78,-42,-45,-48,-51,-54,-57,-60,-62,-65,-68},
+    {-128,-128,-67,18,54,-87,-126,-59,-54,-57,-60,-63,-65,-68,-71,-74,-77},
+    {-128,-128,-87,-2,83,-42,-128,-107,-63,-66,-68,-71,-74,-77,-80,-83,-86},
+    {-128,-128,-107,-22,63,3,-128,-128,-88,-74,-77,-80,-83,-86,-89,-92,-94},
+    {-128,-128,-127,-42,43,48,-93,-128,-128,-83,-86,-89,-92,-95,-98,-100,-103},
+    {-128,-128,-128,-62,24,93,-48,-128,-128,-118,-95,-98,-101,-103,-106,-109,-112},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-101,0,3,-11,-25,-39,-65,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-71,17,63,84,103,101,66,28,-11,-77,-128,-128,-128,-128,-128,-128},
+    {-128,-41,32,100,98,95,92,89,86,83,72,33,-18,-89,-128,-128,-128},
+    {-120,-15,70,58,89,86,83,80,77,74,72,69,66,63,39,-30,-101},
+    {-121,-35,50,10,77,77,74,71,69,66,63,60,57,54,51,48,46},
+    {-128,-55,30,46,28,68,66,63,60,57,54,51,48,45,43,40,37},
+    {-128,-75,10,91,-20,47,57,54,51,48,45,42,40,37,34,31,28},
+    {-128,-95,-10,75,-5,-1,48,45,42,39,36,34,31,28,25,22,19},
+    {-128,-115,-30,55,40,-50,18,36,33,31,28,25,22,19,16,13,10},
+    {-128,-128,-50,35,85,-56,-31,28,25,22,19,16,13,10,7,5,2},
+    {-128,-128,-70,15,100,-11,-79,-12,16,13,10,7,4,2,-1,-4,-7},
+    {-128,-128,-90,-5,80,34,-108,-60,7,4,1,-1,-4,-7,-10,-13,-16},
+    {-128,-128,-110,-25,61,79,-63,-109,-41,-5,-7,-10,-13,-16,-19,-22,-25},
+    {-128,-128,-128,-45,41,124,-18,-128,-90,-22,-16,-19,-22,-25,-28,-31,-33},
+    {-128,-128,-128,-65,21,106,27,-114,-128,-71,-25,-28,-31,-34,-36,-39,-42},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-72,-3,8,-6,-20,-34,-48,-62,-76,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-70,22,60,82,103,125,123,95,56,18,-21,-76,-128,-128,-128},
+    {-128,-128,-39,23,101,123,127,127,127,127,127,127,100,62,23,-17,-88},
+    {-128,-119,-9,45,117,127,127,127,127,127,127,127,127,124,121,106,67},
+    {-128,-89,21,112,76,127,127,127,127,127,124,121,118,115,112,110,107},
+    {-128,-78,7,92,27,94,127,124,121,118,115,112,109,107,104,101,98},
+    {-128,-98,-13,72,70,46,113,115,112,109,106,103,101,98,95,92,89},
+    {-128,-118,-33,52,115,-2,65,106,103,100,98,95,92,89,86,83,80},
+    {-128,-128,-53,32,118,19,16,84,95,92,89,86,83,80,77,74,72},
+    {-128,-128,-73,12,98,64,-32,35,86,83,80,77,74,71,69,66,63},
+    {-128,-128,-93,-8,78,109,-32,-13,54,74,71,68,66,63,60,57,54},
+    {-128,-128,-113,-28,58,127,13,-62,6,65,62,60,57,54,51,48,45},
+    {-128,-128,-128,-48,38,123,58,-84,-43,25,54,51,48,45,42,39,36},
+    {-128,-128,-128,-68,18,103,103,-39,-91,-24,44,42,39,36,33,31,28},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-67,-6,14,0,-14,-28,-42,-56,-70,-84,-98,-128,-128,-128},
+    {-128,-128,-128,-65,27,57,79,101,122,127,115,101,84,46,8,-31,-76},
+    {-128,-128,-128,-38,29,99,120,127,127,127,127,127,127,127,127,90,52},
+    {-128,-128,-117,-8,30,122,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-87,22,58,124,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-57,53,127,93,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-36,49,127,49,112,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-56,29,115,94,64,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-76,9,95,127,15,82,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-96,-11,75,127,43,34,101,127,127,127,127,127,127,127,124},
+    {-128,-128,-116,-31,55,127,88,-15,53,120,127,127,127,124,121,118,115},
+    {-128,-128,-128,-50,35,120,127,-8,4,72,124,121,118,115,112,109,106},
+    {-128,-128,-128,-70,15,100,127,37,-44,23,91,112,109,106,103,100,98},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-123,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-62,-8,13,6,-8,-22,-36,-50,-64,-78,-92,-106,-120},
+    {-128,-128,-128,-128,-60,32,55,76,98,119,127,121,107,93,79,65,36},
+    {-128,-128,-128,-128,-58,34,96,118,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-116,-6,35,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-86,24,37,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-56,54,72,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-25,84,127,111,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-105,5,92,127,73,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-99,-13,72,127,118,81,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-119,-33,52,127,127,33,100,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-53,32,117,127,67,52,119,127,127,127,127,127,127,127},
+    {-128,-128,-128,-73,12,97,127,112,3,70,127,127,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-117,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-56,-11,11,12,-2,-16,-30,-44,-58,-72,-86,-100},
+    {-128,-128,-128,-128,-128,-55,31,52,74,95,117,127,127,113,99,85,71},
+    {-128,-128,-128,-128,-128,-53,39,93,115,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-114,-51,40,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-84,11,42,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-54,56,44,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-24,86,85,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-103,6,116,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-73,37,127,127,97,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-56,29,114,127,127,99,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-76,9,94,127,127,50,118,127,127,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-111,-125,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-51,-14,8,18,4,-10,-24,-38,-52,-66,-80},
+    {-128,-128,-128,-128,-128,-128,-50,28,49,71,93,114,127,127,119,105,91},
+    {-128,-128,-128,-128,-128,-128,-48,44,91,112,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-113,-46,46,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-83,-45,47,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-53,25,49,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-22,87,51,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-102,8,117,98,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-72,38,127,127,127,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-42,68,127,127,121,127,127,127,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-105,-119,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-46,-16,5,24,10,-4,-18,-32,-46,-60},
+    {-128,-128,-128,-128,-128,-128,-128,-44,25,47,68,90,112,127,127,125,111},
+    {-128,-128,-128,-128,-128,-128,-128,-43,49,88,110,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-41,51,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-81,-39,52,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-51,-38,54,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-21,38,56,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-100,9,119,57,127,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-70,39,127,112,127,127,127,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-99,-113,-127,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-41,-19,3,24,16,2,-12,-26,-40},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-39,23,44,66,87,109,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-38,54,86,107,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-36,56,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-117,-34,58,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-50,-33,59,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-19,-31,61,127,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-99,11,52,63,127,127,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-93,-107,-121,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-43,-21,0,22,22,8,-6,-20},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-126,-34,20,41,63,85,106,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-124,-32,59,83,104,126,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-123,-31,61,124,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-121,-29,63,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-104,-27,64,127,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-18,-26,66,127,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-124,-87,-101,-116,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-122,-46,-24,-3,19,28,14,0},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-121,-29,17,39,60,82,104,125},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-119,-27,59,80,102,123,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-117,-26,66,122,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-116,-24,68,127,127,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-114,-22,70,127,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-119,-90,-96,-110,-124,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-117,-48,-27,-5,16,33,19},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-116,-24,15,36,58,79,101},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-114,-22,56,78,99,121,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-112,-20,71,119,127,127,127},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-111,-19,73,127,127,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-114,-92,-90,-104,-118,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-112,-51,-29,-8,14,35},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-110,-19,12,34,55,77},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-109,-17,53,75,97,118},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-107,-15,77,116,127,127},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-117,-95,-84,-98,-112},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-107,-54,-32,-10,11},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-105,-13,9,31,52},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-104,-12,51,72,94},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-119,-98,-78,-92},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-102,-56,-35,-13},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-100,-15,7,28},
+  },
+  {
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-122,-100,-79},
+    {-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-128,-97,-59,-37},
+  },
+};
+
+#endif  // FIRE_NET_GRID_TABLE_H_
@@ -0,0 +1,109 @@
+#include "fire_net_temporal.h"
+#include "fire_net_temporal_weights.h"
+
+// Number formats (see real_model/export_temporal.py):
+//   input       ... ADC counts <0, FIRE_NET_TEMPORAL_ADC_MAX> shifted to Q12
+//                   of reading / 1024
+//   w, u, wo    ... Q12, products with input and state are summed in Q24
+//                   with the biases, the exporter guarantees they fit int32
+//   state, n    ... Q12, pre-activations are rounded to Q12 from Q24
+//   z, r        ... sigmoid in Q15, r goes to Q12 for r * (h Un + bn_rec)
+// tanh(a) = 2 sigmoid(2 a) - 1 shares the sigmoid table.
+
+static_assert(FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN == FIRE_NET_TEMPORAL_HIDDEN,
+              "retrained net, set FIRE_NET_TEMPORAL_HIDDEN in fire_net_temporal.h");
+
+#define HIDDEN FIRE_NET_TEMPORAL_HIDDEN
+#define FRAC FIRE_NET_TEMPORAL_FRAC
+#define GATE_FRAC FIRE_NET_TEMPORAL_GATE_FRAC
+#define PROB_SCALE 10000
+
+static int32_t clampInput(int x) {
+  if (x < 0) {
+    return 0;
+  }
+  if (x > FIRE_NET_TEMPORAL_ADC_MAX) {
+    return FIRE_NET_TEMPORAL_ADC_MAX;
+  }
+  return x;
+}
+
+// Q24 to Q12 with rounding, arithmetic shift rounds toward -inf
+static int32_t toQ12(int32_t acc) {
+  return (acc + (1 << (FRAC - 1))) >> FRAC;
+}
+
+// Tabulated sigmoid of a in Q12, returns Q15
+static int32_t sigmoidQ15(int32_t a) {
+  // sigmoid(-a) = 1 - sigmoid(a), so only positive half is tabulated
+  const int32_t one = fire_net_temporal_sigmoid[FIRE_NET_TEMPORAL_SIGMOID_LEN - 1];
+  const int interp_bits = FRAC - FIRE_NET_TEMPORAL_SIGMOID_STEP_BITS;
+  bool negative = a < 0;
+  uint32_t z = negative ? (uint32_t)(-a) : (uint32_t)a;
+
+  uint32_t idx = z >> interp_bits;
+  int32_t p;
+  if (idx >= FIRE_NET_TEMPORAL_SIGMOID_LEN - 1) {
+    p = one;
+  } else {
+    // linear interpolation between two neighbouring table entries
+    int32_t t = z & ((1u << interp_bits) - 1);
+    int32_t lo = fire_net_temporal_sigmoid[idx];
+    int32_t hi = fire_net_temporal_sigmoid[idx + 1];
+    p = lo + (((hi - lo) * t + (1 << (interp_bits - 1))) >> interp_bits);
+  }
+  return negative ? one - p : p;
+}
+
+// tanh of a in Q12, returns Q12
+static int32_t tanhQ12(int32_t a) {
+  return (2 * sigmoidQ15(2 * a) - (1 << GATE_FRAC) + 4) >> (GATE_FRAC - FRAC);
+}
+
+// Q24 sum of the state products of a row of u
+static int32_t stateSum(const int16_t *u, const int16_t *h) {
+  int32_t acc = 0;
+  for (int k = 0; k < HIDDEN; k++) {
+    acc += (int32_t)u[k] * h[k];
+  }
+  return acc;
+}
+
+// Q24 sum of the bias and input products of gate row
+static int32_t inputSum(int row, const int32_t *x) {
+  return fire_net_temporal_b[row]
+       + x[0] * fire_net_temporal_w[row][0]
+       + x[1] * fire_net_temporal_w[row][1]
+       + x[2] * fire_net_temporal_w[row][2];
+}
+
+void FireNetTemporal::reset() {
+  for (int j = 0; j < HIDDEN; j++) {
+    h_[j] = 0;
+  }
+}
+
+uint16_t FireNetTemporal::step(int smoke, int flame, int gas) {
+  const int32_t x[3] = {clampInput(smoke) << FIRE_NET_TEMPORAL_INPUT_SHIFT,
+                        clampInput(flame) << FIRE_NET_TEMPORAL_INPUT_SHIFT,
+                        clampInput(gas) << FIRE_NET_TEMPORAL_INPUT_SHIFT};
+
+  // every neuron reads the whole previous state
+  int16_t next[HIDDEN];
+  for (int j = 0; j < HIDDEN; j++) {
+    int32_t z = sigmoidQ15(toQ12(inputSum(j, x) + stateSum(fire_net_temporal_u[j], h_)));
+    int32_t r = sigmoidQ15(toQ12(inputSum(HIDDEN + j, x) + stateSum(fire_net_temporal_u[HIDDEN + j], h_)));
+    int32_t hn = toQ12(fire_net_temporal_bn_rec[j] + stateSum(fire_net_temporal_u[2 * HIDDEN + j], h_));
+    int32_t r12 = (r + 4) >> (GATE_FRAC - FRAC);
+    int32_t a_n = toQ12(inputSum(2 * HIDDEN + j, x)) + ((r12 * hn + (1 << (FRAC - 1))) >> FRAC);
+    int32_t n = tanhQ12(a_n);
+    // h' = z h + (1 - z) n
+    next[j] = (int16_t)(n + ((z * (h_[j] - n) + (1 << (GATE_FRAC - 1))) >> GATE_FRAC));
+  }
+  for (int j = 0; j < HIDDEN; j++) {
+    h_[j] = next[j];
+  }
+
+  int32_t logit = toQ12(fire_net_temporal_bo + stateSum(fire_net_temporal_wo, h_));
+  return (uint16_t)((sigmoidQ15(logit) * PROB_SCALE + (1 << (GATE_FRAC - 1))) >> GATE_FRAC);
+}
@@ -0,0 +1,33 @@
+#ifndef FIRE_NET_TEMPORAL_H_
+#define FIRE_NET_TEMPORAL_H_
+
+#include <stdint.h>
+
+// Stateful integer inference of the temporal fire net, a GRU cell followed
+// by Dense(1, sigmoid). Every measurement cycle is one step: the readings
+// update the hidden state, which keeps the history of the session (a
+// growing fire against a steady one of the same readings), so nothing is
+// recomputed over a window. Inputs are raw 10 bit ADC averages, no float
+// operation is used and the state is the only RAM. Weights are trained by
+// real_model/train_temporal.py and generated by real_model/export_temporal.py
+// into fire_net_temporal_weights.h.
+#define FIRE_NET_TEMPORAL_HIDDEN 8  // hidden units, --hidden of train_temporal.py
+
+class FireNetTemporal {
+ public:
+  FireNetTemporal() { reset(); }
+
+  // State of a new session (zeros, as in training)
+  void reset();
+  // Updates the state by the readings of one cycle, returns fire probability
+  // scaled by 10000 (same as PROB_SCALE in the firmware)
+  uint16_t step(int smoke, int flame, int gas);
+
+  // Hidden state in Q12, <-4096, 4096>
+  const int16_t *state() const { return h_; }
+
+ private:
+  int16_t h_[FIRE_NET_TEMPORAL_HIDDEN];
+};
+
+#endif  // FIRE_NET_TEMPORAL_H_
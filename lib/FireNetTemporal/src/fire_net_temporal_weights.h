@@ -0,0 +1,117 @@
+// Generated by real_model/export_temporal.py from model_temporal.npz, do not edit.
+#ifndef FIRE_NET_TEMPORAL_WEIGHTS_H_
+#define FIRE_NET_TEMPORAL_WEIGHTS_H_
+
+#include <stdint.h>
+
+#define FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN 8
+#define FIRE_NET_TEMPORAL_ADC_MAX 1023
+#define FIRE_NET_TEMPORAL_INPUT_SHIFT 2
+#define FIRE_NET_TEMPORAL_FRAC 12
+#define FIRE_NET_TEMPORAL_GATE_FRAC 15
+#define FIRE_NET_TEMPORAL_SIGMOID_STEP_BITS 4
+#define FIRE_NET_TEMPORAL_SIGMOID_LEN 257
+
+// input weights in Q12, rows z, r, n of every neuron (smoke, flame, gas)
+static const int16_t fire_net_temporal_w[3 * FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN][3] = {
+  -5414, 561, -1874,
+  -6159, -793, -1744,
+  -2082, 3204, -1155,
+  -4088, -1678, -3115,
+  1041, 1182, 4226,
+  -6846, -3751, -6128,
+  5985, 4097, 1106,
+  -9500, -1570, -2912,
+  481, 2591, 4283,
+  -3848, 3224, 1492,
+  2274, 580, 2313,
+  -185, -2769, -3383,
+  -482, -3014, -2303,
+  2146, 1713, 5338,
+  3661, -645, -1587,
+  579, 3428, -2048,
+  -1777, 1731, 1129,
+  -3143, 62, -1173,
+  -1981, 1205, 1595,
+  1477, -1536, -3078,
+  -1197, -1565, -3423,
+  -2939, 2066, -337,
+  -4146, 1403, -2284,
+  4845, -684, -1020
+};
+
+// recurrent weights in Q12, rows z, r, n of every neuron
+static const int16_t fire_net_temporal_u[3 * FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN][FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {
+  -7558, -3184, -5872, 10023, 10083, 3346, -2716, 5097,
+  -3875, -2593, -1993, -954, -1235, 1782, 1571, 3898,
+  -1516, -4788, -3384, -2594, -388, 5478, 2523, 1811,
+  -4713, -3570, -5961, 886, -5239, -7520, -3894, -2455,
+  3425, 9954, 8169, -5994, -4994, 217, -6662, -10384,
+  -2685, 3159, -2811, 1199, -2054, -7098, 6883, 3532,
+  -8185, -6591, -8064, 4037, -3829, -3108, -4799, 6839,
+  -6518, -7690, -8244, 5186, 7160, -3556, -5023, 5176,
+  1470, 2682, -368, -5221, -3071, 2247, -3786, -1624,
+  673, -919, 392, -3930, -2756, 12, -951, -3818,
+  466, -986, -670, 878, 98, -777, -4134, -1295,
+  -2322, -2000, -1032, 3166, 822, -1705, -714, 4827,
+  -1725, 3030, 2676, 6684, 6215, 3, 3700, 3442,
+  -72, -4517, -1093, -1683, 2764, -4122, -6937, 2319,
+  -1660, -3128, 2122, 3346, 2722, -682, -4586, 3784,
+  4540, 3841, 1791, -1782, -3965, 114, 1350, -1369,
+  755, 2079, -1102, -3689, -2361, 1316, 4811, -763,
+  2972, 130, 52, -1762, -443, 1481, 4322, -4303,
+  450, 5716, 2162, 444, 4102, 818, 5173, -1769,
+  1614, -883, 179, 336, 3137, -511, 556, 3387,
+  743, -953, -4465, 2757, 2022, 2848, -342, 1595,
+  1659, 2642, 521, 4565, 1606, -116, 6822, 839,
+  -3890, 259, 22, 2304, 3310, -355, 4247, 348,
+  -809, -1923, -362, 2456, 2041, 1840, 16, 2876
+};
+
+// input bias in Q24, rows z, r, n
+static const int32_t fire_net_temporal_b[3 * FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {
+  15266510, -235396, 3276732, -4611344, 7920271, -14806420, 14863514, 2099779,
+  2268269, 2947177, 10337757, -2037481, 3646300, 5976827, 173268, -2159986,
+  805683, 103493, 280558, 3555934, 4431499, 6587658, -2936579, 3157833
+};
+
+// recurrent bias of n in Q24
+static const int32_t fire_net_temporal_bn_rec[FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {
+  1267538, 711378, -2171252, 6031058, 10479864, 1224107, -8624437, 1963028
+};
+
+// output layer weights in Q12
+static const int16_t fire_net_temporal_wo[FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {
+  -5393, -6509, -5928, -4040, -3407, -8084, -3806, 2301
+};
+
+// output layer bias in Q24
+static const int32_t fire_net_temporal_bo = -6967218;
+
+// sigmoid(k / 16) in Q15 for k = 0 .. FIRE_NET_TEMPORAL_SIGMOID_LEN - 1
+static const uint16_t fire_net_temporal_sigmoid[FIRE_NET_TEMPORAL_SIGMOID_LEN] = {
+  16384, 16896, 17407, 17916, 18421, 18923, 19420, 19912, 20397, 20874, 21344, 21804,
+  22255, 22696, 23127, 23547, 23955, 24352, 24737, 25110, 25471, 25819, 26155, 26479,
+  26790, 27090, 27377, 27653, 27917, 28169, 28411, 28642, 28862, 29072, 29272, 29462,
+  29644, 29816, 29979, 30135, 30282, 30422, 30555, 30680, 30799, 30912, 31018, 31119,
+  31214, 31304, 31389, 31469, 31545, 31616, 31684, 31747, 31807, 31864, 31917, 31968,
+  32015, 32060, 32102, 32141, 32179, 32214, 32247, 32278, 32307, 32335, 32361, 32385,
+  32408, 32430, 32450, 32469, 32487, 32504, 32520, 32535, 32549, 32562, 32574, 32586,
+  32597, 32607, 32617, 32626, 32635, 32643, 32650, 32657, 32664, 32670, 32676, 32682,
+  32687, 32692, 32696, 32701, 32705, 32709, 32712, 32716, 32719, 32722, 32725, 32727,
+  32730, 32732, 32734, 32736, 32738, 32740, 32742, 32743, 32745, 32746, 32747, 32749,
+  32750, 32751, 32752, 32753, 32754, 32755, 32756, 32756, 32757, 32758, 32758, 32759,
+  32759, 32760, 32760, 32761, 32761, 32762, 32762, 32762, 32763, 32763, 32763, 32764,
+  32764, 32764, 32764, 32765, 32765, 32765, 32765, 32765, 32766, 32766, 32766, 32766,
+  32766, 32766, 32766, 32766, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+  32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+  32768, 32768, 32768, 32768, 32768
+};
+
+#endif  // FIRE_NET_TEMPORAL_WEIGHTS_H_
@@ -0,0 +1,39 @@
+#ifndef LORA_AIRTIME_H_
+#define LORA_AIRTIME_H_
+
+#include <stdint.h>
+
+// Time on air of a LoRa packet (Semtech AN1200.13, SX1272 datasheet 4.1.1.7).
+// Default settings are the ones used by the nodes (lora.begin() defaults of
+// LoRaLib): SF9, BW 125 kHz, CR 4/7, 8 symbol preamble, explicit header, CRC.
+struct LoRaSettings {
+  uint8_t sf = 9;
+  float bw_khz = 125.0f;
+  uint8_t cr = 7;            // coding rate denominator 5 .. 8
+  uint16_t preamble = 8;
+  bool explicit_header = true;
+  bool crc = true;
+};
+
+// Symbol duration in microseconds
+inline uint32_t loraSymbolTimeUs(const LoRaSettings &s) {
+  return (uint32_t)((1UL << s.sf) * 1000.0f / s.bw_khz);
+}
+
+// Packet duration in microseconds for payload of len bytes
+inline uint32_t loraTimeOnAirUs(const LoRaSettings &s, uint16_t len) {
+  const float t_sym = (1UL << s.sf) * 1000.0f / s.bw_khz;
+  // low data rate optimization is mandatory for symbols longer than 16 ms
+  const int de = t_sym > 16000.0f ? 1 : 0;
+  const int h = s.explicit_header ? 0 : 1;
+  int num = 8 * len - 4 * s.sf + 28 + (s.crc ? 16 : 0) - 20 * h;
+  int den = 4 * (s.sf - 2 * de);
+  int payload_symbols = 8;
+  if (num > 0) {
+    payload_symbols += ((num + den - 1) / den) * s.cr;
+  }
+  float t_preamble = (s.preamble + 4.25f) * t_sym;
+  return (uint32_t)(t_preamble + payload_symbols * t_sym + 0.5f);
+}
+
+#endif  // LORA_AIRTIME_H_
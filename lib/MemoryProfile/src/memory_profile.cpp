@@ -0,0 +1,13 @@
+#include "memory_profile.h"
+
+void printMemoryUsage(Print &out, const MemoryUsage &usage) {
+  out.print(F("Memory: static "));
+  out.print((unsigned long)usage.static_ram);
+  out.print(F(" B, heap peak "));
+  out.print((unsigned long)usage.heap_peak);
+  out.print(F(" B, stack peak "));
+  out.print((unsigned long)usage.stack_peak);
+  out.print(F(" B, never used "));
+  out.print((unsigned long)usage.free_min);
+  out.println(F(" B"));
+}
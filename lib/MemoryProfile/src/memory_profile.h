@@ -0,0 +1,39 @@
+#ifndef MEMORY_PROFILE_H_
+#define MEMORY_PROFILE_H_
+
+#include <stdint.h>
+#include "Print.h"
+
+// RAM use of the node at run time, the static part (and flash) per module
+// is checked against the budget at build time by host_tools/memory_budget.py
+// from the linker map.
+//
+// paintStack() at the start of setup() fills the free RAM between the heap
+// and the stack with a pattern, the lowest word the stack overwrote since
+// is its high-water mark. The heap is read from the break of sbrk(): the
+// malloc of newlib-nano never gives memory back, so the break is the
+// high-water mark of the heap. The heap growing over painted words does not
+// count as stack, the scan starts at the break.
+//
+// The native build has a stand-in in lib_native, stack of the host (its
+// frames are not those of the Cortex-M0+) and heap use of the firmware.
+#define MEMORY_PAINT 0xC5C5C5C5u
+#define MEMORY_PAINT_GUARD 64  // B below the stack pointer left unpainted
+
+struct MemoryUsage {
+  uint32_t static_ram;  // .data and .bss, the tensor arena included
+  uint32_t heap_peak;   // heap high-water mark
+  uint32_t stack_peak;  // stack high-water mark since paintStack()
+  uint32_t free_min;    // RAM between the two marks, never used
+};
+
+// Paints the free RAM, call it first in setup()
+void paintStack();
+
+// Scans the paint upward from the break, a word compare per 4 B of free
+// RAM (about 40 us per free kB at 32 MHz)
+MemoryUsage memoryUsage();
+
+void printMemoryUsage(Print &out, const MemoryUsage &usage);
+
+#endif  // MEMORY_PROFILE_H_
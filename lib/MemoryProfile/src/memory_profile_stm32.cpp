@@ -0,0 +1,42 @@
+// MemoryProfile on STM32duino: RAM is laid out by the linker script of the
+// variant as .data, .bss, heap (from _end up by _sbrk() of the core) and
+// the main stack (from _estack down).
+#if defined(ARDUINO_ARCH_STM32)
+
+#include <stddef.h>
+#include "Arduino.h"
+#include "memory_profile.h"
+
+extern "C" char _sdata;   // start of .data, first byte of RAM
+extern "C" char _end;     // end of .bss, start of the heap
+extern "C" char _estack;  // top of the stack, end of RAM
+extern "C" void *_sbrk(ptrdiff_t incr);
+
+// Bottom of the paint, the break rounded up to a word
+static uint32_t *heapBreak() {
+  return (uint32_t *)(((uintptr_t)_sbrk(0) + 3) & ~(uintptr_t)3);
+}
+
+void paintStack() {
+  uint32_t *top = (uint32_t *)((__get_MSP() - MEMORY_PAINT_GUARD) & ~(uintptr_t)3);
+  for (volatile uint32_t *p = heapBreak(); p < top; p++) {
+    *p = MEMORY_PAINT;
+  }
+}
+
+MemoryUsage memoryUsage() {
+  uint32_t *brk = heapBreak();
+  const uint32_t *p = brk;
+  // the stack (below it the guard) ends the paint
+  while (p < (const uint32_t *)&_estack && *p == MEMORY_PAINT) {
+    p++;
+  }
+  MemoryUsage usage;
+  usage.static_ram = (uint32_t)(&_end - &_sdata);
+  usage.heap_peak = (uint32_t)((char *)brk - &_end);
+  usage.stack_peak = (uint32_t)(&_estack - (const char *)p);
+  usage.free_min = (uint32_t)((const char *)p - (char *)brk);
+  return usage;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef TFLITE_ARENA_H_
+#define TFLITE_ARENA_H_
+
+#include <stddef.h>
+#include <EloquentTinyML.h>
+
+// TFLite interpreter of EloquentTinyML that tells how much of its tensor
+// arena begin() took: the tensors the memory planner placed and the
+// interpreter's own data (tensor structs, node data, quantization
+// parameters) of TFLite Micro. Size the arena of a model (MODEL_ARENA_SIZE
+// in its model header) by this number on the target, the host benchmark
+// (host_tools bench_tflite) knows only the tensors.
+//
+// Reads the interpreter of EloquentTinyML 0.0.x (protected member) and
+// arena_used_bytes() of its TFLite Micro.
+#define TFLITE_ARENA_MARGIN 64  // B left over the used arena for a new model
+
+template <size_t Inputs, size_t Outputs, size_t ArenaSize>
+class ProfiledTfLite : public Eloquent::TinyML::TfLite<Inputs, Outputs, ArenaSize> {
+ public:
+  // Bytes of the arena in use, 0 before begin()
+  size_t arenaUsed() const { return this->interpreter != nullptr ? this->interpreter->arena_used_bytes() : 0; }
+
+  // Arena size the model needs, used bytes with the margin, 16 B aligned
+  size_t arenaNeeded() const { return (arenaUsed() + TFLITE_ARENA_MARGIN + 15) & ~(size_t)15; }
+};
+
+#endif  // TFLITE_ARENA_H_
@@ -0,0 +1,78 @@
+#include "modem_reader.h"
+#include <string.h>
+
+// Matcher table, lengths are computed by the compiler. Patterns ending with
+// ':' or ' ' match the beginning of the line, others the whole line.
+struct ModemPattern {
+  const char *text;
+  uint8_t len;
+  ModemToken token;
+};
+#define MODEM_PATTERN(text, token) {text, sizeof(text) - 1, token}
+
+static const ModemPattern patterns[] = {
+  MODEM_PATTERN("OK", MODEM_OK),
+  MODEM_PATTERN("ERROR", MODEM_ERROR),
+  MODEM_PATTERN("+CME ERROR:", MODEM_ERROR),
+  MODEM_PATTERN("+CMS ERROR:", MODEM_ERROR),
+  MODEM_PATTERN("CONNECT OK", MODEM_CONNECT_OK),
+  MODEM_PATTERN("ALREADY CONNECT", MODEM_ALREADY_CONNECT),
+  MODEM_PATTERN("CONNECT FAIL", MODEM_CONNECT_FAIL),
+  MODEM_PATTERN("SEND OK", MODEM_SEND_OK),
+  MODEM_PATTERN("SEND FAIL", MODEM_SEND_FAIL),
+  MODEM_PATTERN("CLOSE OK", MODEM_CLOSE_OK),
+  MODEM_PATTERN("DEACT OK", MODEM_DEACT_OK),
+  MODEM_PATTERN("CLOSED", MODEM_CLOSED),
+  MODEM_PATTERN("+PDP DEACT", MODEM_PDP_DEACT),
+  MODEM_PATTERN("+QIRDI:", MODEM_DATA),
+  MODEM_PATTERN("+QIRD:", MODEM_READ),
+  MODEM_PATTERN("RING", MODEM_RING),
+};
+
+static const char *const token_names[MODEM_TOKENS] = {
+  "none", "line", ">", "OK", "ERROR", "CONNECT OK", "ALREADY CONNECT", "CONNECT FAIL", "SEND OK",
+  "SEND FAIL", "CLOSE OK", "DEACT OK", "CLOSED", "+PDP DEACT", "+QIRDI", "+QIRD", "RING",
+};
+
+ModemToken ModemReader::feed(char c) {
+  if (c == '\n') {
+    if (len_ == 0) {
+      return MODEM_NONE;
+    }
+    line_[len_] = '\0';
+    size_t len = len_;
+    len_ = 0;
+    return classify(line_, len);
+  }
+  if (c == '\r' || (c == ' ' && len_ == 0)) {
+    return MODEM_NONE;
+  }
+  if (c == '>' && len_ == 0) {
+    line_[0] = '>';
+    line_[1] = '\0';
+    return MODEM_PROMPT;
+  }
+  if (len_ < MODEM_LINE_LEN - 1) {
+    line_[len_++] = c;
+  }
+  return MODEM_NONE;
+}
+
+ModemToken ModemReader::classify(const char *line, size_t len) {
+  for (const ModemPattern &p : patterns) {
+    char last = p.text[p.len - 1];
+    bool prefix = last == ':' || last == ' ';
+    if ((prefix ? len >= p.len : len == p.len) && memcmp(line, p.text, p.len) == 0) {
+      return p.token;
+    }
+  }
+  return MODEM_LINE;
+}
+
+bool ModemReader::isFailure(ModemToken token) {
+  return token == MODEM_ERROR || token == MODEM_CONNECT_FAIL || token == MODEM_SEND_FAIL;
+}
+
+const char *ModemReader::name(ModemToken token) {
+  return token < MODEM_TOKENS ? token_names[token] : "?";
+}
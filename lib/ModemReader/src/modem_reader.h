@@ -0,0 +1,65 @@
+#ifndef MODEM_READER_H_
+#define MODEM_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation-free tokenizer of Quectel M95 responses. Characters are fed
+// one by one as they come from the serial line, complete lines are
+// assembled in a fixed buffer and classified once by a constant table of
+// final responses and URCs, so callers compare tokens instead of strings.
+//
+// Lines longer than MODEM_LINE_LEN - 1 are cut (the rest is dropped), they
+// are still classified by their beginning.
+#define MODEM_LINE_LEN 64
+
+enum ModemToken : uint8_t {
+  MODEM_NONE,             // line not complete yet
+  MODEM_LINE,             // other line (information response like "+CGATT: 1")
+  MODEM_PROMPT,           // "> " of AT+QISEND, has no end of line
+  MODEM_OK,
+  MODEM_ERROR,            // "ERROR", "+CME ERROR: <n>", "+CMS ERROR: <n>"
+  MODEM_CONNECT_OK,
+  MODEM_ALREADY_CONNECT,
+  MODEM_CONNECT_FAIL,
+  MODEM_SEND_OK,
+  MODEM_SEND_FAIL,
+  MODEM_CLOSE_OK,
+  MODEM_DEACT_OK,
+  // URCs
+  MODEM_CLOSED,           // remote side closed the connection
+  MODEM_PDP_DEACT,        // "+PDP DEACT", network deactivated the context
+  MODEM_DATA,             // "+QIRDI: ...", data received (AT+QINDI=1)
+  MODEM_READ,             // "+QIRD: <address>,<type>,<length>", header of AT+QIRD data
+  MODEM_RING,
+  MODEM_TOKENS
+};
+
+class ModemReader {
+ public:
+  ModemReader() : len_(0) { line_[0] = '\0'; }
+
+  // Takes one character, returns the token of the line it completed or
+  // MODEM_NONE. Empty lines and the space after the prompt are skipped.
+  ModemToken feed(char c);
+
+  // Last complete line, valid until the next feed()
+  const char *line() const { return line_; }
+
+  // Drops the partial line, e.g. before raw data follows
+  void reset() { len_ = 0; }
+
+  static ModemToken classify(const char *line, size_t len);
+
+  // ERROR and the FAIL responses
+  static bool isFailure(ModemToken token);
+
+  // Name of the token for diagnostics
+  static const char *name(ModemToken token);
+
+ private:
+  char line_[MODEM_LINE_LEN];
+  uint8_t len_;
+};
+
+#endif  // MODEM_READER_H_
@@ -0,0 +1,263 @@
+#include "mqtt_publisher.h"
+#include <string.h>
+
+// packet types (upper nibble of the fixed header)
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH 0x30
+#define MQTT_PUBACK 0x40
+#define MQTT_PINGREQ 0xC0
+#define MQTT_PINGRESP 0xD0
+#define MQTT_DISCONNECT 0xE0
+
+#define MQTT_QOS1 0x02
+#define MQTT_DUP 0x08
+
+MqttPublisher::MqttPublisher(Client &client)
+    : client_(client), keep_alive_s_(0), packet_id_(0), last_tx_(0), ping_sent_(0), connect_start_(0),
+      ping_outstanding_(false), connecting_(false), connected_(false), published_(0), retransmits_(0), pings_(0) {}
+
+bool MqttPublisher::connect(const char *host, uint16_t port, const char *client_id, uint16_t keep_alive_s) {
+  connected_ = false;
+  if (!client_.connect(host, port) || !begin(client_id, keep_alive_s)) {
+    return false;
+  }
+  int result;
+  while ((result = pollConnect()) == 0) {
+    delay(MQTT_POLL_MS);
+  }
+  return result > 0;
+}
+
+bool MqttPublisher::begin(const char *client_id, uint16_t keep_alive_s) {
+  connected_ = false;
+  // variable header: protocol name, level 4, flags (clean session), keep-alive
+  static const uint8_t header[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02};
+  memcpy(buffer_, header, sizeof(header));
+  buffer_[8] = keep_alive_s >> 8;
+  buffer_[9] = keep_alive_s & 0xFF;
+  uint16_t len = putString(10, client_id, strlen(client_id));
+  if (!len || !send(MQTT_CONNECT, len)) {
+    drop();
+    return false;
+  }
+  keep_alive_s_ = keep_alive_s;
+  connect_start_ = millis();
+  connecting_ = true;
+  return true;
+}
+
+int MqttPublisher::pollConnect() {
+  if (!connecting_) {
+    return connected() ? 1 : -1;
+  }
+  uint8_t type;
+  uint16_t len;
+  while (client_.available()) {
+    if (readPacket(&type, &len, MQTT_ACK_TIMEOUT_MS) <= 0) {
+      drop();
+      return -1;
+    }
+    if ((type & 0xF0) == MQTT_CONNACK) {
+      // return code 0 is accepted
+      if (len != 2 || buffer_[1] != 0) {
+        drop();
+        return -1;
+      }
+      connecting_ = false;
+      connected_ = true;
+      ping_outstanding_ = false;
+      return 1;
+    }
+  }
+  if (client_.connected() && millis() - connect_start_ < MQTT_CONNACK_TIMEOUT_MS) {
+    return 0;
+  }
+  drop();
+  return -1;
+}
+
+bool MqttPublisher::publish(const char *topic, const uint8_t *payload, uint16_t len) {
+  if (!connected()) {
+    return false;
+  }
+  if (++packet_id_ == 0) {
+    packet_id_ = 1;  // 0 is not a valid packet id
+  }
+  for (uint8_t attempt = 0; attempt < MQTT_PUBLISH_TRIES; attempt++) {
+    // built again on every try, reading the acknowledgement overwrites buffer_
+    uint16_t pos = putPublish(topic, payload, len);
+    if (!pos) {
+      return false;  // too long for the buffer
+    }
+    if (attempt) {
+      retransmits_++;
+    }
+    if (!send(MQTT_PUBLISH | MQTT_QOS1 | (attempt ? MQTT_DUP : 0), pos)) {
+      break;
+    }
+    unsigned long start = millis();
+    uint8_t type;
+    uint16_t body_len;
+    while (millis() - start < MQTT_ACK_TIMEOUT_MS) {
+      int result = readPacket(&type, &body_len, MQTT_ACK_TIMEOUT_MS - (millis() - start));
+      if (result < 0) {
+        drop();
+        return false;
+      }
+      if (result == 0) {
+        break;
+      }
+      if ((type & 0xF0) == MQTT_PUBACK && body_len == 2 && ((buffer_[0] << 8) | buffer_[1]) == packet_id_) {
+        published_++;
+        return true;
+      }
+      if ((type & 0xF0) == MQTT_PINGRESP) {
+        ping_outstanding_ = false;
+      }
+    }
+  }
+  drop();
+  return false;
+}
+
+bool MqttPublisher::loop() {
+  if (!connected()) {
+    return false;
+  }
+  unsigned long now = millis();
+  uint8_t type;
+  uint16_t len;
+  while (client_.available()) {
+    if (readPacket(&type, &len, MQTT_ACK_TIMEOUT_MS) <= 0) {
+      drop();
+      return false;
+    }
+    if ((type & 0xF0) == MQTT_PINGRESP) {
+      ping_outstanding_ = false;
+    }
+  }
+  if (ping_outstanding_ && now - ping_sent_ >= (unsigned long)keep_alive_s_ * 1000) {
+    drop();  // broker or network gone
+    return false;
+  }
+  if (!ping_outstanding_ && keep_alive_s_ && now - last_tx_ >= (unsigned long)keep_alive_s_ * 1000) {
+    if (!send(MQTT_PINGREQ, 0)) {
+      drop();
+      return false;
+    }
+    pings_++;
+    ping_sent_ = now;
+    ping_outstanding_ = true;
+  }
+  return true;
+}
+
+bool MqttPublisher::connected() {
+  if (connected_ && !client_.connected()) {
+    connected_ = false;
+  }
+  return connected_;
+}
+
+void MqttPublisher::disconnect() {
+  if (connected()) {
+    send(MQTT_DISCONNECT, 0);
+  }
+  drop();
+}
+
+// Sends fixed header and len bytes of buffer_ as one write
+bool MqttPublisher::send(uint8_t header, uint16_t len) {
+  uint8_t fixed[4];
+  uint8_t n = 0;
+  fixed[n++] = header;
+  uint16_t remaining = len;
+  do {
+    uint8_t digit = remaining % 128;
+    remaining /= 128;
+    fixed[n++] = remaining ? digit | 0x80 : digit;
+  } while (remaining);
+  // shift the body to make one packet of it, one AT+QISEND on the modem
+  if (n + len > MQTT_BUFFER_LEN) {
+    return false;
+  }
+  memmove(buffer_ + n, buffer_, len);
+  memcpy(buffer_, fixed, n);
+  if (client_.write(buffer_, n + len) != (size_t)(n + len)) {
+    return false;
+  }
+  last_tx_ = millis();
+  return true;
+}
+
+// Reads one packet, the body goes to buffer_. Returns 1 on packet, 0 on
+// timeout before it started, -1 on a broken or oversized packet.
+int MqttPublisher::readPacket(uint8_t *header, uint16_t *len, unsigned long timeout_ms) {
+  unsigned long start = millis();
+  if (!readByte(header, start, timeout_ms)) {
+    return 0;
+  }
+  uint32_t length = 0;
+  uint8_t digit;
+  uint8_t shift = 0;
+  do {
+    if (shift > 21 || !readByte(&digit, start, timeout_ms + MQTT_ACK_TIMEOUT_MS)) {
+      return -1;
+    }
+    length |= (uint32_t)(digit & 0x7F) << shift;
+    shift += 7;
+  } while (digit & 0x80);
+  if (length > MQTT_BUFFER_LEN) {
+    return -1;
+  }
+  for (uint16_t i = 0; i < length; i++) {
+    if (!readByte(buffer_ + i, start, timeout_ms + MQTT_ACK_TIMEOUT_MS)) {
+      return -1;
+    }
+  }
+  *len = (uint16_t)length;
+  return 1;
+}
+
+bool MqttPublisher::readByte(uint8_t *value, unsigned long start, unsigned long timeout_ms) {
+  while (!client_.available()) {
+    if (millis() - start >= timeout_ms || !client_.connected()) {
+      return false;
+    }
+    delay(MQTT_POLL_MS);
+  }
+  *value = (uint8_t)client_.read();
+  return true;
+}
+
+// Variable header and payload of PUBLISH, returns the length or 0 if it does not fit
+uint16_t MqttPublisher::putPublish(const char *topic, const uint8_t *payload, uint16_t len) {
+  uint16_t pos = putString(0, topic, strlen(topic));
+  // with the packet id and up to 3 bytes of fixed header
+  if (!pos || pos + 2 + len + 3 > MQTT_BUFFER_LEN) {
+    return 0;
+  }
+  buffer_[pos++] = packet_id_ >> 8;
+  buffer_[pos++] = packet_id_ & 0xFF;
+  memcpy(buffer_ + pos, payload, len);
+  return pos + len;
+}
+
+// Length prefixed string at pos, returns the position after it or 0 if it does not fit
+uint16_t MqttPublisher::putString(uint16_t pos, const char *s, uint16_t len) {
+  if (pos + 2 + len > MQTT_BUFFER_LEN) {
+    return 0;
+  }
+  buffer_[pos] = len >> 8;
+  buffer_[pos + 1] = len & 0xFF;
+  memcpy(buffer_ + pos + 2, s, len);
+  return pos + 2 + len;
+}
+
+void MqttPublisher::drop() {
+  connecting_ = false;
+  connected_ = false;
+  ping_outstanding_ = false;
+  client_.stop();
+}
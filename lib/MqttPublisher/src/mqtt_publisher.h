@@ -0,0 +1,74 @@
+#ifndef MQTT_PUBLISHER_H_
+#define MQTT_PUBLISHER_H_
+
+#include <Arduino.h>
+#include <Client.h>
+
+// Minimal MQTT 3.1.1 client that publishes with QoS 1 over any Arduino
+// Client. PubSubClient only publishes with QoS 0, so a reading lost with a
+// dropped GPRS connection would not be noticed; here publish() returns only
+// after PUBACK and retransmits with the DUP flag otherwise. Nothing is
+// allocated, packets are built in a fixed buffer.
+#define MQTT_BUFFER_LEN 128
+#define MQTT_CONNACK_TIMEOUT_MS 10000
+#define MQTT_ACK_TIMEOUT_MS 5000
+#define MQTT_PUBLISH_TRIES 3
+#define MQTT_POLL_MS 10  // wait between polls of the client
+
+class MqttPublisher {
+ public:
+  explicit MqttPublisher(Client &client);
+
+  // Opens the connection and the session (clean session), true on CONNACK
+  // accepted. Blocks for the TCP connect and CONNACK.
+  bool connect(const char *host, uint16_t port, const char *client_id, uint16_t keep_alive_s);
+
+  // Starts the session (clean session) over a connection opened outside of
+  // the publisher, e.g. by an AtEngine script: sends CONNECT and returns
+  // without waiting. False when CONNECT cannot be sent.
+  bool begin(const char *client_id, uint16_t keep_alive_s);
+
+  // CONNACK of begin(), call from loop(). Takes only data already received:
+  // 1 when the session is accepted, 0 while CONNACK did not come, -1 when
+  // refused, the connection closed or no CONNACK in MQTT_CONNACK_TIMEOUT_MS.
+  int pollConnect();
+
+  // QoS 1 publish, true when acknowledged by PUBACK. On false the connection
+  // is closed and the message has to be published again after reconnect.
+  bool publish(const char *topic, const uint8_t *payload, uint16_t len);
+
+  // Keep-alive, call often. Returns false when the connection is lost (no
+  // PINGRESP within keep-alive, or closed by the network).
+  bool loop();
+
+  bool connected();
+  void disconnect();
+
+  uint32_t published() const { return published_; }
+  uint32_t retransmits() const { return retransmits_; }
+  uint32_t pings() const { return pings_; }
+
+ private:
+  bool send(uint8_t header, uint16_t len);
+  int readPacket(uint8_t *header, uint16_t *len, unsigned long timeout_ms);
+  bool readByte(uint8_t *value, unsigned long start, unsigned long timeout_ms);
+  uint16_t putPublish(const char *topic, const uint8_t *payload, uint16_t len);
+  uint16_t putString(uint16_t pos, const char *s, uint16_t len);
+  void drop();
+
+  Client &client_;
+  uint8_t buffer_[MQTT_BUFFER_LEN];
+  uint16_t keep_alive_s_;
+  uint16_t packet_id_;
+  unsigned long last_tx_;
+  unsigned long ping_sent_;
+  unsigned long connect_start_;
+  bool ping_outstanding_;
+  bool connecting_;  // CONNECT sent, CONNACK not yet
+  bool connected_;
+  uint32_t published_;
+  uint32_t retransmits_;
+  uint32_t pings_;
+};
+
+#endif  // MQTT_PUBLISHER_H_
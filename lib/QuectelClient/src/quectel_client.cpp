@@ -0,0 +1,197 @@
+#include "quectel_client.h"
+#include <stdio.h>
+#include <string.h>
+
+QuectelClient::QuectelClient(Stream &modem)
+    : modem_(modem), rx_pos_(0), rx_len_(0), connected_(false), data_pending_(false), sent_(0),
+      received_(0) {}
+
+int QuectelClient::connect(IPAddress ip, uint16_t port) {
+  char host[16];
+  snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return connect(host, port);
+}
+
+int QuectelClient::connect(const char *host, uint16_t port) {
+  rx_pos_ = rx_len_ = 0;
+  data_pending_ = false;
+  modem_.print(F("AT+QIOPEN=\"TCP\",\""));
+  modem_.print(host);
+  modem_.print(F("\",\""));
+  modem_.print(port);
+  modem_.print(F("\"\r\n"));
+  if (!waitFor(MODEM_OK, QUECTEL_AT_TIMEOUT_MS)) {
+    return 0;
+  }
+  // "CONNECT OK", or "ALREADY CONNECT" when the previous one was not closed
+  connected_ = waitFor(MODEM_CONNECT_OK, QUECTEL_CONNECT_TIMEOUT_MS, MODEM_ALREADY_CONNECT);
+  return connected_ ? 1 : 0;
+}
+
+void QuectelClient::opened() {
+  rx_pos_ = rx_len_ = 0;
+  data_pending_ = false;
+  connected_ = true;
+}
+
+size_t QuectelClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t QuectelClient::write(const uint8_t *buffer, size_t size) {
+  size_t written = 0;
+  while (connected_ && written < size) {
+    size_t len = size - written < QUECTEL_SEND_MAX ? size - written : QUECTEL_SEND_MAX;
+    modem_.print(F("AT+QISEND="));
+    modem_.print((unsigned int)len);
+    modem_.print(F("\r\n"));
+    if (!waitFor(MODEM_PROMPT, QUECTEL_AT_TIMEOUT_MS)) {
+      break;
+    }
+    modem_.write(buffer + written, len);
+    if (!waitFor(MODEM_SEND_OK, QUECTEL_SEND_TIMEOUT_MS)) {
+      break;
+    }
+    written += len;
+    sent_ += len;
+  }
+  return written;
+}
+
+int QuectelClient::available() {
+  if (rx_pos_ < rx_len_) {
+    return rx_len_ - rx_pos_;
+  }
+  // URCs that came meanwhile, without waiting
+  for (ModemToken token = pollToken(); token != MODEM_NONE; token = pollToken()) {
+    handleUrc(token);
+  }
+  if (data_pending_ && fetch()) {
+    return rx_len_ - rx_pos_;
+  }
+  return 0;
+}
+
+int QuectelClient::read() {
+  if (!available()) {
+    return -1;
+  }
+  return rx_[rx_pos_++];
+}
+
+int QuectelClient::read(uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (n < size && available()) {
+    buffer[n++] = rx_[rx_pos_++];
+  }
+  return (int)n;
+}
+
+int QuectelClient::peek() {
+  if (!available()) {
+    return -1;
+  }
+  return rx_[rx_pos_];
+}
+
+void QuectelClient::stop() {
+  if (connected_) {
+    modem_.print(F("AT+QICLOSE\r\n"));
+    waitFor(MODEM_CLOSE_OK, QUECTEL_AT_TIMEOUT_MS);
+  }
+  connected_ = false;
+  data_pending_ = false;
+  rx_pos_ = rx_len_ = 0;
+}
+
+uint8_t QuectelClient::connected() {
+  if (connected_ && rx_pos_ == rx_len_) {
+    for (ModemToken token = pollToken(); token != MODEM_NONE; token = pollToken()) {
+      handleUrc(token);
+    }
+  }
+  // data received before the connection closed can still be read
+  return connected_ || rx_pos_ < rx_len_;
+}
+
+// Next token from the modem, MODEM_NONE on timeout
+ModemToken QuectelClient::readToken(unsigned long timeout_ms) {
+  unsigned long start = millis();
+  while (true) {
+    ModemToken token = pollToken();
+    if (token != MODEM_NONE) {
+      return token;
+    }
+    unsigned long elapsed = millis() - start;
+    if (elapsed >= timeout_ms) {
+      return MODEM_NONE;
+    }
+    // blocks until a character comes or the rest of timeout passes
+    modem_.setTimeout(timeout_ms - elapsed);
+    char c;
+    if (modem_.readBytes(&c, 1) == 1) {
+      token = reader_.feed(c);
+      if (token != MODEM_NONE) {
+        return token;
+      }
+    }
+  }
+}
+
+// Token of characters already received, MODEM_NONE if no line is complete
+ModemToken QuectelClient::pollToken() {
+  while (modem_.available()) {
+    ModemToken token = reader_.feed((char)modem_.read());
+    if (token != MODEM_NONE) {
+      return token;
+    }
+  }
+  return MODEM_NONE;
+}
+
+// Waits for ok (or also_ok), false on a failure response or timeout. URCs on the way are handled.
+bool QuectelClient::waitFor(ModemToken ok, unsigned long timeout_ms, ModemToken also_ok) {
+  unsigned long start = millis();
+  while (true) {
+    unsigned long elapsed = millis() - start;
+    ModemToken token = elapsed < timeout_ms ? readToken(timeout_ms - elapsed) : MODEM_NONE;
+    if (token == MODEM_NONE || ModemReader::isFailure(token)) {
+      return false;
+    }
+    if (token == ok || token == also_ok) {
+      return true;
+    }
+    handleUrc(token);
+  }
+}
+
+void QuectelClient::handleUrc(ModemToken token) {
+  if (token == MODEM_DATA) {
+    data_pending_ = true;
+  } else if (token == MODEM_CLOSED || token == MODEM_PDP_DEACT) {
+    connected_ = false;
+  }
+}
+
+// Reads received data from the modem into rx_, false if there was none
+bool QuectelClient::fetch() {
+  modem_.print(F("AT+QIRD=0,1,0,"));
+  modem_.print(QUECTEL_RX_LEN);
+  modem_.print(F("\r\n"));
+  rx_pos_ = rx_len_ = 0;
+  // "+QIRD: <address>:<port>,TCP,<length>" and the data, or just "OK" when there is no more data
+  if (!waitFor(MODEM_READ, QUECTEL_AT_TIMEOUT_MS, MODEM_OK) || strncmp(reader_.line(), "+QIRD:", 6) != 0) {
+    data_pending_ = false;
+    return false;
+  }
+  const char *length = strrchr(reader_.line(), ',');
+  uint16_t len = length ? (uint16_t)atoi(length + 1) : 0;
+  if (len > QUECTEL_RX_LEN) {
+    len = QUECTEL_RX_LEN;
+  }
+  modem_.setTimeout(QUECTEL_AT_TIMEOUT_MS);
+  rx_len_ = (uint16_t)modem_.readBytes((char *)rx_, len);
+  received_ += rx_len_;
+  waitFor(MODEM_OK, QUECTEL_AT_TIMEOUT_MS);
+  return rx_len_ > 0;
+}
@@ -0,0 +1,65 @@
+#ifndef QUECTEL_CLIENT_H_
+#define QUECTEL_CLIENT_H_
+
+#include <Arduino.h>
+#include <Client.h>
+#include "modem_reader.h"
+
+// Arduino Client over the TCP/IP AT commands of the Quectel M95 (non
+// transparent mode), so network libraries can run over the GSM modem.
+//
+// The modem has to be attached with PDP context set (AT+QICSGP, and
+// AT+QIDNSIP=1 for connect by host name) and AT+QINDI=1, so received data
+// is only announced by "+QIRDI" and fetched with AT+QIRD instead of being
+// mixed into responses. Every write() is one AT+QISEND=<n>, so it is best
+// to write whole packets at once.
+#define QUECTEL_RX_LEN 128         // bytes fetched by one AT+QIRD
+#define QUECTEL_SEND_MAX 1460      // AT+QISEND limit
+#define QUECTEL_CONNECT_TIMEOUT_MS 30000
+#define QUECTEL_SEND_TIMEOUT_MS 5000
+#define QUECTEL_AT_TIMEOUT_MS 2000
+
+class QuectelClient : public Client {
+ public:
+  explicit QuectelClient(Stream &modem);
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char *host, uint16_t port) override;
+  // Takes a connection opened by AT+QIOPEN outside of the client (an
+  // AtEngine script), instead of the blocking connect()
+  void opened();
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+  // TCP payload bytes, AT commands not counted
+  uint32_t bytesSent() const { return sent_; }
+  uint32_t bytesReceived() const { return received_; }
+
+ private:
+  ModemToken readToken(unsigned long timeout_ms);
+  ModemToken pollToken();
+  bool waitFor(ModemToken ok, unsigned long timeout_ms, ModemToken also_ok = MODEM_NONE);
+  void handleUrc(ModemToken token);
+  bool fetch();
+
+  Stream &modem_;
+  ModemReader reader_;
+  uint8_t rx_[QUECTEL_RX_LEN];
+  uint16_t rx_pos_;
+  uint16_t rx_len_;
+  bool connected_;
+  bool data_pending_;  // "+QIRDI" seen, data waits in the modem
+  uint32_t sent_;
+  uint32_t received_;
+};
+
+#endif  // QUECTEL_CLIENT_H_
@@ -0,0 +1,34 @@
+#include "report_policy.h"
+
+static int distance(int a, int b) {
+  return a > b ? a - b : b - a;
+}
+
+bool ReportPolicy::changed(const FireReading &reading) const {
+  return distance(reading.smoke, last_.smoke) > settings_.sensor_deadband ||
+         distance(reading.flame, last_.flame) > settings_.sensor_deadband ||
+         distance(reading.gas, last_.gas) > settings_.sensor_deadband ||
+         distance(reading.prob, last_.prob) > settings_.prob_deadband;
+}
+
+ReportReason ReportPolicy::check(const FireReading &reading, unsigned long now_ms) {
+  ReportReason reason = REPORT_NONE;
+  if (!started_) {
+    reason = REPORT_FIRST;
+  } else if (reading.prob >= settings_.alarm_prob || last_.prob >= settings_.alarm_prob) {
+    reason = REPORT_ALARM;
+  } else if (changed(reading)) {
+    reason = REPORT_CHANGE;
+  } else if (now_ms - last_ms_ >= settings_.heartbeat_ms) {
+    reason = REPORT_HEARTBEAT;
+  }
+
+  if (reason == REPORT_NONE) {
+    suppressed_++;
+    return reason;
+  }
+  started_ = true;
+  last_ = reading;
+  last_ms_ = now_ms;
+  return reason;
+}
@@ -0,0 +1,50 @@
+#ifndef REPORT_POLICY_H_
+#define REPORT_POLICY_H_
+
+#include <stdint.h>
+#include "fire_frame.h"
+
+// Change-driven reporting of the end nodes (lora_transmitter). A reading is
+// sent when some sensor moved more than the sensor dead-band or the fire
+// probability more than the probability dead-band since the last sent
+// reading, when the probability crossed the alarm threshold (either way),
+// every reading while over it, and otherwise as a heartbeat once per
+// heartbeat period. Other readings are suppressed and counted.
+struct ReportSettings {
+  int sensor_deadband;       // ADC counts of smoke, flame, gas
+  int prob_deadband;         // probability * PROB_SCALE
+  int alarm_prob;            // probability * PROB_SCALE
+  unsigned long heartbeat_ms;
+};
+
+enum ReportReason : uint8_t {
+  REPORT_NONE,       // suppressed
+  REPORT_FIRST,      // first reading after reset
+  REPORT_CHANGE,     // dead-band exceeded
+  REPORT_ALARM,      // threshold crossed or over it
+  REPORT_HEARTBEAT,
+  REPORT_REASONS
+};
+
+class ReportPolicy {
+ public:
+  explicit ReportPolicy(const ReportSettings &settings) : settings_(settings) {}
+
+  // Decides about reading taken at now_ms, sent reading becomes the
+  // reference for the next ones
+  ReportReason check(const FireReading &reading, unsigned long now_ms);
+
+  // Readings suppressed since reset, wraps as the frame field
+  uint16_t suppressed() const { return suppressed_; }
+
+ private:
+  bool changed(const FireReading &reading) const;
+
+  ReportSettings settings_;
+  FireReading last_ = {};
+  unsigned long last_ms_ = 0;
+  bool started_ = false;
+  uint16_t suppressed_ = 0;
+};
+
+#endif  // REPORT_POLICY_H_
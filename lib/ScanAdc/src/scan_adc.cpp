@@ -0,0 +1,34 @@
+#include "scan_adc.h"
+
+bool ScanAdc::setChannels(const uint32_t *pins, const uint32_t *numbers, uint8_t channels,
+                          ScanAdcCallback callback) {
+  if (channels == 0 || channels > SCAN_ADC_MAX_CHANNELS) {
+    return false;
+  }
+  for (uint8_t i = 0; i < channels; i++) {
+    pins_[i] = pins[i];
+    // rank of the channel in the scan, channels are converted in ascending order
+    uint8_t rank = 0;
+    for (uint8_t j = 0; j < channels; j++) {
+      if (numbers[j] == numbers[i] && j != i) {
+        return false;  // one conversion per channel
+      }
+      rank += numbers[j] < numbers[i];
+    }
+    order_[rank] = i;
+  }
+  channels_ = channels;
+  callback_ = callback;
+  return true;
+}
+
+void ScanAdc::complete() {
+  uint16_t means[SCAN_ADC_MAX_CHANNELS];
+  for (uint8_t k = 0; k < channels_; k++) {
+    means[order_[k]] = buffer_[k];
+  }
+  busy_ = false;
+  if (callback_) {
+    callback_(means, channels_);
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef SCAN_ADC_H_
+#define SCAN_ADC_H_
+
+#include <stdint.h>
+
+// Acquisition of several analog pins in one ADC scan (STM32L0): the
+// sequencer converts the channels one after another, every channel with
+// hardware oversampling, DMA moves the results and its interrupt hands the
+// means to the callback. The core may sleep (WFI) through the scan, the
+// ADC runs from HSI16 divided down so the scan spans about as long as the
+// old averaging of analogRead() calls.
+//
+// Means are 12 bit ADC counts (analogRead() counts of 10 bits times 4),
+// in the order of the pins given to begin(). The native build has a
+// stand-in in lib_native that takes the values of analogRead().
+#define SCAN_ADC_MAX_CHANNELS 4
+#define SCAN_ADC_CLOCK_HZ 62500        // HSI16 / 256
+#define SCAN_ADC_CONVERSION_CYCLES 92  // 79.5 sampling + 12.5 conversion
+#define SCAN_ADC_OVERSAMPLING 16       // samples per channel, mean by shift
+
+// Duration of one scan of channels
+inline uint32_t scanAdcTimeUs(uint8_t channels) {
+  return (uint32_t)((uint64_t)channels * SCAN_ADC_OVERSAMPLING * SCAN_ADC_CONVERSION_CYCLES * 1000000 /
+                    SCAN_ADC_CLOCK_HZ);
+}
+
+// Called from the DMA interrupt when the scan is done
+typedef void (*ScanAdcCallback)(const uint16_t *means, uint8_t channels);
+
+class ScanAdc {
+ public:
+  // Configures ADC and DMA for pins, false when there are too many or some
+  // pin has no ADC channel. Only one instance can own the ADC.
+  bool begin(const uint32_t *pins, uint8_t channels, ScanAdcCallback callback);
+
+  // Starts a scan, false while the previous one runs
+  bool start();
+  bool busy() const { return busy_; }
+
+  // Called by the DMA interrupt (platform part)
+  void complete();
+
+ private:
+  // Keeps pins and callback, orders the DMA buffer by channel numbers
+  bool setChannels(const uint32_t *pins, const uint32_t *numbers, uint8_t channels, ScanAdcCallback callback);
+
+  uint32_t pins_[SCAN_ADC_MAX_CHANNELS] = {};
+  uint8_t channels_ = 0;
+  ScanAdcCallback callback_ = nullptr;
+  // DMA buffer in ascending channel order (scan direction of the
+  // sequencer) and the pin of every entry
+  uint16_t buffer_[SCAN_ADC_MAX_CHANNELS] = {};
+  uint8_t order_[SCAN_ADC_MAX_CHANNELS] = {};
+  volatile bool busy_ = false;
+};
+
+#endif  // SCAN_ADC_H_
@@ -0,0 +1,116 @@
+// ScanAdc on the STM32L0 HAL of STM32duino: ADC1 with the sequencer in
+// forward scan, DMA1 channel 1 in normal mode, one transfer per channel.
+// analogRead() of the core initializes the ADC on its own, do not mix them.
+#if defined(ARDUINO_ARCH_STM32) && defined(STM32L0xx)
+
+#include "Arduino.h"
+#include "scan_adc.h"
+
+static ADC_HandleTypeDef hadc;
+static DMA_HandleTypeDef hdma;
+static ScanAdc *active = nullptr;
+
+static const uint32_t adcChannels[] = {
+    ADC_CHANNEL_0,  ADC_CHANNEL_1,  ADC_CHANNEL_2,  ADC_CHANNEL_3, ADC_CHANNEL_4,  ADC_CHANNEL_5,
+    ADC_CHANNEL_6,  ADC_CHANNEL_7,  ADC_CHANNEL_8,  ADC_CHANNEL_9, ADC_CHANNEL_10, ADC_CHANNEL_11,
+    ADC_CHANNEL_12, ADC_CHANNEL_13, ADC_CHANNEL_14, ADC_CHANNEL_15};
+
+extern "C" void DMA1_Channel1_IRQHandler(void) {
+  HAL_DMA_IRQHandler(&hdma);
+}
+
+extern "C" void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *handle) {
+  if (handle != &hadc || active == nullptr) {
+    return;
+  }
+  HAL_ADC_Stop_DMA(&hadc);  // ADC disabled until the next scan
+  active->complete();
+}
+
+bool ScanAdc::begin(const uint32_t *pins, uint8_t channels, ScanAdcCallback callback) {
+  uint32_t numbers[SCAN_ADC_MAX_CHANNELS];
+  for (uint8_t i = 0; i < channels && i < SCAN_ADC_MAX_CHANNELS; i++) {
+    PinName name = analogInputToPinName(pins[i]);
+    uint32_t function = name == NC ? (uint32_t)NC : pinmap_function(name, PinMap_ADC);
+    if (function == (uint32_t)NC || STM_PIN_CHANNEL(function) >= sizeof(adcChannels) / sizeof(adcChannels[0])) {
+      return false;
+    }
+    numbers[i] = STM_PIN_CHANNEL(function);
+  }
+  if (!setChannels(pins, numbers, channels, callback)) {
+    return false;
+  }
+
+  __HAL_RCC_ADC1_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  hadc.Instance = ADC1;
+  hadc.Init.ClockPrescaler = ADC_CLOCK_ASYNC_DIV256;  // SCAN_ADC_CLOCK_HZ
+  hadc.Init.Resolution = ADC_RESOLUTION_12B;
+  hadc.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc.Init.ScanConvMode = ADC_SCAN_DIRECTION_FORWARD;
+  hadc.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+  hadc.Init.LowPowerAutoWait = DISABLE;
+  hadc.Init.LowPowerAutoPowerOff = DISABLE;
+  hadc.Init.LowPowerFrequencyMode = ENABLE;  // ADC clock under 3.5 MHz
+  hadc.Init.ContinuousConvMode = DISABLE;
+  hadc.Init.DiscontinuousConvMode = DISABLE;
+  hadc.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
+  hadc.Init.DMAContinuousRequests = DISABLE;
+  hadc.Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+  hadc.Init.SamplingTime = ADC_SAMPLETIME_79CYCLES_5;  // SCAN_ADC_CONVERSION_CYCLES
+  // SCAN_ADC_OVERSAMPLING samples of every channel, sum shifted to 12 bits
+  hadc.Init.OversamplingMode = ENABLE;
+  hadc.Init.Oversample.Ratio = ADC_OVERSAMPLING_RATIO_16;
+  hadc.Init.Oversample.RightBitShift = ADC_RIGHTBITSHIFT_4;
+  hadc.Init.Oversample.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+  if (HAL_ADC_Init(&hadc) != HAL_OK) {
+    return false;
+  }
+
+  ADC_ChannelConfTypeDef config = {};
+  config.Rank = ADC_RANK_CHANNEL_NUMBER;
+  for (uint8_t i = 0; i < channels; i++) {
+    config.Channel = adcChannels[numbers[i]];
+    if (HAL_ADC_ConfigChannel(&hadc, &config) != HAL_OK) {
+      return false;
+    }
+  }
+  if (HAL_ADCEx_Calibration_Start(&hadc, ADC_SINGLE_ENDED) != HAL_OK) {
+    return false;
+  }
+
+  hdma.Instance = DMA1_Channel1;
+  hdma.Init.Request = DMA_REQUEST_0;  // ADC
+  hdma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+  hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma.Init.MemInc = DMA_MINC_ENABLE;
+  hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+  hdma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+  hdma.Init.Mode = DMA_NORMAL;
+  hdma.Init.Priority = DMA_PRIORITY_LOW;
+  if (HAL_DMA_Init(&hdma) != HAL_OK) {
+    return false;
+  }
+  __HAL_LINKDMA(&hadc, DMA_Handle, hdma);
+  HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+  active = this;
+  return true;
+}
+
+bool ScanAdc::start() {
+  if (busy_ || channels_ == 0) {
+    return false;
+  }
+  busy_ = true;
+  if (HAL_ADC_Start_DMA(&hadc, (uint32_t *)buffer_, channels_) != HAL_OK) {
+    busy_ = false;
+    return false;
+  }
+  return true;
+}
+
+#endif  // ARDUINO_ARCH_STM32 && STM32L0xx
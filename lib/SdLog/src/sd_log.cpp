@@ -0,0 +1,54 @@
+#include "sd_log.h"
+#include <string.h>
+
+void SdLog::begin(uint32_t size) {
+  len_ = flushed_ = size % SD_LOG_SECTOR;
+  size_ = size;
+}
+
+bool SdLog::append(const char *row, size_t len, unsigned long now_ms) {
+  if (len > sizeof(buffer_) - len_) {
+    dropped_++;
+    return false;
+  }
+  if (pending() == 0) {
+    oldest_ms_ = now_ms;
+  }
+  if (len_ <= SD_LOG_SECTOR && len_ + len > SD_LOG_SECTOR) {
+    tail_ms_ = now_ms;  // row starting the bytes of the second sector
+  }
+  memcpy(buffer_ + len_, row, len);
+  len_ += len;
+  size_ += len;
+  return true;
+}
+
+SdLogFlush SdLog::due(unsigned long now_ms, unsigned long horizon_ms) const {
+  if (pending() == 0) {
+    return SD_LOG_KEEP;
+  }
+  if (now_ms - oldest_ms_ + horizon_ms >= flush_ms_) {
+    return SD_LOG_ALL;
+  }
+  return len_ >= SD_LOG_SECTOR ? SD_LOG_SECTORS : SD_LOG_KEEP;
+}
+
+size_t SdLog::flushLength(SdLogFlush what) const {
+  switch (what) {
+    case SD_LOG_SECTORS: return len_ >= SD_LOG_SECTOR ? SD_LOG_SECTOR - flushed_ : 0;
+    case SD_LOG_ALL: return pending();
+    default: return 0;
+  }
+}
+
+void SdLog::flushed(size_t len) {
+  flushed_ += len;
+  if (flushed_ >= SD_LOG_SECTOR) {
+    // pending bytes are in the second sector, its oldest row started them;
+    // a write that left the first sector pending keeps the age of its rows
+    len_ -= SD_LOG_SECTOR;
+    flushed_ -= SD_LOG_SECTOR;
+    memmove(buffer_, buffer_ + SD_LOG_SECTOR, len_);
+    oldest_ms_ = tail_ms_;
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef SD_LOG_H_
+#define SD_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Append-only log of the end node on the SD card. Rows are collected in a
+// buffer that mirrors the last sector of the file, so the card gets whole
+// sectors written at sector boundaries instead of a read-modify-write of
+// the same sector and a directory update for every row.
+//
+// Flush policy: full sectors as soon as they are full, every pending byte
+// when the oldest one is flush_ms old (also before a sleep the deadline
+// falls into, see the horizon of due()) or when the caller needs the rows
+// on the card at once. Every flush ends with a sync of the file (data,
+// FAT, directory entry in this order), so a power loss costs at most the
+// rows still in the buffer and never the ones of an earlier flush.
+//
+// The buffer holds two sectors, rows are dropped (and counted) only when
+// flushes keep failing.
+#define SD_LOG_SECTOR 512
+
+enum SdLogFlush : uint8_t {
+  SD_LOG_KEEP,     // nothing due
+  SD_LOG_SECTORS,  // full sectors, the tail stays buffered
+  SD_LOG_ALL       // every pending byte
+};
+
+class SdLog {
+ public:
+  explicit SdLog(unsigned long flush_ms) : flush_ms_(flush_ms) {}
+
+  // Continues a log file of size bytes, buffer starts at its last sector
+  void begin(uint32_t size);
+
+  // Appends a row taken at now_ms, false when it does not fit
+  bool append(const char *row, size_t len, unsigned long now_ms);
+
+  // Flush due at now_ms or within horizon_ms (sleep ahead)
+  SdLogFlush due(unsigned long now_ms, unsigned long horizon_ms = 0) const;
+
+  // Writes the pending bytes of what to file (SD library File or anything
+  // with write(const uint8_t *, size_t) and flush() as sync), false on a
+  // write error, bytes not written stay pending
+  template <class F>
+  bool flush(F &file, SdLogFlush what);
+
+  size_t pending() const { return len_ - flushed_; }
+  // File size with the pending bytes
+  uint32_t size() const { return size_; }
+  // Free bytes of the buffer, the most append() takes
+  size_t room() const { return sizeof(buffer_) - len_; }
+  uint32_t dropped() const { return dropped_; }
+
+ private:
+  // Pending bytes of what
+  size_t flushLength(SdLogFlush what) const;
+  // len bytes are in the file, full sector leaves the buffer
+  void flushed(size_t len);
+
+  unsigned long flush_ms_;
+  uint8_t buffer_[2 * SD_LOG_SECTOR];
+  size_t len_ = 0;      // bytes of the buffered sectors, first at a sector boundary of the file
+  size_t flushed_ = 0;  // of them already in the file
+  unsigned long oldest_ms_ = 0;  // row of the oldest pending byte
+  unsigned long tail_ms_ = 0;    // row of the first byte of the second sector
+  uint32_t size_ = 0;
+  uint32_t dropped_ = 0;
+};
+
+template <class F>
+bool SdLog::flush(F &file, SdLogFlush what) {
+  size_t len = flushLength(what);
+  if (len == 0) {
+    return true;
+  }
+  size_t written = file.write(buffer_ + flushed_, len);
+  if (written > len) {
+    written = 0;  // error code of a write returning int
+  }
+  file.flush();
+  flushed(written);
+  return written == len;
+}
+
+#endif  // SD_LOG_H_
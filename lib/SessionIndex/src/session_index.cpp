@@ -0,0 +1,69 @@
+#include "session_index.h"
+#include <ctype.h>
+#include <string.h>
+
+#define NAME_BASE_MAX 8  // 8.3 name
+#define NAME_EXTENSION_MAX 4
+
+bool SessionIndex::format(int session, char *name) const {
+  if (session < 0) {
+    return false;
+  }
+  char digits[12];
+  int n = 0;
+  do {
+    digits[n++] = (char)('0' + session % 10);
+    session /= 10;
+  } while (session > 0);
+  size_t prefix_len = strlen(prefix_);
+  size_t extension_len = strlen(extension_);
+  if (prefix_len + n > NAME_BASE_MAX || extension_len > NAME_EXTENSION_MAX) {
+    return false;
+  }
+  memcpy(name, prefix_, prefix_len);
+  for (int i = 0; i < n; i++) {
+    name[prefix_len + i] = digits[n - 1 - i];
+  }
+  memcpy(name + prefix_len + n, extension_, extension_len + 1);
+  return true;
+}
+
+static bool sameText(const char *a, const char *b, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int SessionIndex::parse(const char *name) const {
+  size_t prefix_len = strlen(prefix_);
+  if (!sameText(name, prefix_, prefix_len) || !isdigit((unsigned char)name[prefix_len])) {
+    return -1;
+  }
+  int session = 0;
+  const char *p = name + prefix_len;
+  for (; isdigit((unsigned char)*p); p++) {
+    if (session > 99999) {
+      return -1;
+    }
+    session = session * 10 + (*p - '0');
+  }
+  return *p == '.' || *p == '\0' ? session : -1;
+}
+
+void SessionIndex::encodeRecord(int session, uint8_t *record) {
+  uint16_t value = (uint16_t)session;
+  record[0] = (uint8_t)(value >> 8);
+  record[1] = (uint8_t)value;
+  record[2] = (uint8_t)~record[0];
+  record[3] = (uint8_t)~record[1];
+}
+
+int SessionIndex::decodeRecord(const uint8_t *record) {
+  if ((uint8_t)~record[0] != record[2] || (uint8_t)~record[1] != record[3]) {
+    return -1;
+  }
+  return record[0] << 8 | record[1];
+}
@@ -0,0 +1,190 @@
+#ifndef SESSION_INDEX_H_
+#define SESSION_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Session index of the SD card logs (tabor<N>.txt, tabor<N>.bin). Instead
+// of counting the files of the root directory at every boot (the SD library
+// opens every entry by name, a rescan of the directory per file) the number
+// of the last session is kept in a manifest file on the card, so the name
+// of the next log is known from one record.
+//
+// The manifest is append-only, every session adds a record of
+// SESSION_INDEX_RECORD bytes: number upper byte first and its complement.
+// Only the last record is read. A torn or missing record, or a log of the
+// next number that is not empty (card written by an older firmware, files
+// copied over), falls back to one scan of the directory for the highest
+// session number.
+//
+// Names are 8.3 as the SD library needs, prefix and number of at most 8
+// characters: sessions 0 .. 999 for "tabor".
+//
+// The templates take the SD library (SDClass) or a stand-in with the same
+// open(), File::size(), seek(), read(), write(), close() and
+// openNextFile().
+#define SESSION_INDEX_RECORD 4
+#define SESSION_NAME_MAX 13  // 8.3 and NUL
+
+class SessionIndex {
+ public:
+  // manifest file name, prefix and extension (with the dot) of the logs,
+  // append_mode is FILE_WRITE of the SD library
+  SessionIndex(const char *manifest, const char *prefix, const char *extension, uint8_t append_mode)
+      : manifest_(manifest), prefix_(prefix), extension_(extension), append_mode_(append_mode) {}
+
+  // Creates the empty log of a new session and records it in the manifest,
+  // returns it opened with append_mode, closed File when no name is left or
+  // the card fails
+  template <class FS>
+  auto create(FS &fs) -> decltype(fs.open(""));
+
+  // Closes file (log of the current session) and creates the log of the
+  // next session as create()
+  template <class FS, class F>
+  F rotate(FS &fs, F &file);
+
+  int session() const { return session_; }
+  const char *name() const { return name_; }
+  // create() needed the scan of the directory
+  bool recovered() const { return recovered_; }
+
+  // Log name of session into name, false when it is no 8.3 name
+  bool format(int session, char *name) const;
+  // Session of a log name (any extension, any letter case), so the .txt
+  // and .bin logs share the numbers, -1 for another file
+  int parse(const char *name) const;
+
+  static void encodeRecord(int session, uint8_t *record);
+  // -1 for a torn or foreign record
+  static int decodeRecord(const uint8_t *record);
+
+ private:
+  // Last session of the manifest, -1 without a valid record
+  template <class FS>
+  int readManifest(FS &fs);
+  // Highest session of the logs in the root directory, -1 for none
+  template <class FS>
+  int scan(FS &fs);
+  template <class FS>
+  bool appendManifest(FS &fs, int session);
+  template <class FS>
+  auto open(FS &fs, int next) -> decltype(fs.open(""));
+
+  const char *manifest_;
+  const char *prefix_;
+  const char *extension_;
+  uint8_t append_mode_;
+  int session_ = -1;
+  bool recovered_ = false;
+  char name_[SESSION_NAME_MAX] = "";
+};
+
+template <class FS>
+auto SessionIndex::create(FS &fs) -> decltype(fs.open("")) {
+  recovered_ = false;
+  int next = readManifest(fs);
+  if (next < 0) {
+    recovered_ = true;
+    next = scan(fs);
+  }
+  return open(fs, next + 1);
+}
+
+template <class FS, class F>
+F SessionIndex::rotate(FS &fs, F &file) {
+  file.close();
+  recovered_ = false;
+  return open(fs, session_ + 1);
+}
+
+template <class FS>
+auto SessionIndex::open(FS &fs, int next) -> decltype(fs.open("")) {
+  while (true) {
+    char name[SESSION_NAME_MAX];
+    if (!format(next, name)) {
+      return decltype(fs.open(""))();
+    }
+    auto file = fs.open(name, append_mode_);
+    if (!file) {
+      return file;
+    }
+    if (file.size() == 0) {
+      // record after the log: a reset in between leaves the empty log of
+      // the last record's successor, the next boot takes it again
+      if (!appendManifest(fs, next)) {
+        file.close();
+        return decltype(fs.open(""))();
+      }
+      session_ = next;
+      for (size_t i = 0; i < sizeof(name_); i++) {
+        name_[i] = name[i];
+      }
+      return file;
+    }
+    // log of a session the manifest does not know
+    file.close();
+    if (recovered_) {
+      next++;
+    } else {
+      recovered_ = true;
+      int last = scan(fs);
+      next = last >= next ? last + 1 : next + 1;
+    }
+  }
+}
+
+template <class FS>
+int SessionIndex::readManifest(FS &fs) {
+  auto file = fs.open(manifest_);
+  if (!file) {
+    return -1;
+  }
+  uint32_t size = file.size();
+  uint8_t record[SESSION_INDEX_RECORD];
+  bool ok = size >= SESSION_INDEX_RECORD && file.seek(size - SESSION_INDEX_RECORD);
+  for (int i = 0; ok && i < SESSION_INDEX_RECORD; i++) {
+    int c = file.read();
+    ok = c >= 0;
+    record[i] = (uint8_t)c;
+  }
+  file.close();
+  return ok ? decodeRecord(record) : -1;
+}
+
+template <class FS>
+int SessionIndex::scan(FS &fs) {
+  int last = -1;
+  auto dir = fs.open("/");
+  if (!dir) {
+    return last;
+  }
+  while (true) {
+    auto entry = dir.openNextFile();
+    if (!entry) {
+      break;
+    }
+    int session = parse(entry.name());
+    if (session > last) {
+      last = session;
+    }
+    entry.close();
+  }
+  dir.close();
+  return last;
+}
+
+template <class FS>
+bool SessionIndex::appendManifest(FS &fs, int session) {
+  auto file = fs.open(manifest_, append_mode_);
+  if (!file) {
+    return false;
+  }
+  uint8_t record[SESSION_INDEX_RECORD];
+  encodeRecord(session, record);
+  bool ok = file.write(record, SESSION_INDEX_RECORD) == SESSION_INDEX_RECORD;
+  file.close();
+  return ok;
+}
+
+#endif  // SESSION_INDEX_H_
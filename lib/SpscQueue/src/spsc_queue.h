@@ -0,0 +1,119 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <stdint.h>
+#include <atomic>
+
+// Fixed capacity single-producer / single-consumer queue without locks, for
+// passing items from an interrupt handler (producer) to loop() (consumer).
+// Indices run freely and are masked, so Capacity must be a power of two.
+// lora_receiver pushes and pops both from loop() since the DIO0 interrupt
+// only flags a packet; there it is a bounded buffer with a drop policy
+// between decoding and the uplink, the atomics cost a few loads and keep it
+// safe should the producer move back into an interrupt.
+//
+// When the queue is full the producer either drops the new item
+// (QUEUE_DROP_NEWEST) or the oldest one still queued (QUEUE_DROP_OLDEST).
+// Dropping the oldest moves the read index from the producer side, so the
+// consumer claims an item by compare-and-swap of the read index after
+// copying it and copies again if the producer was faster.
+//
+// T must be trivially copyable, push() and pop() never block.
+
+enum QueueDropPolicy {
+  QUEUE_DROP_NEWEST,
+  QUEUE_DROP_OLDEST
+};
+
+template <class T, uint32_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+ public:
+  explicit SpscQueue(QueueDropPolicy policy = QUEUE_DROP_NEWEST) : policy_(policy) {}
+
+  // Producer side, returns false when an item (new or oldest) was dropped
+  bool push(const T &item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    bool dropped = false;
+    if (head - tail >= Capacity) {
+      if (policy_ == QUEUE_DROP_NEWEST) {
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+      }
+      // if the consumer took the oldest meanwhile, there is space already
+      if (claim(tail)) {
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        dropped = true;
+      }
+    }
+    items_[head & (Capacity - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+
+    pushed_.store(pushed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    uint32_t used = head + 1 - tail_.load(std::memory_order_relaxed);
+    if (used > high_water_.load(std::memory_order_relaxed)) {
+      high_water_.store(used, std::memory_order_relaxed);
+    }
+    return !dropped;
+  }
+
+  // Consumer side, returns false when the queue is empty
+  bool pop(T *item) {
+    while (true) {
+      uint32_t tail = tail_.load(std::memory_order_acquire);
+      if (tail == head_.load(std::memory_order_acquire)) {
+        return false;
+      }
+      *item = items_[tail & (Capacity - 1)];
+      if (claim(tail)) {
+        return true;
+      }
+      // item was dropped by the producer while being copied, take the next one
+    }
+  }
+
+  uint32_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  static uint32_t capacity() { return Capacity; }
+
+  QueueDropPolicy policy() const { return policy_; }
+  void setPolicy(QueueDropPolicy policy) { policy_ = policy; }
+
+  // Counters, written by the producer only
+  uint32_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint32_t highWater() const { return high_water_.load(std::memory_order_relaxed); }
+
+ private:
+  // Moves read index from tail to tail + 1 if nobody did it yet
+  bool claim(uint32_t tail) {
+#if defined(__ARM_ARCH_6M__)
+    // Cortex-M0+ has no exclusive load/store, the producer is an interrupt
+    // handler on the same core, so masking interrupts makes this atomic
+    uint32_t primask;
+    __asm__ volatile("mrs %0, primask\n cpsid i" : "=r"(primask)::"memory");
+    bool claimed = tail_.load(std::memory_order_relaxed) == tail;
+    if (claimed) {
+      tail_.store(tail + 1, std::memory_order_relaxed);
+    }
+    __asm__ volatile("msr primask, %0" ::"r"(primask) : "memory");
+    return claimed;
+#else
+    return tail_.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_acquire);
+#endif
+  }
+
+  T items_[Capacity];
+  std::atomic<uint32_t> head_{0};  // next slot to write, producer only
+  std::atomic<uint32_t> tail_{0};  // next slot to read
+  std::atomic<uint32_t> pushed_{0};
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint32_t> high_water_{0};
+  volatile QueueDropPolicy policy_;
+};
+
+#endif  // SPSC_QUEUE_H_
@@ -0,0 +1,114 @@
+#include "uplink_writer.h"
+#include <string.h>
+
+UplinkWriter::UplinkWriter(char *buffer, size_t size) : buffer_(buffer), size_(size), len_(0), overflow_(false) {
+  if (size_ > 0) {
+    buffer_[0] = '\0';
+  }
+}
+
+void UplinkWriter::clear() {
+  len_ = 0;
+  overflow_ = false;
+  if (size_ > 0) {
+    buffer_[0] = '\0';
+  }
+}
+
+UplinkWriter &UplinkWriter::text(const char *s, size_t len) {
+  if (size_ == 0) {
+    overflow_ = overflow_ || len > 0;
+    return *this;
+  }
+  size_t room = size_ - 1 - len_;
+  if (len > room) {
+    len = room;
+    overflow_ = true;
+  }
+  memcpy(buffer_ + len_, s, len);
+  len_ += len;
+  buffer_[len_] = '\0';
+  return *this;
+}
+
+UplinkWriter &UplinkWriter::text(const char *s) {
+  return text(s, strlen(s));
+}
+
+UplinkWriter &UplinkWriter::character(char c) {
+  return text(&c, 1);
+}
+
+// Writes digits of value right-aligned before end, at least min_digits
+// (padded with zeros), returns the first one
+static char *putDigits(char *end, unsigned long value, int min_digits) {
+  char *p = end;
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+    min_digits--;
+  } while (value || min_digits > 0);
+  return p;
+}
+
+UplinkWriter &UplinkWriter::number(unsigned long value) {
+  char digits[20]; // 64-bit long on the host
+  char *end = digits + sizeof(digits);
+  char *start = putDigits(end, value, 1);
+  return text(start, end - start);
+}
+
+UplinkWriter &UplinkWriter::number(long value) {
+  if (value < 0) {
+    character('-');
+    return number(0ul - (unsigned long)value);
+  }
+  return number((unsigned long)value);
+}
+
+UplinkWriter &UplinkWriter::fixed(long value, unsigned long scale) {
+  unsigned long magnitude = (unsigned long)value;
+  if (value < 0) {
+    character('-');
+    magnitude = 0ul - magnitude;
+  }
+  if (scale <= 1) {
+    return number(magnitude);
+  }
+  int fraction_digits = 0;
+  for (unsigned long s = scale; s > 1; s /= 10) {
+    fraction_digits++;
+  }
+  // written backwards: fraction padded with zeros to the digits of the
+  // scale, point, integer part
+  char digits[42];
+  char *end = digits + sizeof(digits);
+  char *start = putDigits(end, magnitude % scale, fraction_digits);
+  *--start = '.';
+  start = putDigits(start, magnitude / scale, 1);
+  return text(start, end - start);
+}
+
+void writeQueryFields(UplinkWriter &out, const FireReading &reading) {
+  out.text("field1=").number((long)reading.flame);
+  out.text("&field2=").number((long)reading.smoke);
+  out.text("&field3=").number((long)reading.gas);
+  out.text("&field4=").fixed(reading.prob, UPLINK_PROB_SCALE);
+  out.text("&field5=").fixed(reading.vbat, UPLINK_VOLTAGE_SCALE);
+}
+
+void writeCsvFields(UplinkWriter &out, const FireReading &reading) {
+  out.number((long)reading.flame).character(',');
+  out.number((long)reading.smoke).character(',');
+  out.number((long)reading.gas).character(',');
+  out.fixed(reading.prob, UPLINK_PROB_SCALE).character(',');
+  out.fixed(reading.vbat, UPLINK_VOLTAGE_SCALE);
+}
+
+void writeCompactFields(UplinkWriter &out, const FireReading &reading) {
+  out.number((long)reading.smoke).character(',');
+  out.number((long)reading.flame).character(',');
+  out.number((long)reading.gas).character(',');
+  out.number((long)reading.prob).character(',');
+  out.number((long)reading.vbat);
+}
@@ -0,0 +1,62 @@
+#ifndef UPLINK_WRITER_H_
+#define UPLINK_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fire_frame.h"
+
+// Allocation-free serializer of uplink requests. Fields are appended one by
+// one from the fixed point values of the reading (value * scale) with
+// integer arithmetic only, no heap, no float and no printf formatting. The
+// output goes to the caller buffer, in the receiver straight to the request
+// buffer the AT engine sends from.
+//
+// Writing past the end sets overflow(), the output is cut but always
+// terminated.
+
+// fixed point scales of FireReading, PROB_SCALE and VOLTAGE_SCALE of the
+// nodes
+#define UPLINK_PROB_SCALE 10000
+#define UPLINK_VOLTAGE_SCALE 1000
+
+class UplinkWriter {
+ public:
+  UplinkWriter(char *buffer, size_t size);
+
+  UplinkWriter &text(const char *s);
+  UplinkWriter &text(const char *s, size_t len);
+  UplinkWriter &character(char c);
+  UplinkWriter &number(long value);
+  UplinkWriter &number(unsigned long value);
+  // value / scale with all digits of the scale (power of ten), e.g.
+  // fixed(9950, 10000) writes "0.9950"
+  UplinkWriter &fixed(long value, unsigned long scale);
+
+  const char *c_str() const { return buffer_; }
+  size_t length() const { return len_; }
+  bool overflow() const { return overflow_; }
+  void clear();
+
+ private:
+  char *buffer_;
+  size_t size_;
+  size_t len_;
+  bool overflow_;
+};
+
+// Query string format of the ThingSpeak update, same fields as the
+// original GET request:
+//   field1=<flame>&field2=<smoke>&field3=<gas>&field4=<prob>&field5=<vbat>
+// probability and voltage as decimals (0.9950, 3.712)
+void writeQueryFields(UplinkWriter &out, const FireReading &reading);
+
+// Comma separated decimals in the order of the query fields,
+// <flame>,<smoke>,<gas>,<prob>,<vbat>, one update of the bulk_update.csv body
+void writeCsvFields(UplinkWriter &out, const FireReading &reading);
+
+// Compact body, raw fixed point integers in the frame order:
+//   <smoke>,<flame>,<gas>,<prob * PROB_SCALE>,<vbat * VOLTAGE_SCALE>
+// (MQTT payload), the consumer divides by the scales
+void writeCompactFields(UplinkWriter &out, const FireReading &reading);
+
+#endif  // UPLINK_WRITER_H_
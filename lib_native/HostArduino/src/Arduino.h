@@ -0,0 +1,86 @@
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+// Arduino API for the native (host) build, see host_hal.h
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WString.h"
+#include "Print.h"
+#include "host_hal.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define INPUT_ANALOG 4
+
+// analog pins are numbered after digital pins D0 .. D15 of the Nucleo header
+#define A0 100
+#define A1 101
+#define A2 102
+#define A3 103
+#define A4 104
+#define A5 105
+
+// Pins wired to the analog trace and to the fire switch on the end node
+#define HOST_SMOKE_PIN A1
+#define HOST_GAS_PIN A2
+#define HOST_FLAME_PIN A3
+#define HOST_BATTERY_PIN A5
+#define HOST_FIRE_SWITCH_PIN 8
+// high side switches of the sensors and the SD card, see HostPowerModel
+#define HOST_SENSOR_POWER_PIN 6
+#define HOST_SD_POWER_PIN 7
+
+// M95 on the central node: a pulse on POWERKEY switches the modem on or off,
+// STATUS is high while it is on
+#define HOST_MODEM_POWERKEY_PIN 8
+#define HOST_MODEM_STATUS_PIN 9
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+void interrupts();
+void noInterrupts();
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  operator bool() const { return true; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+// implemented by the firmware
+void setup();
+void loop();
+
+#endif  // ARDUINO_H_
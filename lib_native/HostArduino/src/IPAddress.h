@@ -0,0 +1,18 @@
+#ifndef IPADDRESS_H_HOST_
+#define IPADDRESS_H_HOST_
+
+#include <stdint.h>
+
+// Arduino IPAddress stand-in, IPv4 only
+class IPAddress {
+ public:
+  IPAddress() : bytes_{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes_{a, b, c, d} {}
+  uint8_t operator[](int index) const { return bytes_[index]; }
+  uint8_t &operator[](int index) { return bytes_[index]; }
+
+ private:
+  uint8_t bytes_[4];
+};
+
+#endif  // IPADDRESS_H_HOST_
@@ -0,0 +1,199 @@
+#include "LoRaLib.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// all radios of the program, packets from --air-in go to listening ones
+static std::vector<SX127x *> radios;
+static FILE *air_out = nullptr;
+
+static void writePacket(FILE *f, uint64_t at_us, const uint8_t *data, size_t len) {
+  fprintf(f, "%llu ", (unsigned long long)(at_us / 1000));
+  for (size_t i = 0; i < len; i++) {
+    fprintf(f, "%02x", data[i]);
+  }
+  fprintf(f, "\n");
+}
+
+static bool parsePacket(const char *line, uint64_t *at_ms, std::vector<uint8_t> *data) {
+  unsigned long long ms;
+  int consumed = 0;
+  if (sscanf(line, "%llu %n", &ms, &consumed) != 1) {
+    return false;
+  }
+  *at_ms = ms;
+  const char *p = line + consumed;
+  unsigned int byte;
+  while (sscanf(p, "%2x", &byte) == 1) {
+    data->push_back((uint8_t)byte);
+    p += 2;
+  }
+  return !data->empty();
+}
+
+// Packets of --air-in, scheduled one at a time (with --air-repeat the file
+// starts over after its last packet)
+struct AirPacket {
+  uint64_t at_us;  // end of airtime, the packet is in the receiver buffer
+  std::vector<uint8_t> data;
+};
+static std::vector<AirPacket> air_in;
+static uint64_t air_in_period_us = 0;
+
+static void scheduleAirPacket(size_t index, uint64_t offset_us) {
+  if (index == air_in.size()) {
+    if (!host_config.air_repeat || air_in_period_us == 0) {
+      return;
+    }
+    index = 0;
+    offset_us += air_in_period_us;
+  }
+  hostSchedule(offset_us + air_in[index].at_us, [index, offset_us]() {
+    const std::vector<uint8_t> &data = air_in[index].data;
+    bool received = false;
+    for (SX127x *radio : radios) {
+      if (radio->state() == SX127x::RX) {
+        radio->hostReceive(data.data(), data.size());
+        received = true;
+      }
+    }
+    if (!received) {
+      host_stats.lora_rx_missed++;
+    }
+    scheduleAirPacket(index + 1, offset_us);
+  });
+}
+
+void hostLoRaBegin() {
+  hostSetLoad(HOST_LOAD_RADIO, host_config.power.radio_standby_ma);
+  if (!host_config.air_out_path.empty()) {
+    air_out = fopen(host_config.air_out_path.c_str(), "w");
+  }
+  if (host_config.air_in_path.empty()) {
+    return;
+  }
+  FILE *f = fopen(host_config.air_in_path.c_str(), "r");
+  if (!f) {
+    fprintf(stderr, "cannot read %s\n", host_config.air_in_path.c_str());
+    return;
+  }
+  char line[600];
+  while (fgets(line, sizeof(line), f)) {
+    uint64_t at_ms;
+    AirPacket packet;
+    if (!parsePacket(line, &at_ms, &packet.data)) {
+      continue;
+    }
+    LoRaSettings settings;
+    packet.at_us = at_ms * 1000 + loraTimeOnAirUs(settings, packet.data.size());
+    air_in.push_back(packet);
+  }
+  fclose(f);
+  if (!air_in.empty()) {
+    // repeated with the gap before the first packet also after the last one
+    air_in_period_us = air_in.back().at_us + air_in.front().at_us;
+    scheduleAirPacket(0, 0);
+  }
+}
+
+void hostLoRaEnd() {
+  if (air_out) {
+    fclose(air_out);
+    air_out = nullptr;
+  }
+}
+
+int16_t SX1272::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power, uint8_t currentLimit,
+                      uint16_t preambleLength, uint8_t gain) {
+  (void)freq;
+  (void)syncWord;
+  (void)power;
+  (void)currentLimit;
+  (void)gain;
+  settings_.bw_khz = bw;
+  settings_.sf = sf;
+  settings_.cr = cr;
+  settings_.preamble = preambleLength;
+  radios.push_back(this);
+  return ERR_NONE;
+}
+
+int16_t SX127x::transmit(uint8_t *data, size_t len, uint8_t addr) {
+  int16_t state = startTransmit(data, len, addr);
+  if (state != ERR_NONE) {
+    return state;
+  }
+  // blocking transmission waits until the end of the packet
+  hostAdvance(tx_end_us_ - hostMicros(), HOST_WAIT_DELAY);
+  setState(STANDBY);
+  return ERR_NONE;
+}
+
+int16_t SX127x::startTransmit(uint8_t *data, size_t len, uint8_t addr) {
+  (void)addr;
+  if (len > SX127X_MAX_PACKET_LENGTH) {
+    return ERR_PACKET_TOO_LONG;
+  }
+  uint32_t airtime = loraTimeOnAirUs(settings_, len);
+  setState(TX);
+  tx_end_us_ = hostMicros() + airtime;
+  host_stats.lora_tx_packets++;
+  host_stats.lora_tx_airtime_us += airtime;
+  if (air_out) {
+    writePacket(air_out, hostMicros(), data, len);
+  }
+  hostSchedule(tx_end_us_, [this]() {
+    if (state_ != TX) {
+      return;
+    }
+    setState(STANDBY);
+    if (dio0_) {
+      dio0_();
+    }
+  });
+  return ERR_NONE;
+}
+
+int16_t SX127x::startReceive(uint8_t len) {
+  (void)len;
+  setState(RX);
+  return ERR_NONE;
+}
+
+void SX127x::hostReceive(const uint8_t *data, size_t len) {
+  rx_len_ = len;
+  memcpy(rx_buffer_, data, len);
+  host_stats.lora_rx_packets++;
+  if (dio0_) {
+    dio0_();
+  }
+}
+
+size_t SX127x::getPacketLength(bool update) {
+  (void)update;
+  return rx_len_;
+}
+
+int16_t SX127x::readData(uint8_t *data, size_t len) {
+  size_t n = len == 0 || len > rx_len_ ? rx_len_ : len;
+  memcpy(data, rx_buffer_, n);
+  setState(STANDBY);
+  return ERR_NONE;
+}
+
+void SX127x::setState(State state) {
+  const HostPowerModel &power = host_config.power;
+  const double state_ma[] = {power.radio_standby_ma, power.radio_sleep_ma, power.radio_tx_ma, power.radio_rx_ma};
+  state_ = state;
+  hostSetLoad(HOST_LOAD_RADIO, state_ma[state]);
+}
+
+int16_t SX127x::standby() {
+  setState(STANDBY);
+  return ERR_NONE;
+}
+
+int16_t SX127x::sleep() {
+  setState(SLEEP);
+  return ERR_NONE;
+}
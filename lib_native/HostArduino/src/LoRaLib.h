@@ -0,0 +1,88 @@
+#ifndef LORALIB_H_HOST_
+#define LORALIB_H_HOST_
+
+// LoRaLib 8.x stand-in for the native build. Transmitted packets are written
+// to --air-out, packets from --air-in arrive at their time stamps while the
+// module listens. DIO0 interrupt fires at the end of the packet, computed
+// from the modem settings by lib/LoRaAirtime.
+
+#include "Arduino.h"
+#include "lora_airtime.h"
+
+#define ERR_NONE 0
+#define ERR_UNKNOWN -1
+#define ERR_CHIP_NOT_FOUND -2
+#define ERR_PACKET_TOO_LONG -4
+#define ERR_TX_TIMEOUT -5
+#define ERR_RX_TIMEOUT -6
+#define ERR_CRC_MISMATCH -7
+
+#define SX127X_SYNC_WORD 0x12
+#define SX127X_MAX_PACKET_LENGTH 255
+
+class Module {
+ public:
+  Module(int cs = 10, int int0 = 2, int int1 = 3) : cs_(cs), int0_(int0), int1_(int1) {}
+
+ private:
+  int cs_;
+  int int0_;
+  int int1_;
+};
+
+class LoRa : public Module {
+ public:
+  LoRa(int cs = 10, int int0 = 2, int int1 = 3) : Module(cs, int0, int1) {}
+};
+
+class SX127x {
+ public:
+  enum State { STANDBY, SLEEP, TX, RX };
+
+  explicit SX127x(Module *mod) : mod_(mod) {}
+
+  int16_t transmit(uint8_t *data, size_t len, uint8_t addr = 0);
+  int16_t startTransmit(uint8_t *data, size_t len, uint8_t addr = 0);
+  int16_t startReceive(uint8_t len = 0);
+  int16_t readData(uint8_t *data, size_t len);
+  size_t getPacketLength(bool update = true);
+  float getRSSI() const { return rssi_; }
+  float getSNR() const { return snr_; }
+  int16_t standby();
+  int16_t sleep();
+  void setDio0Action(void (*func)(void)) { dio0_ = func; }
+  void clearDio0Action() { dio0_ = nullptr; }
+
+  // host side
+  State state() const { return state_; }
+  const LoRaSettings &settings() const { return settings_; }
+  void hostReceive(const uint8_t *data, size_t len);
+
+ protected:
+  void setState(State state);  // radio current of the power model follows the state
+
+  Module *mod_;
+  LoRaSettings settings_;
+  State state_ = STANDBY;
+  uint64_t tx_end_us_ = 0;
+  void (*dio0_)(void) = nullptr;
+  uint8_t rx_buffer_[SX127X_MAX_PACKET_LENGTH];
+  size_t rx_len_ = 0;
+  float rssi_ = -90.0f;
+  float snr_ = 8.0f;
+};
+
+class SX1272 : public SX127x {
+ public:
+  SX1272(Module *mod) : SX127x(mod) {}
+
+  int16_t begin(float freq = 915.0, float bw = 125.0, uint8_t sf = 9, uint8_t cr = 7, uint8_t syncWord = SX127X_SYNC_WORD,
+                int8_t power = 17, uint8_t currentLimit = 100, uint16_t preambleLength = 8, uint8_t gain = 0);
+};
+
+class SX1278 : public SX1272 {
+ public:
+  SX1278(Module *mod) : SX1272(mod) {}
+};
+
+#endif  // LORALIB_H_HOST_
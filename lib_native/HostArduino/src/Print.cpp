@@ -0,0 +1,92 @@
+#include "Print.h"
+#include <stdio.h>
+#include <string.h>
+#include "host_hal.h"
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::write(const char *str) {
+  return str ? write((const uint8_t *)str, strlen(str)) : 0;
+}
+
+size_t Print::print(long value, int base) {
+  if (base == DEC) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%ld", value);
+    return write(buf);
+  }
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char buf[72];
+  char *p = buf + sizeof(buf) - 1;
+  *p = 0;
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    int digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  return write(p);
+}
+
+size_t Print::print(double value, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, value);
+  return write(buf);
+}
+
+int Stream::timedRead() {
+  uint64_t deadline = hostMicros() + (uint64_t)timeout_ * 1000;
+  while (true) {
+    int c = read();
+    if (c >= 0) {
+      return c;
+    }
+    if (hostMicros() >= deadline) {
+      return -1;
+    }
+    hostWaitUntil(deadline, HOST_WAIT_STREAM);
+  }
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    out += (char)c;
+    c = timedRead();
+  }
+  return out;
+}
+
+String Stream::readString() {
+  String out;
+  int c = timedRead();
+  while (c >= 0) {
+    out += (char)c;
+    c = timedRead();
+  }
+  return out;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t n = 0;
+  while (n < length) {
+    int c = timedRead();
+    if (c < 0) {
+      break;
+    }
+    buffer[n++] = (char)c;
+  }
+  return n;
+}
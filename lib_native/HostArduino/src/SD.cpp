@@ -0,0 +1,190 @@
+#include "SD.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+SDClass SD;
+
+struct HostFile {
+  FILE *f = nullptr;
+  std::string name;
+  std::string path;
+  bool directory = false;
+  std::vector<std::string> entries;
+  size_t next_entry = 0;
+};
+
+static std::string hostPath(const char *path) {
+  std::string p = host_config.sd_path;
+  if (path[0] != '/') {
+    p += '/';
+  }
+  return p + path;
+}
+
+static bool isDir(const std::string &path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool SDClass::begin(uint8_t cs_pin) {
+  (void)cs_pin;
+  if (!hostPowered(HOST_SD_POWER_PIN)) {
+    return false;
+  }
+  ::mkdir(host_config.sd_path.c_str(), 0755);
+  return isDir(host_config.sd_path);
+}
+
+void SDClass::end() {
+}
+
+File SDClass::open(const char *path, uint8_t mode) {
+  if (!hostPowered(HOST_SD_POWER_PIN)) {
+    return File();
+  }
+  std::shared_ptr<HostFile> impl = std::make_shared<HostFile>();
+  impl->path = hostPath(path);
+  std::string name = path;
+  impl->name = name.substr(name.find_last_of('/') + 1);
+  host_stats.sd_opens++;
+
+  if (isDir(impl->path)) {
+    DIR *dir = opendir(impl->path.c_str());
+    if (!dir) {
+      return File();
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+      if (entry->d_name[0] != '.') {
+        impl->entries.push_back(entry->d_name);
+      }
+    }
+    closedir(dir);
+    impl->directory = true;
+    return File(impl);
+  }
+
+  // FILE_WRITE of the SD library appends to the end of the file
+  impl->f = fopen(impl->path.c_str(), mode == FILE_WRITE ? "a+" : "r");
+  if (!impl->f) {
+    return File();
+  }
+  return File(impl);
+}
+
+bool SDClass::exists(const char *path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool SDClass::remove(const char *path) {
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool SDClass::mkdir(const char *path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0 || isDir(hostPath(path));
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+  if (!impl_ || !impl_->f || !hostPowered(HOST_SD_POWER_PIN)) {
+    return 0;
+  }
+  size_t n = fwrite(buffer, 1, size, impl_->f);
+  host_stats.sd_bytes_written += n;
+  return n;
+}
+
+int File::available() {
+  if (!impl_ || !impl_->f) {
+    return 0;
+  }
+  long pos = ftell(impl_->f);
+  fseek(impl_->f, 0, SEEK_END);
+  long end = ftell(impl_->f);
+  fseek(impl_->f, pos, SEEK_SET);
+  return (int)(end - pos);
+}
+
+int File::read() {
+  return impl_ && impl_->f ? fgetc(impl_->f) : -1;
+}
+
+int File::peek() {
+  if (!impl_ || !impl_->f) {
+    return -1;
+  }
+  int c = fgetc(impl_->f);
+  if (c >= 0) {
+    ungetc(c, impl_->f);
+  }
+  return c;
+}
+
+void File::flush() {
+  if (impl_ && impl_->f) {
+    fflush(impl_->f);
+  }
+}
+
+bool File::seek(uint32_t pos) {
+  return impl_ && impl_->f && fseek(impl_->f, pos, SEEK_SET) == 0;
+}
+
+uint32_t File::position() {
+  return impl_ && impl_->f ? (uint32_t)ftell(impl_->f) : 0;
+}
+
+uint32_t File::size() {
+  if (!impl_ || !impl_->f) {
+    return 0;
+  }
+  fflush(impl_->f);
+  struct stat st;
+  return stat(impl_->path.c_str(), &st) == 0 ? (uint32_t)st.st_size : 0;
+}
+
+void File::close() {
+  if (!impl_) {
+    return;
+  }
+  if (impl_->f) {
+    fclose(impl_->f);
+    impl_->f = nullptr;
+  }
+  host_stats.sd_closes++;
+  impl_.reset();
+}
+
+File::operator bool() const {
+  return impl_ && (impl_->f || impl_->directory);
+}
+
+const char *File::name() const {
+  return impl_ ? impl_->name.c_str() : "";
+}
+
+bool File::isDirectory() const {
+  return impl_ && impl_->directory;
+}
+
+File File::openNextFile(uint8_t mode) {
+  if (!impl_ || !impl_->directory || impl_->next_entry >= impl_->entries.size()) {
+    return File();
+  }
+  std::string dir = impl_->path.substr(host_config.sd_path.size());
+  std::string path = dir + "/" + impl_->entries[impl_->next_entry++];
+  return SD.open(path.c_str(), mode);
+}
+
+void File::rewindDirectory() {
+  if (impl_) {
+    impl_->next_entry = 0;
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef SD_H_HOST_
+#define SD_H_HOST_
+
+// Arduino SD library stand-in for the native build, the card is a host
+// directory (--sd). Opens, closes and written bytes are counted in host_stats.
+// The card does not answer while its power switch (HOST_SD_POWER_PIN) is off.
+
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x13
+
+struct HostFile;
+
+class File : public Stream {
+ public:
+  File() {}
+  explicit File(std::shared_ptr<HostFile> impl) : impl_(impl) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override;
+  bool seek(uint32_t pos);
+  uint32_t position();
+  uint32_t size();
+  void close();
+  operator bool() const;
+  const char *name() const;
+  bool isDirectory() const;
+  File openNextFile(uint8_t mode = FILE_READ);
+  void rewindDirectory();
+
+ private:
+  std::shared_ptr<HostFile> impl_;
+};
+
+class SDClass {
+ public:
+  bool begin(uint8_t cs_pin = 10);
+  void end();
+  File open(const char *path, uint8_t mode = FILE_READ);
+  File open(const String &path, uint8_t mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool exists(const char *path);
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path);
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool mkdir(const char *path);
+};
+
+extern SDClass SD;
+
+#endif  // SD_H_HOST_
@@ -0,0 +1,8 @@
+#ifndef SPI_H_
+#define SPI_H_
+
+// SPI bus is used only through SD and LoRaLib stand-ins in the native build
+
+#include "Arduino.h"
+
+#endif  // SPI_H_
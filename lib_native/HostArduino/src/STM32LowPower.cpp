@@ -0,0 +1,13 @@
+#include "STM32LowPower.h"
+
+STM32LowPower LowPower;
+
+void STM32LowPower::idle(uint32_t ms) {
+  hostIdleUntil(ms ? hostMicros() + ms * 1000ULL : host_config.duration_us);
+}
+
+void STM32LowPower::deepSleep(uint32_t ms) {
+  // without alarm only an interrupt wakes the MCU, at the latest the end of the run
+  uint64_t deadline = ms ? hostMicros() + ms * 1000ULL : host_config.duration_us;
+  hostSleepUntil(deadline);
+}
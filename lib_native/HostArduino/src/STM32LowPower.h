@@ -0,0 +1,21 @@
+#ifndef STM32LOWPOWER_H_HOST_
+#define STM32LOWPOWER_H_HOST_
+
+// STM32duino Low Power stand-in for the native build. deepSleep() is STOP
+// mode: the clock moves to the RTC alarm or to the next interrupt (e.g.
+// LoRa DIO0), the MCU draws STOP current and millis() stops meanwhile.
+// idle() is sleep mode (WFI): the same wake-ups, peripherals and millis()
+// keep running.
+
+#include "Arduino.h"
+
+class STM32LowPower {
+ public:
+  void begin() {}
+  void idle(uint32_t ms = 0);
+  void deepSleep(uint32_t ms = 0);
+};
+
+extern STM32LowPower LowPower;
+
+#endif  // STM32LOWPOWER_H_HOST_
@@ -0,0 +1,36 @@
+#ifndef STM32RTC_H_HOST_
+#define STM32RTC_H_HOST_
+
+// STM32duino RTC stand-in for the native build, the RTC counts the virtual
+// time from 2000-01-01 (RTC reset value) and keeps running in STOP mode.
+
+#include "Arduino.h"
+
+#define HOST_RTC_EPOCH_START 946684800UL
+
+class STM32RTC {
+ public:
+  enum Source_Clock : uint8_t { LSI_CLOCK, LSE_CLOCK, HSE_CLOCK };
+
+  static STM32RTC &getInstance() {
+    static STM32RTC instance;
+    return instance;
+  }
+
+  void setClockSource(Source_Clock source) { (void)source; }
+  void begin(bool resetTime = false) { (void)resetTime; }
+
+  // seconds since 1970, subSeconds in ms
+  uint32_t getEpoch(uint32_t *subSeconds = nullptr) {
+    uint64_t ms = hostMicros() / 1000;
+    if (subSeconds) {
+      *subSeconds = (uint32_t)(ms % 1000);
+    }
+    return HOST_RTC_EPOCH_START + (uint32_t)(ms / 1000);
+  }
+
+ private:
+  STM32RTC() {}
+};
+
+#endif  // STM32RTC_H_HOST_
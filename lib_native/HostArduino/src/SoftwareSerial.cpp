@@ -0,0 +1,197 @@
+#include "SoftwareSerial.h"
+#include <stdlib.h>
+
+// Typical response times of the M95
+#define MODEM_AT_LATENCY_MS 20
+#define MODEM_ATTACH_LATENCY_MS 300
+#define MODEM_CONNECT_LATENCY_MS 600
+#define MODEM_SEND_LATENCY_MS 250
+#define MODEM_CLOSE_LATENCY_MS 400
+#define MODEM_DEACT_LATENCY_MS 300
+#define GPRS_RTT_MS 300  // TCP data to server and answer back
+#define CTRL_Z 0x1A
+#define MQTT_PORT 1883
+
+void SoftwareSerial::begin(long baud) {
+  byte_us_ = (uint32_t)(10000000L / baud);
+}
+
+int SoftwareSerial::read() {
+  if (rx_.empty()) {
+    return -1;
+  }
+  int c = rx_.front();
+  rx_.pop_front();
+  return c;
+}
+
+size_t SoftwareSerial::write(uint8_t c) {
+  hostAdvance(byte_us_, HOST_WAIT_STREAM);
+  host_stats.modem_tx_bytes++;
+
+  if (data_mode_) {
+    if (c == '\n' && send_buffer_.empty() && line_end_) {
+      return 1;  // line feed after the AT+QISEND carriage return
+    }
+    line_end_ = false;
+    if (send_len_ == 0 && c == CTRL_Z) {
+      data_mode_ = false;
+      sendData(send_buffer_);
+    } else {
+      send_buffer_ += (char)c;
+      if (send_len_ && send_buffer_.size() == send_len_) {
+        data_mode_ = false;
+        sendData(send_buffer_);
+      }
+    }
+    return 1;
+  }
+  line_end_ = c == '\r';
+  if (c == '\r' || c == '\n') {
+    if (!line_.empty()) {
+      command(line_);
+      line_.clear();
+    }
+  } else {
+    line_ += (char)c;
+  }
+  return 1;
+}
+
+void SoftwareSerial::command(const std::string &line) {
+  // command echo is switched off (ATE0) on the deployed modems
+  if (line == "AT") {
+    reply(MODEM_AT_LATENCY_MS, "OK\r\n");
+  } else if (line == "AT+CGATT?") {
+    reply(MODEM_ATTACH_LATENCY_MS, "+CGATT: 1\r\n\r\nOK\r\n");
+  } else if (line.compare(0, 10, "AT+QICSGP=") == 0 || line.compare(0, 10, "AT+QIDNSIP") == 0) {
+    context_ = true;
+    reply(MODEM_AT_LATENCY_MS, "OK\r\n");
+  } else if (line.compare(0, 9, "AT+QINDI=") == 0) {
+    indication_ = atoi(line.c_str() + 9) == 1;
+    reply(MODEM_AT_LATENCY_MS, "OK\r\n");
+  } else if (line.compare(0, 10, "AT+QIOPEN=") == 0 && context_) {
+    if (connection_ != NO_CONNECTION) {
+      reply(MODEM_AT_LATENCY_MS, "OK\r\n\r\nALREADY CONNECT\r\n");
+      return;
+    }
+    if (host_config.tcp_fail_every && ++connects_ % host_config.tcp_fail_every == 0) {
+      reply(MODEM_AT_LATENCY_MS, "OK\r\n");
+      reply(MODEM_CONNECT_LATENCY_MS, "\r\nCONNECT FAIL\r\n");
+      return;
+    }
+    // AT+QIOPEN="TCP","host","port"
+    size_t port_start = line.rfind(",\"");
+    int port = port_start == std::string::npos ? 0 : atoi(line.c_str() + port_start + 2);
+    connection_ = port == MQTT_PORT ? MQTT_CONNECTION : HTTP_CONNECTION;
+    connection_id_++;
+    socket_rx_.clear();
+    broker_.open();
+    host_stats.tcp_connections++;
+    reply(MODEM_AT_LATENCY_MS, "OK\r\n");
+    reply(MODEM_CONNECT_LATENCY_MS, "\r\nCONNECT OK\r\n");
+  } else if (line.compare(0, 9, "AT+QISEND") == 0 && connection_ != NO_CONNECTION) {
+    send_len_ = line.size() > 10 && line[9] == '=' ? (size_t)atoi(line.c_str() + 10) : 0;
+    send_buffer_.clear();
+    reply(MODEM_AT_LATENCY_MS, "> ");
+    data_mode_ = true;
+  } else if (line.compare(0, 8, "AT+QIRD=") == 0) {
+    // AT+QIRD=0,1,0,<max length>
+    size_t max_len = (size_t)atoi(line.c_str() + line.rfind(',') + 1);
+    if (socket_rx_.empty()) {
+      reply(MODEM_AT_LATENCY_MS, "OK\r\n");
+      return;
+    }
+    std::string data = socket_rx_.substr(0, max_len);
+    socket_rx_.erase(0, data.size());
+    reply(MODEM_AT_LATENCY_MS, "+QIRD: 10.0.0.1:1883,TCP," + std::to_string(data.size()) + "\r\n" + data + "\r\nOK\r\n");
+  } else if (line == "AT+QICLOSE") {
+    if (connection_ == NO_CONNECTION) {
+      reply(MODEM_AT_LATENCY_MS, "ERROR\r\n");
+      return;
+    }
+    connection_ = NO_CONNECTION;
+    connection_id_++;
+    reply(MODEM_CLOSE_LATENCY_MS, "CLOSE OK\r\n");
+  } else if (line == "AT+QIDEACT") {
+    context_ = false;
+    connection_ = NO_CONNECTION;
+    connection_id_++;
+    reply(MODEM_DEACT_LATENCY_MS, "DEACT OK\r\n");
+  } else {
+    reply(MODEM_AT_LATENCY_MS, "ERROR\r\n");
+  }
+}
+
+void SoftwareSerial::sendData(const std::string &data) {
+  host_stats.tcp_tx_bytes += data.size();
+  reply(MODEM_SEND_LATENCY_MS, "SEND OK\r\n");
+  if (connection_ == HTTP_CONNECTION) {
+    host_stats.http_requests++;
+    if (host_config.http_keep_alive) {
+      // HTTP/1.1 server, the connection stays unless the request closes it
+      // (a bare GET line is HTTP/0.9 and is closed)
+      reply(GPRS_RTT_MS, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+      if (data.find(" HTTP/1.1\r\n") != std::string::npos &&
+          data.find("\r\nConnection: close\r\n") == std::string::npos) {
+        host_stats.http_kept_open++;
+        return;
+      }
+    }
+    // server answers and closes the http connection
+    closeConnection(MODEM_CLOSE_LATENCY_MS);
+    return;
+  }
+
+  std::string answer;
+  bool open = broker_.receive((const uint8_t *)data.data(), data.size(), &answer);
+  uint32_t id = connection_id_;
+  uint64_t at = hostMicros() + GPRS_RTT_MS * 1000ULL;
+  if (!answer.empty()) {
+    hostSchedule(at, [this, id, answer]() {
+      if (id != connection_id_) {
+        return;
+      }
+      host_stats.tcp_rx_bytes += answer.size();
+      if (indication_) {
+        bool announce = socket_rx_.empty();
+        socket_rx_ += answer;
+        if (announce) {
+          reply(0, "+QIRDI: 0,1,0\r\n");
+        }
+      } else {
+        reply(0, answer);
+      }
+    });
+  }
+  if (!open) {
+    closeConnection(GPRS_RTT_MS);
+  }
+}
+
+void SoftwareSerial::closeConnection(uint32_t latency_ms) {
+  uint32_t id = connection_id_;
+  hostSchedule(hostMicros() + latency_ms * 1000ULL, [this, id]() {
+    if (id != connection_id_) {
+      return;
+    }
+    connection_ = NO_CONNECTION;
+    connection_id_++;
+    reply(0, "CLOSED\r\n");
+  });
+}
+
+void SoftwareSerial::reply(uint32_t latency_ms, const std::string &text) {
+  uint64_t at = hostMicros() + (uint64_t)latency_ms * 1000;
+  if (at < reply_end_us_) {
+    at = reply_end_us_;
+  }
+  for (char c : text) {
+    at += byte_us_;
+    hostSchedule(at, [this, c]() {
+      rx_.push_back((uint8_t)c);
+      host_stats.modem_rx_bytes++;
+    });
+  }
+  reply_end_us_ = at;
+}
@@ -0,0 +1,65 @@
+#ifndef SOFTWARE_SERIAL_H_HOST_
+#define SOFTWARE_SERIAL_H_HOST_
+
+// SoftwareSerial stand-in for the native build with a Quectel M95 on the
+// other end. The modem answers the AT commands used by the firmware
+// (AT, CGATT, QICSGP, QIDNSIP, QINDI, QIOPEN, QISEND, QIRD, QICLOSE,
+// QIDEACT), replies arrive byte by byte at the serial baud rate after a
+// response latency. Sent bytes cost their transmit time, SoftwareSerial
+// bit-bangs with the CPU.
+//
+// A TCP connection to port 1883 goes to the MQTT broker stand-in
+// (host_broker.h), any other port is an http server that closes the
+// connection after the request. Received TCP data is announced by
+// "+QIRDI: 0,1,0" and read by AT+QIRD when AT+QINDI=1, otherwise it is
+// written to the serial line as it comes.
+
+#include <deque>
+#include <string>
+#include "Arduino.h"
+#include "host_broker.h"
+
+class SoftwareSerial : public Stream {
+ public:
+  SoftwareSerial(uint8_t rx_pin, uint8_t tx_pin) : rx_pin_(rx_pin), tx_pin_(tx_pin) {}
+
+  void begin(long baud);
+  void end() {}
+  bool listen() { return true; }
+  bool isListening() { return true; }
+  operator bool() const { return true; }
+
+  int available() override { return (int)rx_.size(); }
+  int read() override;
+  int peek() override { return rx_.empty() ? -1 : rx_.front(); }
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+ private:
+  enum Connection { NO_CONNECTION, HTTP_CONNECTION, MQTT_CONNECTION };
+
+  void command(const std::string &line);
+  void reply(uint32_t latency_ms, const std::string &text);
+  void sendData(const std::string &data);
+  void closeConnection(uint32_t latency_ms);
+
+  uint8_t rx_pin_;
+  uint8_t tx_pin_;
+  uint32_t byte_us_ = 1042;        // 10 bits at 9600 Bd
+  uint64_t reply_end_us_ = 0;      // last queued reply byte, replies do not overlap
+  std::deque<uint8_t> rx_;         // bytes delivered to the firmware
+  std::string line_;               // command being received
+  bool line_end_ = false;          // last byte was the carriage return of a command
+  bool data_mode_ = false;         // after QISEND, until Ctrl+Z or send_len_ bytes
+  size_t send_len_ = 0;            // length given by AT+QISEND=<n>, 0 for Ctrl+Z
+  std::string send_buffer_;
+  Connection connection_ = NO_CONNECTION;
+  uint32_t connection_id_ = 0;     // events of a closed connection are ignored
+  uint32_t connects_ = 0;          // AT+QIOPEN commands, for --tcp-fail
+  bool context_ = false;
+  bool indication_ = false;        // AT+QINDI=1
+  std::string socket_rx_;          // received TCP data not read by AT+QIRD yet
+  HostBroker broker_;
+};
+
+#endif  // SOFTWARE_SERIAL_H_HOST_
@@ -0,0 +1,8 @@
+#ifndef STRING_H_HOST_
+#define STRING_H_HOST_
+
+// <String.h> included by the firmware, not the C <string.h>
+
+#include "WString.h"
+
+#endif  // STRING_H_HOST_
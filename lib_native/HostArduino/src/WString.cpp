@@ -0,0 +1,260 @@
+#include "WString.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_hal.h"
+
+static void formatNumber(char *buf, size_t size, unsigned long value, bool negative, unsigned char base) {
+  char tmp[66];
+  int i = 0;
+  do {
+    int digit = value % base;
+    tmp[i++] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  size_t n = 0;
+  if (negative && n + 1 < size) {
+    buf[n++] = '-';
+  }
+  while (i > 0 && n + 1 < size) {
+    buf[n++] = tmp[--i];
+  }
+  buf[n] = 0;
+}
+
+String::String(const char *cstr) {
+  copy(cstr ? cstr : "", cstr ? strlen(cstr) : 0);
+}
+
+String::String(const String &str) {
+  copy(str.c_str(), str.len_);
+}
+
+String::String(String &&str) : buffer_(str.buffer_), capacity_(str.capacity_), len_(str.len_) {
+  str.buffer_ = nullptr;
+  str.capacity_ = 0;
+  str.len_ = 0;
+}
+
+String::String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+String::String(char c) {
+  char buf[2] = {c, 0};
+  copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+  char buf[68];
+  bool negative = value < 0 && base == 10;
+  formatNumber(buf, sizeof(buf), negative ? -(unsigned long)value : (unsigned long)value, negative, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) {
+  char buf[68];
+  formatNumber(buf, sizeof(buf), value, false, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned char decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String() {
+  release();
+}
+
+String &String::operator=(const String &rhs) {
+  if (this != &rhs) {
+    copy(rhs.c_str(), rhs.len_);
+  }
+  return *this;
+}
+
+String &String::operator=(String &&rhs) {
+  if (this != &rhs) {
+    release();
+    buffer_ = rhs.buffer_;
+    capacity_ = rhs.capacity_;
+    len_ = rhs.len_;
+    rhs.buffer_ = nullptr;
+    rhs.capacity_ = 0;
+    rhs.len_ = 0;
+  }
+  return *this;
+}
+
+String &String::operator=(const char *cstr) {
+  copy(cstr ? cstr : "", cstr ? strlen(cstr) : 0);
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  if (buffer_ && capacity_ >= size) {
+    return true;
+  }
+  char *buf = (char *)realloc(buffer_, size + 1);
+  if (!buf) {
+    return false;
+  }
+  host_stats.string_allocs++;
+  host_stats.string_bytes += size + 1 - (buffer_ ? capacity_ + 1 : 0);
+  if (host_stats.string_bytes > host_stats.string_bytes_peak) {
+    host_stats.string_bytes_peak = host_stats.string_bytes;
+  }
+  if (!buffer_) {
+    buf[0] = 0;
+  }
+  buffer_ = buf;
+  capacity_ = size;
+  return true;
+}
+
+void String::release() {
+  if (buffer_) {
+    host_stats.string_bytes -= capacity_ + 1;
+    free(buffer_);
+    buffer_ = nullptr;
+  }
+}
+
+void String::copy(const char *cstr, unsigned int length) {
+  if (!reserve(length)) {
+    len_ = 0;
+    return;
+  }
+  memmove(buffer_, cstr, length);
+  buffer_[length] = 0;
+  len_ = length;
+}
+
+bool String::concat(const char *cstr) {
+  unsigned int n = strlen(cstr);
+  if (!reserve(len_ + n)) {
+    return false;
+  }
+  memcpy(buffer_ + len_, cstr, n + 1);
+  len_ += n;
+  return true;
+}
+
+bool String::concat(const String &str) {
+  if (&str == this) {
+    String copy_of(str);
+    return concat(copy_of.c_str());
+  }
+  return concat(str.c_str());
+}
+
+bool String::concat(char c) {
+  char buf[2] = {c, 0};
+  return concat(buf);
+}
+
+bool String::equals(const String &str) const {
+  return len_ == str.len_ && strcmp(c_str(), str.c_str()) == 0;
+}
+
+bool String::equals(const char *cstr) const {
+  return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::startsWith(const String &prefix) const {
+  return prefix.len_ <= len_ && strncmp(c_str(), prefix.c_str(), prefix.len_) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+  return suffix.len_ <= len_ && strcmp(c_str() + len_ - suffix.len_, suffix.c_str()) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  if (from >= len_) {
+    return -1;
+  }
+  const char *found = strchr(c_str() + from, c);
+  return found ? (int)(found - c_str()) : -1;
+}
+
+int String::indexOf(const String &str, unsigned int from) const {
+  if (from >= len_) {
+    return -1;
+  }
+  const char *found = strstr(c_str() + from, str.c_str());
+  return found ? (int)(found - c_str()) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int tmp = from;
+    from = to;
+    to = tmp;
+  }
+  if (from >= len_) {
+    return String();
+  }
+  if (to > len_) {
+    to = len_;
+  }
+  String out;
+  out.copy(c_str() + from, to - from);
+  return out;
+}
+
+void String::trim() {
+  if (!buffer_ || len_ == 0) {
+    return;
+  }
+  unsigned int begin = 0;
+  while (begin < len_ && (buffer_[begin] == ' ' || (buffer_[begin] >= '\t' && buffer_[begin] <= '\r'))) {
+    begin++;
+  }
+  unsigned int end = len_;
+  while (end > begin && (buffer_[end - 1] == ' ' || (buffer_[end - 1] >= '\t' && buffer_[end - 1] <= '\r'))) {
+    end--;
+  }
+  len_ = end - begin;
+  memmove(buffer_, buffer_ + begin, len_);
+  buffer_[len_] = 0;
+}
+
+long String::toInt() const {
+  return atol(c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(c_str());
+}
+
+String operator+(const String &lhs, const String &rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const String &lhs, const char *rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const String &lhs, char rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
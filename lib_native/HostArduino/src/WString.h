@@ -0,0 +1,74 @@
+#ifndef WSTRING_H_
+#define WSTRING_H_
+
+#include <stddef.h>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+// Host stand-in of Arduino String, allocates from the heap the same way
+// (malloc/realloc per concatenation), so heap use measured on the host
+// follows the firmware. Allocations are counted in host_stats.
+class String {
+ public:
+  String(const char *cstr = "");
+  String(const String &str);
+  String(String &&str);
+  String(const __FlashStringHelper *str);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimals = 2);
+  explicit String(double value, unsigned char decimals = 2);
+  ~String();
+
+  String &operator=(const String &rhs);
+  String &operator=(String &&rhs);
+  String &operator=(const char *cstr);
+
+  bool concat(const String &str);
+  bool concat(const char *cstr);
+  bool concat(char c);
+  String &operator+=(const String &rhs) { concat(rhs); return *this; }
+  String &operator+=(const char *cstr) { concat(cstr); return *this; }
+  String &operator+=(char c) { concat(c); return *this; }
+
+  unsigned int length() const { return len_; }
+  const char *c_str() const { return buffer_ ? buffer_ : ""; }
+  char charAt(unsigned int index) const { return index < len_ ? buffer_[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  bool equals(const String &str) const;
+  bool equals(const char *cstr) const;
+  bool operator==(const String &rhs) const { return equals(rhs); }
+  bool operator==(const char *cstr) const { return equals(cstr); }
+  bool operator!=(const String &rhs) const { return !equals(rhs); }
+  bool startsWith(const String &prefix) const;
+  bool endsWith(const String &suffix) const;
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String &str, unsigned int from = 0) const;
+  String substring(unsigned int from) const { return substring(from, len_); }
+  String substring(unsigned int from, unsigned int to) const;
+  void trim();
+  long toInt() const;
+  float toFloat() const;
+
+ private:
+  bool reserve(unsigned int size);
+  void release();
+  void copy(const char *cstr, unsigned int length);
+
+  char *buffer_ = nullptr;
+  unsigned int capacity_ = 0;
+  unsigned int len_ = 0;
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+String operator+(const String &lhs, char rhs);
+
+#endif  // WSTRING_H_
@@ -0,0 +1,122 @@
+#include "host_broker.h"
+#include <stdio.h>
+#include "host_hal.h"
+
+#define MQTT_CONNECT 1
+#define MQTT_CONNACK 2
+#define MQTT_PUBLISH 3
+#define MQTT_PUBACK 4
+#define MQTT_SUBSCRIBE 8
+#define MQTT_SUBACK 9
+#define MQTT_PINGREQ 12
+#define MQTT_PINGRESP 13
+#define MQTT_DISCONNECT 14
+
+void HostBroker::open() {
+  buffer_.clear();
+  connected_ = false;
+  keep_alive_s_ = 0;
+  last_rx_us_ = hostMicros();
+}
+
+bool HostBroker::receive(const uint8_t *data, size_t len, std::string *reply) {
+  // broker drops the client after 1.5 keep-alive periods without a packet
+  if (connected_ && keep_alive_s_ && hostMicros() - last_rx_us_ > keep_alive_s_ * 1500000ULL) {
+    host_stats.mqtt_keep_alive_drops++;
+    return false;
+  }
+  last_rx_us_ = hostMicros();
+  buffer_.append((const char *)data, len);
+
+  while (buffer_.size() >= 2) {
+    // fixed header: type and flags, remaining length (variable length integer)
+    size_t pos = 1;
+    uint32_t remaining = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      if (pos >= buffer_.size()) {
+        return true;  // incomplete header
+      }
+      byte = (uint8_t)buffer_[pos++];
+      remaining |= (uint32_t)(byte & 0x7F) << shift;
+      shift += 7;
+    } while ((byte & 0x80) && shift < 28);
+    if (buffer_.size() < pos + remaining) {
+      return true;  // incomplete packet
+    }
+    uint8_t type = (uint8_t)buffer_[0];
+    bool ok = packet(type, (const uint8_t *)buffer_.data() + pos, remaining, reply);
+    buffer_.erase(0, pos + remaining);
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HostBroker::packet(uint8_t type, const uint8_t *body, size_t len, std::string *reply) {
+  switch (type >> 4) {
+    case MQTT_CONNECT: {
+      // protocol name (2 + 4), level, flags, keep alive
+      if (len < 10) {
+        return false;
+      }
+      keep_alive_s_ = (uint16_t)(body[8] << 8 | body[9]);
+      connected_ = true;
+      host_stats.mqtt_connects++;
+      const uint8_t connack[] = {MQTT_CONNACK << 4, 2, 0, 0};
+      reply->append((const char *)connack, sizeof(connack));
+      return true;
+    }
+    case MQTT_PUBLISH: {
+      if (!connected_ || len < 2) {
+        return false;
+      }
+      int qos = (type >> 1) & 3;
+      size_t topic_len = (size_t)(body[0] << 8 | body[1]);
+      size_t pos = 2 + topic_len;
+      uint16_t packet_id = 0;
+      if (qos > 0) {
+        if (pos + 2 > len) {
+          return false;
+        }
+        packet_id = (uint16_t)(body[pos] << 8 | body[pos + 1]);
+        pos += 2;
+      }
+      if (pos > len) {
+        return false;
+      }
+      host_stats.mqtt_publishes++;
+      if (type & 0x08) {
+        host_stats.mqtt_duplicates++;
+      }
+      if (!host_config.quiet) {
+        printf("[broker %.3f s] %.*s: %.*s\n", hostMicros() / 1e6, (int)topic_len, (const char *)body + 2,
+               (int)(len - pos), (const char *)body + pos);
+      }
+      if (qos == 1) {
+        const uint8_t puback[] = {MQTT_PUBACK << 4, 2, (uint8_t)(packet_id >> 8), (uint8_t)(packet_id & 0xFF)};
+        reply->append((const char *)puback, sizeof(puback));
+      }
+      return true;
+    }
+    case MQTT_SUBSCRIBE: {
+      if (!connected_ || len < 2) {
+        return false;
+      }
+      const uint8_t suback[] = {MQTT_SUBACK << 4, 3, body[0], body[1], 0};
+      reply->append((const char *)suback, sizeof(suback));
+      return true;
+    }
+    case MQTT_PINGREQ: {
+      const uint8_t pingresp[] = {MQTT_PINGRESP << 4, 0};
+      reply->append((const char *)pingresp, sizeof(pingresp));
+      return connected_;
+    }
+    case MQTT_DISCONNECT:
+    default:
+      connected_ = false;
+      return false;
+  }
+}
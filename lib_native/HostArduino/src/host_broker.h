@@ -0,0 +1,31 @@
+#ifndef HOST_BROKER_H_
+#define HOST_BROKER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// MQTT 3.1.1 broker stand-in for one client, reached through the fake modem
+// of SoftwareSerial on port 1883. Answers CONNECT, PUBLISH QoS 0/1,
+// SUBSCRIBE, PINGREQ and DISCONNECT, published messages are counted in
+// host_stats and printed unless --quiet.
+class HostBroker {
+ public:
+  // Resets the session state, called when the TCP connection opens
+  void open();
+
+  // Bytes sent by the client, answers of the broker are appended to reply.
+  // Returns false when the connection is to be closed (DISCONNECT, protocol
+  // error or keep-alive expired before these bytes arrived).
+  bool receive(const uint8_t *data, size_t len, std::string *reply);
+
+ private:
+  bool packet(uint8_t type, const uint8_t *body, size_t len, std::string *reply);
+
+  std::string buffer_;
+  bool connected_ = false;
+  uint16_t keep_alive_s_ = 0;
+  uint64_t last_rx_us_ = 0;
+};
+
+#endif  // HOST_BROKER_H_
@@ -0,0 +1,427 @@
+#include "Arduino.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <chrono>
+#include <queue>
+#include <vector>
+
+HostConfig host_config;
+HostStats host_stats;
+HardwareSerial Serial;
+
+// LoRa stand-in loads received packets before setup()
+void hostLoRaBegin();
+void hostLoRaEnd();
+
+struct HostEvent {
+  uint64_t at_us;
+  uint64_t seq;
+  std::function<void()> fn;
+
+  bool operator>(const HostEvent &other) const {
+    return at_us != other.at_us ? at_us > other.at_us : seq > other.seq;
+  }
+};
+
+static uint64_t now_us = 0;
+static uint64_t slept_us = 0;  // SysTick does not run in STOP mode
+static uint64_t wake_us = 0;   // end of the last STOP mode
+static uint64_t event_seq = 0;
+static std::priority_queue<HostEvent, std::vector<HostEvent>, std::greater<HostEvent> > events;
+static bool interrupts_enabled = true;
+
+static uint8_t pin_modes[128];
+static uint8_t pin_values[128];
+static bool modem_on = false;  // see HOST_MODEM_STATUS_PIN
+
+static std::vector<HostTraceRow> trace;
+
+static double load_ma[HOST_LOADS];
+
+// ---- virtual clock ---------------------------------------------------------
+
+uint64_t hostMicros() {
+  return now_us;
+}
+
+uint64_t hostNextEvent() {
+  return events.empty() ? UINT64_MAX : events.top().at_us;
+}
+
+void hostSchedule(uint64_t at_us, std::function<void()> fn) {
+  events.push(HostEvent{at_us < now_us ? now_us : at_us, event_seq++, fn});
+}
+
+static void runDueEvents() {
+  while (interrupts_enabled && !events.empty() && events.top().at_us <= now_us) {
+    HostEvent event = events.top();
+    events.pop();
+    event.fn();
+  }
+}
+
+// Moves the clock to target_us, the loads draw their current meanwhile
+static void moveClock(uint64_t target_us, HostWaitReason reason) {
+  double s = (target_us - now_us) / 1e6;
+  const HostPowerModel &power = host_config.power;
+  load_ma[HOST_LOAD_MCU] = reason == HOST_WAIT_SLEEP  ? power.mcu_stop_ma
+                           : reason == HOST_WAIT_IDLE ? power.mcu_idle_ma
+                                                      : power.mcu_run_ma;
+  for (int load = 0; load < HOST_LOADS; load++) {
+    host_stats.load_mas[load] += load_ma[load] * s;
+  }
+  if (reason == HOST_WAIT_SLEEP) {
+    slept_us += target_us - now_us;
+  }
+  now_us = target_us;
+}
+
+void hostAdvance(uint64_t us, HostWaitReason reason) {
+  uint64_t target = now_us + us;
+  host_stats.waited_us[reason] += us;
+  while (interrupts_enabled && !events.empty() && events.top().at_us <= target) {
+    moveClock(events.top().at_us, reason);
+    runDueEvents();
+  }
+  moveClock(target, reason);
+}
+
+void hostWaitUntil(uint64_t deadline_us, HostWaitReason reason) {
+  uint64_t target = deadline_us;
+  if (interrupts_enabled && hostNextEvent() < target) {
+    target = hostNextEvent();
+  }
+  if (target > now_us) {
+    hostAdvance(target - now_us, reason);
+  } else {
+    runDueEvents();
+  }
+}
+
+void hostSleepUntil(uint64_t deadline_us) {
+  host_stats.sleeps++;
+  if (now_us - wake_us > host_stats.awake_us_max) {
+    host_stats.awake_us_max = now_us - wake_us;
+  }
+  hostWaitUntil(deadline_us, HOST_WAIT_SLEEP);
+  wake_us = now_us;
+}
+
+void hostIdleUntil(uint64_t deadline_us) {
+  host_stats.idles++;
+  hostWaitUntil(deadline_us, HOST_WAIT_IDLE);
+}
+
+void hostSetLoad(HostLoad load, double ma) {
+  load_ma[load] = ma;
+}
+
+unsigned long millis() {
+  return (unsigned long)((now_us - slept_us) / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(now_us - slept_us);
+}
+
+void delay(unsigned long ms) {
+  hostAdvance((uint64_t)ms * 1000, HOST_WAIT_DELAY);
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvance(us, HOST_WAIT_DELAY);
+}
+
+void interrupts() {
+  interrupts_enabled = true;
+  runDueEvents();
+}
+
+void noInterrupts() {
+  interrupts_enabled = false;
+}
+
+// ---- pins ------------------------------------------------------------------
+
+bool hostPowered(uint8_t pin) {
+  return pin >= sizeof(pin_modes) || pin_modes[pin] != OUTPUT || pin_values[pin] == HIGH;
+}
+
+static void updatePowerSwitches() {
+  hostSetLoad(HOST_LOAD_SENSORS, hostPowered(HOST_SENSOR_POWER_PIN) ? host_config.power.sensors_ma : 0);
+  hostSetLoad(HOST_LOAD_SD, hostPowered(HOST_SD_POWER_PIN) ? host_config.power.sd_ma : 0);
+}
+
+bool hostTraceRow(HostTraceRow *row) {
+  if (trace.empty()) {
+    return false;
+  }
+  size_t index = (size_t)(now_us / 1000 / host_config.trace_period_ms);
+  *row = trace[index < trace.size() ? index : trace.size() - 1];
+  return true;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < sizeof(pin_modes)) {
+    pin_modes[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+      pin_values[pin] = HIGH;
+    }
+  }
+  updatePowerSwitches();
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin == HOST_MODEM_POWERKEY_PIN && pin_modes[pin] == OUTPUT && pin_values[pin] == HIGH && !value) {
+    modem_on = !modem_on;
+  }
+  if (pin < sizeof(pin_values)) {
+    pin_values[pin] = value ? HIGH : LOW;
+  }
+  updatePowerSwitches();
+}
+
+int digitalRead(uint8_t pin) {
+  HostTraceRow row;
+  if (pin == HOST_FIRE_SWITCH_PIN && pin_modes[pin] == INPUT_PULLUP && hostTraceRow(&row)) {
+    // golden label switch pulls the pin low when there is a fire
+    return row.label ? LOW : HIGH;
+  }
+  if (pin == HOST_MODEM_STATUS_PIN && pin_modes[pin] == INPUT) {
+    return modem_on ? HIGH : LOW;
+  }
+  return pin < sizeof(pin_values) ? pin_values[pin] : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  HostTraceRow row;
+  if (pin == HOST_BATTERY_PIN) {
+    return host_config.battery_adc;
+  }
+  if (!hostPowered(HOST_SENSOR_POWER_PIN) || !hostTraceRow(&row)) {
+    return 0;
+  }
+  switch (pin) {
+    case HOST_SMOKE_PIN: return row.smoke;
+    case HOST_FLAME_PIN: return row.flame;
+    case HOST_GAS_PIN: return row.gas;
+    default: return 0;
+  }
+}
+
+long random(long max) {
+  return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+  return min < max ? min + rand() % (max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  srand((unsigned)seed);
+}
+
+// ---- serial monitor --------------------------------------------------------
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (!host_config.quiet) {
+    putchar(c);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  if (!host_config.quiet) {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+// ---- main ------------------------------------------------------------------
+
+static bool loadTrace(const std::string &path) {
+  FILE *f = fopen(path.c_str(), "r");
+  if (!f) {
+    return false;
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    HostTraceRow row = {0, 0, 0, 0};
+    if (sscanf(line, "%d,%d,%d,%d", &row.smoke, &row.flame, &row.gas, &row.label) >= 3) {
+      trace.push_back(row);
+    }
+  }
+  fclose(f);
+  return !trace.empty();
+}
+
+static void usage(const char *program) {
+  fprintf(stderr, "usage: %s [--duration s] [--trace session.TXT] [--trace-period ms] [--air-in packets.txt]\n"
+                  "       [--air-repeat] [--air-out packets.txt] [--sd dir] [--tick us] [--battery adc]\n"
+                  "       [--battery-wh Wh] [--max-loop ms] [--tcp-fail n] [--http-keep-alive] [--quiet]\n", program);
+}
+
+static bool parseArgs(int argc, char **argv) {
+  bool duration_set = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--quiet") {
+      host_config.quiet = true;
+    } else if (arg == "--duration" && has_value) {
+      host_config.duration_us = (uint64_t)(atof(argv[++i]) * 1e6);
+      duration_set = true;
+    } else if (arg == "--trace" && has_value) {
+      host_config.trace_path = argv[++i];
+    } else if (arg == "--trace-period" && has_value) {
+      host_config.trace_period_ms = atoi(argv[++i]);
+    } else if (arg == "--air-in" && has_value) {
+      host_config.air_in_path = argv[++i];
+    } else if (arg == "--air-repeat") {
+      host_config.air_repeat = true;
+    } else if (arg == "--air-out" && has_value) {
+      host_config.air_out_path = argv[++i];
+    } else if (arg == "--sd" && has_value) {
+      host_config.sd_path = argv[++i];
+    } else if (arg == "--tick" && has_value) {
+      host_config.tick_us = atoi(argv[++i]);
+    } else if (arg == "--battery" && has_value) {
+      host_config.battery_adc = atoi(argv[++i]);
+    } else if (arg == "--battery-wh" && has_value) {
+      host_config.battery_wh = atof(argv[++i]);
+    } else if (arg == "--max-loop" && has_value) {
+      host_config.max_loop_ms = atoi(argv[++i]);
+    } else if (arg == "--tcp-fail" && has_value) {
+      host_config.tcp_fail_every = atoi(argv[++i]);
+    } else if (arg == "--http-keep-alive") {
+      host_config.http_keep_alive = true;
+    } else {
+      return false;
+    }
+  }
+  if (!host_config.trace_path.empty()) {
+    if (!loadTrace(host_config.trace_path)) {
+      fprintf(stderr, "cannot read trace %s\n", host_config.trace_path.c_str());
+      return false;
+    }
+    if (!duration_set) {
+      host_config.duration_us = (uint64_t)trace.size() * host_config.trace_period_ms * 1000;
+    }
+  }
+  return true;
+}
+
+static uint64_t heapInUse() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks;
+}
+
+static void printStats(double wall_s, uint64_t heap_base, uint64_t loop_start_us) {
+  const HostStats &s = host_stats;
+  double total_s = now_us / 1e6;
+  uint64_t core_us = now_us - s.waited_us[HOST_WAIT_SLEEP] - s.waited_us[HOST_WAIT_IDLE];
+  double awake = now_us > 0 ? 100.0 * core_us / now_us : 0;
+  fprintf(stderr, "\n---- native run ----\n");
+  fprintf(stderr, "virtual time     %.1f s in %.2f s wall (%.0fx)\n", total_s, wall_s, wall_s > 0 ? total_s / wall_s : 0);
+  fprintf(stderr, "loop() calls     %llu, mean %.1f us, max %.1f ms\n", (unsigned long long)s.loops,
+          s.loops ? (double)(now_us - loop_start_us) / s.loops : 0, s.loop_us_max / 1e3);
+  fprintf(stderr, "time in delay()  %.1f s (%.1f %%)\n", s.waited_us[HOST_WAIT_DELAY] / 1e6, 100.0 * s.waited_us[HOST_WAIT_DELAY] / now_us);
+  fprintf(stderr, "time on serial   %.1f s (%.1f %%)\n", s.waited_us[HOST_WAIT_STREAM] / 1e6, 100.0 * s.waited_us[HOST_WAIT_STREAM] / now_us);
+  fprintf(stderr, "CPU awake        %.1f %%\n", awake);
+  fprintf(stderr, "LoRa             tx %llu (airtime %.2f s, duty %.3f %%), rx %llu, missed %llu\n",
+          (unsigned long long)s.lora_tx_packets, s.lora_tx_airtime_us / 1e6, 100.0 * s.lora_tx_airtime_us / now_us,
+          (unsigned long long)s.lora_rx_packets, (unsigned long long)s.lora_rx_missed);
+  fprintf(stderr, "modem serial     tx %llu B, rx %llu B\n", (unsigned long long)s.modem_tx_bytes, (unsigned long long)s.modem_rx_bytes);
+  fprintf(stderr, "GPRS             %llu connections, tcp tx %llu B, rx %llu B\n", (unsigned long long)s.tcp_connections,
+          (unsigned long long)s.tcp_tx_bytes, (unsigned long long)s.tcp_rx_bytes);
+  if (s.http_requests) {
+    fprintf(stderr, "HTTP server      %llu requests, %llu left open\n", (unsigned long long)s.http_requests,
+            (unsigned long long)s.http_kept_open);
+  }
+  if (s.mqtt_connects) {
+    fprintf(stderr, "MQTT broker      %llu connects, %llu publishes (%llu dup), %llu keep-alive drops\n",
+            (unsigned long long)s.mqtt_connects, (unsigned long long)s.mqtt_publishes,
+            (unsigned long long)s.mqtt_duplicates, (unsigned long long)s.mqtt_keep_alive_drops);
+  }
+  fprintf(stderr, "SD               %llu opens, %llu closes, %llu B written\n", (unsigned long long)s.sd_opens,
+          (unsigned long long)s.sd_closes, (unsigned long long)s.sd_bytes_written);
+  fprintf(stderr, "heap             peak %llu B above start\n", (unsigned long long)(s.heap_peak - heap_base));
+  fprintf(stderr, "String           %llu allocations, peak %llu B\n", (unsigned long long)s.string_allocs,
+          (unsigned long long)s.string_bytes_peak);
+}
+
+static void printPower(uint64_t loop_start_us) {
+  const HostStats &s = host_stats;
+  const HostPowerModel &power = host_config.power;
+  static const char *names[HOST_LOADS] = {"MCU", "radio", "sensors", "SD card"};
+  double total_s = now_us / 1e6;
+  double load_mw[HOST_LOADS];
+  double total_mw = 0;
+  for (int load = 0; load < HOST_LOADS; load++) {
+    double rail_v = load == HOST_LOAD_SENSORS ? power.sensors_rail_v : power.rail_v;
+    load_mw[load] = s.load_mas[load] / total_s * rail_v / power.converter_efficiency;
+    total_mw += load_mw[load];
+  }
+  if (s.sleeps) {
+    double awake_ms = (now_us - loop_start_us - slept_us) / 1e3;
+    fprintf(stderr, "STOP mode        %llu entries, awake between them mean %.1f ms, max %.1f ms\n",
+            (unsigned long long)s.sleeps, awake_ms / s.sleeps, s.awake_us_max / 1e3);
+  } else {
+    fprintf(stderr, "STOP mode        not used\n");
+  }
+  if (s.idles) {
+    fprintf(stderr, "sleep mode       %llu entries, %.1f s (%.1f %%)\n", (unsigned long long)s.idles,
+            s.waited_us[HOST_WAIT_IDLE] / 1e6, 100.0 * s.waited_us[HOST_WAIT_IDLE] / now_us);
+  }
+  for (int load = 0; load < HOST_LOADS; load++) {
+    fprintf(stderr, "  %-14s %9.4f mA, %8.3f mW from pack (%.1f %%)\n", names[load], s.load_mas[load] / total_s,
+            load_mw[load], total_mw > 0 ? 100.0 * load_mw[load] / total_mw : 0);
+  }
+  double life_h = total_mw > 0 ? host_config.battery_wh * 1000.0 / total_mw : 0;
+  fprintf(stderr, "battery          %.1f mW mean, %.1f Wh pack lasts %.0f h (%.1f days)\n", total_mw,
+          host_config.battery_wh, life_h, life_h / 24);
+}
+
+int main(int argc, char **argv) {
+  if (!parseArgs(argc, argv)) {
+    usage(argv[0]);
+    return 1;
+  }
+  auto wall_start = std::chrono::steady_clock::now();
+  hostLoRaBegin();
+
+  // packets of --air-in are loaded already, heap use above this is the firmware's
+  uint64_t heap_base = heapInUse();
+  host_stats.heap_base = heap_base;
+  host_stats.heap_peak = heap_base;
+  updatePowerSwitches();
+  setup();
+  uint64_t loop_start_us = now_us;
+  wake_us = now_us;
+  while (now_us < host_config.duration_us) {
+    uint64_t start = now_us;
+    loop();
+    hostAdvance(host_config.tick_us, HOST_WAIT_LOOP);
+    host_stats.loops++;
+    if (now_us - start > host_stats.loop_us_max) {
+      host_stats.loop_us_max = now_us - start;
+    }
+    uint64_t heap = heapInUse();
+    if (heap > host_stats.heap_peak) {
+      host_stats.heap_peak = heap;
+    }
+  }
+  hostLoRaEnd();
+  fflush(stdout);
+
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  printStats(wall_s, heap_base, loop_start_us);
+  if (host_config.battery_wh > 0) {
+    printPower(loop_start_us);
+  }
+  if (host_config.max_loop_ms && host_stats.loop_us_max > host_config.max_loop_ms * 1000ULL) {
+    fprintf(stderr, "FAILED: loop() took %.1f ms, limit %u ms\n", host_stats.loop_us_max / 1e3, host_config.max_loop_ms);
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+#ifndef HOST_HAL_H_
+#define HOST_HAL_H_
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+// Hardware abstraction of the native (host) build. Arduino API, LoRaLib,
+// SD and SoftwareSerial stand-ins are implemented on top of a virtual clock:
+// delay() and blocking reads move the clock instead of sleeping, so
+// setup()/loop() of the firmware run unmodified and much faster than real
+// time. Interrupts (LoRa DIO0) and modem replies are events scheduled on
+// the virtual clock.
+//
+// The program is started as
+//   program [--duration s] [--trace session.TXT] [--trace-period ms]
+//           [--air-in packets.txt] [--air-repeat] [--air-out packets.txt]
+//           [--sd dir] [--tick us] [--battery adc] [--battery-wh Wh]
+//           [--max-loop ms] [--tcp-fail n] [--http-keep-alive] [--quiet]
+//
+// With --max-loop the program fails (exit code 2) when a loop() call took
+// longer, e.g. because the firmware blocked on the modem. With --tcp-fail
+// every n-th TCP connection of the modem fails (CONNECT FAIL). By default
+// the http server closes the connection after every request, with
+// --http-keep-alive it answers and keeps an HTTP/1.1 connection open unless
+// the request has Connection: close.
+//
+// Power model of the end node: the MCU draws run current except in STOP
+// mode and idle (sleep mode, WFI) of the STM32LowPower stand-in, the radio by the LoRaLib state, sensors
+// and SD card while their power switch pins are high (always when the pins
+// are not outputs). With --battery-wh the run ends with the mean current of
+// every load and the projected life of the pack. As on the STM32, SysTick
+// and so millis() / micros() stop in STOP mode, the RTC keeps running.
+// Peripherals (ADC scan, radio) and SysTick run in idle.
+
+enum HostWaitReason {
+  HOST_WAIT_LOOP,    // time of loop() itself (--tick per call)
+  HOST_WAIT_DELAY,   // delay() / delayMicroseconds()
+  HOST_WAIT_STREAM,  // blocking Stream reads and SoftwareSerial writes
+  HOST_WAIT_SLEEP,   // low-power sleep, CPU is not awake
+  HOST_WAIT_IDLE,    // sleep mode (WFI), core stopped, clocks run
+  HOST_WAIT_REASONS
+};
+
+enum HostLoad {
+  HOST_LOAD_MCU,
+  HOST_LOAD_RADIO,
+  HOST_LOAD_SENSORS,
+  HOST_LOAD_SD,
+  HOST_LOADS
+};
+
+// Typical currents of the end node loads in mA (datasheets), sensors on the
+// 5 V rail, the rest on 3.3 V, both from the pack by switching converters
+struct HostPowerModel {
+  double mcu_run_ma = 6.0;           // STM32L073 at 32 MHz from flash
+  double mcu_idle_ma = 1.5;          // sleep mode at 32 MHz, ADC and DMA on
+  double mcu_stop_ma = 0.0012;       // STOP mode, RTC on LSE
+  double radio_standby_ma = 1.4;     // SX1272
+  double radio_sleep_ma = 0.0001;
+  double radio_tx_ma = 90.0;         // PA_BOOST +17 dBm
+  double radio_rx_ma = 11.2;
+  double sensors_ma = 175.0;         // MQ7 heater 150, SEN0570 20, DFR0076 5
+  double sd_ma = 1.0;                // card idle in SPI mode
+  double rail_v = 3.3;
+  double sensors_rail_v = 5.0;
+  double converter_efficiency = 0.85;
+};
+
+struct HostConfig {
+  uint64_t duration_us = 3600ULL * 1000000;
+  uint32_t tick_us = 100;             // virtual time of one loop() call without delays
+  std::string trace_path;             // session (smoke,flame,gas,label) fed to analogRead
+  uint32_t trace_period_ms = 6000;    // virtual time of one trace row
+  std::string air_in_path;            // received LoRa packets "<time ms> <hex bytes>"
+  bool air_repeat = false;            // replay air_in_path until the end of the run (soak tests)
+  std::string air_out_path;           // transmitted LoRa packets, same format
+  std::string sd_path = "sd";         // directory backing the SD card
+  int battery_adc = 660;              // analogRead of battery pin (about 11.1 V)
+  double battery_wh = 0;              // pack of the power report, 0 for no report
+  HostPowerModel power;
+  uint32_t max_loop_ms = 0;           // longest allowed loop() call, 0 for no limit
+  uint32_t tcp_fail_every = 0;        // every n-th AT+QIOPEN fails, 0 never
+  bool http_keep_alive = false;       // http server keeps HTTP/1.1 connections open
+  bool quiet = false;                 // suppress Serial output
+};
+
+struct HostStats {
+  uint64_t loops = 0;
+  uint64_t loop_us_max = 0;
+  uint64_t waited_us[HOST_WAIT_REASONS] = {0};
+  uint64_t lora_tx_packets = 0;
+  uint64_t lora_tx_airtime_us = 0;
+  uint64_t lora_rx_packets = 0;
+  uint64_t lora_rx_missed = 0;
+  uint64_t modem_tx_bytes = 0;
+  uint64_t modem_rx_bytes = 0;
+  uint64_t tcp_tx_bytes = 0;          // payload sent over GPRS by the modem
+  uint64_t tcp_rx_bytes = 0;          // payload received over GPRS
+  uint64_t tcp_connections = 0;
+  uint64_t http_requests = 0;         // requests the http server took
+  uint64_t http_kept_open = 0;        // of them answered without closing
+  uint64_t mqtt_connects = 0;
+  uint64_t mqtt_publishes = 0;
+  uint64_t mqtt_duplicates = 0;
+  uint64_t mqtt_keep_alive_drops = 0;
+  uint64_t sd_opens = 0;
+  uint64_t sd_closes = 0;
+  uint64_t sd_bytes_written = 0;
+  uint64_t string_allocs = 0;         // String (re)allocations of the firmware
+  uint64_t string_bytes = 0;          // heap held by String buffers
+  uint64_t string_bytes_peak = 0;
+  uint64_t heap_base = 0;             // heap in use before setup()
+  uint64_t heap_peak = 0;
+  uint64_t sleeps = 0;                // STOP mode entries
+  uint64_t idles = 0;                 // sleep mode (WFI) entries
+  uint64_t awake_us_max = 0;          // longest time awake between them
+  double load_mas[HOST_LOADS] = {0};  // charge drawn by every load, mA s
+};
+
+extern HostConfig host_config;
+extern HostStats host_stats;
+
+uint64_t hostMicros();
+
+// Moves the clock forward by us, due events run in order on the way
+void hostAdvance(uint64_t us, HostWaitReason reason);
+
+// Moves the clock to the next event or to deadline, whichever comes first
+void hostWaitUntil(uint64_t deadline_us, HostWaitReason reason);
+
+// Runs fn (e.g. an interrupt handler) when the clock reaches at_us
+void hostSchedule(uint64_t at_us, std::function<void()> fn);
+
+// Time of the next scheduled event, UINT64_MAX if there is none
+uint64_t hostNextEvent();
+
+// Current drawn by load from now on, mA at its rail (MCU is set by the
+// wait reason)
+void hostSetLoad(HostLoad load, double ma);
+
+// STOP mode until the next event (interrupt) or until deadline
+void hostSleepUntil(uint64_t deadline_us);
+
+// Sleep mode (WFI) until the next event or until deadline
+void hostIdleUntil(uint64_t deadline_us);
+
+// False while the power switch on pin (HOST_SENSOR_POWER_PIN,
+// HOST_SD_POWER_PIN) is an output driven low
+bool hostPowered(uint8_t pin);
+
+// Current row of the analog trace, false when there is no trace
+struct HostTraceRow {
+  int smoke;
+  int flame;
+  int gas;
+  int label;
+};
+bool hostTraceRow(HostTraceRow *row);
+
+#endif  // HOST_HAL_H_
@@ -0,0 +1,44 @@
+// MemoryProfile stand-in for the native build: the paint is a window of
+// the host stack below paintStack() (depth of the calls from setup() and
+// loop(), in host frames), the heap is what the firmware took above the
+// heap in use before setup() (malloc of glibc), static RAM the .data and
+// .bss of the program.
+#include <malloc.h>
+#include <stdint.h>
+#include "host_hal.h"
+#include "memory_profile.h"
+
+#define HOST_STACK_PAINT (64 * 1024)  // B of the window
+
+extern "C" char __data_start;  // first byte of .data
+extern "C" char end;           // end of .bss
+
+static char *paintTop = nullptr;
+
+__attribute__((noinline)) void paintStack() {
+  paintTop = (char *)__builtin_frame_address(0);
+  volatile uint32_t *p = (uint32_t *)(((uintptr_t)paintTop - HOST_STACK_PAINT) & ~(uintptr_t)3);
+  volatile uint32_t *top = (uint32_t *)(((uintptr_t)paintTop - MEMORY_PAINT_GUARD) & ~(uintptr_t)3);
+  for (; p < top; p++) {
+    *p = MEMORY_PAINT;
+  }
+}
+
+MemoryUsage memoryUsage() {
+  MemoryUsage usage = {};
+  usage.static_ram = (uint32_t)(&end - &__data_start);
+  struct mallinfo2 info = mallinfo2();
+  uint64_t heap = info.uordblks > host_stats.heap_peak ? info.uordblks : host_stats.heap_peak;
+  usage.heap_peak = heap > host_stats.heap_base ? (uint32_t)(heap - host_stats.heap_base) : 0;
+  if (paintTop == nullptr) {
+    return usage;
+  }
+  const volatile uint32_t *bottom = (uint32_t *)(((uintptr_t)paintTop - HOST_STACK_PAINT) & ~(uintptr_t)3);
+  const volatile uint32_t *p = bottom;
+  while ((char *)p < paintTop && *p == MEMORY_PAINT) {
+    p++;
+  }
+  usage.stack_peak = (uint32_t)(paintTop - (const char *)p);
+  usage.free_min = (uint32_t)((const char *)p - (const char *)bottom);
+  return usage;
+}
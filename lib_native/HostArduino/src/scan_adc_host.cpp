@@ -0,0 +1,23 @@
+// ScanAdc stand-in for the native build: the scan ends scanAdcTimeUs()
+// after start() as an interrupt, with analogRead() of every pin in 12 bit
+// counts. Channels are ordered by pin number as A1 .. A5 on the Nucleo.
+#include "Arduino.h"
+#include "scan_adc.h"
+
+bool ScanAdc::begin(const uint32_t *pins, uint8_t channels, ScanAdcCallback callback) {
+  return setChannels(pins, pins, channels, callback);
+}
+
+bool ScanAdc::start() {
+  if (busy_ || channels_ == 0) {
+    return false;
+  }
+  busy_ = true;
+  hostSchedule(hostMicros() + scanAdcTimeUs(channels_), [this]() {
+    for (uint8_t k = 0; k < channels_; k++) {
+      buffer_[k] = (uint16_t)(analogRead((uint8_t)pins_[order_[k]]) * 4);
+    }
+    complete();
+  });
+  return true;
+}
@@ -9,15 +9,53 @@
 // include the library
 #include "Arduino.h"
 #include <LoRaLib.h>
-#include <String.h>
 #include <SoftwareSerial.h>
+#include "fire_frame.h"
+#include "energy_profile.h"
+#include "spsc_queue.h"
+#include "quectel_client.h"
+#include "mqtt_publisher.h"
+#include "at_engine.h"
+#include "uplink_writer.h"
 
 #define NODE_LOCAL_ADRESS 0x11
 #define PROB_SCALE 10000
 #define VOLTAGE_SCALE 1000
-#define MSG_LEN 11
+#define MSG_LEN FIRE_FRAME_MAX_LEN // longest radio frame (aggregated), see lib/FireFrame
 #define ERR_VAL 65535 // max value of received integer, is treated as error value
 
+// Set uplink mode. In batch mode are received readings collected for
+// BATCH_WINDOW_MS and sent together in one ThingSpeak bulk update, so one
+// GPRS session serves many readings. Reading with fire probability over
+// ALARM_PROB is sent immediately with the readings collected so far.
+// Comment out following # define for one GET request per reading.
+#define BATCH_UPLINK_MODE
+// In MQTT mode the receiver keeps one TCP connection to the broker open and
+// publishes every reading with QoS 1 to fire/<node>/reading, reconnecting
+// with backoff when it drops. Use instead of BATCH_UPLINK_MODE.
+// #define MQTT_UPLINK_MODE
+#define BATCH_WINDOW_MS 60000
+#define BATCH_MAX_READINGS 24
+#define BATCH_BODY_LEN 1280 // 24 readings of at most 50 characters + key
+#define ALARM_PROB 5000 // fire probability * PROB_SCALE
+#define BATCH_RETRY_MS 10000 // after a failed batch uplink
+
+#define THINGSPEAK_CHANNEL "2881290"
+#define THINGSPEAK_API_KEY "S8QL4UGSKU4E3NUH"
+
+#define MQTT_BROKER "broker.hivemq.com"
+#define MQTT_PORT "1883"
+#define MQTT_CLIENT_ID "fire-receiver-11"
+#define MQTT_KEEP_ALIVE_S 120 // shorter than NAT timeout of the operator
+#define MQTT_BACKOFF_MIN_MS 1000
+#define MQTT_BACKOFF_MAX_MS 300000
+
+#define AT_TIMEOUT_MS 5000
+
+#if defined(BATCH_UPLINK_MODE) && defined(MQTT_UPLINK_MODE)
+#error "Define only one of BATCH_UPLINK_MODE and MQTT_UPLINK_MODE"
+#endif
+
 // pin define
 # define GSM_POWERKEY_PIN 8
 # define GSM_STATUS_PIN 9
@@ -34,53 +72,201 @@
 //            or left floating.
 SX1272 lora = new LoRa;
 
-// flag to indicate that a packet was received
-volatile bool receivedFlag = false;
-
 // disable interrupt when it's not needed
 volatile bool enableInterrupt = true;
 
 //structs
-struct receivedMsg{
-  byte transm_id;
-  int flame;
-  int gas;
-  int smoke;
-  int prob;
-  int vbat;
-};
+// decoded radio frame, see lib/FireFrame
+typedef FireReading receivedMsg;
 
 // creating instance of receivedMsg struct, global
 receivedMsg msg;
 
+// The DIO0 interrupt only flags a received packet, SPI transfers of up to
+// MSG_LEN bytes in it would hold off the modem SoftwareSerial for bit times
+// in the middle of an AT exchange. loop() reads and decodes the packet as
+// soon as it runs (the AT engine does not block it) and queues the
+// readings, the uplink takes them from the queue at its own pace. Both
+// sides run in loop(), the queue only bounds the readings waiting for the
+// uplink. When the queue is full QUEUE_DROP_OLDEST drops the oldest queued
+// reading, QUEUE_DROP_NEWEST the one just received.
+#define RX_QUEUE_LEN 16 // power of two
+#define RX_QUEUE_POLICY QUEUE_DROP_OLDEST
+SpscQueue<receivedMsg, RX_QUEUE_LEN> rxQueue(RX_QUEUE_POLICY);
+// energy profiles of the end nodes (diagnostics frames), printed only
+SpscQueue<FireDiag, 2> diagQueue(QUEUE_DROP_OLDEST);
+
+// packet in the module FIFO, set by the interrupt
+volatile bool receivedFlag = false;
+
+// reception errors
+unsigned long rxCrcErrors = 0;
+unsigned long rxInvalid = 0;
+unsigned long rxLost = 0; // v2 frames missing in the sequence
+// packets overwritten in the FIFO before loop() read them (it blocked)
+volatile unsigned long rxOverruns = 0;
+
+// last sequence number of v2 nodes, nodes over RX_SEQ_NODES are not tracked
+#define RX_SEQ_NODES 16
+struct nodeSeq {
+  uint8_t id;
+  uint8_t seq;
+};
+nodeSeq rxSeq[RX_SEQ_NODES];
+int rxSeqNodes = 0;
+
+#ifdef BATCH_UPLINK_MODE
+// readings waiting for the bulk update, with time of reception
+struct batchEntry {
+  receivedMsg msg;
+  unsigned long time;
+};
+batchEntry batch[BATCH_MAX_READINGS];
+int batchLen = 0;
+bool batchAlarm = false;
+// the first batchSending readings are in the uplink running, they leave the
+// batch when it succeeds, a failed one is sent again after BATCH_RETRY_MS
+int batchSending = 0;
+bool batchRetry = false;
+unsigned long batchFailTime = 0;
+#define BATCH_HEADER_LEN 176 // 167 B with a 4 digit Content-Length
+// http request being sent, header is written right before the body
+char uplinkBuffer[BATCH_HEADER_LEN + BATCH_BODY_LEN];
+#else
+char uplinkBuffer[192];
+#endif
+
+// http uplink in progress, from the first AT command to QIDEACT
+bool uplinkRunning = false;
+bool uplinkOk = false;
+int uplinkReadings = 0;
+int uplinkBytes = 0;
+unsigned long uplinkStart = 0;
+
+#ifdef MQTT_UPLINK_MODE
+// reading taken from the queue, kept until the broker acknowledges it
+bool mqttPending = false;
+unsigned long mqttPendingTime = 0;
+unsigned long mqttBackoff = MQTT_BACKOFF_MIN_MS;
+unsigned long mqttLastAttempt = 0;
+bool mqttAttempted = false;
+bool mqttAttached = false; // attach script connected, session can be started
+bool mqttConnecting = false; // CONNECT sent, CONNACK taken in loop()
+#endif
+
 // Functions declarations
-int decodeUpperByte(byte upper_byte);
-int decodeNum(byte lower_byte, byte upper_byte);
-bool readMsg(byte arr[MSG_LEN], receivedMsg *msg);
+void readPacket();
+int readMsg(byte arr[MSG_LEN], size_t len, receivedMsg msgs[FIRE_FRAME_AGG_MAX]);
+bool readDiag(byte arr[MSG_LEN], size_t len);
+void countLost(const receivedMsg &msg);
 void printMsg(receivedMsg msg);
+void printDiag(const FireDiag &diag);
+void printRxStats();
+void printUplinkStats(int readings, int request_bytes, unsigned long start_time);
+#ifdef BATCH_UPLINK_MODE
+void addToBatch(receivedMsg msg);
+bool batchReady();
+int writeBatchBody(char *body, int size);
+void sendBatch();
+void batchDone(bool ok);
+#endif
+#ifdef MQTT_UPLINK_MODE
+void onMqttAttached(bool ok, uint8_t step);
+void mqttOpenSession();
+void mqttSessionDone(int result);
+void mqttFailed();
+bool publishReading(receivedMsg msg);
+#endif
 // GSM
 void gsm_module_init();
-bool WaitForResponse();
-bool SendCommand(String command);
-bool SendCommandCustomResp(String command, String resp);
-bool WaitForCustomResponse(String resp);
+void startUplink(const char *request, int len, int readings);
+void onUplinkDone(bool ok, uint8_t step);
+void onDeactDone(bool ok, uint8_t step);
 
 SoftwareSerial gprsSerial(6, 7); // RX, TX
 
-bool newData = false;
+// AT commands run as scripts from loop() (at.poll()), LoRa readings are
+// taken from the queue also while the modem works
+AtEngine at(gprsSerial);
+
+// GPRS attach and PDP context, first steps of the uplink scripts
+#define GPRS_ATTACH_STEPS \
+  {"AT", MODEM_OK, AT_TIMEOUT_MS, 0}, \
+  /* {"AT+CPIN?", MODEM_OK, AT_TIMEOUT_MS, 0}, SIM pin */ \
+  /* {"AT+CSQ", MODEM_OK, AT_TIMEOUT_MS, 0}, signal quality */ \
+  {"AT+CGATT?", MODEM_OK, AT_TIMEOUT_MS, 0}, \
+  /* start gprs connection */ \
+  {"AT+QICSGP=1,\"internet.t-mobile.cz\",\"gprs\",\"gprs\"", MODEM_OK, AT_TIMEOUT_MS, 0}, \
+  /* set next QIOPEN command to access through domain name (not IP) */ \
+  {"AT+QIDNSIP=1", MODEM_OK, AT_TIMEOUT_MS, 0}
+
+// http request to ThingSpeak, the request is the data of the script
+const AtStep httpScript[] = {
+  GPRS_ATTACH_STEPS,
+  // connect to server, wait for response with connection info
+  {"AT+QIOPEN=\"TCP\",\"api.thingspeak.com\",\"80\"", MODEM_OK, AT_TIMEOUT_MS, 0},
+  {nullptr, MODEM_CONNECT_OK, AT_TIMEOUT_MS, 0},
+  {"AT+QISEND", MODEM_PROMPT, AT_TIMEOUT_MS, 0},
+  {nullptr, MODEM_SEND_OK, AT_TIMEOUT_MS, AT_SEND_DATA},
+  {nullptr, MODEM_CLOSED, AT_TIMEOUT_MS, 0}, // wait until http connection close
+};
+
+// deactivate gprs context, also after a failed script
+const AtStep deactScript[] = {
+  {"AT+QIDEACT", MODEM_DEACT_OK, AT_TIMEOUT_MS, 0},
+};
+
+#ifdef MQTT_UPLINK_MODE
+// received data is announced by URC (AT+QINDI=1) for QuectelClient, the
+// TCP connection to the broker is opened here so loop() does not wait for
+// it, MqttPublisher starts the session over it
+const AtStep mqttAttachScript[] = {
+  GPRS_ATTACH_STEPS,
+  {"AT+QINDI=1", MODEM_OK, AT_TIMEOUT_MS, 0},
+  {"AT+QIOPEN=\"TCP\",\"" MQTT_BROKER "\",\"" MQTT_PORT "\"", MODEM_OK, AT_TIMEOUT_MS, 0},
+  {nullptr, MODEM_CONNECT_OK, QUECTEL_CONNECT_TIMEOUT_MS, 0},
+};
+
+QuectelClient gsmClient(gprsSerial);
+MqttPublisher mqtt(gsmClient);
+#endif
 
 void setFlag(void) {
   // check if the interrupt is enabled
   if(!enableInterrupt) {
-    Serial.println(F("Seflag terminated, Interrupt not enabled"));
     return;
   }
-
-  // we got a packet, set the flag
-  Serial.println(F("recflag set to true"));
+  if (receivedFlag) {
+    rxOverruns++;
+  }
   receivedFlag = true;
 }
 
+// Reads and decodes the packet flagged by setFlag(), queues its readings
+void readPacket() {
+  static byte byteArr[MSG_LEN];
+  static receivedMsg received[FIRE_FRAME_AGG_MAX];
+  size_t len = lora.getPacketLength();
+  if (len > MSG_LEN) {
+    len = MSG_LEN;
+  }
+  int state = lora.readData(byteArr, len);
+  if (state == ERR_NONE) {
+    int count = readMsg(byteArr, len, received);
+    for (int i = 0; i < count; i++) {
+      rxQueue.push(received[i]);
+    }
+    if (count == 0 && !readDiag(byteArr, len)) {
+      rxInvalid++;
+    }
+  } else if (state == ERR_CRC_MISMATCH) {
+    rxCrcErrors++;
+  }
+
+  // listen for the next packet
+  lora.startReceive();
+}
+
 void setup() {
   Serial.begin(9600);
   gprsSerial.begin(9600); // the GPRS baud rate
@@ -124,7 +310,8 @@ void setup() {
   }
   pinMode(GSM_STATUS_PIN, INPUT);
   pinMode(GSM_POWERKEY_PIN, OUTPUT);
-  // gsm_module_init();
+  // power the modem on here, the 2 s POWERKEY pulse would stall loop()
+  gsm_module_init();
 
   // NOTE: 'listen' mode will be disabled
   // automatically by calling any of the
@@ -141,128 +328,133 @@ void setup() {
   // by calling lora.startReceive()
 }
 
-
 void loop() {
-  if(receivedFlag) {
-    // disable the interrupt service routine while processing the data
-    enableInterrupt = false;
+  #ifdef MQTT_UPLINK_MODE
+  // an idle engine would take the URCs ("+QIRDI", "CLOSED") of QuectelClient
+  if (at.busy()) {
+    at.poll();
+  }
+  #else
+  at.poll();
+  #endif
 
-    // reset flag
+  if (receivedFlag) {
     receivedFlag = false;
-    newData = true;
-    
-    // buffer - byte array for received data
-    byte byteArr[MSG_LEN];
-    int state = lora.readData(byteArr, MSG_LEN);
-    
-    if (state == ERR_NONE) {
-      // packet was successfully received
-      Serial.println(F("Received packet!"));
-
-      // print data of the packet
-      Serial.println("Bytearray: ");
-      for(auto i: byteArr){
-        Serial.print(i);
-        Serial.print(", ");
-      }
-      Serial.print("\n");
-      
-      // decode the incoming message form byte array to receivedMsg struct
-      bool success = readMsg(byteArr, &msg);
+    readPacket();
+  }
 
-      // print message data to Serial monitor
-      printMsg(msg);
+  FireDiag diag;
+  if (diagQueue.pop(&diag)) {
+    printDiag(diag);
+  }
 
-      Serial.print("received values valid: ");
-      Serial.println(success);
+  #ifdef BATCH_UPLINK_MODE
+  // take everything received so far, the batch is sent when full anyway
+  while (batchLen < BATCH_MAX_READINGS && rxQueue.pop(&msg)) {
+    Serial.println(F("Received packet!"));
+    printMsg(msg);
+    addToBatch(msg);
+  }
 
+  if (!uplinkRunning && batchReady()) {
+    printRxStats();
+    sendBatch();
+  }
 
-    } else if (state == ERR_CRC_MISMATCH) {
-      // packet was received, but is malformed
-      Serial.println(F("CRC error!"));
+  #elif defined(MQTT_UPLINK_MODE)
+  if (at.busy()) {
+    // attach script runs, QuectelClient must not read the modem meanwhile
+  } else if (mqtt.loop()) {
+    if (!mqttPending && rxQueue.pop(&msg)) {
+      Serial.println(F("Received packet!"));
+      printMsg(msg);
+      printRxStats();
+      mqttPending = true;
+      mqttPendingTime = millis();
     }
-
-    // we're ready to receive more packets,
-    // enable interrupt service routine
-    enableInterrupt = true;
-    state = lora.startReceive();
+    if (mqttPending && publishReading(msg)) {
+      mqttPending = false;
+    }
+  } else if (mqttConnecting) {
+    mqttSessionDone(mqtt.pollConnect());
+  } else if (mqttAttached) {
+    mqttAttached = false;
+    mqttOpenSession();
+  } else if (!mqttAttempted || millis() - mqttLastAttempt >= mqttBackoff) {
+    // readings wait in rxQueue until the connection is back
+    mqttAttempted = true;
+    mqttLastAttempt = millis();
+    gsm_module_init();
+    at.run(mqttAttachScript, sizeof(mqttAttachScript) / sizeof(mqttAttachScript[0]), onMqttAttached);
   }
 
-  if (newData){
-    gsm_module_init();
-    
-    newData = false;
+  #else
+  if (!uplinkRunning && rxQueue.pop(&msg)) {
+    Serial.println(F("Received packet!"));
 
-    // GSM
-    float v_bat = float(msg.vbat)/VOLTAGE_SCALE;
-    float prob = float(msg.prob)/PROB_SCALE;
+    // print message data to Serial monitor
+    printMsg(msg);
+    printRxStats();
 
     Serial.print("Flame sensor = ");
     Serial.print(msg.flame);
     Serial.println(" °C");
     Serial.print("Probability = ");
+    char prob[12];
+    UplinkWriter(prob, sizeof(prob)).fixed(msg.prob, PROB_SCALE);
     Serial.print(prob);
     Serial.println(" %");
 
-    if (gprsSerial.available())
-      Serial.write(gprsSerial.read());
-
-    SendCommand("AT");
-
-    // SendCommand("AT+CPIN?"); // SIM pin
-    // SendCommand("AT+CREG?"); 
-    // SendCommand("AT+CSQ"); // signal quality
-    
-    SendCommand("AT+CGATT?");
-    
-    // start gprs connection
-    SendCommand("AT+QICSGP=1,\"internet.t-mobile.cz\",\"gprs\",\"gprs\""); 
-    
-    // set next QIOPEN command to access through domain name (not IP)
-    SendCommand("AT+QIDNSIP=1");                                           
-    
-    // connect to server
-    SendCommand("AT+QIOPEN=\"TCP\",\"api.thingspeak.com\",\"80\"");        
-    
-    // wait for response with connection info
-    WaitForCustomResponse("CONNECT");                                      
-    
-    // begin http GET request to remote server
-    SendCommandCustomResp("AT+QISEND", ">");    
-
-    String str = "GET https://api.thingspeak.com/update?api_key=S8QL4UGSKU4E3NUH&field1=" + String(msg.flame) + "&field2=" + String(msg.smoke) + "&field3=" + String(msg.gas) + "&field4=" + String(prob) + "&field5=" + String(v_bat);
-    gprsSerial.println(str);
-    gprsSerial.println((char)26); // end of message
-    WaitForCustomResponse("SEND");
-    WaitForCustomResponse("CLOSED"); // wait until http connection close
-    SendCommandCustomResp("AT+QIDEACT", "DEACT"); // deactivate gprs context
-    // delay(10000);
-  }
-
-  delay(50);
-}
+    // GSM, request written straight to the buffer the AT engine sends from
+    UplinkWriter request(uplinkBuffer, sizeof(uplinkBuffer));
+    request.text("GET https://api.thingspeak.com/update?api_key=" THINGSPEAK_API_KEY "&");
+    writeQueryFields(request, msg);
+    request.text("\r\n");
+    startUplink(uplinkBuffer, request.length(), 1);
+  }
+  #endif // end of uplink modes
 
-int decodeUpperByte(byte upper_byte){
-  int shifted = (int)upper_byte << 8;
-  return shifted;
-} 
+  // modem replies are taken sooner while a script runs
+  delay(at.busy() ? 5 : 50);
+}
 
-int decodeNum(byte lower_byte, byte upper_byte) {
-  int decoded_number = (int)lower_byte | decodeUpperByte(upper_byte);
-  return decoded_number;
+// Decodes frame of any version (v1 by its length) into readings, returns
+// their number, 0 for invalid frame
+int readMsg(byte arr[MSG_LEN], size_t len, receivedMsg msgs[FIRE_FRAME_AGG_MAX]){
+  int count = decodeFrames(arr, len, msgs, FIRE_FRAME_AGG_MAX);
+  for (int i = 0; i < count && len != FIRE_FRAME_V1_LEN; i++) {
+    countLost(msgs[i]);
+  }
+  return count;
 }
 
-bool readMsg(byte arr[MSG_LEN], receivedMsg *msg){
-  msg->transm_id = arr[0];
-  msg->smoke = decodeNum(arr[2], arr[1]);
-  msg->flame = decodeNum(arr[4], arr[3]);
-  msg->gas = decodeNum(arr[6], arr[5]);
-  msg->prob = decodeNum(arr[8], arr[7]);
-  msg->vbat = decodeNum(arr[10], arr[9]);
-  if(msg->flame >= ERR_VAL || msg->gas >= ERR_VAL||msg->smoke >= ERR_VAL||msg->prob >= ERR_VAL){
+// Queues diagnostics frame, returns false for other frames
+bool readDiag(byte arr[MSG_LEN], size_t len){
+  FireDiag diag;
+  if (!decodeFrameDiag(arr, len, &diag)) {
     return false;
   }
-  return true; 
+  diagQueue.push(diag);
+  return true;
+}
+
+// Adds frames skipped since the previous one of the node to rxLost, the
+// sequence starts again after reset of the node
+void countLost(const receivedMsg &msg){
+  for (int i = 0; i < rxSeqNodes; i++) {
+    if (rxSeq[i].id == msg.transm_id) {
+      if (!(msg.flags & FIRE_FLAG_BOOT)) {
+        rxLost += (uint8_t)(msg.seq - rxSeq[i].seq - 1);
+      }
+      rxSeq[i].seq = msg.seq;
+      return;
+    }
+  }
+  if (rxSeqNodes < RX_SEQ_NODES) {
+    rxSeq[rxSeqNodes].id = msg.transm_id;
+    rxSeq[rxSeqNodes].seq = msg.seq;
+    rxSeqNodes++;
+  }
 }
 
 void printMsg(receivedMsg msg){
@@ -278,85 +470,267 @@ void printMsg(receivedMsg msg){
   Serial.print(msg.prob);
   Serial.print(F(", vbat: "));
   Serial.print(msg.vbat);
+  Serial.print(F(", seq: "));
+  Serial.print(msg.seq);
+  if (msg.flags & FIRE_FLAG_HEARTBEAT) {
+    // node reports on change only, readings it did not send since reset
+    Serial.print(F(", heartbeat, suppressed: "));
+    Serial.print(msg.suppressed);
+  }
   Serial.println();
 }
 
-void gsm_module_init(){
-  if(!digitalRead(GSM_STATUS_PIN)){
-    digitalWrite(GSM_POWERKEY_PIN, HIGH);
-    delay(2000);
-    digitalWrite(GSM_POWERKEY_PIN, LOW);
+// Mean time and energy per stage of the node's measurement cycle
+void printDiag(const FireDiag &diag){
+  Serial.print(F("Energy profile of transmitter ID: "));
+  Serial.print(diag.transm_id);
+  Serial.print(F(", "));
+  Serial.print(diag.cycles);
+  Serial.print(F(" cycles, mean cycle "));
+  Serial.print(diag.cycle_ms);
+  Serial.println(F(" ms:"));
+  uint32_t total_uj = 0;
+  for (int stage = 0; stage < FIRE_DIAG_STAGES; stage++) {
+    Serial.print(F("  "));
+    Serial.print(profileStageName(stage));
+    Serial.print(F(": "));
+    Serial.print(diag.stage_us[stage]);
+    Serial.print(F(" us, "));
+    Serial.print(diag.stage_uj[stage]);
+    Serial.println(F(" uJ"));
+    total_uj += diag.stage_uj[stage];
   }
+  Serial.print(F("  total: "));
+  Serial.print(total_uj);
+  Serial.print(F(" uJ per cycle, "));
+  // uJ per ms is mW
+  Serial.print(diag.cycle_ms ? (float)total_uj / diag.cycle_ms : 0.0f);
+  Serial.println(F(" mW"));
 }
 
+void printRxStats(){
+  Serial.print(F("queued: "));
+  Serial.print(rxQueue.size());
+  Serial.print(F(", max queued: "));
+  Serial.print(rxQueue.highWater());
+  Serial.print(F(", dropped: "));
+  Serial.print(rxQueue.dropped());
+  Serial.print(F(", crc errors: "));
+  Serial.print(rxCrcErrors);
+  Serial.print(F(", invalid: "));
+  Serial.print(rxInvalid);
+  Serial.print(F(", lost: "));
+  Serial.print(rxLost);
+  Serial.print(F(", overruns: "));
+  Serial.print(rxOverruns);
+  Serial.println();
+}
+
+// Bytes of the http request (what goes over GPRS, without AT commands) and
+// time from modem power check to the end of the session, per reading
+void printUplinkStats(int readings, int request_bytes, unsigned long start_time){
+  unsigned long session_time = millis() - start_time;
+  Serial.print(F("uplink: "));
+  Serial.print(readings);
+  Serial.print(F(" readings, request "));
+  Serial.print(request_bytes);
+  Serial.print(F(" B ("));
+  Serial.print(request_bytes / readings);
+  Serial.print(F(" B per reading), modem session "));
+  Serial.print(session_time);
+  Serial.print(F(" ms ("));
+  Serial.print(session_time / readings);
+  Serial.println(F(" ms per reading)"));
+}
 
-bool WaitForResponse()
-{
-  unsigned long startTime = millis();
-  while (millis() - startTime < 5000)
-  {
-    String reply = gprsSerial.readStringUntil('\n');
-    if (reply.length() > 0)
-    {
-      Serial.print("Received: \"");
-      Serial.print(reply);
-      Serial.println("\"");
+#ifdef BATCH_UPLINK_MODE
+void addToBatch(receivedMsg msg){
+  batch[batchLen].msg = msg;
+  batch[batchLen].time = millis() - msg.age_s * 1000UL; // readings of aggregated frame are older
+  batchLen++;
+  if (msg.prob >= ALARM_PROB) {
+    batchAlarm = true;
+  }
+}
 
-      if (reply.startsWith("OK"))
-        return true;
+bool batchReady(){
+  if (batchLen == 0) {
+    return false;
+  }
+  if (batchRetry && millis() - batchFailTime < BATCH_RETRY_MS) {
+    return false;
+  }
+  return batchRetry || batchAlarm || batchLen >= BATCH_MAX_READINGS || millis() - batch[0].time >= BATCH_WINDOW_MS;
+}
 
-      if (reply.startsWith("ERROR"))
-        return false;
+// ThingSpeak bulk update body (bulk_update.csv, relative time format), one
+// update per reading: seconds since the previous one, fields 1-5 as in the
+// single GET request, node address in the status column
+int writeBatchBody(char *body, int size){
+  UplinkWriter out(body, size);
+  out.text("write_api_key=" THINGSPEAK_API_KEY "&time_format=relative&updates=");
+  unsigned long previous_time = batch[0].time;
+  for (int i = 0; i < batchLen && !out.overflow(); i++) {
+    if (i) {
+      out.character('|');
     }
+    // readings of aggregated frames may be older than the previous one
+    unsigned long reading_time = batch[i].time > previous_time ? batch[i].time : previous_time;
+    out.number((reading_time - previous_time) / 1000).character(',');
+    writeCsvFields(out, batch[i].msg);
+    out.text(",,,,,,,node").number((long)batch[i].msg.transm_id);
+    previous_time = reading_time;
   }
-  Serial.println("Did not receive OK.");
-  return false;
+  return out.length();
 }
 
-bool SendCommand(String command)
-{
-  Serial.print("Sending command: \"");
-  Serial.print(command);
-  Serial.println("\"");
+void sendBatch(){
+  // body first, the header needs its length
+  char *body = uplinkBuffer + BATCH_HEADER_LEN;
+  int body_len = writeBatchBody(body, BATCH_BODY_LEN);
+  char header[BATCH_HEADER_LEN];
+  UplinkWriter out(header, sizeof(header));
+  out.text("POST /channels/" THINGSPEAK_CHANNEL "/bulk_update.csv HTTP/1.1\r\nHost: api.thingspeak.com\r\n"
+           "Content-Type: application/x-www-form-urlencoded\r\n"
+           // the script waits for the server to close the connection
+           "Connection: close\r\nContent-Length: ");
+  out.number((long)body_len).text("\r\n\r\n");
+  int header_len = out.length();
+  memcpy(body - header_len, header, header_len);
+  startUplink(body - header_len, header_len + body_len, batchLen);
+
+  // readings received during the uplink are added after the ones sent
+  batchSending = batchLen;
+}
 
-  gprsSerial.print(command);
-  gprsSerial.print("\r\n");
+// End of the batch uplink: sent readings leave the batch, after a failure
+// all of them stay (alarm included) for the retry
+void batchDone(bool ok){
+  if (!ok) {
+    batchRetry = true;
+    batchFailTime = millis();
+    Serial.print(F("uplink: "));
+    Serial.print(batchLen);
+    Serial.println(F(" readings kept for retry"));
+    return;
+  }
+  batchLen -= batchSending;
+  memmove(batch, batch + batchSending, batchLen * sizeof(batch[0]));
+  batchSending = 0;
+  batchRetry = false;
+  batchAlarm = false;
+  for (int i = 0; i < batchLen; i++) {
+    if (batch[i].msg.prob >= ALARM_PROB) {
+      batchAlarm = true;
+    }
+  }
+}
+#endif // end of batch uplink mode
 
-  return WaitForResponse();
+#ifdef MQTT_UPLINK_MODE
+void onMqttAttached(bool ok, uint8_t step){
+  if (ok) {
+    mqttAttached = true;
+  } else {
+    mqttFailed();
+  }
 }
 
-bool SendCommandCustomResp(String command, String resp)
-{
-  Serial.print("Sending command: \"");
-  Serial.print(command);
-  Serial.println("\"");
+// Sends CONNECT over the connection of the attach script, CONNACK is
+// taken by mqttSessionDone() from loop()
+void mqttOpenSession(){
+  Serial.print(F("mqtt: connecting to "));
+  Serial.println(F(MQTT_BROKER));
+  gsmClient.opened();
+  if (mqtt.begin(MQTT_CLIENT_ID, MQTT_KEEP_ALIVE_S)) {
+    mqttConnecting = true;
+    return;
+  }
+  mqttFailed();
+}
 
-  gprsSerial.print(command);
-  gprsSerial.print("\r\n");
+// result of MqttPublisher::pollConnect(), 0 while CONNACK did not come
+void mqttSessionDone(int result){
+  if (result == 0) {
+    return;
+  }
+  mqttConnecting = false;
+  if (result > 0) {
+    Serial.println(F("mqtt: connected"));
+    mqttBackoff = MQTT_BACKOFF_MIN_MS;
+    return;
+  }
+  mqttFailed();
+}
 
-  return WaitForCustomResponse(resp);
+void mqttFailed(){
+  mqttBackoff = 2 * mqttBackoff < MQTT_BACKOFF_MAX_MS ? 2 * mqttBackoff : MQTT_BACKOFF_MAX_MS;
+  Serial.print(F("mqtt: connect failed, next try in "));
+  Serial.print(mqttBackoff);
+  Serial.println(F(" ms"));
+  at.run(deactScript, 1);
 }
 
-bool WaitForCustomResponse(String resp)
-{
-  unsigned long startTime = millis();
-  while (millis() - startTime < 5000) // TIMEOUT 5 SECONDS!
-  {
-    String reply = gprsSerial.readStringUntil('\n');
-    if (reply.length() > 0)
-    {
-      Serial.print("Received: \"");
-      Serial.print(reply);
-      Serial.println("\"");
-
-      if (reply.startsWith(resp))
-        return true;
-
-      if (reply.startsWith("ERROR"))
-        return false;
-    }
+// QoS 1 publish of the reading, fixed point values as received. Prints TCP
+// bytes of the exchange and latency from taking the reading from the queue.
+bool publishReading(receivedMsg msg){
+  char topic[24];
+  char payload[48];
+  UplinkWriter(topic, sizeof(topic)).text("fire/").number((long)msg.transm_id).text("/reading");
+  UplinkWriter body(payload, sizeof(payload));
+  writeCompactFields(body, msg);
+  int len = body.length();
+  uint32_t bytes = gsmClient.bytesSent() + gsmClient.bytesReceived();
+  if (!mqtt.publish(topic, (const uint8_t *)payload, len)) {
+    Serial.println(F("mqtt: publish failed"));
+    return false;
+  }
+  Serial.print(F("mqtt: published "));
+  Serial.print(topic);
+  Serial.print(F(", "));
+  Serial.print(gsmClient.bytesSent() + gsmClient.bytesReceived() - bytes);
+  Serial.print(F(" B, latency "));
+  Serial.print(millis() - mqttPendingTime);
+  Serial.print(F(" ms, retransmits "));
+  Serial.println(mqtt.retransmits());
+  return true;
+}
+#endif // end of mqtt uplink mode
+
+// Queues the http request (in uplinkBuffer) and QIDEACT after it
+void startUplink(const char *request, int len, int readings){
+  gsm_module_init();
+  uplinkRunning = true;
+  uplinkOk = false;
+  uplinkReadings = readings;
+  uplinkBytes = len;
+  uplinkStart = millis();
+  at.run(httpScript, sizeof(httpScript) / sizeof(httpScript[0]), onUplinkDone, request, len);
+  at.run(deactScript, 1, onDeactDone);
+}
+
+void onUplinkDone(bool ok, uint8_t step){
+  uplinkOk = ok;
+  if (!ok) {
+    Serial.print(F("uplink: failed at step "));
+    Serial.println(step);
   }
-  Serial.print("Did not receive ");
-  Serial.println(resp);
-  return false;
-}
\ No newline at end of file
+}
+
+void onDeactDone(bool ok, uint8_t step){
+  uplinkRunning = false;
+  if (uplinkOk) {
+    printUplinkStats(uplinkReadings, uplinkBytes, uplinkStart);
+  }
+  #ifdef BATCH_UPLINK_MODE
+  batchDone(uplinkOk);
+  #endif
+}
+
+void gsm_module_init(){
+  if(!digitalRead(GSM_STATUS_PIN)){
+    digitalWrite(GSM_POWERKEY_PIN, HIGH);
+    delay(2000);
+    digitalWrite(GSM_POWERKEY_PIN, LOW);
+  }
+}
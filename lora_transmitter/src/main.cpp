@@ -2,17 +2,242 @@
 
 // include the library
 #include "Arduino.h"
+#include <limits.h>
 #include <LoRaLib.h>
 #include <SPI.h>
 #include "SD.h"
-#include "model_real_data.h"
-#include <EloquentTinyML.h>
+#include "fire_frame.h"
 
 // Set mode. In SD card mode are data transmitted and saved to SD card, 
 // in normal mode are transmitted only. Comment out following # define 
 // for non-SD mode.
 #define SDCARD_MODE
 
+// Set inference mode. In fixed point mode is the fire net evaluated by
+// integer kernel from lib/FireNetFixed (no soft-float, no tensor arena),
+// in grid mode by interpolation in precomputed grid from lib/FireNetGrid
+// (constant time, less accurate), in temporal mode by the stateful GRU of
+// lib/FireNetTemporal (one step per cycle, the state keeps the history of
+// the session, see host_tools bench_temporal for its lead time), otherwise
+// TFLite interpreter from EloquentTinyML is used. Define at most one of
+// following modes, comment out all for TFLite mode.
+#define FIXED_POINT_NET_MODE
+// #define GRID_NET_MODE
+// #define TEMPORAL_NET_MODE
+
+#if defined(FIXED_POINT_NET_MODE) + defined(GRID_NET_MODE) + defined(TEMPORAL_NET_MODE) > 1
+#error "Define only one of FIXED_POINT_NET_MODE, GRID_NET_MODE and TEMPORAL_NET_MODE"
+#endif
+
+// Set radio frame version. The v2 frame (lib/FireFrame) is bit packed in
+// 10 bytes and carries a sequence number, uncomment following # define to
+// send the old 11 byte v1 frame to receivers that do not decode v2.
+// #define FRAME_V1_MODE
+
+// Set aggregation mode. In aggregation mode the node collects
+// AGGREGATE_READINGS readings and sends them delta encoded in one aggregated
+// frame (lib/FireFrame), so the preamble and header are paid once per
+// frame. Reading with fire probability over AGGREGATE_FLUSH_PROB, and the
+// first one below it again, is sent at once with the readings collected so
+// far. Comment out following # define for one frame per reading.
+// #define AGGREGATE_MODE
+#define AGGREGATE_READINGS 8 // 1 .. FIRE_FRAME_AGG_MAX, see host_tools agg_airtime
+#define AGGREGATE_FLUSH_PROB 5000 // fire probability * PROB_SCALE
+
+#if defined(FRAME_V1_MODE) && defined(AGGREGATE_MODE)
+#error "Define only one of FRAME_V1_MODE and AGGREGATE_MODE"
+#endif
+
+// Set reporting mode. In change-driven mode a reading is sent only when
+// some sensor moved over REPORT_SENSOR_DEADBAND or the fire probability
+// over REPORT_PROB_DEADBAND since the last sent reading, when the
+// probability crosses REPORT_ALARM_PROB (every reading over it is sent),
+// and otherwise as a heartbeat every REPORT_HEARTBEAT_MS with the count of
+// suppressed readings (lib/ReportPolicy). Readings are still saved to SD
+// card. A receiver alarming below REPORT_ALARM_PROB can miss whole episodes
+// that rise less than REPORT_PROB_DEADBAND over its threshold (report_replay
+// "missed episodes"). Comment out following # define to send every reading.
+#define REPORT_ON_CHANGE_MODE
+#define REPORT_SENSOR_DEADBAND 8 // ADC counts
+#define REPORT_PROB_DEADBAND 250 // fire probability * PROB_SCALE
+#define REPORT_ALARM_PROB 5000 // fire probability * PROB_SCALE
+#define REPORT_HEARTBEAT_MS 300000 // see host_tools report_replay
+
+#if defined(REPORT_ON_CHANGE_MODE) && (defined(FRAME_V1_MODE) || defined(AGGREGATE_MODE))
+#error "REPORT_ON_CHANGE_MODE needs the v2 frame, undefine FRAME_V1_MODE and AGGREGATE_MODE"
+#endif
+#ifdef REPORT_ON_CHANGE_MODE
+#include "report_policy.h"
+#endif
+
+// Set low-power mode. In low-power mode the MCU sleeps in STOP mode between
+// measurement cycles (STM32LowPower) and wakes up by RTC alarm for the next
+// measurement or by DIO0 at the end of transmission, the radio sleeps
+// between transmissions. SysTick and so millis() stop in STOP mode, time is
+// taken from the RTC. Every cycle prints its awake time. Comment out
+// following # define to busy-poll for the next measurement.
+#define LOW_POWER_MODE
+#define MIN_SLEEP_MS 2 // shorter waits are not worth the STOP mode entry
+
+// Power switches of the SD card and the sensors (high side switch on pin,
+// HIGH = on). SD card is powered only while a reading is written. Sensors
+// are switched on SENSOR_WARMUP_MS before the measurement; the fire net is
+// trained on continuously heated sensors (MQ7, SEN0570), check the readings
+// after the warm-up against logged sessions before enabling it. Both need
+// a switch the current board does not have (SD card on D7, sensors on D6),
+// uncomment following # defines on a board with them.
+// #define SD_POWER_MODE
+#define SD_POWER_PIN 7
+#define SD_POWER_UP_MS 10 // supply ramp before SD.begin()
+// #define SENSOR_POWER_MODE
+#define SENSOR_POWER_PIN 6
+#define SENSOR_WARMUP_MS 2000
+
+#if defined(SENSOR_POWER_MODE) && !defined(LOW_POWER_MODE)
+#error "SENSOR_POWER_MODE needs LOW_POWER_MODE to wake up for the warm-up"
+#endif
+#ifdef LOW_POWER_MODE
+#include "STM32LowPower.h"
+#include "STM32RTC.h"
+#endif
+
+// Set SD log buffering. Rows are collected in the sector buffer of
+// lib/SdLog and written to the card a whole sector at a time, after
+// SD_LOG_FLUSH_MS at the latest (before the sleep the deadline would fall
+// into) and at once from fire probability SD_LOG_SYNC_PROB on. Every flush
+// syncs the file, a power loss costs at most the buffered rows. Without
+// SD_POWER_MODE the file stays open. Comment out following # define to
+// open, write and close the file for every reading.
+#define SD_LOG_BUFFER_MODE
+#define SD_LOG_FLUSH_MS 60000 // see host_tools sd_log_bench
+#define SD_LOG_SYNC_PROB 5000 // fire probability * PROB_SCALE
+#if defined(SDCARD_MODE) && defined(SD_LOG_BUFFER_MODE)
+#include "sd_log.h"
+#include "uplink_writer.h"
+#endif
+
+// Set SD log format. In binary mode readings are logged as delta and
+// varint coded records of lib/FireLog (about 5 instead of 18 bytes) in
+// sector sized blocks with a CRC, to tabor<N>.bin after a schema block.
+// host_tools log_convert turns the logs into the CSV of the sessions.
+// Comment out following # define to log CSV rows to tabor<N>.txt.
+#define SD_LOG_BINARY_MODE
+#if defined(SD_LOG_BINARY_MODE) && !defined(SD_LOG_BUFFER_MODE)
+#error "SD_LOG_BINARY_MODE needs SD_LOG_BUFFER_MODE to write whole blocks"
+#endif
+#if defined(SDCARD_MODE) && defined(SD_LOG_BINARY_MODE)
+#include "fire_log.h"
+#endif
+
+// Set SD session index. The number of the last log is kept in the manifest
+// SESSION_MANIFEST (lib/SessionIndex), the log of a new session is created
+// without opening every file of the card (boot with 1000 files 0.1 s
+// instead of 38 s, see host_tools boot_index_bench). With
+// SD_LOG_BUFFER_MODE the log continues in the file of the next session
+// once it reaches SD_LOG_ROTATE_BYTES. Comment out following # define to
+// name the log by the count of the files on the card.
+#define SESSION_INDEX_MODE
+#define SESSION_MANIFEST "SESSIONS.IDX"
+#define SD_LOG_ROTATE_BYTES 1048576 // 32 clusters of 32 KB
+#if defined(SDCARD_MODE) && defined(SESSION_INDEX_MODE)
+#include "session_index.h"
+#endif
+
+// Set ADC mode. In DMA mode the sensors and the battery are sampled in one
+// ADC scan with hardware oversampling (lib/ScanAdc), the core sleeps (WFI)
+// until the DMA interrupt delivers the means. The scan of about 94 ms
+// replaces 10 rounds of analogRead() with delay(10) and the battery
+// readings, its means are within a count of theirs on the native build.
+// The HAL code (lib/ScanAdc/src/scan_adc_stm32.cpp) is not verified on the
+// board yet: check the IRQ and the ADC clock there before enabling it,
+// a wrong one loses every measurement. Uncomment following # define to scan
+// by DMA instead of reading the pins by analogRead().
+// #define DMA_ADC_MODE
+#define ADC_SCAN_TIMEOUT_MS 200
+#ifdef DMA_ADC_MODE
+#include "scan_adc.h"
+#endif
+
+// Set energy profile mode. Stages of the measurement cycle are timed and
+// combined with the current draw model below into energy per cycle
+// (lib/EnergyProfile), means over DIAG_CYCLES cycles are printed and sent in
+// a diagnostics frame (lib/FireFrame). Comment out following # define to
+// skip the profiling.
+#define ENERGY_PROFILE_MODE
+#define DIAG_CYCLES 100 // about 10 minutes
+// Current draw model, typical currents at the rails (see HostPowerModel of
+// lib_native for the sources) drawn from the pack by switching converters
+#define DRAW_MCU_RUN_MA 6.0
+#define DRAW_MCU_IDLE_MA 1.5 // sleep mode through the ADC scan
+#define DRAW_MCU_STOP_MA 0.0012
+#define DRAW_ADC_MA 0.2 // ADC converting, extra of adc and battery stages
+#define DRAW_SD_WRITE_MA 30.0
+#define DRAW_RADIO_TX_MA 90.0
+#define DRAW_SENSORS_MA 175.0 // MQ7 heater 150, SEN0570 20, DFR0076 5
+#define DRAW_RAIL_V 3.3
+#define DRAW_SENSORS_RAIL_V 5.0
+#define DRAW_EFFICIENCY 0.85
+#define PACK_WH 28.5
+#define PACK_UW(ma, v) ((uint32_t)((ma) * (v) * 1000 / DRAW_EFFICIENCY))
+
+#ifdef ENERGY_PROFILE_MODE
+#include "energy_profile.h"
+// awake stages are timed by micros(), stages spanning STOP mode or sleep
+// mode (ADC scan, polled without LOW_POWER_MODE) by nowMs()
+#if defined(DMA_ADC_MODE) && defined(LOW_POWER_MODE)
+#define PROFILE_IDLE_STAGES (1 << STAGE_ADC)
+#else
+#define PROFILE_IDLE_STAGES 0
+#endif
+#define PROFILE_US(stage) ((PROFILE_IDLE_STAGES >> (stage) & 1) ? nowMs() * 1000UL : micros())
+#define PROFILE_BEGIN(stage) profiler.begin(stage, PROFILE_US(stage))
+#define PROFILE_END(stage) profiler.end(stage, PROFILE_US(stage))
+#else
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#endif
+
+// Set memory profile mode. Free RAM is painted at the start of setup(), the
+// stack and heap high-water marks with static RAM (lib/MemoryProfile) are
+// printed after setup and with the energy profile, the tensor arena taken
+// by ml.begin() in TFLite mode. Static RAM and flash per module are checked
+// against the budget of platformio.ini at build time
+// (host_tools/memory_budget.py). Comment out following # define to skip
+// the memory profile.
+#define MEMORY_PROFILE_MODE
+#ifdef MEMORY_PROFILE_MODE
+#include "memory_profile.h"
+#endif
+
+// Set rolling features. Every reading updates the rolling-window features
+// of lib/FireFeatures: EMA, variance, slope, min and max of each sensor
+// over the last FEATURE_WINDOW readings (384 B, see host_tools
+// feature_dump, which writes them for training too). A TFLite model with
+// FIRE_FEATURES_COUNT inputs (NUMBER_OF_NET_INPUTS) gets the feature vector
+// instead of the three readings. No model takes them yet, uncomment
+// following # define with one.
+// #define ROLLING_FEATURES_MODE
+#define FEATURE_WINDOW 10 // readings, a minute
+#define FEATURE_EMA_SHIFT 2 // EMA weight 1/4 of a new reading
+#ifdef ROLLING_FEATURES_MODE
+#include "fire_features.h"
+#endif
+
+#if defined(FIXED_POINT_NET_MODE)
+#include "fire_net_fixed.h"
+#elif defined(GRID_NET_MODE)
+#include "fire_net_grid.h"
+#elif defined(TEMPORAL_NET_MODE)
+#include "fire_net_temporal.h"
+#else
+#define TFLITE_NET_MODE
+#include "model_real_data.h"
+#include <EloquentTinyML.h>
+#ifdef MEMORY_PROFILE_MODE
+#include "tflite_arena.h"
+#endif
+#endif
+
 // create instance of LoRa class using SX1278 module
 // this pinout corresponds to RadioShield
 // https://github.com/jgromes/RadioShield
@@ -25,24 +250,52 @@
 //            or left floating.
 SX1272 lora = new LoRa;
 
+#ifdef ROLLING_FEATURES_MODE
+FireFeatures<FEATURE_WINDOW> rollingFeatures(FEATURE_EMA_SHIFT);
+#endif
+
+#ifdef TEMPORAL_NET_MODE
+// hidden state of the session, a reset starts from zeros as in training
+FireNetTemporal temporalNet;
+#endif
+
+#ifdef TFLITE_NET_MODE
 // FIRE NET
 // Define the number of inputs and outputs for the model
 #define NUMBER_OF_NET_INPUTS  3
 #define NUMBER_OF_NET_OUTPUTS 1
+#ifdef ROLLING_FEATURES_MODE
+static_assert(NUMBER_OF_NET_INPUTS == 3 || NUMBER_OF_NET_INPUTS == FIRE_FEATURES_COUNT,
+              "model takes the three readings or the feature vector");
+#else
+static_assert(NUMBER_OF_NET_INPUTS == 3, "model with the feature vector needs ROLLING_FEATURES_MODE");
+#endif
 
-// Define the size of the tensor arena (used for memory allocation during inference)
-// For small models, 2–4 KB is usually enough
-#define TENSOR_ARENA_SIZE (2 * 1024)
+// Size of the tensor arena (used for memory allocation during inference)
+// comes with the model, MODEL_ARENA_SIZE of its header is sized by the
+// arena used on the target (printed at start in MEMORY_PROFILE_MODE)
+#define TENSOR_ARENA_SIZE MODEL_ARENA_SIZE
 
 // Create an instance of the TfLite interpreter for the given model
+#ifdef MEMORY_PROFILE_MODE
+ProfiledTfLite<NUMBER_OF_NET_INPUTS, NUMBER_OF_NET_OUTPUTS, TENSOR_ARENA_SIZE> ml;
+#else
 Eloquent::TinyML::TfLite<NUMBER_OF_NET_INPUTS, NUMBER_OF_NET_OUTPUTS, TENSOR_ARENA_SIZE> ml;
+#endif
+#endif
 
 
 // Device global constatnts
 #define LOCAL_ADRESS 0x11
 #define PROB_SCALE 10000
 #define VOLTAGE_SCALE 1000
-#define MSG_LEN 11
+#if defined(FRAME_V1_MODE)
+#define MSG_LEN FIRE_FRAME_V1_LEN
+#elif defined(AGGREGATE_MODE)
+#define MSG_LEN FIRE_FRAME_AGG_MAX_LEN
+#else
+#define MSG_LEN FIRE_FRAME_V2_HEARTBEAT_LEN
+#endif
 #define ERR_VALUE 65535
 #define TIME_SPAN 6000
 // set to proper value!!! (0.013526 for 4M7/1M7 divider, 3.3V FS, 10 bit ADC)
@@ -59,11 +312,6 @@ Eloquent::TinyML::TfLite<NUMBER_OF_NET_INPUTS, NUMBER_OF_NET_OUTPUTS, TENSOR_ARE
 #define FireSwitch 8
 
 // Structs
-struct encodedInTwoBytes {
-  byte upper_byte;
-  byte lower_byte;
-};
-
 struct averageSensorVals {
   int smoke;
   int flame;
@@ -72,15 +320,29 @@ struct averageSensorVals {
 
 // Functions declarations
 void setFlag(void);
-byte encodeLowerByte(int num);
-byte encodeUpperByte(int num);
-bool encodeNumber(int num, encodedInTwoBytes *encoded);
-int decodeUpperByte(byte upper_byte);
-int decodeNumber(byte lower_byte, byte upper_byte);
-void countMovingAverage(int x, float *avg, float a);
 void measureAverageValues(averageSensorVals *average);
 void measureBattery(float *vbat);
-float getFireProbability();
+int getFireProbability();
+unsigned long nowMs();
+#ifdef DMA_ADC_MODE
+void runAdcScan();
+void onAdcScan(const uint16_t *means, uint8_t channels);
+#endif
+#ifdef LOW_POWER_MODE
+void sleepUntilNextCycle();
+unsigned long printCycleDuty();
+#endif
+#ifdef ENERGY_PROFILE_MODE
+void profileCycle(unsigned long awakeMs);
+void printEnergyProfile();
+void sendDiag();
+#endif
+#if defined(MEMORY_PROFILE_MODE) && defined(TFLITE_NET_MODE)
+void printArenaUsage();
+#endif
+#ifdef SENSOR_POWER_MODE
+void setSensorPower(bool on);
+#endif
 
 #ifdef SDCARD_MODE
 
@@ -88,15 +350,38 @@ float getFireProbability();
 int getNumFiles(File dir);
 bool writeData(File mf, averageSensorVals *average, int is_fire, float fire_prob);
 bool writeHeader(File mf, String header);
+void startLogFile(File mf);
+#ifdef SD_LOG_BUFFER_MODE
+void logData(averageSensorVals *average, int is_fire, int scaled_probability);
+bool flushSdLog(SdLogFlush what);
+#endif
+#if defined(SESSION_INDEX_MODE) && defined(SD_LOG_BUFFER_MODE)
+void rotateSdLog();
+#endif
+#ifdef SD_POWER_MODE
+bool setSdPower(bool on);
+#endif
 
 // file object for SD card data and string for file name
 File myFile;
 String full_filename;
 
+#ifdef SD_LOG_BUFFER_MODE
+SdLog sdLog(SD_LOG_FLUSH_MS);
+#endif
+#ifdef SD_LOG_BINARY_MODE
+FireLogEncoder fireLog;
+#endif
+#if defined(SESSION_INDEX_MODE) && defined(SD_LOG_BINARY_MODE)
+SessionIndex sessionIndex(SESSION_MANIFEST, "tabor", ".bin", FILE_WRITE);
+#elif defined(SESSION_INDEX_MODE)
+SessionIndex sessionIndex(SESSION_MANIFEST, "tabor", ".txt", FILE_WRITE);
+#endif
+
 #endif
 
 // Global variable
-long timeOfLastMeasurement = millis();
+unsigned long timeOfLastMeasurement = 0;
 
 // save transmission state between loops
 int transmissionState = ERR_NONE;
@@ -107,28 +392,68 @@ volatile bool transmittedFlag = true;
 // disable interrupt when it's not needed
 volatile bool enableInterrupt = true;
 
+// sequence number of the v2 frame, the receiver counts lost frames from gaps
+uint8_t frameSeq = 0;
+uint8_t frameFlags = FIRE_FLAG_BOOT;
 
-int freeRAM() {
-  // Estimate free RAM memory
-  // +---------------------+  <- high addresses
-  // |      STACK ↓        |  ← address of stack_dummy
-  // |                     |
-  // |     Free RAM        |
-  // |                     |
-  // |      HEAP ↑         |  ← result of malloc(4)
-  // +---------------------+  <- low addresses
+#ifdef AGGREGATE_MODE
+// readings waiting for the aggregated frame
+FireReading aggregate[AGGREGATE_READINGS];
+int aggregateLen = 0;
+bool aggregateAlarm = false; // last reading was over AGGREGATE_FLUSH_PROB
+#define AGGREGATE_INTERVAL_S ((TIME_SPAN + 500) / 1000)
+#endif
 
-  // free RAM ≈ address_of_stack - address_of_heap
-  char stack_dummy = 0;
-  return &stack_dummy - (char*)malloc(4);
-}
+#ifdef REPORT_ON_CHANGE_MODE
+ReportPolicy reportPolicy({REPORT_SENSOR_DEADBAND, REPORT_PROB_DEADBAND, REPORT_ALARM_PROB, REPORT_HEARTBEAT_MS});
+#endif
+
+#ifdef LOW_POWER_MODE
+STM32RTC &rtc = STM32RTC::getInstance();
+// awake time of the current cycle, see printCycleDuty()
+unsigned long cycleStartMs = 0;
+unsigned long wakeMs = 0;
+unsigned long awakeMs = 0;
+#endif
+
+#ifdef SENSOR_POWER_MODE
+bool sensorsPowered = false;
+#endif
+
+#ifdef DMA_ADC_MODE
+ScanAdc adcScan;
+enum ScanChannel { SCAN_SMOKE, SCAN_FLAME, SCAN_GAS, SCAN_BATTERY, SCAN_CHANNELS };
+const uint32_t scanPins[SCAN_CHANNELS] = {SmokeSensorPin, FlameSensorPin, GasSensorPin, BatteryPin};
+// means of the last scan, 12 bit ADC counts
+volatile uint16_t scanMeans[SCAN_CHANNELS];
+#endif
+
+#ifdef ENERGY_PROFILE_MODE
+EnergyProfiler profiler({PACK_UW(DRAW_MCU_RUN_MA, DRAW_RAIL_V), PACK_UW(DRAW_MCU_IDLE_MA, DRAW_RAIL_V),
+                         PACK_UW(DRAW_MCU_STOP_MA, DRAW_RAIL_V),
+                         {PACK_UW(DRAW_ADC_MA, DRAW_RAIL_V), 0, PACK_UW(DRAW_SD_WRITE_MA, DRAW_RAIL_V),
+                          PACK_UW(DRAW_ADC_MA, DRAW_RAIL_V), 0, 0, PACK_UW(DRAW_RADIO_TX_MA, DRAW_RAIL_V),
+                          PACK_UW(DRAW_SENSORS_MA, DRAW_SENSORS_RAIL_V)},
+                         PROFILE_IDLE_STAGES});
+// means of the last DIAG_CYCLES cycles, sent when the radio is free
+FireDiag diag;
+bool diagPending = false;
+#endif
 
 
 void setup() {
+  #ifdef MEMORY_PROFILE_MODE
+  paintStack();
+  #endif
   Serial.begin(9600);
+
+  #ifdef LOW_POWER_MODE
+  rtc.setClockSource(STM32RTC::LSE_CLOCK);
+  rtc.begin();
+  LowPower.begin();
+  #endif
   
-  Serial.print("Estimated free RAM: ");
-  Serial.println(freeRAM());
+  #ifdef TFLITE_NET_MODE
   Serial.print("Model size: ");
   Serial.println(model_tflite_len);
 
@@ -136,29 +461,50 @@ void setup() {
   Serial.println("Starting model init...");
   ml.begin(model_tflite);
   Serial.println("Model is ready!");
+  #ifdef MEMORY_PROFILE_MODE
+  printArenaUsage();
+  #endif
+  #endif
 
   #ifdef SDCARD_MODE
-  String filename = "tabor"; // default file name for saving data on SD, can be changed
-
   Serial.print("Initializing SD card...");
+  #ifdef SD_POWER_MODE
+  pinMode(SD_POWER_PIN, OUTPUT);
+  if (!setSdPower(true)) {
+  #else
   if (!SD.begin(SD_CSPIN)) {
+  #endif
     Serial.println("initialization failed!");
     while (1);
   }
   Serial.println("initialization done.");
-  
+
+  #ifdef SESSION_INDEX_MODE
+  myFile = sessionIndex.create(SD);
+  full_filename = sessionIndex.name();
+  if (sessionIndex.recovered()) {
+    Serial.println("Session index recovered by directory scan");
+  }
+  #else
+  String filename = "tabor"; // default file name for saving data on SD, can be changed
+
   File root = SD.open("/");
 
   int num_files = getNumFiles(root);
 
+  #ifdef SD_LOG_BINARY_MODE
+  full_filename = filename + String(num_files) + String(".bin") ;
+  #else
   full_filename = filename + String(num_files) + String(".txt") ;
+  #endif
 
   myFile = SD.open(full_filename, FILE_WRITE);
+  #endif
 
   // if the file opened okay, write header to it:
   if (myFile) {
     // write header to file
-    writeHeader(myFile, "smoke,flame,gas,label, prob");
+    startLogFile(myFile);
     // close the file:
     myFile.close();
 
@@ -167,6 +513,17 @@ void setup() {
     Serial.println("error opening file");
   }
   myFile.close();
+  #ifdef SD_LOG_BUFFER_MODE
+  // log continues at the end of the file, kept open without SD_POWER_MODE
+  myFile = SD.open(full_filename, FILE_WRITE);
+  sdLog.begin(myFile.size());
+  #ifdef SD_POWER_MODE
+  myFile.close();
+  #endif
+  #endif
+  #ifdef SD_POWER_MODE
+  setSdPower(false);
+  #endif
 
   #endif // end of SD card mode
 
@@ -203,25 +560,83 @@ void setup() {
   pinMode(SmokeSensorPin, INPUT_ANALOG);
   pinMode(GasSensorPin, INPUT_ANALOG);
   pinMode(BatteryPin, INPUT_ANALOG);
+  #ifdef DMA_ADC_MODE
+  if (!adcScan.begin(scanPins, SCAN_CHANNELS, onAdcScan)) {
+    Serial.println(F("ADC scan initialization failed!"));
+    while (true);
+  }
+  #endif
 
   pinMode(FireSwitch, INPUT_PULLUP);
 
+  #ifdef SENSOR_POWER_MODE
+  pinMode(SENSOR_POWER_PIN, OUTPUT);
+  setSensorPower(true);
+  #elif defined(ENERGY_PROFILE_MODE)
+  profiler.begin(STAGE_SENSORS, nowMs() * 1000UL); // powered all the time
+  #endif
+
+  #ifdef LOW_POWER_MODE
+  // radio wakes up by startTransmit()
+  lora.sleep();
+  cycleStartMs = wakeMs = nowMs();
+  #endif
+  timeOfLastMeasurement = nowMs();
+
   // setup finished
+  #ifdef MEMORY_PROFILE_MODE
+  printMemoryUsage(Serial, memoryUsage());
+  #endif
   Serial.println(F("Setup finished."));
 }
 
 void loop() {
+  #ifdef ENERGY_PROFILE_MODE
+  if (transmittedFlag && profiler.running(STAGE_TX)) {
+    profiler.end(STAGE_TX, nowMs() * 1000UL);
+  }
+  if (transmittedFlag && diagPending) {
+    sendDiag();
+  }
+  #endif
   
-  if (transmittedFlag and (millis() - timeOfLastMeasurement) >= TIME_SPAN) {
+  if (transmittedFlag and (nowMs() - timeOfLastMeasurement) >= TIME_SPAN) {
+    #if defined(ENERGY_PROFILE_MODE) && defined(LOW_POWER_MODE)
+    profileCycle(printCycleDuty());
+    #elif defined(ENERGY_PROFILE_MODE)
+    profileCycle(ULONG_MAX); // never sleeps
+    #elif defined(LOW_POWER_MODE)
+    printCycleDuty();
+    #endif
+
     // Measure current values and count average
+    PROFILE_BEGIN(STAGE_ADC);
     measureAverageValues(&average_values);
+    PROFILE_END(STAGE_ADC);
+    #ifdef SENSOR_POWER_MODE
+    setSensorPower(false);
+    #endif
     
     // Predict probability of flame
-    float fire_prob = getFireProbability();
-    // float fire_prob = 0.5;
-    int scaled_probability = (int)(fire_prob*PROB_SCALE);
+    PROFILE_BEGIN(STAGE_NET);
+    #ifdef ROLLING_FEATURES_MODE
+    rollingFeatures.update(average_values.smoke, average_values.flame, average_values.gas);
+    #endif
+    int scaled_probability = getFireProbability();
+    PROFILE_END(STAGE_NET);
+    float fire_prob = (float)scaled_probability/PROB_SCALE;
     
     #ifdef SDCARD_MODE // save to sd card only if control variable SDCARD_MODE defined 
+      PROFILE_BEGIN(STAGE_SD);
+      #ifdef SD_LOG_BUFFER_MODE
+      int is_fire = !digitalRead(FireSwitch);
+      logData(&average_values, is_fire, scaled_probability);
+      Serial.println("Golden label, switch is:");
+      Serial.println(is_fire);
+      #else
+      #ifdef SD_POWER_MODE
+      setSdPower(true);
+      #endif
       myFile = SD.open(full_filename, FILE_WRITE);
 
       // if the file opened okay, write to it:
@@ -238,10 +653,17 @@ void loop() {
         Serial.println("error opening file");
       }
       //myFile.close();
+      #ifdef SD_POWER_MODE
+      setSdPower(false);
+      #endif
+      #endif // SD_LOG_BUFFER_MODE
+      PROFILE_END(STAGE_SD);
       #endif // end of SD card mode
 
     float v_bat;
+    PROFILE_BEGIN(STAGE_BATTERY);
     measureBattery(&v_bat); // #TODO: maybe we dont need to measure battery voltage every 6 seconds
+    PROFILE_END(STAGE_BATTERY);
     //Serial.print("Battery voltage: ");
     Serial.println(v_bat);
 
@@ -255,17 +677,56 @@ void loop() {
     Serial.print("  =>  Fire probability: ");
     Serial.println(fire_prob);
 
-    // Encode int into 2 bytes
-    encodedInTwoBytes encoded_smoke;
-    encodedInTwoBytes encoded_flame;
-    encodedInTwoBytes encoded_gas;
-    encodedInTwoBytes encoded_prob;
-    encodedInTwoBytes encoded_vbat;
-    bool res_smoke = encodeNumber(average_values.smoke, &encoded_smoke);
-    bool res_flame = encodeNumber(average_values.flame, &encoded_flame);
-    bool res_gas = encodeNumber(average_values.gas, &encoded_gas);
-    bool res_prob = encodeNumber(scaled_probability, &encoded_prob);
-    bool res_vbat = encodeNumber(scaled_vbat, &encoded_vbat);
+    // Encode values into the radio frame (lib/FireFrame), values out of range are sent as ERR_VALUE (v1)
+    // or clamped with the error flag (v2)
+    FireReading reading = {LOCAL_ADRESS, average_values.smoke, average_values.flame, average_values.gas,
+                           scaled_probability, scaled_vbat, frameSeq, frameFlags};
+    #ifdef REPORT_ON_CHANGE_MODE
+    ReportReason reason = reportPolicy.check(reading, nowMs());
+    if (reason == REPORT_NONE) {
+      Serial.print(F("No change, suppressed readings: "));
+      Serial.println(reportPolicy.suppressed());
+      return; // next reading after TIME_SPAN
+    }
+    #endif
+
+    byte byteArr[MSG_LEN];
+    size_t frameLen = MSG_LEN;
+    #if defined(FRAME_V1_MODE)
+    encodeFrameV1(reading, byteArr);
+    #elif defined(AGGREGATE_MODE)
+    aggregate[aggregateLen++] = reading;
+    frameSeq++;
+    frameFlags = 0;
+    bool alarm = scaled_probability >= AGGREGATE_FLUSH_PROB;
+    bool flush = alarm || aggregateAlarm || aggregateLen >= AGGREGATE_READINGS;
+    aggregateAlarm = alarm;
+    if (!flush) {
+      return; // next reading after TIME_SPAN
+    }
+    if (aggregateLen == 1) {
+      // single reading (alarm) is shorter in v2 frame
+      encodeFrameV2(reading, byteArr);
+      frameLen = FIRE_FRAME_V2_LEN;
+    } else {
+      frameLen = encodeFrameAgg(aggregate, aggregateLen, AGGREGATE_INTERVAL_S, byteArr, sizeof(byteArr));
+    }
+    aggregateLen = 0;
+    #else
+    #ifdef REPORT_ON_CHANGE_MODE
+    if (reason == REPORT_HEARTBEAT) {
+      reading.suppressed = reportPolicy.suppressed();
+      encodeFrameV2Heartbeat(reading, byteArr);
+      frameLen = FIRE_FRAME_V2_HEARTBEAT_LEN;
+    } else
+    #endif
+    {
+      encodeFrameV2(reading, byteArr);
+      frameLen = FIRE_FRAME_V2_LEN;
+    }
+    frameSeq++;
+    frameFlags = 0;
+    #endif
 
     // disable the interrupt service routine while processing the data
     enableInterrupt = false;
@@ -286,14 +747,19 @@ void loop() {
 
     // you can transmit byte array up to 256 bytes long
     // Packet = {Local adress, Smoke measurement, Flame measurement, Gas measurement, Fire probability * 10000, battery voltage*10000}
-    byte byteArr[] = {LOCAL_ADRESS, encoded_smoke.upper_byte, encoded_smoke.lower_byte, encoded_flame.upper_byte, encoded_flame.lower_byte, 
-                      encoded_gas.upper_byte, encoded_gas.lower_byte, encoded_prob.upper_byte, encoded_prob.lower_byte, encoded_vbat.upper_byte,
-                    encoded_vbat.lower_byte};
-    int transmissionState = lora.startTransmit(byteArr, MSG_LEN);
+    // in v1, see lib/FireFrame for v2
+    #ifdef ENERGY_PROFILE_MODE
+    profiler.begin(STAGE_TX, nowMs() * 1000UL);
+    #endif
+    int transmissionState = lora.startTransmit(byteArr, frameLen);
     
     // we're ready to send more packets, enable interrupt service routine
     enableInterrupt = true;
   }
+
+  #ifdef LOW_POWER_MODE
+  sleepUntilNextCycle();
+  #endif
 }
 
 // this function is called when a complete packet is transmitted by the module
@@ -308,48 +774,15 @@ void setFlag(void) {
   transmittedFlag = true;
 }
 
-byte encodeLowerByte(int num){
-  int mask = 255; // bin = '1111 1111'
-  int lowerResult = mask & num;
-  byte LowerByte = (byte)lowerResult;
-  return LowerByte;
-}
-
-byte encodeUpperByte(int num){
-  int mask = 255; // bin = '1111 1111'
-  int shifted_num = num >> 8;
-  int lowerResult = mask & shifted_num;
-  byte LowerByte = (byte)lowerResult;
-  return LowerByte;
-}
-
-bool encodeNumber(int num, encodedInTwoBytes *encoded) {
-  if (num < 0 || num >= ERR_VALUE) { // It is not possible to decode int in two bytes
-    // Error value
-    encoded->lower_byte = 0xFF; 
-    encoded->upper_byte = 0xFF;
-    return false;
-  }
-  encoded->lower_byte = encodeLowerByte(num);
-  encoded->upper_byte = encodeUpperByte(num);
-  return true;
-}
-
-int decodeUpperByte(byte upper_byte){
-  int shifted = (int)upper_byte << 8;
-  return shifted;
-} 
-
-int decodeNumber(byte lower_byte, byte upper_byte) {
-  int decoded_number = (int)lower_byte | decodeUpperByte(upper_byte); // Bitovy OR
-  return decoded_number;
-}
-
-void countMovingAverage(int x, float *avg, float a=0.8) {
-  *avg = a*x + (1-a)*(*avg);
-}
-
 void measureAverageValues(averageSensorVals *average) {
+  #ifdef DMA_ADC_MODE
+  // battery is in the same scan, see measureBattery()
+  runAdcScan();
+  // analogRead() counts of 10 bits
+  average->smoke = scanMeans[SCAN_SMOKE] >> 2;
+  average->flame = scanMeans[SCAN_FLAME] >> 2;
+  average->gas = scanMeans[SCAN_GAS] >> 2;
+  #else
   float avg_smoke = 0;
   float avg_flame = 0;
   float avg_gas = 0;
@@ -367,11 +800,16 @@ void measureAverageValues(averageSensorVals *average) {
   average->smoke = (int)(avg_smoke/num_iter);
   average->flame = (int)(avg_flame/num_iter);
   average->gas = (int)(avg_gas/num_iter);
+  #endif
 
-  timeOfLastMeasurement = millis();
+  timeOfLastMeasurement = nowMs();
 }
 
 void measureBattery(float *vbat){
+  #ifdef DMA_ADC_MODE
+  // scanned by measureAverageValues()
+  *vbat = scanMeans[SCAN_BATTERY] / 4.0 * DIVIDER_RATIO;
+  #else
   const int num_iter = 4;
   int sum_vbat = 0;
   for (int i = 0; i < num_iter; i++){
@@ -380,17 +818,235 @@ void measureBattery(float *vbat){
   }
   *vbat = ((float)sum_vbat/(float)num_iter);
   *vbat = *vbat*DIVIDER_RATIO;
+  #endif
   //Serial.println(*vbat);
 }
 
-float getFireProbability(){
+#ifdef DMA_ADC_MODE
+// Scans sensors and battery, the core sleeps until the DMA interrupt. Sleep
+// mode does not count as awake time of the cycle.
+void runAdcScan() {
+  if (!adcScan.start()) {
+    Serial.println(F("ADC scan busy"));
+    return;
+  }
+  unsigned long start = nowMs();
+  #ifdef LOW_POWER_MODE
+  awakeMs += start - wakeMs;
+  #endif
+  while (adcScan.busy() && nowMs() - start < ADC_SCAN_TIMEOUT_MS) {
+    #ifdef LOW_POWER_MODE
+    LowPower.idle(ADC_SCAN_TIMEOUT_MS);
+    #else
+    delay(1);
+    #endif
+  }
+  #ifdef LOW_POWER_MODE
+  wakeMs = nowMs();
+  #endif
+  if (adcScan.busy()) {
+    Serial.println(F("ADC scan timeout"));
+  }
+}
+
+// DMA interrupt, scan done
+void onAdcScan(const uint16_t *means, uint8_t channels) {
+  for (uint8_t i = 0; i < channels && i < SCAN_CHANNELS; i++) {
+    scanMeans[i] = means[i];
+  }
+}
+#endif
+
+// Time in ms, in low-power mode from the RTC (SysTick stops in STOP mode,
+// resolution of the RTC sub-seconds is about 4 ms). Wraps as millis().
+unsigned long nowMs() {
+  #ifdef LOW_POWER_MODE
+  uint32_t subSeconds;
+  uint32_t epoch = rtc.getEpoch(&subSeconds);
+  return epoch * 1000UL + subSeconds;
+  #else
+  return millis();
+  #endif
+}
+
+#ifdef LOW_POWER_MODE
+// Sleeps in STOP mode until the next measurement, DIO0 interrupt at the end
+// of transmission wakes the MCU earlier. With SENSOR_POWER_MODE the MCU
+// wakes up SENSOR_WARMUP_MS before the measurement to power the sensors.
+void sleepUntilNextCycle() {
+  unsigned long elapsed = nowMs() - timeOfLastMeasurement;
+  if (transmittedFlag && elapsed >= TIME_SPAN) {
+    return; // measure now
+  }
+  // packet still on air after TIME_SPAN, wait for DIO0
+  unsigned long sleepMs = elapsed < TIME_SPAN ? TIME_SPAN - elapsed : TIME_SPAN;
+  #ifdef SENSOR_POWER_MODE
+  if (!sensorsPowered) {
+    if (sleepMs > SENSOR_WARMUP_MS) {
+      sleepMs -= SENSOR_WARMUP_MS;
+    } else {
+      setSensorPower(true);
+    }
+  }
+  #endif
+  if (sleepMs < MIN_SLEEP_MS) {
+    return;
+  }
+  #if defined(SDCARD_MODE) && defined(SD_LOG_BUFFER_MODE)
+  // flush deadline would pass in STOP mode
+  SdLogFlush what = sdLog.due(nowMs(), sleepMs);
+  if (what != SD_LOG_KEEP) {
+    PROFILE_BEGIN(STAGE_SD);
+    flushSdLog(what);
+    PROFILE_END(STAGE_SD);
+  }
+  #endif
+  Serial.flush(); // UART stops in STOP mode
+  awakeMs += nowMs() - wakeMs;
+  LowPower.deepSleep(sleepMs);
+  wakeMs = nowMs();
+}
+
+// Prints length and awake time of the cycle since the last measurement,
+// returns the awake time
+unsigned long printCycleDuty() {
+  unsigned long now = nowMs();
+  unsigned long cycleMs = now - cycleStartMs;
+  awakeMs += now - wakeMs;
+  Serial.print(F("Cycle "));
+  Serial.print(cycleMs);
+  Serial.print(F(" ms, awake "));
+  Serial.print(awakeMs);
+  Serial.print(F(" ms ("));
+  Serial.print(cycleMs ? 100.0 * awakeMs / cycleMs : 0.0);
+  Serial.println(F(" %)"));
+  cycleStartMs = wakeMs = now;
+  unsigned long cycleAwakeMs = awakeMs;
+  awakeMs = 0;
+  return cycleAwakeMs;
+}
+#endif
+
+#ifdef SENSOR_POWER_MODE
+void setSensorPower(bool on) {
+  digitalWrite(SENSOR_POWER_PIN, on ? HIGH : LOW);
+  sensorsPowered = on;
+  #ifdef ENERGY_PROFILE_MODE
+  if (on) {
+    profiler.begin(STAGE_SENSORS, nowMs() * 1000UL);
+  } else {
+    profiler.end(STAGE_SENSORS, nowMs() * 1000UL);
+  }
+  #endif
+}
+#endif
+
+#ifdef ENERGY_PROFILE_MODE
+// Ends the cycle of the energy profile, means of DIAG_CYCLES cycles are
+// printed and sent in the diagnostics frame
+void profileCycle(unsigned long awakeMs) {
+  uint32_t awakeUs = awakeMs < UINT32_MAX / 1000 ? awakeMs * 1000 : UINT32_MAX;
+  profiler.endCycle(nowMs() * 1000UL, awakeUs);
+  if (profiler.cycles() < DIAG_CYCLES) {
+    return;
+  }
+  printEnergyProfile();
+  #ifdef MEMORY_PROFILE_MODE
+  printMemoryUsage(Serial, memoryUsage());
+  #endif
+  profiler.fillDiag(&diag);
+  profiler.reset();
+  diagPending = true;
+}
+
+void printEnergyProfile() {
+  Serial.print(F("Energy profile of "));
+  Serial.print(profiler.cycles());
+  Serial.print(F(" cycles, mean cycle "));
+  Serial.print(profiler.meanCycleUs() / 1000);
+  Serial.println(F(" ms:"));
+  for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+    Serial.print(F("  "));
+    Serial.print(profileStageName(stage));
+    Serial.print(F(": "));
+    Serial.print(profiler.meanUs(stage));
+    Serial.print(F(" us, "));
+    Serial.print(profiler.meanUj(stage));
+    Serial.println(F(" uJ"));
+  }
+  // uJ per ms is mW
+  float mw = (float)profiler.meanCycleUj() / (profiler.meanCycleUs() / 1000.0);
+  Serial.print(F("  total: "));
+  Serial.print(profiler.meanCycleUj());
+  Serial.print(F(" uJ per cycle, "));
+  Serial.print(mw);
+  Serial.print(F(" mW, pack lasts "));
+  Serial.print(PACK_WH * 1000 / mw);
+  Serial.println(F(" h"));
+}
+
+// Sends the diagnostics frame, with the sequence number of the next reading
+void sendDiag() {
+  byte frame[FIRE_FRAME_DIAG_LEN];
+  diag.transm_id = LOCAL_ADRESS;
+  diag.seq = frameSeq;
+  diag.flags = 0;
+  encodeFrameDiag(diag, frame);
+  diagPending = false;
+
+  enableInterrupt = false;
+  transmittedFlag = false;
+  Serial.println(F("Sending diagnostics ... "));
+  profiler.begin(STAGE_TX, nowMs() * 1000UL);
+  lora.startTransmit(frame, FIRE_FRAME_DIAG_LEN);
+  enableInterrupt = true;
+}
+#endif
+
+#if defined(MEMORY_PROFILE_MODE) && defined(TFLITE_NET_MODE)
+// Tensor arena taken by ml.begin() against TENSOR_ARENA_SIZE, the size the
+// model header should give when the arena is bigger than needed
+void printArenaUsage() {
+  Serial.print(F("Tensor arena used: "));
+  Serial.print((unsigned long)ml.arenaUsed());
+  Serial.print(F(" of "));
+  Serial.print(TENSOR_ARENA_SIZE);
+  Serial.println(F(" B"));
+  if (ml.arenaNeeded() < TENSOR_ARENA_SIZE) {
+    Serial.print(F("  set MODEL_ARENA_SIZE to "));
+    Serial.print((unsigned long)ml.arenaNeeded());
+    Serial.println(F(" to free the rest"));
+  }
+}
+#endif
+
+// Returns fire probability scaled by PROB_SCALE
+int getFireProbability(){
+  #if defined(FIXED_POINT_NET_MODE)
+  return predictFireProbabilityFixed(average_values.smoke, average_values.flame, average_values.gas);
+  #elif defined(GRID_NET_MODE)
+  return predictFireProbabilityGrid(average_values.smoke, average_values.flame, average_values.gas);
+  #elif defined(TEMPORAL_NET_MODE)
+  // one step per measurement cycle, call it once per cycle
+  return temporalNet.step(average_values.smoke, average_values.flame, average_values.gas);
+  #elif defined(ROLLING_FEATURES_MODE) && NUMBER_OF_NET_INPUTS == FIRE_FEATURES_COUNT
+  // extended model, features in counts as feature_dump writes them
+  int32_t features[FIRE_FEATURES_COUNT];
+  rollingFeatures.vector(features);
+  float input[NUMBER_OF_NET_INPUTS];
+  for (int i = 0; i < FIRE_FEATURES_COUNT; i++) {
+    input[i] = (float)features[i] / fireFeatureScale(i);
+  }
+  return (int)(ml.predict(input)*PROB_SCALE);
+  #else
   // Store input values in an array as expected by EloquentTinyML
   float input[NUMBER_OF_NET_INPUTS] = { average_values.smoke, average_values.flame, average_values.gas };
 
   // Predict output
   float predicted = ml.predict(input);
 
-  return predicted;
+  return (int)(predicted*PROB_SCALE);
+  #endif
 }
 
 // SD card related functions: ---------------------
@@ -429,4 +1085,127 @@ bool writeHeader(File mf, String header){
   return true;
 }
 
+// Writes the CSV header or the FireLog schema block of a new log
+void startLogFile(File mf){
+  #ifdef SD_LOG_BINARY_MODE
+  uint8_t schema[FIRE_LOG_BLOCK];
+  mf.write(schema, fireLog.begin(LOCAL_ADRESS, TIME_SPAN, schema));
+  #else
+  writeHeader(mf, "smoke,flame,gas,label, prob");
+  #endif
+}
+
+#ifdef SD_LOG_BUFFER_MODE
+// Appends the row of writeData() (a FireLog record in SD_LOG_BINARY_MODE)
+// to the SD log buffer and flushes what is due, everything from
+// SD_LOG_SYNC_PROB on
+void logData(averageSensorVals *average, int is_fire, int scaled_probability){
+  #ifdef SESSION_INDEX_MODE
+  if (sdLog.size() >= SD_LOG_ROTATE_BYTES) {
+    rotateSdLog();
+  }
+  #endif
+  #ifdef SD_LOG_BINARY_MODE
+  // a record is dropped before it is encoded, the blocks stay whole
+  if (sdLog.room() < FIRE_LOG_CHUNK_MAX) {
+    Serial.println("SD log buffer full, record dropped");
+  } else {
+    FireLogRecord record = {average->smoke, average->flame, average->gas, scaled_probability, (uint8_t)is_fire};
+    uint8_t chunk[FIRE_LOG_CHUNK_MAX];
+    size_t len = fireLog.encode(record, chunk);
+    sdLog.append((const char *)chunk, len, nowMs());
+  }
+  #else
+  char row[48];
+  UplinkWriter out(row, sizeof(row));
+  out.number((long)average->smoke).character(',').number((long)average->flame).character(',');
+  out.number((long)average->gas).character(',').number((long)is_fire).character(',');
+  out.fixed((scaled_probability + 50) / 100, 100).character('\n'); // 2 decimals as print()
+  if (!sdLog.append(row, out.length(), nowMs())) {
+    Serial.println("SD log buffer full, row dropped");
+  }
+  #endif
+  flushSdLog(scaled_probability >= SD_LOG_SYNC_PROB ? SD_LOG_ALL : sdLog.due(nowMs()));
+}
+
+// Writes what of the SD log buffer to the card, powered and opened for it
+// in SD_POWER_MODE
+bool flushSdLog(SdLogFlush what){
+  if (what == SD_LOG_KEEP) {
+    return true;
+  }
+  #ifdef SD_POWER_MODE
+  if (setSdPower(true)) {
+    myFile = SD.open(full_filename, FILE_WRITE);
+  }
+  #endif
+  bool ok = myFile && sdLog.flush(myFile, what);
+  #ifdef SD_POWER_MODE
+  myFile.close();
+  setSdPower(false);
+  #endif
+  if (!ok) {
+    Serial.println("error writing SD log");
+  }
+  return ok;
+}
+
+#ifdef SESSION_INDEX_MODE
+// Writes the rest of the log (trailer of the open FireLog block) and
+// continues in the file of the next session, stays in the full one when no
+// file is left
+void rotateSdLog(){
+  #ifdef SD_LOG_BINARY_MODE
+  if (sdLog.room() < FIRE_LOG_BLOCK) {
+    return; // flushes fail, the blocks stay whole
+  }
+  uint8_t trailer[FIRE_LOG_BLOCK];
+  sdLog.append((const char *)trailer, fireLog.end(trailer), nowMs());
+  #endif
+  #ifdef SD_POWER_MODE
+  if (setSdPower(true)) {
+    myFile = SD.open(full_filename, FILE_WRITE);
+  }
+  #endif
+  if (myFile && sdLog.flush(myFile, SD_LOG_ALL)) {
+    File next = sessionIndex.rotate(SD, myFile);
+    if (next) {
+      myFile = next;
+      full_filename = sessionIndex.name();
+      startLogFile(myFile);
+      myFile.flush();
+      sdLog.begin(myFile.size());
+      Serial.println("SD log continues in " + full_filename);
+    } else {
+      Serial.println("error opening next SD log");
+      myFile = SD.open(full_filename, FILE_WRITE);
+    }
+  }
+  #ifdef SD_POWER_MODE
+  myFile.close();
+  setSdPower(false);
+  #endif
+}
+#endif
+#endif
+
+#ifdef SD_POWER_MODE
+// Powers the card and initializes it, card has to be initialized again
+// after every power up
+bool setSdPower(bool on){
+  if (!on) {
+    SD.end();
+    digitalWrite(SD_POWER_PIN, LOW);
+    return true;
+  }
+  digitalWrite(SD_POWER_PIN, HIGH);
+  delay(SD_POWER_UP_MS);
+  if (!SD.begin(SD_CSPIN)) {
+    Serial.println("SD card initialization failed!");
+    return false;
+  }
+  return true;
+}
+#endif
+
 #endif
\ No newline at end of file
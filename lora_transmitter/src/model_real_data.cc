@@ -1,4 +1,7 @@
-unsigned char model_tflite[] = {
+// real_model/model_real3.tflite (convert_h5_to_tflite.py, float) as xxd -i.
+#include "model_real_data.h"
+
+alignas(16) const unsigned char model_tflite[] = {
   0x1c, 0x00, 0x00, 0x00, 0x54, 0x46, 0x4c, 0x33, 0x14, 0x00, 0x20, 0x00,
   0x1c, 0x00, 0x18, 0x00, 0x14, 0x00, 0x10, 0x00, 0x0c, 0x00, 0x00, 0x00,
   0x08, 0x00, 0x04, 0x00, 0x14, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
@@ -171,4 +174,4 @@ unsigned char model_tflite[] = {
   0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x0c, 0x00, 0x00, 0x00,
   0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09
 };
-unsigned int model_tflite_len = 2048;
+const unsigned int model_tflite_len = 2048;
@@ -0,0 +1,56 @@
+# Compare predictions of the compile-time generated fire net (lib/FireNet)
+# with the TFLite model on recorded sessions. Predictions of the generated
+# network are written by host_tools (env check_constexpr) for the same
+# sessions in the same order:
+#
+#   .pio/build/check_constexpr/program net.txt ../data/*.TXT ../data/*/*.TXT
+#   python check_constexpr.py --net_output ../host_tools/net.txt ../data/*.TXT ../data/*/*.TXT
+#
+# The TFLite model is run by tf.lite.Interpreter, without TensorFlow its
+# outputs for the same sessions come from host_tools bench_tflite
+# (see check_fixed.py), the sessions joined by commas in the same order:
+#
+#   .pio/build/bench_tflite/program -r tflite_outputs.txt $(ls ../data/*.TXT ../data/*/*.TXT | paste -sd,) \
+#       ../real_model/model_real3.tflite
+#   python check_constexpr.py --net_output ../host_tools/net.txt --tflite_output ../host_tools/tflite_outputs.txt \
+#       ../data/*.TXT ../data/*/*.TXT
+import argparse
+import numpy as np
+import pandas as pd
+
+from check_fixed import reference_predict
+
+parser = argparse.ArgumentParser()
+parser.add_argument("sessions", nargs="+", type=str, help="Recorded sessions (data/*.TXT).")
+parser.add_argument("--tflite", default="model_real3.tflite", type=str, help="TFLite model used as reference.")
+parser.add_argument("--net_output", required=True, type=str, help="Predictions written by host_tools check_constexpr.")
+parser.add_argument("--tflite_output", default=None, type=str,
+                    help="Outputs of the TFLite model written by host_tools bench_tflite -r for the same sessions.")
+parser.add_argument("--tolerance", default=1e-4, type=float, help="Maximal allowed absolute difference (float32 summation order).")
+
+
+def main(args: argparse.Namespace) -> int:
+    net = np.loadtxt(args.net_output)
+    tflite_output = np.loadtxt(args.tflite_output) if args.tflite_output is not None else None
+
+    offset = 0
+    worst = 0.0
+    for session in args.sessions:
+        x = pd.read_csv(session)[["smoke", "flame", "gas"]].values
+        reference = reference_predict(args.tflite, x, None if tflite_output is None
+                                      else tflite_output[offset:offset + len(x)])
+        predicted = net[offset:offset + len(x)]
+        offset += len(x)
+        diff = np.abs(predicted - reference)
+        worst = max(worst, diff.max())
+        print(f"{session:40s} rows {len(x):5d}, max abs diff {diff.max():.2e}, decisions differ in {np.count_nonzero((predicted >= 0.5) != (reference >= 0.5))}")
+
+    assert offset == len(net), "number of predictions does not match the sessions"
+    assert tflite_output is None or offset == len(tflite_output), "number of TFLite outputs does not match the sessions"
+    print(f"max abs diff {worst:.2e}: {'OK' if worst <= args.tolerance else 'MISMATCH'}")
+    return 0 if worst <= args.tolerance else 1
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    raise SystemExit(main(main_args))
@@ -0,0 +1,106 @@
+# Accuracy check of the fixed-point fire net (lib/FireNetFixed) against the
+# TFLite model on all_data.csv. The integer kernel is emulated bit by bit
+# with numpy, predictions dumped by host_tools (env bench_fixed) can be
+# compared with the emulation by --kernel_output.
+#
+# The TFLite model is run by tf.lite.Interpreter. Without TensorFlow its
+# outputs come from host_tools bench_tflite, which runs the .tflite with
+# reference kernels, by --tflite_output; the check fails without either.
+#
+#   python check_fixed.py
+#   .pio/build/bench_tflite/program -r tflite_outputs.txt ../real_model/all_data.csv ../real_model/model_real3.tflite
+#   python check_fixed.py --tflite_output ../host_tools/tflite_outputs.txt
+#   python check_fixed.py --kernel_output fixed_predictions.txt
+import argparse
+import sys
+import numpy as np
+import pandas as pd
+
+from export_fixed import load_dense_layers, quantize, LOGIT_FRAC, SIGMOID_STEP_BITS, PROB_SCALE
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--model", default="model_real3.h5", type=str, help="Keras model (.h5).")
+parser.add_argument("--tflite", default="model_real3.tflite", type=str, help="TFLite model used as reference.")
+parser.add_argument("--data", default="all_data.csv", type=str, help="Dataset with smoke,flame,gas,label columns.")
+parser.add_argument("--adc_max", default=1023, type=int, help="Maximal ADC value on the input.")
+parser.add_argument("--kernel_output", default=None, type=str, help="Predictions printed by host_tools bench_fixed.")
+parser.add_argument("--tflite_output", default=None, type=str,
+                    help="Outputs of the TFLite model written by host_tools bench_tflite -r for the same rows.")
+
+
+def emulate_fixed(q, x, adc_max):
+    # same integer operations as fire_net_fixed.cpp
+    x = np.clip(x.astype(np.int64), 0, adc_max)
+    acc = q["b1"][None, :] + x @ q["w1"].T
+    assert np.all(np.abs(acc) < 2**31), "int32 overflow"
+    hidden = np.maximum(acc, 0)
+    acc_out = q["b2"] + hidden @ q["w2"]
+    shift = q["out_frac"] - LOGIT_FRAC
+    logit = (acc_out + (1 << (shift - 1))) >> shift
+    return emulate_sigmoid(q["sigmoid"], logit)
+
+
+def emulate_sigmoid(table, logit):
+    # same as sigmoidFixed() in fire_net_fixed.cpp, logit is in Q12
+    interp_bits = LOGIT_FRAC - SIGMOID_STEP_BITS
+    z = np.abs(logit)
+    idx = z >> interp_bits
+    saturated = idx >= len(table) - 1
+    idx = np.minimum(idx, len(table) - 2)
+    t = z & ((1 << interp_bits) - 1)
+    lo, hi = table[idx], table[idx + 1]
+    p = np.where(saturated, table[-1], lo + (((hi - lo) * t + (1 << (interp_bits - 1))) >> interp_bits))
+    return np.where(logit < 0, table[-1] - p, p)
+
+
+def reference_predict(tflite_path, x, tflite_output=None):
+    # outputs of the TFLite model for rows x, tflite_output are the ones
+    # bench_tflite wrote for them
+    if tflite_output is not None:
+        if len(tflite_output) != len(x):
+            sys.exit(f"{len(tflite_output)} TFLite outputs for {len(x)} rows")
+        return tflite_output
+    try:
+        import tensorflow as tf
+    except ImportError:
+        sys.exit(f"TensorFlow not available, {tflite_path} cannot be run; "
+                 "give its outputs of host_tools bench_tflite -r by --tflite_output")
+
+    interpreter = tf.lite.Interpreter(model_path=tflite_path)
+    input_index = interpreter.get_input_details()[0]["index"]
+    interpreter.resize_tensor_input(input_index, x.shape)
+    interpreter.allocate_tensors()
+    interpreter.set_tensor(input_index, x.astype(np.float32))
+    interpreter.invoke()
+    return interpreter.get_tensor(interpreter.get_output_details()[0]["index"])[:, 0]
+
+
+def main(args: argparse.Namespace) -> None:
+    data = pd.read_csv(args.data)
+    x = data[["smoke", "flame", "gas"]].values
+    labels = data["label"].values
+
+    layers = load_dense_layers(args.model)
+    q = quantize(layers, args.adc_max)
+
+    fixed = emulate_fixed(q, x, args.adc_max)
+    tflite_output = np.loadtxt(args.tflite_output) if args.tflite_output is not None else None
+    reference = reference_predict(args.tflite, x, tflite_output)
+    reference_scaled = np.round(reference * PROB_SCALE).astype(np.int64)
+
+    error = np.abs(fixed - reference_scaled)
+    print(f"samples: {len(x)}")
+    print(f"abs error [1/{PROB_SCALE}]: max {error.max()}, mean {error.mean():.3f}, exact {np.mean(error == 0) * 100:.1f} %")
+    print(f"decision (p >= 0.5) agreement: {np.mean((fixed >= PROB_SCALE // 2) == (reference >= 0.5)) * 100:.2f} %")
+    print(f"accuracy reference: {np.mean((reference >= 0.5) == labels) * 100:.2f} %")
+    print(f"accuracy fixed:     {np.mean((fixed >= PROB_SCALE // 2) == labels) * 100:.2f} %")
+
+    if args.kernel_output is not None:
+        kernel = np.loadtxt(args.kernel_output, dtype=np.int64)
+        mismatch = np.count_nonzero(kernel != fixed)
+        print(f"C kernel vs emulation: {mismatch} mismatches ({'bit exact' if mismatch == 0 else 'NOT bit exact'})")
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    main(main_args)
@@ -0,0 +1,76 @@
+# Generate a header with constexpr weights of a Keras Sequential model of
+# Dense layers for the compile-time network template in lib/FireNet.
+# Only h5py and numpy are needed, no TensorFlow.
+#
+#   python export_constexpr.py --model model_real3.h5 --name model_real3 --out ../lib/FireNet/src/model_real3_net.h
+#   python export_constexpr.py --model ../synthetic_model_v1/model.h5 --name model_synthetic --out ../lib/FireNet/src/model_synthetic_net.h
+import argparse
+import json
+import h5py
+import numpy as np
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--model", default="model_real3.h5", type=str, help="Keras model (.h5).")
+parser.add_argument("--name", default="model_real3", type=str, help="Namespace of the generated network.")
+parser.add_argument("--out", default="../lib/FireNet/src/model_real3_net.h", type=str, help="Output header.")
+
+ACTIVATIONS = {"linear": "Linear", "relu": "Relu", "sigmoid": "Sigmoid"}
+
+
+def load_model(path):
+    # returns list of (name, activation, kernel, bias) in order of the model config
+    with h5py.File(path, "r") as f:
+        config = json.loads(f.attrs["model_config"])
+        layers = []
+        for layer in config["config"]["layers"]:
+            if layer["class_name"] == "InputLayer":
+                continue
+            assert layer["class_name"] == "Dense", f"unsupported layer {layer['class_name']}"
+            name = layer["config"]["name"]
+            found = {}
+            f["model_weights"][name].visititems(lambda n, o: found.__setitem__(n.split("/")[-1], o[()]) if isinstance(o, h5py.Dataset) else None)
+            layers.append((name, layer["config"]["activation"], found["kernel"], found["bias"]))
+    return layers
+
+
+def format_float(value):
+    text = f"{float(np.float32(value)):.9g}"
+    if "." not in text and "e" not in text:
+        text += ".0"
+    return text + "f"
+
+
+def format_floats(values):
+    return ", ".join(format_float(v) for v in np.ravel(values))
+
+
+def write_header(layers, name, path, model_path):
+    guard = f"{name.upper()}_NET_H_"
+    with open(path, "w") as f:
+        f.write(f"// Generated by real_model/export_constexpr.py from {model_path}, do not edit.\n")
+        f.write(f"#ifndef {guard}\n#define {guard}\n\n")
+        f.write('#include "fire_net.h"\n\n')
+        f.write(f"namespace {name} {{\n\n")
+        for layer_name, activation, kernel, bias in layers:
+            f.write(f"constexpr float {layer_name}_kernel[{kernel.shape[0]}][{kernel.shape[1]}] = {{\n")
+            for row in kernel:
+                f.write(f"  {{{format_floats(row)}}},\n")
+            f.write("};\n\n")
+            f.write(f"constexpr float {layer_name}_bias[{bias.shape[0]}] = {{{format_floats(bias)}}};\n\n")
+
+        dense = [f"Dense<{k.shape[0]}, {k.shape[1]}, {ACTIVATIONS[a]}, {n}_kernel, {n}_bias>" for n, a, k, b in layers]
+        f.write("typedef FireNet<" + ",\n                ".join(dense) + " > Net;\n\n")
+        f.write(f"}}  // namespace {name}\n\n")
+        f.write(f"#endif  // {guard}\n")
+
+
+def main(args: argparse.Namespace) -> None:
+    layers = load_model(args.model)
+    write_header(layers, args.name, args.out, args.model)
+    print(" -> ".join(f"Dense({k.shape[1]}, {a})" for n, a, k, b in layers))
+    print(f"Written {args.out}")
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    main(main_args)
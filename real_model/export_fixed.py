@@ -0,0 +1,98 @@
+# Export the 3-18-1 fire net (model_real3.h5) to integer weights for the
+# fixed-point kernel in lib/FireNetFixed. Only h5py and numpy are needed, no
+# TensorFlow. The same integer arithmetic is emulated in check_fixed.py.
+#
+#   python export_fixed.py --model model_real3.h5 --out ../lib/FireNetFixed/src/fire_net_fixed_weights.h
+import argparse
+import h5py
+import numpy as np
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--model", default="model_real3.h5", type=str, help="Keras model (.h5).")
+parser.add_argument("--out", default="../lib/FireNetFixed/src/fire_net_fixed_weights.h", type=str, help="Output header.")
+parser.add_argument("--adc_max", default=1023, type=int, help="Maximal ADC value on the input (10 bit ADC).")
+
+PROB_SCALE = 10000
+SIGMOID_RANGE = 10     # sigmoid is tabulated on <0, SIGMOID_RANGE)
+SIGMOID_STEP_BITS = 4  # 1/16 step of the table
+W2_FRAC = 15           # output layer weights in Q15
+LOGIT_FRAC = 12        # logit is rescaled to Q12 before sigmoid lookup
+
+
+def load_dense_layers(path):
+    # Keras stores the weights of every Dense layer as kernel (in x out) and bias (out)
+    layers = []
+    with h5py.File(path, "r") as f:
+        weights = f["model_weights"]
+        names = sorted((n for n in weights.keys() if n.startswith("dense")), key=lambda n: (len(n), n))
+        for name in names:
+            found = {}
+            weights[name].visititems(lambda n, o: found.__setitem__(n.split("/")[-1], o[()]) if isinstance(o, h5py.Dataset) else None)
+            layers.append((found["kernel"].astype(np.float64), found["bias"].astype(np.float64)))
+    return layers
+
+
+def quantize(layers, adc_max):
+    (w1, b1), (w2, b2) = layers
+    assert w1.shape[0] == 3 and w2.shape[1] == 1, "kernel supports only 3-N-1 topology"
+    assert np.max(np.abs(w2)) < 1.0, "output layer weights do not fit Q15"
+
+    # hidden accumulator (int32) has to hold adc_max * sum|w1| + |b1|
+    acc_max = np.max(adc_max * np.sum(np.abs(w1), axis=0) + np.abs(b1))
+    w1_frac = min(int(np.floor(np.log2((2**31 - 1) / acc_max))), 24)
+
+    q = {"w1_frac": w1_frac, "out_frac": w1_frac + W2_FRAC}
+    q["w1"] = np.round(w1.T * (1 << w1_frac)).astype(np.int64)  # (hidden, 3)
+    q["b1"] = np.round(b1 * (1 << w1_frac)).astype(np.int64)
+    q["w2"] = np.round(w2[:, 0] * (1 << W2_FRAC)).astype(np.int64)
+    q["b2"] = int(np.round(b2[0] * (1 << q["out_frac"])))
+
+    # sigmoid table in PROB_SCALE units, one extra entry for interpolation
+    z = np.arange(SIGMOID_RANGE * (1 << SIGMOID_STEP_BITS) + 1) / (1 << SIGMOID_STEP_BITS)
+    q["sigmoid"] = np.round(PROB_SCALE / (1 + np.exp(-z))).astype(np.int64)
+    return q
+
+
+def format_array(values, per_line=12):
+    values = [str(int(v)) for v in np.ravel(values)]
+    lines = [", ".join(values[i:i + per_line]) for i in range(0, len(values), per_line)]
+    return "  " + ",\n  ".join(lines)
+
+
+def write_header(q, path, model_path, adc_max):
+    hidden = q["w1"].shape[0]
+    with open(path, "w") as f:
+        f.write(f"// Generated by real_model/export_fixed.py from {model_path}, do not edit.\n")
+        f.write("#ifndef FIRE_NET_FIXED_WEIGHTS_H_\n#define FIRE_NET_FIXED_WEIGHTS_H_\n\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write(f"#define FIRE_NET_FIXED_HIDDEN {hidden}\n")
+        f.write(f"#define FIRE_NET_FIXED_ADC_MAX {adc_max}\n")
+        f.write(f"#define FIRE_NET_FIXED_W1_FRAC {q['w1_frac']}\n")
+        f.write(f"#define FIRE_NET_FIXED_W2_FRAC {W2_FRAC}\n")
+        f.write(f"#define FIRE_NET_FIXED_LOGIT_FRAC {LOGIT_FRAC}\n")
+        f.write(f"#define FIRE_NET_FIXED_SIGMOID_STEP_BITS {SIGMOID_STEP_BITS}\n")
+        f.write(f"#define FIRE_NET_FIXED_SIGMOID_LEN {len(q['sigmoid'])}\n\n")
+        f.write(f"// hidden layer weights in Q{q['w1_frac']}, one row per neuron (smoke, flame, gas)\n")
+        f.write(f"static const int32_t fire_net_fixed_w1[FIRE_NET_FIXED_HIDDEN][3] = {{\n{format_array(q['w1'], 3)}\n}};\n\n")
+        f.write(f"// hidden layer bias in Q{q['w1_frac']}\n")
+        f.write(f"static const int32_t fire_net_fixed_b1[FIRE_NET_FIXED_HIDDEN] = {{\n{format_array(q['b1'], 6)}\n}};\n\n")
+        f.write(f"// output layer weights in Q{W2_FRAC}\n")
+        f.write(f"static const int16_t fire_net_fixed_w2[FIRE_NET_FIXED_HIDDEN] = {{\n{format_array(q['w2'])}\n}};\n\n")
+        f.write(f"// output layer bias in Q{q['out_frac']}\n")
+        f.write(f"static const int64_t fire_net_fixed_b2 = {q['b2']}LL;\n\n")
+        f.write(f"// sigmoid(k / {1 << SIGMOID_STEP_BITS}) * PROB_SCALE for k = 0 .. FIRE_NET_FIXED_SIGMOID_LEN - 1\n")
+        f.write(f"static const uint16_t fire_net_fixed_sigmoid[FIRE_NET_FIXED_SIGMOID_LEN] = {{\n{format_array(q['sigmoid'])}\n}};\n\n")
+        f.write("#endif  // FIRE_NET_FIXED_WEIGHTS_H_\n")
+
+
+def main(args: argparse.Namespace) -> None:
+    layers = load_dense_layers(args.model)
+    q = quantize(layers, args.adc_max)
+    write_header(q, args.out, args.model, args.adc_max)
+    print(f"hidden weights Q{q['w1_frac']}, output weights Q{W2_FRAC}, logit Q{q['out_frac']}")
+    print(f"Written {args.out}")
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    main(main_args)
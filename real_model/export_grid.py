@@ -0,0 +1,98 @@
+# Distil the fire net (model_real3.h5) into a 3-D grid over the ADC input
+# space (smoke, flame, gas) for lib/FireNetGrid. The grid stores the logit
+# (int8, Q4, clipped to <-8, 8)), which is piecewise linear for a ReLU net and
+# so interpolates much better than the probability itself. Firmware does
+# trilinear interpolation and the tabulated sigmoid of lib/FireNetFixed.
+#
+# Prints table size against max/mean abs error on all_data.csv for several
+# grid steps and writes the header for the chosen one:
+#
+#   python export_grid.py --step_bits 6 --out ../lib/FireNetGrid/src/fire_net_grid_table.h
+import argparse
+import numpy as np
+import pandas as pd
+
+from export_fixed import load_dense_layers, quantize, LOGIT_FRAC, PROB_SCALE
+from check_fixed import emulate_sigmoid, reference_predict
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--model", default="model_real3.h5", type=str, help="Keras model (.h5).")
+parser.add_argument("--tflite", default="model_real3.tflite", type=str, help="TFLite model used as reference.")
+parser.add_argument("--data", default="all_data.csv", type=str, help="Dataset with smoke,flame,gas columns.")
+parser.add_argument("--step_bits", default=6, type=int, help="Grid step is 2^step_bits ADC counts.")
+parser.add_argument("--out", default="../lib/FireNetGrid/src/fire_net_grid_table.h", type=str, help="Output header.")
+
+ADC_RANGE = 1024  # 10 bit ADC, grid covers <0, ADC_RANGE>
+GRID_FRAC = 4     # logit in the grid is Q4
+
+
+def build_grid(layers, step_bits):
+    (w1, b1), (w2, b2) = layers
+    size = ADC_RANGE // (1 << step_bits) + 1
+    axis = np.arange(size) * (1 << step_bits)
+    points = np.stack(np.meshgrid(axis, axis, axis, indexing="ij"), -1).reshape(-1, 3)
+    logit = np.maximum(points @ w1 + b1, 0) @ w2[:, 0] + b2[0]
+    grid = np.clip(np.round(logit * (1 << GRID_FRAC)), -128, 127).astype(np.int64)
+    return grid.reshape(size, size, size)
+
+
+def emulate_grid(grid, step_bits, sigmoid_table, x):
+    # same integer operations as fire_net_grid.cpp
+    x = np.clip(x.astype(np.int64), 0, ADC_RANGE - 1)
+    i = x >> step_bits
+    t = x & ((1 << step_bits) - 1)
+    one = 1 << step_bits
+    acc = 0
+    for dx in (0, 1):
+        for dy in (0, 1):
+            for dz in (0, 1):
+                w = (t[:, 0] if dx else one - t[:, 0]) * (t[:, 1] if dy else one - t[:, 1]) * (t[:, 2] if dz else one - t[:, 2])
+                acc = acc + w * grid[i[:, 0] + dx, i[:, 1] + dy, i[:, 2] + dz]
+    # acc is Q(GRID_FRAC + 3 * step_bits), rescale to Q12
+    shift = GRID_FRAC + 3 * step_bits - LOGIT_FRAC
+    logit = (acc + (1 << (shift - 1))) >> shift if shift > 0 else acc << -shift
+    return emulate_sigmoid(sigmoid_table, logit)
+
+
+def write_header(grid, step_bits, path, model_path):
+    size = grid.shape[0]
+    with open(path, "w") as f:
+        f.write(f"// Generated by real_model/export_grid.py from {model_path}, do not edit.\n")
+        f.write("#ifndef FIRE_NET_GRID_TABLE_H_\n#define FIRE_NET_GRID_TABLE_H_\n\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write(f"#define FIRE_NET_GRID_STEP_BITS {step_bits}\n")
+        f.write(f"#define FIRE_NET_GRID_SIZE {size}\n")
+        f.write(f"#define FIRE_NET_GRID_FRAC {GRID_FRAC}\n\n")
+        f.write(f"// logit in Q{GRID_FRAC} at [smoke][flame][gas] = [i][j][k] * {1 << step_bits}\n")
+        f.write("static const int8_t fire_net_grid[FIRE_NET_GRID_SIZE][FIRE_NET_GRID_SIZE][FIRE_NET_GRID_SIZE] = {\n")
+        for plane in grid:
+            f.write("  {\n")
+            for row in plane:
+                f.write("    {" + ",".join(str(int(v)) for v in row) + "},\n")
+            f.write("  },\n")
+        f.write("};\n\n")
+        f.write("#endif  // FIRE_NET_GRID_TABLE_H_\n")
+
+
+def main(args: argparse.Namespace) -> None:
+    layers = load_dense_layers(args.model)
+    sigmoid_table = quantize(layers, ADC_RANGE - 1)["sigmoid"]
+    x = pd.read_csv(args.data)[["smoke", "flame", "gas"]].values
+    reference = np.round(reference_predict(layers, args.tflite, x) * PROB_SCALE).astype(np.int64)
+
+    print(f"{'step':>6s} {'size':>10s} {'max err':>9s} {'mean err':>9s} {'decisions':>10s}")
+    for step_bits in range(7, 3, -1):
+        grid = build_grid(layers, step_bits)
+        predicted = emulate_grid(grid, step_bits, sigmoid_table, x)
+        error = np.abs(predicted - reference) / PROB_SCALE
+        agree = np.mean((predicted >= PROB_SCALE // 2) == (reference >= PROB_SCALE // 2)) * 100
+        marker = " <-" if step_bits == args.step_bits else ""
+        print(f"{1 << step_bits:6d} {grid.size:8d} B {error.max():9.4f} {error.mean():9.5f} {agree:9.2f}%{marker}")
+
+    write_header(build_grid(layers, args.step_bits), args.step_bits, args.out, args.model)
+    print(f"Written {args.out}")
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    main(main_args)
@@ -0,0 +1,176 @@
+# Export the temporal fire net (model_temporal.npz of train_temporal.py) to
+# integer weights for the streaming kernel in lib/FireNetTemporal. Only
+# numpy is needed. The integer arithmetic of the kernel is emulated here and
+# compared with the float net on the recorded sessions, predictions dumped by
+# host_tools (env bench_temporal) can be compared with the emulation by
+# --kernel_output.
+#
+#   python export_temporal.py --out ../lib/FireNetTemporal/src/fire_net_temporal_weights.h
+#   python export_temporal.py --kernel_output temporal_predictions.txt
+import argparse
+import numpy as np
+
+from train_temporal import load_sessions, run_session
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--model", default="model_temporal.npz", type=str, help="Weights of train_temporal.py.")
+parser.add_argument("--out", default="../lib/FireNetTemporal/src/fire_net_temporal_weights.h", type=str,
+                    help="Output header.")
+parser.add_argument("--adc_max", default=1023, type=int, help="Maximal ADC value on the input (10 bit ADC).")
+parser.add_argument("--sessions", default="../data/tatka_taborak/*.TXT,../data/lhota_velke_ohne/*.TXT,"
+                    "../data/TABOR3_carodejnice.TXT,../data/final_test/hohoho.TXT", type=str,
+                    help="Sessions of the check (bench_temporal gets the same ones), comma separated globs.")
+parser.add_argument("--kernel_output", default=None, type=str, help="Predictions printed by host_tools bench_temporal.")
+
+PROB_SCALE = 10000
+FRAC = 12              # weights, state and pre-activations in Q12, biases in Q24
+GATE_FRAC = 15         # sigmoid output (gates) in Q15
+SIGMOID_RANGE = 16     # sigmoid is tabulated on <0, SIGMOID_RANGE)
+SIGMOID_STEP_BITS = 4  # 1/16 step of the table
+
+
+def quantize(p, adc_max):
+    hidden = len(p["bn_rec"])
+    input_shift = FRAC - int(np.log2(float(p["input_scale"])))
+    assert input_shift >= 0 and (1 << (FRAC - input_shift)) == p["input_scale"], "input scale has to be 2^k <= 2^12"
+    for name in ("W", "U", "wo"):
+        assert np.max(np.abs(p[name])) < 8.0, f"{name} does not fit int16 Q{FRAC}"
+
+    q = {"hidden": hidden, "input_shift": input_shift}
+    # one row per gate and neuron (z, r, n), columns of the inputs or the state
+    q["w"] = np.round(p["W"].T * (1 << FRAC)).astype(np.int64)
+    q["u"] = np.round(p["U"].T * (1 << FRAC)).astype(np.int64)
+    q["b"] = np.round(p["b"] * (1 << 2 * FRAC)).astype(np.int64)
+    q["bn_rec"] = np.round(p["bn_rec"] * (1 << 2 * FRAC)).astype(np.int64)
+    q["wo"] = np.round(p["wo"] * (1 << FRAC)).astype(np.int64)
+    q["bo"] = int(np.round(p["bo"][0] * (1 << 2 * FRAC)))
+
+    # gate accumulators (int32) hold bias + inputs * w + state * u, the state
+    # is at most 1 (tanh) in Q12
+    x_max = adc_max << input_shift
+    acc_max = np.abs(q["b"]) + x_max * np.sum(np.abs(q["w"]), axis=1) + (1 << FRAC) * np.sum(np.abs(q["u"]), axis=1)
+    assert np.max(acc_max) < 2**31, "gate accumulator overflows int32"
+    hn_max = (np.abs(q["bn_rec"]) + (1 << FRAC) * np.sum(np.abs(q["u"][2 * hidden:]), axis=1)) >> FRAC
+    assert np.max(hn_max) < 2**19, "r * (h Un + bn_rec) overflows int32"
+
+    z = np.arange(SIGMOID_RANGE * (1 << SIGMOID_STEP_BITS) + 1) / (1 << SIGMOID_STEP_BITS)
+    q["sigmoid"] = np.round((1 << GATE_FRAC) / (1 + np.exp(-z))).astype(np.int64)
+    assert q["sigmoid"][-1] == 1 << GATE_FRAC
+    return q
+
+
+def emulate_sigmoid(table, a):
+    # same as sigmoidQ15() in fire_net_temporal.cpp, a is in Q12
+    interp_bits = FRAC - SIGMOID_STEP_BITS
+    z = abs(a)
+    idx = z >> interp_bits
+    if idx >= len(table) - 1:
+        p = int(table[-1])
+    else:
+        t = z & ((1 << interp_bits) - 1)
+        lo, hi = int(table[idx]), int(table[idx + 1])
+        p = lo + (((hi - lo) * t + (1 << (interp_bits - 1))) >> interp_bits)
+    return int(table[-1]) - p if a < 0 else p
+
+
+def emulate_session(q, readings, adc_max):
+    # same integer operations as FireNetTemporal::step(), one reading per row
+    def to_q12(acc):
+        return (acc + (1 << (FRAC - 1))) >> FRAC
+
+    hidden, table = q["hidden"], q["sigmoid"]
+    h = np.zeros(hidden, dtype=np.int64)
+    probs = np.empty(len(readings), dtype=np.int64)
+    for t, reading in enumerate(readings):
+        x = np.clip(reading.astype(np.int64), 0, adc_max) << q["input_shift"]
+        acc_x = q["b"] + q["w"] @ x
+        acc_h = q["u"] @ h
+        h_next = np.empty(hidden, dtype=np.int64)
+        for j in range(hidden):
+            z = emulate_sigmoid(table, int(to_q12(acc_x[j] + acc_h[j])))
+            r = emulate_sigmoid(table, int(to_q12(acc_x[hidden + j] + acc_h[hidden + j])))
+            hn = int(to_q12(q["bn_rec"][j] + acc_h[2 * hidden + j]))
+            r12 = (r + 4) >> 3
+            a_n = int(to_q12(acc_x[2 * hidden + j])) + ((r12 * hn + (1 << (FRAC - 1))) >> FRAC)
+            n = (2 * emulate_sigmoid(table, 2 * a_n) - (1 << GATE_FRAC) + 4) >> 3
+            h_next[j] = n + ((z * (int(h[j]) - n) + (1 << (GATE_FRAC - 1))) >> GATE_FRAC)
+        h = h_next
+        logit = int(to_q12(q["bo"] + q["wo"] @ h))
+        probs[t] = (emulate_sigmoid(table, logit) * PROB_SCALE + (1 << (GATE_FRAC - 1))) >> GATE_FRAC
+    return probs
+
+
+def format_array(values, per_line=12):
+    values = [str(int(v)) for v in np.ravel(values)]
+    lines = [", ".join(values[i:i + per_line]) for i in range(0, len(values), per_line)]
+    return "  " + ",\n  ".join(lines)
+
+
+def write_header(q, path, model_path, adc_max):
+    hidden = q["hidden"]
+    with open(path, "w") as f:
+        f.write(f"// Generated by real_model/export_temporal.py from {model_path}, do not edit.\n")
+        f.write("#ifndef FIRE_NET_TEMPORAL_WEIGHTS_H_\n#define FIRE_NET_TEMPORAL_WEIGHTS_H_\n\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN {hidden}\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_ADC_MAX {adc_max}\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_INPUT_SHIFT {q['input_shift']}\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_FRAC {FRAC}\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_GATE_FRAC {GATE_FRAC}\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_SIGMOID_STEP_BITS {SIGMOID_STEP_BITS}\n")
+        f.write(f"#define FIRE_NET_TEMPORAL_SIGMOID_LEN {len(q['sigmoid'])}\n\n")
+        f.write(f"// input weights in Q{FRAC}, rows z, r, n of every neuron (smoke, flame, gas)\n")
+        f.write(f"static const int16_t fire_net_temporal_w[3 * FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN][3] = {{\n"
+                f"{format_array(q['w'], 3)}\n}};\n\n")
+        f.write(f"// recurrent weights in Q{FRAC}, rows z, r, n of every neuron\n")
+        f.write(f"static const int16_t fire_net_temporal_u[3 * FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN]"
+                f"[FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {{\n{format_array(q['u'], hidden)}\n}};\n\n")
+        f.write(f"// input bias in Q{2 * FRAC}, rows z, r, n\n")
+        f.write(f"static const int32_t fire_net_temporal_b[3 * FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {{\n"
+                f"{format_array(q['b'], hidden)}\n}};\n\n")
+        f.write(f"// recurrent bias of n in Q{2 * FRAC}\n")
+        f.write(f"static const int32_t fire_net_temporal_bn_rec[FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {{\n"
+                f"{format_array(q['bn_rec'], hidden)}\n}};\n\n")
+        f.write(f"// output layer weights in Q{FRAC}\n")
+        f.write(f"static const int16_t fire_net_temporal_wo[FIRE_NET_TEMPORAL_WEIGHTS_HIDDEN] = {{\n"
+                f"{format_array(q['wo'], hidden)}\n}};\n\n")
+        f.write(f"// output layer bias in Q{2 * FRAC}\n")
+        f.write(f"static const int32_t fire_net_temporal_bo = {q['bo']};\n\n")
+        f.write(f"// sigmoid(k / {1 << SIGMOID_STEP_BITS}) in Q{GATE_FRAC} for k = 0 .. FIRE_NET_TEMPORAL_SIGMOID_LEN - 1\n")
+        f.write(f"static const uint16_t fire_net_temporal_sigmoid[FIRE_NET_TEMPORAL_SIGMOID_LEN] = {{\n"
+                f"{format_array(q['sigmoid'])}\n}};\n\n")
+        f.write("#endif  // FIRE_NET_TEMPORAL_WEIGHTS_H_\n")
+
+
+def main(args: argparse.Namespace) -> None:
+    model = np.load(args.model)
+    p = {k: model[k] for k in model.files}
+    q = quantize(p, args.adc_max)
+    write_header(q, args.out, args.model, args.adc_max)
+    print(f"{q['hidden']} hidden units, weights Q{FRAC}, gates Q{GATE_FRAC}")
+    print(f"Written {args.out}")
+
+    fixed_all = []
+    error_max = 0
+    agree = total = 0
+    for path, x, y in load_sessions(args.sessions):
+        reference = run_session(p, x)
+        fixed = emulate_session(q, np.round(x * p["input_scale"]).astype(np.int64), args.adc_max)
+        fixed_all.append(fixed)
+        error_max = max(error_max, int(np.max(np.abs(fixed - np.round(reference * PROB_SCALE)))))
+        agree += np.sum((fixed >= PROB_SCALE // 2) == (reference >= 0.5))
+        total += len(fixed)
+    print(f"readings: {total}")
+    print(f"abs error of the integer kernel [1/{PROB_SCALE}]: max {error_max}")
+    print(f"decision (p >= 0.5) agreement: {agree / total * 100:.2f} %")
+
+    if args.kernel_output is not None:
+        kernel = np.loadtxt(args.kernel_output, dtype=np.int64)
+        fixed_all = np.concatenate(fixed_all)
+        mismatch = np.count_nonzero(kernel != fixed_all) if len(kernel) == len(fixed_all) else len(fixed_all)
+        print(f"C kernel vs emulation: {mismatch} mismatches ({'bit exact' if mismatch == 0 else 'NOT bit exact'})")
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    main(main_args)
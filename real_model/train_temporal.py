@@ -0,0 +1,194 @@
+# Stateful temporal fire net: a GRU over the readings of a session, one step
+# per measurement cycle (TIME_SPAN), so a growing fire and a steady campfire
+# of the same readings can be told apart by the history in the hidden state.
+# Trained here with numpy only (truncated backpropagation through time over
+# windows of the recorded sessions), export_temporal.py turns the weights into
+# the integer kernel of lib/FireNetTemporal.
+#
+#   python train_temporal.py
+#   python export_temporal.py
+#
+# Cell (Keras GRU, reset_after, gates z, r, n):
+#   z  = sigmoid(x Wz + h Uz + bz)
+#   r  = sigmoid(x Wr + h Ur + br)
+#   n  = tanh(x Wn + bn + r * (h Un + bn_rec))
+#   h' = z * h + (1 - z) * n
+#   p  = sigmoid(h' wo + bo)
+# x are the readings divided by INPUT_SCALE (10 bit ADC counts).
+import argparse
+import glob
+import numpy as np
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--hidden", default=8, type=int, help="Hidden units.")
+parser.add_argument("--epochs", default=600, type=int, help="Number of epochs.")
+parser.add_argument("--seed", default=42, type=int, help="Random seed.")
+parser.add_argument("--learning_rate", default=0.01, type=float, help="Initial learning rate.")
+parser.add_argument("--window", default=256, type=int, help="Readings of a training window.")
+parser.add_argument("--warmup", default=64, type=int, help="Readings of a window before the loss counts.")
+parser.add_argument("--stride", default=32, type=int, help="Readings between training windows.")
+parser.add_argument("--sessions", default="../data/tatka_taborak/*.TXT,../data/lhota_velke_ohne/*.TXT", type=str,
+                    help="Training sessions (the sessions of all_data.csv), comma separated globs.")
+parser.add_argument("--test_sessions", default="../data/TABOR3_carodejnice.TXT,../data/final_test/hohoho.TXT",
+                    type=str, help="Held-out sessions, comma separated globs.")
+parser.add_argument("--out", default="model_temporal.npz", type=str, help="Trained weights.")
+
+INPUT_SCALE = 1024.0
+
+
+def load_sessions(globs):
+    # smoke,flame,gas,label[,prob] with header, one reading per row
+    sessions = []
+    for pattern in globs.split(","):
+        for path in sorted(glob.glob(pattern)):
+            rows = np.genfromtxt(path, delimiter=",", skip_header=1, usecols=(0, 1, 2, 3))
+            rows = rows[~np.isnan(rows).any(axis=1)]
+            sessions.append((path, rows[:, :3] / INPUT_SCALE, (rows[:, 3] > 0).astype(np.float64)))
+    return sessions
+
+
+def sigmoid(a):
+    return 1 / (1 + np.exp(-a))
+
+
+def init_params(hidden, rng):
+    def glorot(n_in, n_out):
+        limit = np.sqrt(6 / (n_in + n_out))
+        return rng.uniform(-limit, limit, (n_in, n_out))
+
+    u = np.concatenate([np.linalg.qr(rng.normal(size=(hidden, hidden)))[0] for _ in range(3)], axis=1)
+    return {"W": glorot(3, 3 * hidden), "U": u, "b": np.zeros(3 * hidden), "bn_rec": np.zeros(hidden),
+            "wo": glorot(hidden, 1)[:, 0], "bo": np.zeros(1)}
+
+
+def gru_step(p, x, h):
+    hidden = h.shape[1]
+    ax = x @ p["W"] + p["b"]
+    ah = h @ p["U"]
+    z = sigmoid(ax[:, :hidden] + ah[:, :hidden])
+    r = sigmoid(ax[:, hidden:2 * hidden] + ah[:, hidden:2 * hidden])
+    hn = ah[:, 2 * hidden:] + p["bn_rec"]
+    n = np.tanh(ax[:, 2 * hidden:] + r * hn)
+    h_next = z * h + (1 - z) * n
+    return h_next, (x, h, z, r, hn, n)
+
+
+def run_session(p, x):
+    # stateful inference, one step per reading as on the node
+    h = np.zeros((1, len(p["bn_rec"])))
+    probs = np.empty(len(x))
+    for t in range(len(x)):
+        h, _ = gru_step(p, x[t:t + 1], h)
+        probs[t] = sigmoid(h[0] @ p["wo"] + p["bo"][0])
+    return probs
+
+
+def loss_and_grads(p, x, y, mask):
+    # x (T, B, 3), y and mask (T, B), loss is mean binary cross-entropy over mask
+    steps, batch = y.shape
+    hidden = len(p["bn_rec"])
+    h = np.zeros((batch, hidden))
+    caches, hs, probs = [], [], []
+    for t in range(steps):
+        h, cache = gru_step(p, x[t], h)
+        caches.append(cache)
+        hs.append(h)
+        probs.append(sigmoid(h @ p["wo"] + p["bo"][0]))
+    probs = np.clip(np.array(probs), 1e-7, 1 - 1e-7)
+    count = mask.sum()
+    loss = -np.sum(mask * (y * np.log(probs) + (1 - y) * np.log(1 - probs))) / count
+
+    g = {k: np.zeros_like(v) for k, v in p.items()}
+    dh_next = np.zeros((batch, hidden))
+    for t in reversed(range(steps)):
+        x_t, h_prev, z, r, hn, n = caches[t]
+        dlogit = (probs[t] - y[t]) * mask[t] / count
+        g["wo"] += hs[t].T @ dlogit
+        g["bo"] += dlogit.sum()
+        dh = dh_next + dlogit[:, None] * p["wo"][None, :]
+        dz = dh * (h_prev - n)
+        dn = dh * (1 - z)
+        dh_prev = dh * z
+        da_n = dn * (1 - n * n)
+        dr = da_n * hn
+        dhn = da_n * r
+        da_z = dz * z * (1 - z)
+        da_r = dr * r * (1 - r)
+        da_x = np.concatenate([da_z, da_r, da_n], axis=1)
+        da_h = np.concatenate([da_z, da_r, dhn], axis=1)
+        g["W"] += x_t.T @ da_x
+        g["b"] += da_x.sum(axis=0)
+        g["U"] += h_prev.T @ da_h
+        g["bn_rec"] += dhn.sum(axis=0)
+        dh_next = dh_prev + da_h @ p["U"].T
+    return loss, g
+
+
+def make_windows(sessions, window, warmup, stride):
+    # windows start from zero state as the node after a reset, the loss
+    # counts after warmup readings (and on the first ones of a session)
+    xs, ys, masks = [], [], []
+    for _, x, y in sessions:
+        starts = list(range(0, max(len(x) - window, 0) + 1, stride))
+        if starts[-1] + window < len(x):
+            starts.append(len(x) - window)
+        for s in starts:
+            xw = np.zeros((window, 3))
+            yw = np.zeros(window)
+            mw = np.zeros(window)
+            n = min(window, len(x) - s)
+            xw[:n] = x[s:s + n]
+            yw[:n] = y[s:s + n]
+            mw[:n] = 1
+            if s > 0:
+                mw[:warmup] = 0
+            xs.append(xw)
+            ys.append(yw)
+            masks.append(mw)
+    return np.stack(xs, axis=1), np.stack(ys, axis=1), np.stack(masks, axis=1)
+
+
+def report(p, sessions, name):
+    correct = total = 0
+    for path, x, y in sessions:
+        probs = run_session(p, x)
+        correct += np.sum((probs >= 0.5) == (y > 0))
+        total += len(y)
+    print(f"{name} accuracy (stateful over whole sessions): {correct / total * 100:.2f} % of {total} readings")
+
+
+def main(args: argparse.Namespace) -> None:
+    rng = np.random.default_rng(args.seed)
+    sessions = load_sessions(args.sessions)
+    test_sessions = load_sessions(args.test_sessions)
+    x, y, mask = make_windows(sessions, args.window, args.warmup, args.stride)
+    print(f"{len(sessions)} training sessions, {x.shape[1]} windows of {args.window} readings")
+
+    p = init_params(args.hidden, rng)
+    m = {k: np.zeros_like(v) for k, v in p.items()}
+    v = {k: np.zeros_like(v) for k, v in p.items()}
+    beta1, beta2 = 0.9, 0.999
+    for epoch in range(args.epochs):
+        # AdamW with cosine decay to 0 as predict_fire.py, whole batch
+        lr = args.learning_rate * 0.5 * (1 + np.cos(np.pi * epoch / args.epochs))
+        loss, g = loss_and_grads(p, x, y, mask)
+        norm = np.sqrt(sum(np.sum(gk * gk) for gk in g.values()))
+        scale = min(1.0, 1.0 / (norm + 1e-12))  # gradient clipping
+        for k in p:
+            m[k] = beta1 * m[k] + (1 - beta1) * g[k] * scale
+            v[k] = beta2 * v[k] + (1 - beta2) * (g[k] * scale) ** 2
+            m_hat = m[k] / (1 - beta1 ** (epoch + 1))
+            v_hat = v[k] / (1 - beta2 ** (epoch + 1))
+            p[k] -= lr * (m_hat / (np.sqrt(v_hat) + 1e-8) + 0.004 * p[k])
+        if (epoch + 1) % 50 == 0:
+            print(f"Epoch {epoch + 1:03d}: loss {loss:.4f}, learning rate {lr:.6f}")
+
+    report(p, sessions, "training")
+    report(p, test_sessions, "held-out")
+    np.savez(args.out, input_scale=INPUT_SCALE, **p)
+    print(f"Written {args.out}")
+
+
+if __name__ == "__main__":
+    main_args = parser.parse_args([] if "__file__" not in globals() else None)
+    main(main_args)
@@ -1,24 +1,63 @@
 #include <Arduino.h>
+#include "memory_profile.h"
+
+// Set inference mode. In constexpr mode is the network generated at compile
+// time from synthetic_model_v1/model.h5 (real_model/export_constexpr.py),
+// otherwise the TFLite flatbuffer is parsed by EloquentTinyML at startup.
+// Comment out following # define for TFLite mode.
+#define CONSTEXPR_NET_MODE
+
+#ifdef CONSTEXPR_NET_MODE
+
+#include "model_synthetic_net.h"
+
+#define NUMBER_OF_INPUTS model_synthetic::Net::inputs
+
+struct {
+    float predict(const float *input) { return model_synthetic::Net::predict(input); }
+} ml;
+
+#else
+
 #include "model_data.h"
 #include <EloquentTinyML.h>
+#include "tflite_arena.h"
 
 // Define the number of inputs and outputs for the model
 #define NUMBER_OF_INPUTS  3
 #define NUMBER_OF_OUTPUTS 1
 
-// Define the size of the tensor arena (used for memory allocation during inference)
-// For small models, 2–4 KB is usually enough
-#define TENSOR_ARENA_SIZE (2 * 1024)
+// Size of the tensor arena (used for memory allocation during inference)
+// comes with the model, MODEL_ARENA_SIZE of its header
+#define TENSOR_ARENA_SIZE MODEL_ARENA_SIZE
 
 // Create an instance of the TfLite interpreter for the given model
-Eloquent::TinyML::TfLite<NUMBER_OF_INPUTS, NUMBER_OF_OUTPUTS, TENSOR_ARENA_SIZE> ml;
+ProfiledTfLite<NUMBER_OF_INPUTS, NUMBER_OF_OUTPUTS, TENSOR_ARENA_SIZE> ml;
+
+#endif
+
+// Memory usage (lib/MemoryProfile) is printed every MEMORY_REPORT_LOOPS
+// predictions, static RAM and flash are checked at build time
+// (host_tools/memory_budget.py)
+#define MEMORY_REPORT_LOOPS 60
+
+unsigned int loops = 0;
 
 void setup() {
+    paintStack();
     Serial.begin(9600);
     delay(1000);
 
+    #ifndef CONSTEXPR_NET_MODE
     // Initialize the model from the included model data array
     ml.begin(model_tflite);
+    Serial.print("Tensor arena used: ");
+    Serial.print((unsigned long)ml.arenaUsed());
+    Serial.print(" of ");
+    Serial.print(TENSOR_ARENA_SIZE);
+    Serial.print(" B, MODEL_ARENA_SIZE needed ");
+    Serial.println((unsigned long)ml.arenaNeeded());
+    #endif
     Serial.println("Model is ready!");
 }
 
@@ -45,5 +84,9 @@ void loop() {
     Serial.print("  =>  golden value: ");
     Serial.println(x1*0.2 + x2*0.5 + x3*0.3);
 
+    if (++loops % MEMORY_REPORT_LOOPS == 0) {
+        printMemoryUsage(Serial, memoryUsage());
+    }
+
     delay(1000);
 }
\ No newline at end of file